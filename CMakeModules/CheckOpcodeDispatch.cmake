@@ -0,0 +1,48 @@
+#
+# This file is part of AtomVM.
+#
+# Copyright 2026 agent <agent@local>
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+#
+
+# Check that every opcode handled by the switch of opcodesswitch.h also has a
+# DISPATCH_TARGET label and a DISPATCH_ENTRY in the dispatch table. The build
+# of the loader only catches a missing DISPATCH_ENTRY if the case has its
+# DISPATCH_TARGET.
+function(check_opcode_dispatch file)
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${file})
+    file(READ ${file} contents)
+
+    string(REGEX MATCHALL "case OP_[A-Z0-9_]+:" cases "${contents}")
+    string(REGEX REPLACE "case (OP_[A-Z0-9_]+):" "\\1" cases "${cases}")
+    string(REGEX MATCHALL "DISPATCH_TARGET\\(OP_[A-Z0-9_]+\\)" targets "${contents}")
+    string(REGEX REPLACE "DISPATCH_TARGET\\((OP_[A-Z0-9_]+)\\)" "\\1" targets "${targets}")
+    string(REGEX MATCHALL "DISPATCH_ENTRY\\(OP_[A-Z0-9_]+\\)" entries "${contents}")
+    string(REGEX REPLACE "DISPATCH_ENTRY\\((OP_[A-Z0-9_]+)\\)" "\\1" entries "${entries}")
+
+    foreach(list_name cases targets entries)
+        list(SORT ${list_name})
+    endforeach()
+    if (NOT cases STREQUAL targets OR NOT cases STREQUAL entries)
+        set(missing_targets ${cases})
+        list(REMOVE_ITEM missing_targets ${targets})
+        set(missing_entries ${cases})
+        list(REMOVE_ITEM missing_entries ${entries})
+        message(FATAL_ERROR "${file}: opcode cases, DISPATCH_TARGET labels and DISPATCH_ENTRY "
+            "entries don't match. Missing targets: ${missing_targets}. "
+            "Missing entries: ${missing_entries}.")
+    endif()
+endfunction()
@@ -29,6 +29,7 @@
     apply/3,
     start_timer/3, start_timer/4,
     cancel_timer/1,
+    read_timer/1,
     send_after/3,
     process_info/2,
     system_info/1,
@@ -45,6 +46,8 @@
     get/1,
     put/2,
     erase/1,
+    get_keys/0,
+    get_keys/1,
     function_exported/3,
     display/1,
     list_to_atom/1,
@@ -94,6 +97,7 @@
     is_process_alive/1,
     garbage_collect/0,
     garbage_collect/1,
+    statistics/1,
     binary_to_term/1,
     term_to_binary/1,
     timestamp/0,
@@ -106,15 +110,10 @@
     timestamp/0
 ]).
 
-%%
-%% TODO Correct the following bugs
-%% * cancel_timer should be renamed cancel, per the OTP documentation
-%% * return value needs to be {ok, cancel} or {error, Reason}
-%% * review API documentation for timer functions in this module
-%%
-
--type mem_type() :: binary.
+-type mem_type() :: binary | atomvm_pool_reserved | atomvm_pool_oversized.
 -type time_unit() :: second | millisecond | microsecond.
+-type priority_level() :: low | normal | high | max.
+-type message_queue_data() :: on_heap | off_heap.
 -type timestamp() :: {
     MegaSecs :: non_neg_integer(), Secs :: non_neg_integer(), MicroSecs :: non_neg_integer
 }.
@@ -129,8 +128,8 @@
 %% @end
 %%-----------------------------------------------------------------------------
 -spec start_timer(Time :: non_neg_integer(), Dest :: pid() | atom(), Msg :: term()) -> reference().
-start_timer(Time, Dest, Msg) ->
-    start_timer(Time, Dest, Msg, []).
+start_timer(_Time, _Dest, _Msg) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @hidden
@@ -147,24 +146,31 @@ start_timer(Time, Dest, Msg) ->
 -spec start_timer(
     Time :: non_neg_integer(), Dest :: pid() | atom(), Msg :: term(), _Options :: list()
 ) -> reference().
-start_timer(Time, Dest, Msg, _Options) ->
-    timer_manager:start_timer(Time, Dest, Msg).
+start_timer(_Time, _Dest, _Msg, _Options) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
-%% @hidden
-%% @param   Time time in milliseconds after which to send the timeout message.
-%% @param   Dest Pid or server name to which to send the timeout message.
-%% @param   Msg Message to send to Dest after Time ms.
-%% @param   Options options
-%% @returns a reference that can be used to cancel the timer, if desired.
-%% @doc     Start a timer, and send {timeout, TimerRef, Msg} to Dest after
-%%          Time ms, where TimerRef is the reference returned from this function.
-%%
-%%          <em><b>Note.</b>  The Options argument is currently ignored.</em>
+%% @param   TimerRef the reference of the timer to cancel.
+%% @returns the time left in milliseconds, or false if the timer already
+%%          expired or was cancelled.
+%% @doc     Cancel a timer started with start_timer/3,4 or send_after/3.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec cancel_timer(TimerRef :: reference()) -> non_neg_integer() | false.
+cancel_timer(_TimerRef) ->
+    erlang:nif_error(undefined).
+
 %%-----------------------------------------------------------------------------
--spec cancel_timer(TimerRef :: reference()) -> ok.
-cancel_timer(TimerRef) ->
-    timer_manager:cancel_timer(TimerRef).
+%% @param   TimerRef the reference of the timer to read.
+%% @returns the time left in milliseconds, or false if the timer already
+%%          expired or was cancelled.
+%% @doc     Read the time left of a timer started with start_timer/3,4 or
+%%          send_after/3.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec read_timer(TimerRef :: reference()) -> non_neg_integer() | false.
+read_timer(_TimerRef) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @param   Time time in milliseconds after which to send the message.
@@ -175,8 +181,8 @@ cancel_timer(TimerRef) ->
 %% @end
 %%-----------------------------------------------------------------------------
 -spec send_after(Time :: non_neg_integer(), Dest :: pid() | atom(), Msg :: term()) -> reference().
-send_after(Time, Dest, Msg) ->
-    timer_manager:send_after(Time, Dest, Msg).
+send_after(_Time, _Dest, _Msg) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @param   Pid the process pid.
@@ -194,6 +200,9 @@ send_after(Time, Dest, Msg) ->
 %%      <li><b>message_queue_len</b> the number of messages enqueued for the process (integer)</li>
 %%      <li><b>memory</b> the estimated total number of bytes in use by the process (integer)</li>
 %%      <li><b>links</b> the list of linked processes</li>
+%%      <li><b>priority</b> the priority level of the process (atom)</li>
+%%      <li><b>message_queue_data</b> where received messages are kept until the next garbage collection, on_heap or off_heap (atom)</li>
+%%      <li><b>garbage_collection</b> the number of minor collections since last full sweep, the fullsweep_after setting of the process, the number of collections its heap growth strategy avoided compared to bounded_free and the number of collections avoided by keeping heap fragments until the next needed collection (proplist)</li>
 %% </ul>
 %% Specifying an unsupported term or atom raises a bad_arg error.
 %%
@@ -204,7 +213,13 @@ send_after(Time, Dest, Msg) ->
     (Pid :: pid(), stack_size) -> {stack_size, non_neg_integer()};
     (Pid :: pid(), message_queue_len) -> {message_queue_len, non_neg_integer()};
     (Pid :: pid(), memory) -> {memory, non_neg_integer()};
-    (Pid :: pid(), links) -> {links, [pid()]}.
+    (Pid :: pid(), links) -> {links, [pid()]};
+    (Pid :: pid(), priority) -> {priority, priority_level()};
+    (Pid :: pid(), message_queue_data) -> {message_queue_data, message_queue_data()};
+    (Pid :: pid(), garbage_collection) ->
+        {garbage_collection, [
+            {minor_gcs | fullsweep_after | avoided_gcs | avoided_forced_gcs, non_neg_integer()}
+        ]}.
 process_info(_Pid, _Key) ->
     erlang:nif_error(undefined).
 
@@ -226,6 +241,7 @@ process_info(_Pid, _Key) ->
 %%      <li><b>wordsize</b> the number of bytes in a machine word on the current platform (integer)</li>
 %%      <li><b>schedulers</b> the number of schedulers, equal to the number of online processors (integer)</li>
 %%      <li><b>schedulers_online</b> the current number of schedulers (integer)</li>
+%%      <li><b>fullsweep_after</b> the default fullsweep_after setting of new processes (tuple)</li>
 %% </ul>
 %% The following keys are supported on the ESP32 platform:
 %% <ul>
@@ -254,6 +270,10 @@ system_info(_Key) ->
 %%
 %% This function allows to modify system flags at runtime.
 %%
+%% The following key is supported:
+%% <ul>
+%%       <li><b>fullsweep_after</b> the default number of minor garbage collections before a full sweep, for new processes</li>
+%% </ul>
 %% The following key is supported on SMP builds:
 %% <ul>
 %%       <li><b>schedulers_online</b> the number of schedulers online</li>
@@ -409,6 +429,16 @@ max(_A, _B) ->
 %% @returns the amount of memory (in bytes) used of the specified type
 %% @doc     Return the amount of memory (in bytes) used of the specified type
 %%
+%% The following types are supported:
+%% <ul>
+%%   <li><b>binary</b> the memory used by reference counted binaries</li>
+%%   <li><b>atomvm_pool_reserved</b> the memory reserved by the pooled
+%%   allocator for heaps, messages and processes</li>
+%%   <li><b>atomvm_pool_oversized</b> the memory of blocks too large for the
+%%   size classes of the pooled allocator</li>
+%% </ul>
+%% The pooled allocator is enabled with the `AVM_MEMORY_POOL' build option,
+%% otherwise pool types return 0.
 %% @end
 %%-----------------------------------------------------------------------------
 -spec memory(Type :: mem_type()) -> non_neg_integer().
@@ -467,6 +497,26 @@ put(_Key, _Value) ->
 erase(_Key) ->
     erlang:nif_error(undefined).
 
+%%-----------------------------------------------------------------------------
+%% @returns the list of keys in the process dictionary
+%% @doc     Return all keys of the process dictionary, in no particular order.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec get_keys() -> [any()].
+get_keys() ->
+    erlang:nif_error(undefined).
+
+%%-----------------------------------------------------------------------------
+%% @param   Value   value to look for
+%% @returns the list of keys associated with Value
+%% @doc     Return the keys of the process dictionary whose value is exactly
+%%          equal to Value, in no particular order.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec get_keys(Value :: any()) -> [any()].
+get_keys(_Value) ->
+    erlang:nif_error(undefined).
+
 %%-----------------------------------------------------------------------------
 %% @param   Module      module to test
 %% @param   Function    function to test
@@ -789,9 +839,22 @@ spawn(_Name) ->
 spawn(_Module, _Function, _Args) ->
     erlang:nif_error(undefined).
 
+%% How the heap of a process is resized by garbage collections:
+%% <ul>
+%%      <li><b>bounded_free</b> (default) keep free space between 16 words and twice the size of the last allocation</li>
+%%      <li><b>minimum</b> keep no free space, for memory constrained processes</li>
+%%      <li><b>fibonacci</b> round heap sizes up to a Fibonacci sequence and only shrink the heap
+%%      when more than three quarters of it are free, for processes that allocate steadily</li>
+%% </ul>
+-type heap_growth_strategy() :: bounded_free | minimum | fibonacci.
+
 -type spawn_option() ::
     {min_heap_size, pos_integer()}
     | {max_heap_size, pos_integer()}
+    | {priority, priority_level()}
+    | {fullsweep_after, non_neg_integer()}
+    | {atomvm_heap_growth, heap_growth_strategy()}
+    | {message_queue_data, message_queue_data()}
     | link
     | monitor.
 
@@ -957,9 +1020,22 @@ group_leader(_Leader, _Pid) ->
 %% '''
 %% and the process does not exit if `Reason' is not `normal'.
 %%
+%% `priority' sets the priority level of the process, one of `low', `normal'
+%% (the default), `high' or `max'. Ready processes with a higher priority
+%% are scheduled first, yet lower priority processes are regularly given a
+%% turn so they are not starved.
+%%
+%% `message_queue_data' is either `on_heap' (the default) or `off_heap'. With
+%% `off_heap', messages received by the process do not force a garbage
+%% collection: they are merged into its heap by the next collection. This
+%% suits processes receiving many messages, such as loggers.
+%%
 %% @end
 %%-----------------------------------------------------------------------------
--spec process_flag(Flag :: trap_exit, Value :: boolean()) -> pid().
+-spec process_flag
+    (Flag :: trap_exit, Value :: boolean()) -> boolean();
+    (Flag :: priority, Value :: priority_level()) -> priority_level();
+    (Flag :: message_queue_data, Value :: message_queue_data()) -> message_queue_data().
 process_flag(_Flag, _Value) ->
     erlang:nif_error(undefined).
 
@@ -1013,7 +1089,7 @@ is_process_alive(_Pid) ->
 
 %%-----------------------------------------------------------------------------
 %% @returns `true'
-%% @doc     Run a garbage collect in current process
+%% @doc     Run a full sweep garbage collection in current process
 %% @end
 %%-----------------------------------------------------------------------------
 -spec garbage_collect() -> true.
@@ -1031,6 +1107,25 @@ garbage_collect() ->
 garbage_collect(_Pid) ->
     erlang:nif_error(undefined).
 
+%%-----------------------------------------------------------------------------
+%% @param   Item    statistics to return
+%% @returns the requested statistics
+%% @doc     Return system statistics.
+%%
+%% The following item is supported:
+%% <ul>
+%%      <li><b>garbage_collection</b> the number of garbage collections and the
+%%      number of words they reclaimed since the system started, as
+%%      `{NumberOfGCs, WordsReclaimed, 0}'</li>
+%% </ul>
+%% Specifying an unsupported item raises a bad_arg error.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec statistics(Item :: garbage_collection) ->
+    {non_neg_integer(), non_neg_integer(), 0}.
+statistics(_Item) ->
+    erlang:nif_error(undefined).
+
 %%-----------------------------------------------------------------------------
 %% @returns A term decoded from passed binary
 %% @param   Binary  binary to decode
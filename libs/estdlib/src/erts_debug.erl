@@ -24,7 +24,9 @@
 %%-----------------------------------------------------------------------------
 -module(erts_debug).
 
--export([flat_size/1]).
+-export([flat_size/1, size/1]).
+
+-compile({no_auto_import, [size/1]}).
 
 %%-----------------------------------------------------------------------------
 %% @param   Term        term to get the size of
@@ -35,3 +37,14 @@
 -spec flat_size(Term :: any()) -> non_neg_integer().
 flat_size(_Term) ->
     erlang:nif_error(undefined).
+
+%%-----------------------------------------------------------------------------
+%% @param   Term        term to get the size of
+%% @returns A size
+%% @doc     Return the size, in terms, of a given term, counting subterms
+%%          that are shared within the term only once.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec size(Term :: any()) -> non_neg_integer().
+size(_Term) ->
+    erlang:nif_error(undefined).
@@ -32,7 +32,7 @@
     nth/2,
     member/2,
     delete/2,
-    reverse/1,
+    reverse/1, reverse/2,
     foreach/2,
     keydelete/3,
     keyfind/3,
@@ -52,6 +52,14 @@
     sublist/2
 ]).
 
+%% NIFs doing a bounded chunk of work, called in a loop by the functions above
+-export([
+    reverse_chunk/2,
+    flatten_chunk/2,
+    seq_chunk/3,
+    sort_chunk/1
+]).
+
 %%-----------------------------------------------------------------------------
 %% @param   Fun the function to apply
 %% @param   List the list over which to map
@@ -90,12 +98,8 @@ nth(Index, [_H | T]) when Index > 1 ->
 %% @end
 %%-----------------------------------------------------------------------------
 -spec member(E :: term(), L :: list()) -> boolean().
-member(_, []) ->
-    false;
-member(E, [E | _]) ->
-    true;
-member(E, [_ | T]) ->
-    member(E, T).
+member(_E, _L) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @param   E the member to delete
@@ -110,9 +114,9 @@ delete(E, L) ->
 
 %% @private
 delete(_, [], Accum) ->
-    reverse(Accum);
+    lists:reverse(Accum);
 delete(E, [E | T], Accum) ->
-    reverse(Accum) ++ T;
+    lists:reverse(Accum, T);
 delete(E, [H | T], Accum) ->
     delete(E, T, [H | Accum]).
 
@@ -124,14 +128,21 @@ delete(E, [H | T], Accum) ->
 %%-----------------------------------------------------------------------------
 -spec reverse(list()) -> list().
 reverse(L) ->
-    %% TODO this should be done in unit time in a BIF
     reverse(L, []).
 
-%% @private
-reverse([], Accum) ->
-    Accum;
-reverse([H | T], Accum) ->
-    reverse(T, [H | Accum]).
+%%-----------------------------------------------------------------------------
+%% @param   L the list to reverse
+%% @param   Tail the tail to append
+%% @returns the elements of L in reverse order, followed by Tail
+%% @doc     Reverse the elements of L and append Tail.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec reverse(list(), term()) -> term().
+reverse(L, Tail) ->
+    case lists:reverse_chunk(L, Tail) of
+        {[], Reversed} -> Reversed;
+        {Rest, Acc} -> reverse(Rest, Acc)
+    end.
 
 %%-----------------------------------------------------------------------------
 %% @param   Fun the predicate to evaluate
@@ -156,26 +167,8 @@ foreach(Fun, [H | T]) ->
 %% @end
 %%-----------------------------------------------------------------------------
 -spec keydelete(K :: term(), I :: pos_integer(), L :: list()) -> list().
-keydelete(K, I, L) ->
-    keydelete(K, I, L, []).
-
-%% @private
-keydelete(_K, _I, [], L) ->
-    reverse(L);
-keydelete(K, I, [H | T], L2) when is_tuple(H) ->
-    case I =< tuple_size(H) of
-        true ->
-            case element(I, H) of
-                K ->
-                    reverse(L2) ++ T;
-                _ ->
-                    keydelete(K, I, T, [H | L2])
-            end;
-        false ->
-            keydelete(K, I, T, [H | L2])
-    end;
-keydelete(K, I, [H | T], L2) ->
-    keydelete(K, I, T, [H | L2]).
+keydelete(_K, _I, _L) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @param   K the key to match
@@ -186,22 +179,8 @@ keydelete(K, I, [H | T], L2) ->
 %% @end
 %%-----------------------------------------------------------------------------
 -spec keyfind(K :: term(), I :: pos_integer(), L :: list(tuple())) -> tuple() | false.
-keyfind(_K, _I, []) ->
-    false;
-keyfind(K, I, [H | T]) when is_tuple(H) ->
-    case I =< tuple_size(H) of
-        true ->
-            case element(I, H) of
-                K ->
-                    H;
-                _ ->
-                    keyfind(K, I, T)
-            end;
-        false ->
-            keyfind(K, I, T)
-    end;
-keyfind(K, I, [_H | T]) ->
-    keyfind(K, I, T).
+keyfind(_K, _I, _L) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @param   K the key to match
@@ -212,22 +191,8 @@ keyfind(K, I, [_H | T]) ->
 %% @end
 %%-----------------------------------------------------------------------------
 -spec keymember(K :: term(), I :: pos_integer(), L :: list(tuple())) -> boolean().
-keymember(_K, _I, []) ->
-    false;
-keymember(K, I, [H | T]) when is_tuple(H) ->
-    case I =< tuple_size(H) of
-        true ->
-            case element(I, H) of
-                K ->
-                    true;
-                _ ->
-                    keymember(K, I, T)
-            end;
-        false ->
-            keymember(K, I, T)
-    end;
-keymember(K, I, [_H | T]) ->
-    keymember(K, I, T).
+keymember(_K, _I, _L) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @param   K           the key to match
@@ -255,7 +220,7 @@ keyreplace(K, I, [H | T], L, NewTuple, NewList) when is_tuple(H) andalso is_tupl
         true ->
             case element(I, H) of
                 K ->
-                    reverse(NewList) ++ [NewTuple | T];
+                    lists:reverse(NewList, [NewTuple | T]);
                 _ ->
                     keyreplace(K, I, T, L, NewTuple, [H | NewList])
             end;
@@ -297,7 +262,7 @@ foldl(Fun, Acc0, [H | T]) ->
     List :: list()
 ) -> Acc1 :: term().
 foldr(Fun, Acc0, List) ->
-    foldl(Fun, Acc0, reverse(List)).
+    foldl(Fun, Acc0, lists:reverse(List)).
 
 %%-----------------------------------------------------------------------------
 %% @param   Fun the predicate to evaluate
@@ -335,21 +300,15 @@ any(Fun, L) ->
 %% @end
 %%-----------------------------------------------------------------------------
 -spec flatten(L :: list()) -> list().
-flatten(L) when is_list(L) ->
-    flatten(L, []).
+flatten(L) ->
+    flatten_chunks([L], []).
 
 %% @private
-%% pre: Accum is flattened
-flatten([], Accum) ->
-    Accum;
-flatten([H | T], Accum) when is_list(H) ->
-    FlattenedT = flatten(T, Accum),
-    flatten(H, FlattenedT);
-flatten([H | T], Accum) ->
-    FlattenedT = flatten(T, Accum),
-    [H | FlattenedT].
-
-%% post: return is flattened
+flatten_chunks(Stack, Acc) ->
+    case lists:flatten_chunk(Stack, Acc) of
+        {Stack2, Acc2} -> flatten_chunks(Stack2, Acc2);
+        Reversed -> lists:reverse(Reversed)
+    end.
 
 %%-----------------------------------------------------------------------------
 %% @param   Pred the predicate to apply to elements in List
@@ -385,7 +344,7 @@ filter(Pred, L) ->
 
 %% @private
 filter(_Pred, [], Accum) ->
-    reverse(Accum);
+    lists:reverse(Accum);
 filter(Pred, [H | T], Accum) ->
     case Pred(H) of
         true ->
@@ -424,7 +383,14 @@ join([E | R], Sep, Accum) ->
 %%-----------------------------------------------------------------------------
 -spec seq(From :: integer(), To :: integer()) -> list().
 seq(From, To) ->
-    seq(From, To, 1).
+    seq_chunks(From, To, []).
+
+%% @private
+seq_chunks(From, To, Acc) ->
+    case lists:seq_chunk(From, To, Acc) of
+        {To2, Acc2} -> seq_chunks(From, To2, Acc2);
+        List -> List
+    end.
 
 %%-----------------------------------------------------------------------------
 %% @param   From    from integer
@@ -453,7 +419,7 @@ seq(From, To, Incr, Accum) when
     (Incr > 0 andalso From > To) orelse
         (Incr < 0 andalso To > From)
 ->
-    reverse(Accum);
+    lists:reverse(Accum);
 seq(From, To, Incr, Accum) ->
     seq(From + Incr, To, Incr, [From | Accum]).
 
@@ -465,7 +431,43 @@ seq(From, To, Incr, Accum) ->
 %% @end
 %%-----------------------------------------------------------------------------
 sort(List) when is_list(List) ->
-    sort(fun lt/2, List).
+    case lists:sort_chunk(List) of
+        {Run, Rest} -> sort_runs(Rest, [Run]);
+        Sorted -> Sorted
+    end.
+
+%% @private
+sort_runs(List, Runs) ->
+    case lists:sort_chunk(List) of
+        {Run, Rest} -> sort_runs(Rest, [Run | Runs]);
+        Run -> merge_runs(lists:reverse([Run | Runs]))
+    end.
+
+%% @private
+merge_runs([Run]) ->
+    Run;
+merge_runs(Runs) ->
+    merge_runs(merge_pairs(Runs, [])).
+
+%% @private
+merge_pairs([Run1, Run2 | T], Acc) ->
+    merge_pairs(T, [merge(Run1, Run2, []) | Acc]);
+merge_pairs([Run], Acc) ->
+    lists:reverse(Acc, [Run]);
+merge_pairs([], Acc) ->
+    lists:reverse(Acc).
+
+%% @private
+%% Elements of Run1 come first when equal, so that sort/1 is stable
+merge([H1 | T1] = Run1, [H2 | T2] = Run2, Acc) ->
+    case H2 < H1 of
+        true -> merge(Run1, T2, [H2 | Acc]);
+        false -> merge(T1, Run2, [H1 | Acc])
+    end;
+merge([], Run2, Acc) ->
+    lists:reverse(Acc, Run2);
+merge(Run1, [], Acc) ->
+    lists:reverse(Acc, Run1).
 
 %%-----------------------------------------------------------------------------
 %% @param   Fun sort function
@@ -487,9 +489,6 @@ quick_sort(Fun, [Pivot | T]) ->
 quick_sort(_Fun, []) ->
     [].
 
-%% @private
-lt(A, B) -> A < B.
-
 %%-----------------------------------------------------------------------------
 %% @param   Elem the element to duplicate
 %% @param   Count the number of times to duplicate the element
@@ -498,11 +497,8 @@ lt(A, B) -> A < B.
 %% @end
 %%-----------------------------------------------------------------------------
 -spec duplicate(integer(), Elem) -> [Elem].
-duplicate(Count, Elem) when is_integer(Count) andalso Count > 0 ->
-    duplicate(Count, Elem, []).
-
-duplicate(0, _Elem, Acc) -> Acc;
-duplicate(Count, Elem, Acc) -> duplicate(Count - 1, Elem, [Elem | Acc]).
+duplicate(_Count, _Elem) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @param   List list to take the sublist from
@@ -517,6 +513,46 @@ sublist(List, Len) when is_integer(Len) andalso Len >= 0 ->
     sublist0(List, Len, []).
 
 %% @private
-sublist0(_List, 0, Acc) -> reverse(Acc);
-sublist0([], _, Acc) -> reverse(Acc);
+sublist0(_List, 0, Acc) -> lists:reverse(Acc);
+sublist0([], _, Acc) -> lists:reverse(Acc);
 sublist0([H | Tail], Len, Acc) -> sublist0(Tail, Len - 1, [H | Acc]).
+
+%%-----------------------------------------------------------------------------
+%% @hidden
+%% @doc     Prepend at most a chunk of L reversed to Tail, and return the
+%%          rest of L with the result.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec reverse_chunk(list(), term()) -> {list(), term()}.
+reverse_chunk(_L, _Tail) ->
+    erlang:nif_error(undefined).
+
+%%-----------------------------------------------------------------------------
+%% @hidden
+%% @doc     Flatten a chunk of the deep lists of Stack, prepending elements to
+%%          Acc. Returns Acc once Stack is empty.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec flatten_chunk(list(), list()) -> {list(), list()} | list().
+flatten_chunk(_Stack, _Acc) ->
+    erlang:nif_error(undefined).
+
+%%-----------------------------------------------------------------------------
+%% @hidden
+%% @doc     Prepend the last chunk of seq(From, To) to Acc. Returns the
+%%          list once it starts with From, or the end of the next chunk.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec seq_chunk(integer(), integer(), list()) -> {integer(), list()} | list().
+seq_chunk(_From, _To, _Acc) ->
+    erlang:nif_error(undefined).
+
+%%-----------------------------------------------------------------------------
+%% @hidden
+%% @doc     Sort a chunk of List. Returns the sorted list if List is a single
+%%          chunk, or the sorted chunk with the rest of List.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec sort_chunk(list()) -> {list(), list()} | list().
+sort_chunk(_List) ->
+    erlang:nif_error(undefined).
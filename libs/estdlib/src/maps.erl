@@ -29,8 +29,8 @@
 %% in general make no assumptions about the ordering of entries in a map.
 %%
 %% This module implements a subset of the Erlang/OTP `maps' interface.
-%% Some OTP functions are not implemented, and the approach favors
-%% correctness and readability over speed and performance.
+%% Some OTP functions are not implemented.  Functions that do not take a
+%% function argument are implemented natively by the VM.
 %% @end
 %%-----------------------------------------------------------------------------
 -module(maps).
@@ -92,13 +92,8 @@ get(Key, Map) ->
 %% @end
 %%-----------------------------------------------------------------------------
 -spec get(Key :: key(), Map :: map(), Default :: term()) -> Value :: value().
-get(Key, Map, Default) ->
-    try
-        ?MODULE:get(Key, Map)
-    catch
-        _:{badkey, _} ->
-            Default
-    end.
+get(_Key, _Map, _Default) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @param   Key     the key
@@ -129,10 +124,8 @@ is_key(Key, Map) ->
 %% @end
 %%-----------------------------------------------------------------------------
 -spec put(Key :: key(), Value :: value(), Map :: map()) -> map().
-put(Key, Value, Map) when is_map(Map) ->
-    Map#{Key => Value};
-put(_Key, _Value, Map) when not is_map(Map) ->
-    throw({badmap, Map}).
+put(_Key, _Value, _Map) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @param   Map     the map
@@ -194,10 +187,8 @@ new() ->
 %% @end
 %%-----------------------------------------------------------------------------
 -spec keys(Map :: map()) -> [key()].
-keys(Map) when is_map(Map) ->
-    iterate_keys(maps:next(maps:iterator(Map)), []);
-keys(Map) ->
-    throw({badmap, Map}).
+keys(_Map) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @param   Map     the map
@@ -211,10 +202,8 @@ keys(Map) ->
 %% @end
 %%-----------------------------------------------------------------------------
 -spec values(Map :: map()) -> [key()].
-values(Map) when is_map(Map) ->
-    iterate_values(maps:next(maps:iterator(Map)), []);
-values(Map) ->
-    throw({badmap, Map}).
+values(_Map) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @param   Map     the map
@@ -227,10 +216,8 @@ values(Map) ->
 %% @end
 %%-----------------------------------------------------------------------------
 -spec to_list(Map :: map()) -> [key()].
-to_list(Map) when is_map(Map) ->
-    iterate_entries(maps:next(maps:iterator(Map)), []);
-to_list(Map) ->
-    throw({badmap, Map}).
+to_list(_Map) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @param   List a list of `[{Key, Value}]' pairs
@@ -246,10 +233,8 @@ to_list(Map) ->
 %% @end
 %%-----------------------------------------------------------------------------
 -spec from_list(List :: [{Key :: key(), Value :: value()}]) -> map().
-from_list(List) when is_list(List) ->
-    iterate_from_list(List, ?MODULE:new());
 from_list(_List) ->
-    throw(badarg).
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @param   Map the map
@@ -277,13 +262,8 @@ size(Map) ->
 %% @end
 %%-----------------------------------------------------------------------------
 -spec find(Key :: key(), Map :: map()) -> {ok, Value :: value()} | error.
-find(Key, Map) ->
-    try
-        {ok, ?MODULE:get(Key, Map)}
-    catch
-        _:{badkey, _} ->
-            error
-    end.
+find(_Key, _Map) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @param   Pred    a function used to filter entries from the map
@@ -338,7 +318,7 @@ filter(_Pred, _Map) ->
     MapOrIterator :: map_or_iterator()
 ) -> term().
 fold(Fun, Init, Map) when is_function(Fun, 3) andalso is_map(Map) ->
-    iterate_fold(Fun, maps:next(maps:iterator(Map)), Init);
+    fold_entries(Fun, maps:to_list(Map), Init);
 fold(Fun, Init, [Pos | Map] = Iterator) when
     is_function(Fun, 3) andalso is_integer(Pos) andalso is_map(Map)
 ->
@@ -385,12 +365,8 @@ map(_Fun, _Map) ->
 %% @end
 %%-----------------------------------------------------------------------------
 -spec merge(Map1 :: map(), Map2 :: map()) -> map().
-merge(Map1, Map2) when is_map(Map1) andalso is_map(Map2) ->
-    iterate_merge(maps:next(maps:iterator(Map2)), Map1);
-merge(Map1, _Map2) when not is_map(Map1) ->
-    throw({badmap, Map1});
-merge(_Map1, Map2) when not is_map(Map2) ->
-    throw({badmap, Map2}).
+merge(_Map1, _Map2) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @param   Key     the key to remove
@@ -409,17 +385,8 @@ merge(_Map1, Map2) when not is_map(Map2) ->
 %% @end
 %%-----------------------------------------------------------------------------
 -spec remove(Key :: key(), MapOrIterator :: map_or_iterator()) -> map().
-remove(Key, Map) when is_map(Map) ->
-    case ?MODULE:is_key(Key, Map) of
-        true ->
-            iterate_remove(Key, maps:next(maps:iterator(Map)), ?MODULE:new());
-        _ ->
-            Map
-    end;
-remove(Key, [Pos | Map] = Iterator) when is_integer(Pos) andalso is_map(Map) ->
-    iterate_remove(Key, maps:next(Iterator), ?MODULE:new());
-remove(_Key, Map) when not is_map(Map) ->
-    throw({badmap, Map}).
+remove(_Key, _MapOrIterator) ->
+    erlang:nif_error(undefined).
 
 %%-----------------------------------------------------------------------------
 %% @param   Key     the key to update
@@ -434,32 +401,13 @@ remove(_Key, Map) when not is_map(Map) ->
 %% @end
 %%-----------------------------------------------------------------------------
 -spec update(Key :: key(), Value :: value(), Map :: map()) -> map().
-update(Key, Value, Map) ->
-    _ = ?MODULE:get(Key, Map),
-    Map#{Key => Value}.
+update(_Key, _Value, _Map) ->
+    erlang:nif_error(undefined).
 
 %%
 %% Internal functions
 %%
 
-%% @private
-iterate_keys(none, Accum) ->
-    lists:reverse(Accum);
-iterate_keys({Key, _Value, Iterator}, Accum) ->
-    iterate_keys(maps:next(Iterator), [Key | Accum]).
-
-%% @private
-iterate_values(none, Accum) ->
-    lists:reverse(Accum);
-iterate_values({_Key, Value, Iterator}, Accum) ->
-    iterate_values(maps:next(Iterator), [Value | Accum]).
-
-%% @private
-iterate_entries(none, Accum) ->
-    lists:reverse(Accum);
-iterate_entries({Key, Value, Iterator}, Accum) ->
-    iterate_entries(maps:next(Iterator), [{Key, Value} | Accum]).
-
 %% @private
 iterate_filter(_Pred, none, Accum) ->
     Accum;
@@ -473,6 +421,12 @@ iterate_filter(Pred, {Key, Value, Iterator}, Accum) ->
         end,
     iterate_filter(Pred, maps:next(Iterator), NewAccum).
 
+%% @private
+fold_entries(_Fun, [], Accum) ->
+    Accum;
+fold_entries(Fun, [{Key, Value} | T], Accum) ->
+    fold_entries(Fun, T, Fun(Key, Value, Accum)).
+
 %% @private
 iterate_fold(_Fun, none, Accum) ->
     Accum;
@@ -486,25 +440,3 @@ iterate_map(_Fun, none, Accum) ->
 iterate_map(Fun, {Key, Value, Iterator}, Accum) ->
     NewAccum = Accum#{Key => Fun(Key, Value)},
     iterate_map(Fun, maps:next(Iterator), NewAccum).
-
-%% @private
-iterate_merge(none, Accum) ->
-    Accum;
-iterate_merge({Key, Value, Iterator}, Accum) ->
-    iterate_merge(maps:next(Iterator), Accum#{Key => Value}).
-
-%% @private
-iterate_remove(_Key, none, Accum) ->
-    Accum;
-iterate_remove(Key, {Key, _Value, Iterator}, Accum) ->
-    iterate_remove(Key, maps:next(Iterator), Accum);
-iterate_remove(Key, {OtherKey, Value, Iterator}, Accum) ->
-    iterate_remove(Key, maps:next(Iterator), Accum#{OtherKey => Value}).
-
-%% @private
-iterate_from_list([], Accum) ->
-    Accum;
-iterate_from_list([{Key, Value} | T], Accum) ->
-    iterate_from_list(T, Accum#{Key => Value});
-iterate_from_list(_List, _Accum) ->
-    throw(badarg).
@@ -87,6 +87,30 @@ static inline const void *atom_string_data(AtomString atom_str)
     return ((const uint8_t *) atom_str) + 1;
 }
 
+/**
+ * @brief Computes a key that orders atoms by their name.
+ *
+ * @details The key is made of the first 8 bytes of the atom name in big endian order, padded with
+ * zeros. Atoms with different keys compare like their keys, atoms with the same key have to be
+ * compared using their full name.
+ * @param atom_str an AtomString pointer.
+ * @returns the sort key of the atom string.
+ */
+static inline uint64_t atom_string_sort_key(AtomString atom_str)
+{
+    size_t len = atom_string_len(atom_str);
+    const uint8_t *data = (const uint8_t *) atom_string_data(atom_str);
+
+    uint64_t key = 0;
+    for (size_t i = 0; i < 8; i++) {
+        key <<= 8;
+        if (i < len) {
+            key |= data[i];
+        }
+    }
+    return key;
+}
+
 /**
  * @brief Write module:function/arity to the supplied buffer.
  *
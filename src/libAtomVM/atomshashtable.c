@@ -23,26 +23,40 @@
 #include "smp.h"
 #include "utils.h"
 
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
 #ifndef AVM_NO_SMP
-#define SMP_RDLOCK(htable) smp_rwlock_rdlock(htable->lock)
-#define SMP_WRLOCK(htable) smp_rwlock_wrlock(htable->lock)
-#define SMP_UNLOCK(htable) smp_rwlock_unlock(htable->lock)
+#define SMP_LOCK(htable) smp_mutex_lock(htable->lock)
+#define SMP_UNLOCK(htable) smp_mutex_unlock(htable->lock)
 #else
-#define SMP_RDLOCK(htable)
-#define SMP_WRLOCK(htable)
+#define SMP_LOCK(htable)
 #define SMP_UNLOCK(htable)
 #endif
 
-#define DEFAULT_SIZE 8
+// capacity is always a power of 2
+#define DEFAULT_SIZE 16
+
+// tables are grown when more than 3/4 of the slots are used
+#define NEEDS_GROW(count, capacity) ((count) * 4 >= (capacity) * 3)
 
 struct HNode
 {
-    struct HNode *next;
-    AtomString key;
-    unsigned long value;
+    // NULL for empty slots, set once (after value) and never cleared
+    AtomString ATOMIC key;
+    unsigned long ATOMIC value;
+};
+
+// Readers never take the lock: they load the current buckets and probe them.
+// Buckets replaced by a resize are kept in the previous list until the table
+// is destroyed since a reader may still be probing them, their total size is
+// lower than the size of the current buckets.
+struct AtomsHashTableBuckets
+{
+    int capacity;
+    struct AtomsHashTableBuckets *previous;
+    struct HNode slots[];
 };
 
 static unsigned long sdbm_hash(const unsigned char *str, int len)
@@ -58,13 +72,40 @@ static unsigned long sdbm_hash(const unsigned char *str, int len)
     return hash;
 }
 
+static struct AtomsHashTableBuckets *buckets_new(int capacity)
+{
+    struct AtomsHashTableBuckets *buckets = calloc(1, sizeof(struct AtomsHashTableBuckets) + capacity * sizeof(struct HNode));
+    if (IS_NULL_PTR(buckets)) {
+        return NULL;
+    }
+    buckets->capacity = capacity;
+    buckets->previous = NULL;
+
+    return buckets;
+}
+
+static struct HNode *buckets_find_slot(struct AtomsHashTableBuckets *buckets, AtomString string, unsigned long hash)
+{
+    unsigned long mask = buckets->capacity - 1;
+    unsigned long index = hash & mask;
+
+    while (1) {
+        struct HNode *node = &buckets->slots[index];
+        AtomString key = node->key;
+        if (key == NULL || atom_are_equals(string, key)) {
+            return node;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
 struct AtomsHashTable *atomshashtable_new()
 {
     struct AtomsHashTable *htable = malloc(sizeof(struct AtomsHashTable));
     if (IS_NULL_PTR(htable)) {
         return NULL;
     }
-    htable->buckets = calloc(DEFAULT_SIZE, sizeof(struct HNode *));
+    htable->buckets = buckets_new(DEFAULT_SIZE);
     if (IS_NULL_PTR(htable->buckets)) {
         free(htable);
         return NULL;
@@ -74,52 +115,78 @@ struct AtomsHashTable *atomshashtable_new()
     htable->capacity = DEFAULT_SIZE;
 
 #ifndef AVM_NO_SMP
-    htable->lock = smp_rwlock_create();
+    htable->lock = smp_mutex_create();
 #endif
 
     return htable;
 }
 
+void atomshashtable_destroy(struct AtomsHashTable *hash_table)
+{
+    struct AtomsHashTableBuckets *buckets = hash_table->buckets;
+    while (buckets) {
+        struct AtomsHashTableBuckets *previous = buckets->previous;
+        free(buckets);
+        buckets = previous;
+    }
+#ifndef AVM_NO_SMP
+    smp_mutex_destroy(hash_table->lock);
+#endif
+    free(hash_table);
+}
+
+static bool atomshashtable_grow(struct AtomsHashTable *hash_table)
+{
+    struct AtomsHashTableBuckets *old_buckets = hash_table->buckets;
+    struct AtomsHashTableBuckets *new_buckets = buckets_new(old_buckets->capacity * 2);
+    if (IS_NULL_PTR(new_buckets)) {
+        return false;
+    }
+
+    for (int i = 0; i < old_buckets->capacity; i++) {
+        struct HNode *node = &old_buckets->slots[i];
+        AtomString key = node->key;
+        if (key) {
+            unsigned long hash = sdbm_hash(key, atom_string_len(key));
+            struct HNode *new_node = buckets_find_slot(new_buckets, key, hash);
+            new_node->value = node->value;
+            new_node->key = key;
+        }
+    }
+
+    new_buckets->previous = old_buckets;
+    hash_table->capacity = new_buckets->capacity;
+    hash_table->buckets = new_buckets;
+
+    return true;
+}
+
 int atomshashtable_insert(struct AtomsHashTable *hash_table, AtomString string, unsigned long value)
 {
     int alen = atom_string_len(string);
 
     unsigned long hash = sdbm_hash(string, alen);
-    SMP_WRLOCK(hash_table);
-    long index = hash % hash_table->capacity;
-
-    struct HNode *node = hash_table->buckets[index];
-    if (node) {
-        while (1) {
-            if (atom_are_equals(string, node->key)) {
-                node->value = value;
-                SMP_UNLOCK(hash_table);
-                return 1;
-            }
-
-            if (node->next) {
-                node = node->next;
-            } else {
-                break;
-            }
-        }
-    }
+    SMP_LOCK(hash_table);
 
-    struct HNode *new_node = malloc(sizeof(struct HNode));
-    if (IS_NULL_PTR(new_node)) {
+    struct HNode *node = buckets_find_slot(hash_table->buckets, string, hash);
+    if (node->key) {
+        node->value = value;
         SMP_UNLOCK(hash_table);
-        return 0;
+        return 1;
     }
-    new_node->next = NULL;
-    new_node->key = string;
-    new_node->value = value;
-
-    if (node) {
-        node->next = new_node;
-    } else {
-        hash_table->buckets[index] = new_node;
+
+    if (NEEDS_GROW(hash_table->count + 1, hash_table->capacity)) {
+        if (UNLIKELY(!atomshashtable_grow(hash_table))) {
+            SMP_UNLOCK(hash_table);
+            return 0;
+        }
+        node = buckets_find_slot(hash_table->buckets, string, hash);
     }
 
+    // value must be visible before key, since readers stop at the key
+    node->value = value;
+    node->key = string;
+
     hash_table->count++;
     SMP_UNLOCK(hash_table);
     return 1;
@@ -128,40 +195,19 @@ int atomshashtable_insert(struct AtomsHashTable *hash_table, AtomString string,
 unsigned long atomshashtable_get_value(const struct AtomsHashTable *hash_table, const AtomString string, unsigned long default_value)
 {
     unsigned long hash = sdbm_hash(string, atom_string_len(string));
-    SMP_RDLOCK(hash_table);
-    long index = hash % hash_table->capacity;
-
-    const struct HNode *node = hash_table->buckets[index];
-    while (node) {
-        if (atom_are_equals(string, node->key)) {
-            unsigned long result = node->value;
-            SMP_UNLOCK(hash_table);
-            return result;
-        }
 
-        node = node->next;
+    const struct HNode *node = buckets_find_slot(hash_table->buckets, string, hash);
+    if (node->key) {
+        return node->value;
     }
 
-    SMP_UNLOCK(hash_table);
     return default_value;
 }
 
 int atomshashtable_has_key(const struct AtomsHashTable *hash_table, const AtomString string)
 {
     unsigned long hash = sdbm_hash(string, atom_string_len(string));
-    SMP_RDLOCK(hash_table);
-    long index = hash % hash_table->capacity;
 
-    const struct HNode *node = hash_table->buckets[index];
-    while (node) {
-        if (atom_are_equals(string, node->key)) {
-            SMP_UNLOCK(hash_table);
-            return 1;
-        }
-
-        node = node->next;
-    }
-
-    SMP_UNLOCK(hash_table);
-    return 0;
+    const struct HNode *node = buckets_find_slot(hash_table->buckets, string, hash);
+    return node->key != NULL;
 }
@@ -27,24 +27,31 @@ extern "C" {
 
 #include "atom.h"
 
+#include "smp.h"
+
 #ifndef AVM_NO_SMP
-#ifndef TYPEDEF_RWLOCK
-#define TYPEDEF_RWLOCK
-typedef struct RWLock RWLock;
+#ifndef TYPEDEF_MUTEX
+#define TYPEDEF_MUTEX
+typedef struct Mutex Mutex;
 #endif
 #endif
 
+struct AtomsHashTableBuckets;
+
+// Open addressing hash table, grown when needed. Lookups do not take any lock,
+// insertions are serialized by lock.
 struct AtomsHashTable
 {
     int capacity;
     int count;
 #ifndef AVM_NO_SMP
-    RWLock *lock;
+    Mutex *lock;
 #endif
-    struct HNode **buckets;
+    struct AtomsHashTableBuckets *ATOMIC buckets;
 };
 
 struct AtomsHashTable *atomshashtable_new();
+void atomshashtable_destroy(struct AtomsHashTable *hash_table);
 int atomshashtable_insert(struct AtomsHashTable *hash_table, AtomString string, unsigned long value);
 unsigned long atomshashtable_get_value(const struct AtomsHashTable *hash_table, AtomString string, unsigned long default_value);
 int atomshashtable_has_key(const struct AtomsHashTable *hash_table, AtomString string);
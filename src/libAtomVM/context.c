@@ -42,20 +42,86 @@
 #define DEFAULT_STACK_SIZE 8
 #define BYTES_PER_TERM (TERM_BITS / 8)
 
+term context_priority_to_atom(enum ProcessPriority priority)
+{
+    switch (priority) {
+        case PriorityLow:
+            return LOW_ATOM;
+        case PriorityNormal:
+            return NORMAL_ATOM;
+        case PriorityHigh:
+            return HIGH_ATOM;
+        case PriorityMax:
+            return MAX_ATOM;
+    }
+    UNREACHABLE();
+}
+
+bool context_priority_from_atom(term atom, enum ProcessPriority *priority)
+{
+    switch (atom) {
+        case LOW_ATOM:
+            *priority = PriorityLow;
+            return true;
+        case NORMAL_ATOM:
+            *priority = PriorityNormal;
+            return true;
+        case HIGH_ATOM:
+            *priority = PriorityHigh;
+            return true;
+        case MAX_ATOM:
+            *priority = PriorityMax;
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool context_heap_growth_strategy_from_atom(term atom, enum HeapGrowthStrategy *strategy)
+{
+    switch (atom) {
+        case BOUNDED_FREE_ATOM:
+            *strategy = BoundedFreeHeapGrowth;
+            return true;
+        case MINIMUM_ATOM:
+            *strategy = MinimumHeapGrowth;
+            return true;
+        case FIBONACCI_ATOM:
+            *strategy = FibonacciHeapGrowth;
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool context_message_queue_data_from_atom(term atom, bool *off_heap)
+{
+    switch (atom) {
+        case ON_HEAP_ATOM:
+            *off_heap = false;
+            return true;
+        case OFF_HEAP_ATOM:
+            *off_heap = true;
+            return true;
+        default:
+            return false;
+    }
+}
+
 static void context_monitors_handle_terminate(Context *ctx);
 
 Context *context_new(GlobalContext *glb)
 {
-    Context *ctx = malloc(sizeof(Context));
+    Context *ctx = memory_pool_alloc(glb, MEMORY_POOL_SHARED_CACHE, sizeof(Context));
     if (IS_NULL_PTR(ctx)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         return NULL;
     }
     ctx->cp = 0;
 
-    if (UNLIKELY(memory_init_heap(&ctx->heap, DEFAULT_STACK_SIZE) != MEMORY_GC_OK)) {
+    if (UNLIKELY(memory_init_pooled_heap(&ctx->heap, DEFAULT_STACK_SIZE, glb, MEMORY_POOL_SHARED_CACHE) != MEMORY_GC_OK)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
-        free(ctx);
+        memory_pool_free(ctx);
         return NULL;
     }
     ctx->e = ctx->heap.heap_end;
@@ -69,9 +135,24 @@ Context *context_new(GlobalContext *glb)
     ctx->has_min_heap_size = 0;
     ctx->has_max_heap_size = 0;
 
+    ctx->old_heap = NULL;
+    ctx->old_heap_ptr = NULL;
+    ctx->old_mso_list = term_nil();
+    ctx->mature_start = NULL;
+    ctx->mature_end = NULL;
+    ctx->fullsweep_after = glb->fullsweep_after;
+    ctx->minor_gcs = 0;
+    ctx->heap_growth_strategy = BoundedFreeHeapGrowth;
+    ctx->avoided_gcs = 0;
+    ctx->consumed_messages = NULL;
+    ctx->consumed_messages_size = 0;
+    ctx->consumed_messages_count = 0;
+    ctx->tolerated_fragments = NULL;
+    ctx->avoided_forced_gcs = 0;
+
     mailbox_init(&ctx->mailbox);
 
-    list_init(&ctx->dictionary);
+    dictionary_init(&ctx->dictionary);
 
     ctx->native_handler = NULL;
 
@@ -80,12 +161,17 @@ Context *context_new(GlobalContext *glb)
     ctx->restore_trap_handler = NULL;
 
     ctx->leader = 0;
+#ifndef AVM_NO_SMP
+    ctx->scheduler_id = -1;
+#endif
 
     timer_list_item_init(&ctx->timer_list_head, 0);
 
     list_init(&ctx->monitors_head);
 
     ctx->trap_exit = false;
+    ctx->message_queue_off_heap = false;
+    ctx->gc_avoided = false;
 #ifdef ENABLE_ADVANCED_TRACE
     ctx->trace_calls = 0;
     ctx->trace_call_args = 0;
@@ -95,6 +181,7 @@ Context *context_new(GlobalContext *glb)
 #endif
 
     ctx->flags = NoFlags;
+    ctx->priority = PriorityNormal;
     ctx->platform_data = NULL;
 
     ctx->group_leader = term_from_local_process_id(INVALID_PROCESS_ID);
@@ -115,7 +202,7 @@ void context_destroy(Context *ctx)
     struct ListHead *processes_table_list = synclist_wrlock(&ctx->global->processes_table);
     UNUSED(processes_table_list);
 
-    list_remove(&ctx->processes_table_head);
+    globalcontext_remove_process_nolock(ctx->global, ctx);
 
     // Ensure process is not registered
     globalcontext_maybe_unregister_process_id(ctx->global, ctx->process_id);
@@ -128,10 +215,12 @@ void context_destroy(Context *ctx)
 
     // Any other process released our mailbox, so we can clear it.
     mailbox_destroy(&ctx->mailbox, &ctx->heap);
+    memory_flush_consumed_messages(ctx);
 
     free(ctx->fr);
 
     memory_destroy_heap(&ctx->heap, ctx->global);
+    memory_destroy_old_heap(ctx);
 
     dictionary_destroy(&ctx->dictionary);
 
@@ -149,7 +238,7 @@ void context_destroy(Context *ctx)
         free(ctx->platform_data);
     }
 
-    free(ctx);
+    memory_pool_free(ctx);
 }
 
 void context_process_kill_signal(Context *ctx, struct TermSignal *signal)
@@ -192,7 +281,7 @@ void context_process_flush_monitor_signal(Context *ctx, uint64_t ref_ticks, bool
             && term_get_tuple_element(msg, 0) == DOWN_ATOM
             && term_is_reference(term_get_tuple_element(msg, 1))
             && term_to_ref_ticks(term_get_tuple_element(msg, 1)) == ref_ticks) {
-            mailbox_remove_message(&ctx->mailbox, &ctx->heap);
+            context_remove_message(ctx);
             // If option info is combined with option flush, false is returned if a flush was needed, otherwise true.
             result = !info;
         } else {
@@ -203,7 +292,7 @@ void context_process_flush_monitor_signal(Context *ctx, uint64_t ref_ticks, bool
     ctx->x[0] = result ? TRUE_ATOM : FALSE_ATOM;
 }
 
-void context_update_flags(Context *ctx, int mask, int value) CLANG_THREAD_SANITIZE_SAFE
+enum ContextFlags context_update_flags(Context *ctx, int mask, int value) CLANG_THREAD_SANITIZE_SAFE
 {
 #ifndef AVM_NO_SMP
     enum ContextFlags expected = ctx->flags;
@@ -211,8 +300,11 @@ void context_update_flags(Context *ctx, int mask, int value) CLANG_THREAD_SANITI
     do {
         desired = (expected & mask) | value;
     } while (!ATOMIC_COMPARE_EXCHANGE_WEAK(&ctx->flags, &expected, desired));
+    return expected;
 #else
-    ctx->flags = (ctx->flags & mask) | value;
+    enum ContextFlags previous = ctx->flags;
+    ctx->flags = (previous & mask) | value;
+    return previous;
 #endif
 }
 
@@ -221,14 +313,30 @@ size_t context_message_queue_len(Context *ctx)
     return mailbox_len(&ctx->mailbox);
 }
 
+void context_remove_message(Context *ctx)
+{
+    if (!ctx->message_queue_off_heap) {
+        mailbox_remove_message(&ctx->mailbox, &ctx->heap);
+        return;
+    }
+    MailboxMessage *removed = mailbox_take_message(&ctx->mailbox);
+    if (LIKELY(removed != NULL)) {
+        // Only normal messages are in the inner list
+        term mso_list;
+        HeapFragment *fragment = mailbox_message_to_fragment(CONTAINER_OF(removed, Message, base), &mso_list);
+        memory_append_consumed_message(ctx, fragment, mso_list);
+    }
+}
+
 size_t context_size(Context *ctx)
 {
     size_t messages_size = mailbox_size(&ctx->mailbox);
+    size_t old_heap_size = ctx->old_heap ? ctx->old_heap->heap_end - ctx->old_heap->storage : 0;
 
     // TODO include ctx->platform_data
     return sizeof(Context)
         + messages_size
-        + memory_heap_memory_size(&ctx->heap) * BYTES_PER_TERM;
+        + (memory_heap_memory_size(&ctx->heap) + ctx->consumed_messages_size + old_heap_size) * BYTES_PER_TERM;
 }
 
 bool context_get_process_info(Context *ctx, term *out, term atom_key)
@@ -239,6 +347,8 @@ bool context_get_process_info(Context *ctx, term *out, term atom_key)
         case STACK_SIZE_ATOM:
         case MESSAGE_QUEUE_LEN_ATOM:
         case MEMORY_ATOM:
+        case PRIORITY_ATOM:
+        case MESSAGE_QUEUE_DATA_ATOM:
             ret_size = TUPLE_SIZE(2);
             break;
         case LINKS_ATOM: {
@@ -253,6 +363,9 @@ bool context_get_process_info(Context *ctx, term *out, term atom_key)
             ret_size = TUPLE_SIZE(2) + CONS_SIZE * links_count;
             break;
         }
+        case GARBAGE_COLLECTION_ATOM:
+            ret_size = TUPLE_SIZE(2) + (CONS_SIZE + TUPLE_SIZE(2)) * 4;
+            break;
         default:
             *out = BADARG_ATOM;
             return false;
@@ -297,6 +410,43 @@ bool context_get_process_info(Context *ctx, term *out, term atom_key)
             break;
         }
 
+        // priority level of the process
+        case PRIORITY_ATOM: {
+            term_put_tuple_element(ret, 0, PRIORITY_ATOM);
+            term_put_tuple_element(ret, 1, context_priority_to_atom(ctx->priority));
+            break;
+        }
+
+        // where messages are kept until the process collects its heap
+        case MESSAGE_QUEUE_DATA_ATOM: {
+            term_put_tuple_element(ret, 0, MESSAGE_QUEUE_DATA_ATOM);
+            term_put_tuple_element(ret, 1, ctx->message_queue_off_heap ? OFF_HEAP_ATOM : ON_HEAP_ATOM);
+            break;
+        }
+
+        // garbage collection counters and settings of the process
+        case GARBAGE_COLLECTION_ATOM: {
+            term_put_tuple_element(ret, 0, GARBAGE_COLLECTION_ATOM);
+            term fullsweep_after = term_alloc_tuple(2, &ctx->heap);
+            term_put_tuple_element(fullsweep_after, 0, FULLSWEEP_AFTER_ATOM);
+            term_put_tuple_element(fullsweep_after, 1, term_from_int32(ctx->fullsweep_after));
+            term minor_gcs = term_alloc_tuple(2, &ctx->heap);
+            term_put_tuple_element(minor_gcs, 0, MINOR_GCS_ATOM);
+            term_put_tuple_element(minor_gcs, 1, term_from_int32(ctx->minor_gcs));
+            term avoided_gcs = term_alloc_tuple(2, &ctx->heap);
+            term_put_tuple_element(avoided_gcs, 0, AVOIDED_GCS_ATOM);
+            term_put_tuple_element(avoided_gcs, 1, term_from_int32(ctx->avoided_gcs));
+            term avoided_forced_gcs = term_alloc_tuple(2, &ctx->heap);
+            term_put_tuple_element(avoided_forced_gcs, 0, AVOIDED_FORCED_GCS_ATOM);
+            term_put_tuple_element(avoided_forced_gcs, 1, term_from_int32(ctx->avoided_forced_gcs));
+            term list = term_list_prepend(avoided_forced_gcs, term_nil(), &ctx->heap);
+            list = term_list_prepend(avoided_gcs, list, &ctx->heap);
+            list = term_list_prepend(fullsweep_after, list, &ctx->heap);
+            list = term_list_prepend(minor_gcs, list, &ctx->heap);
+            term_put_tuple_element(ret, 1, list);
+            break;
+        }
+
         // pids of linked processes
         case LINKS_ATOM: {
             term_put_tuple_element(ret, 0, LINKS_ATOM);
@@ -327,6 +477,7 @@ static void context_monitors_handle_terminate(Context *ctx)
     struct ListHead *tmp;
     MUTABLE_LIST_FOR_EACH (item, tmp, &ctx->monitors_head) {
         struct Monitor *monitor = GET_LIST_ENTRY(item, struct Monitor, monitor_list_head);
+        globalcontext_remove_monitor(glb, monitor);
         if (monitor->ref_ticks && term_is_boxed(monitor->monitor_obj)) {
             // Resource monitor
             struct ResourceMonitor *resource_monitor = (struct ResourceMonitor *) monitor;
@@ -403,7 +554,7 @@ int context_link(Context *ctx, term link_pid)
     }
     monitor->monitor_obj = link_pid;
     monitor->ref_ticks = 0;
-    list_append(&ctx->monitors_head, &monitor->monitor_list_head);
+    globalcontext_add_monitor(ctx->global, ctx, monitor);
 
     return 0;
 }
@@ -418,7 +569,7 @@ uint64_t context_monitor(Context *ctx, term monitor_pid)
     }
     monitor->monitor_obj = monitor_pid;
     monitor->ref_ticks = ref_ticks;
-    list_append(&ctx->monitors_head, &monitor->monitor_list_head);
+    globalcontext_add_monitor(ctx->global, ctx, monitor);
 
     return ref_ticks;
 }
@@ -434,20 +585,12 @@ struct ResourceMonitor *context_resource_monitor(Context *ctx, void *resource)
     // Not really boxed, but sufficient to distinguish from pids
     monitor->base.monitor_obj = ((term) resource) | TERM_BOXED_VALUE_TAG;
     monitor->base.ref_ticks = ref_ticks;
-    list_append(&ctx->monitors_head, &monitor->base.monitor_list_head);
+    globalcontext_add_monitor(ctx->global, ctx, &monitor->base);
 
     return monitor;
 }
 
 void context_unlink(Context *ctx, term link_pid)
 {
-    struct ListHead *item;
-    LIST_FOR_EACH (item, &ctx->monitors_head) {
-        struct Monitor *monitor = GET_LIST_ENTRY(item, struct Monitor, monitor_list_head);
-        if ((monitor->monitor_obj == link_pid) && (monitor->ref_ticks == 0)) {
-            list_remove(&monitor->monitor_list_head);
-            free(monitor);
-            return;
-        }
-    }
+    globalcontext_unlink(ctx->global, ctx, link_pid);
 }
@@ -32,9 +32,11 @@
 extern "C" {
 #endif
 
+#include "dictionary.h"
 #include "globalcontext.h"
 #include "list.h"
 #include "mailbox.h"
+#include "memory_pool.h"
 #include "smp.h"
 #include "term.h"
 #include "timer_list.h"
@@ -67,6 +69,21 @@ enum ContextFlags
     Trap = 32,
 };
 
+/**
+ * @brief How the heap of a process is resized by garbage collections.
+ */
+enum HeapGrowthStrategy
+{
+    // Allocate what is needed and keep free space between MIN_FREE_SPACE_SIZE
+    // and twice the requested size
+    BoundedFreeHeapGrowth = 0,
+    // Allocate exactly what is needed
+    MinimumHeapGrowth,
+    // Round heap sizes up to a Fibonacci sequence and only shrink the heap
+    // when more than three quarters of it are free
+    FibonacciHeapGrowth
+};
+
 // Max number of x(N) & fr(N) registers
 // BEAM sets this to 1024.
 #define MAX_REG 16
@@ -80,8 +97,13 @@ struct Context
     term x[MAX_REG];
 
     struct ListHead processes_list_head;
+#ifndef AVM_NO_SMP
+    // Scheduler that runs or last ran this process, -1 if it never ran
+    int scheduler_id;
+#endif
 
     struct ListHead processes_table_head;
+    Context *processes_index_next;
     int32_t process_id;
 
     struct TimerListItem timer_list_head;
@@ -93,6 +115,30 @@ struct Context
     size_t min_heap_size;
     size_t max_heap_size;
 
+    // Old generation, for terms that survived two garbage collections
+    HeapFragment *old_heap;
+    term *old_heap_ptr;
+    term old_mso_list;
+    // Young terms that survived a garbage collection, promoted to the old
+    // generation by the next minor collection
+    term *mature_start;
+    term *mature_end;
+    // Number of minor collections before a full sweep and since last one
+    unsigned int fullsweep_after;
+    unsigned int minor_gcs;
+    enum HeapGrowthStrategy heap_growth_strategy;
+    // Garbage collections that bounded_free strategy would have done
+    unsigned int avoided_gcs;
+    // Messages removed from the mailbox while message_queue_data is off_heap,
+    // merged into the heap by the next garbage collection
+    HeapFragment *consumed_messages;
+    size_t consumed_messages_size;
+    unsigned int consumed_messages_count;
+    // Heap fragments kept at the last safe point instead of forcing a
+    // collection, and number of collections that were avoided so
+    HeapFragment *tolerated_fragments;
+    unsigned int avoided_forced_gcs;
+
     unsigned long cp;
 
     // saved state when scheduled out
@@ -103,7 +149,7 @@ struct Context
 
     Mailbox mailbox;
 
-    struct ListHead dictionary;
+    struct Dictionary dictionary;
 
     // Ports support
     native_handler_f native_handler;
@@ -115,6 +161,9 @@ struct Context
     unsigned int has_max_heap_size : 1;
 
     bool trap_exit : 1;
+    bool message_queue_off_heap : 1;
+    // A collection was counted in avoided_gcs since the last collection
+    bool gc_avoided : 1;
 #ifdef ENABLE_ADVANCED_TRACE
     unsigned int trace_calls : 1;
     unsigned int trace_call_args : 1;
@@ -124,6 +173,7 @@ struct Context
 #endif
 
     enum ContextFlags ATOMIC flags;
+    enum ProcessPriority ATOMIC priority;
 
     void *platform_data;
 
@@ -146,8 +196,12 @@ typedef struct Context Context;
 struct Monitor
 {
     struct ListHead monitor_list_head;
+    // next monitor in the same bucket of the global monitors index
+    struct Monitor *index_next;
     uint64_t ref_ticks; // 0 for links
     term monitor_obj;
+    // process whose monitors list holds this monitor
+    int32_t owner_process_id;
 };
 
 /**
@@ -219,6 +273,24 @@ static inline int context_is_port_driver(const Context *ctx)
     return ctx->native_handler != NULL;
 }
 
+/**
+ * @brief Get the scheduler running the process
+ *
+ * @details The scheduler is used to allocate memory from its memory pool
+ * cache. To be called from the process only.
+ * @param ctx a valid context
+ * @returns the scheduler id or `MEMORY_POOL_SHARED_CACHE`
+ */
+static inline int context_scheduler_id(const Context *ctx)
+{
+#ifndef AVM_NO_SMP
+    return ctx->scheduler_id;
+#else
+    UNUSED(ctx);
+    return MEMORY_POOL_SHARED_CACHE;
+#endif
+}
+
 /**
  * @brief Cleans up unused registers
  *
@@ -233,6 +305,19 @@ static inline void context_clean_registers(Context *ctx, int live)
     }
 }
 
+/**
+ * @brief Returns true if a context's stack is in a heap fragment
+ *
+ * @details This happens after a NIF allocated a new root fragment with
+ * `MEMORY_NO_GC`. The stack cannot grow until next garbage collection.
+ * @param ctx a valid context.
+ * @returns true if the stack is not in the root fragment of the heap
+ */
+static inline bool context_stack_in_fragment(const Context *ctx)
+{
+    return ctx->e < ctx->heap.heap_start || ctx->e > ctx->heap.heap_end;
+}
+
 /**
  * @brief Returns a context's stack base
  *
@@ -310,6 +395,16 @@ static inline bool context_is_term_equal_to_atom_string(Context *ctx, term atom_
  */
 size_t context_message_queue_len(Context *ctx);
 
+/**
+ * @brief Remove the message at the receive pointer of the process's mailbox
+ *
+ * @details The message is appended to the heap fragments of the process or,
+ * if its `message_queue_data` flag is `off_heap`, to the messages it consumed,
+ * which do not force a garbage collection.
+ * @param ctx a valid context.
+ */
+void context_remove_message(Context *ctx);
+
 /**
  * @brief Returns total amount of size (in byes) occupied by the process.
  *
@@ -325,8 +420,9 @@ size_t context_size(Context *ctx);
  * @param ctx the context to set/clear flag on.
  * @param mask the mask to apply on flags
  * @param value the value to set
+ * @returns the flags before the update
  */
-void context_update_flags(Context *ctx, int mask, int value);
+enum ContextFlags context_update_flags(Context *ctx, int mask, int value);
 
 /**
  * @brief Get flags on a given context.
@@ -385,6 +481,41 @@ void context_process_flush_monitor_signal(Context *ctx, uint64_t ref_ticks, bool
  */
 bool context_get_process_info(Context *ctx, term *out, term atom_key);
 
+/**
+ * @brief Get the atom of a process priority level.
+ *
+ * @param priority the priority level
+ * @return one of \c low, \c normal, \c high or \c max atoms
+ */
+term context_priority_to_atom(enum ProcessPriority priority);
+
+/**
+ * @brief Get a process priority level from its atom.
+ *
+ * @param atom one of \c low, \c normal, \c high or \c max atoms
+ * @param priority set to the priority level
+ * @return \c false if atom is not a priority level
+ */
+bool context_priority_from_atom(term atom, enum ProcessPriority *priority);
+
+/**
+ * @brief Get a heap growth strategy from its atom.
+ *
+ * @param atom one of \c bounded_free, \c minimum or \c fibonacci atoms
+ * @param strategy set to the heap growth strategy
+ * @return \c false if atom is not a heap growth strategy
+ */
+bool context_heap_growth_strategy_from_atom(term atom, enum HeapGrowthStrategy *strategy);
+
+/**
+ * @brief Get a message queue data mode from its atom.
+ *
+ * @param atom one of \c on_heap or \c off_heap atoms
+ * @param off_heap set to \c true if atom is \c off_heap
+ * @return \c false if atom is not a message queue data mode
+ */
+bool context_message_queue_data_from_atom(term atom, bool *off_heap);
+
 /**
  * @brief Half-link process to another process
  * @details Caller must hold the global process lock. This creates one half of
@@ -147,6 +147,31 @@ static const char *const incomplete_atom = "\xA" "incomplete";
 
 static const char *const links_atom = "\x5" "links";
 
+static const char *const timeout_atom = "\x7" "timeout";
+
+static const char *const priority_atom = "\x8" "priority";
+static const char *const low_atom = "\x3" "low";
+static const char *const high_atom = "\x4" "high";
+static const char *const max_atom = "\x3" "max";
+
+static const char *const fullsweep_after_atom = "\xF" "fullsweep_after";
+static const char *const garbage_collection_atom = "\x12" "garbage_collection";
+static const char *const minor_gcs_atom = "\x9" "minor_gcs";
+
+static const char *const atomvm_heap_growth_atom = "\x12" "atomvm_heap_growth";
+static const char *const bounded_free_atom = "\xC" "bounded_free";
+static const char *const minimum_atom = "\x7" "minimum";
+static const char *const fibonacci_atom = "\x9" "fibonacci";
+static const char *const avoided_gcs_atom = "\xB" "avoided_gcs";
+static const char *const atomvm_pool_reserved_atom = "\x14" "atomvm_pool_reserved";
+static const char *const atomvm_pool_oversized_atom = "\x15" "atomvm_pool_oversized";
+
+static const char *const message_queue_data_atom = "\x12" "message_queue_data";
+static const char *const on_heap_atom = "\x7" "on_heap";
+static const char *const off_heap_atom = "\x8" "off_heap";
+
+static const char *const avoided_forced_gcs_atom = "\x12" "avoided_forced_gcs";
+
 void defaultatoms_init(GlobalContext *glb)
 {
     int ok = 1;
@@ -278,6 +303,31 @@ void defaultatoms_init(GlobalContext *glb)
 
     ok &= globalcontext_insert_atom(glb, links_atom) == LINKS_ATOM_INDEX;
 
+    ok &= globalcontext_insert_atom(glb, timeout_atom) == TIMEOUT_ATOM_INDEX;
+
+    ok &= globalcontext_insert_atom(glb, priority_atom) == PRIORITY_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, low_atom) == LOW_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, high_atom) == HIGH_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, max_atom) == MAX_ATOM_INDEX;
+
+    ok &= globalcontext_insert_atom(glb, fullsweep_after_atom) == FULLSWEEP_AFTER_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, garbage_collection_atom) == GARBAGE_COLLECTION_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, minor_gcs_atom) == MINOR_GCS_ATOM_INDEX;
+
+    ok &= globalcontext_insert_atom(glb, atomvm_heap_growth_atom) == ATOMVM_HEAP_GROWTH_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, bounded_free_atom) == BOUNDED_FREE_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, minimum_atom) == MINIMUM_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, fibonacci_atom) == FIBONACCI_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, avoided_gcs_atom) == AVOIDED_GCS_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, atomvm_pool_reserved_atom) == ATOMVM_POOL_RESERVED_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, atomvm_pool_oversized_atom) == ATOMVM_POOL_OVERSIZED_ATOM_INDEX;
+
+    ok &= globalcontext_insert_atom(glb, message_queue_data_atom) == MESSAGE_QUEUE_DATA_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, on_heap_atom) == ON_HEAP_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, off_heap_atom) == OFF_HEAP_ATOM_INDEX;
+
+    ok &= globalcontext_insert_atom(glb, avoided_forced_gcs_atom) == AVOIDED_FORCED_GCS_ATOM_INDEX;
+
     if (!ok) {
         AVM_ABORT();
     }
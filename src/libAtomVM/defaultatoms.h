@@ -156,7 +156,32 @@ extern "C" {
 
 #define LINKS_ATOM_INDEX 100
 
-#define PLATFORM_ATOMS_BASE_INDEX 101
+#define TIMEOUT_ATOM_INDEX 101
+
+#define PRIORITY_ATOM_INDEX 102
+#define LOW_ATOM_INDEX 103
+#define HIGH_ATOM_INDEX 104
+#define MAX_ATOM_INDEX 105
+
+#define FULLSWEEP_AFTER_ATOM_INDEX 106
+#define GARBAGE_COLLECTION_ATOM_INDEX 107
+#define MINOR_GCS_ATOM_INDEX 108
+
+#define ATOMVM_HEAP_GROWTH_ATOM_INDEX 109
+#define BOUNDED_FREE_ATOM_INDEX 110
+#define MINIMUM_ATOM_INDEX 111
+#define FIBONACCI_ATOM_INDEX 112
+#define AVOIDED_GCS_ATOM_INDEX 113
+#define ATOMVM_POOL_RESERVED_ATOM_INDEX 114
+#define ATOMVM_POOL_OVERSIZED_ATOM_INDEX 115
+
+#define MESSAGE_QUEUE_DATA_ATOM_INDEX 116
+#define ON_HEAP_ATOM_INDEX 117
+#define OFF_HEAP_ATOM_INDEX 118
+
+#define AVOIDED_FORCED_GCS_ATOM_INDEX 119
+
+#define PLATFORM_ATOMS_BASE_INDEX 120
 
 #define FALSE_ATOM TERM_FROM_ATOM_INDEX(FALSE_ATOM_INDEX)
 #define TRUE_ATOM TERM_FROM_ATOM_INDEX(TRUE_ATOM_INDEX)
@@ -287,6 +312,31 @@ extern "C" {
 
 #define LINKS_ATOM TERM_FROM_ATOM_INDEX(LINKS_ATOM_INDEX)
 
+#define TIMEOUT_ATOM TERM_FROM_ATOM_INDEX(TIMEOUT_ATOM_INDEX)
+
+#define PRIORITY_ATOM TERM_FROM_ATOM_INDEX(PRIORITY_ATOM_INDEX)
+#define LOW_ATOM TERM_FROM_ATOM_INDEX(LOW_ATOM_INDEX)
+#define HIGH_ATOM TERM_FROM_ATOM_INDEX(HIGH_ATOM_INDEX)
+#define MAX_ATOM TERM_FROM_ATOM_INDEX(MAX_ATOM_INDEX)
+
+#define FULLSWEEP_AFTER_ATOM TERM_FROM_ATOM_INDEX(FULLSWEEP_AFTER_ATOM_INDEX)
+#define GARBAGE_COLLECTION_ATOM TERM_FROM_ATOM_INDEX(GARBAGE_COLLECTION_ATOM_INDEX)
+#define MINOR_GCS_ATOM TERM_FROM_ATOM_INDEX(MINOR_GCS_ATOM_INDEX)
+
+#define ATOMVM_HEAP_GROWTH_ATOM TERM_FROM_ATOM_INDEX(ATOMVM_HEAP_GROWTH_ATOM_INDEX)
+#define BOUNDED_FREE_ATOM TERM_FROM_ATOM_INDEX(BOUNDED_FREE_ATOM_INDEX)
+#define MINIMUM_ATOM TERM_FROM_ATOM_INDEX(MINIMUM_ATOM_INDEX)
+#define FIBONACCI_ATOM TERM_FROM_ATOM_INDEX(FIBONACCI_ATOM_INDEX)
+#define AVOIDED_GCS_ATOM TERM_FROM_ATOM_INDEX(AVOIDED_GCS_ATOM_INDEX)
+#define ATOMVM_POOL_RESERVED_ATOM TERM_FROM_ATOM_INDEX(ATOMVM_POOL_RESERVED_ATOM_INDEX)
+#define ATOMVM_POOL_OVERSIZED_ATOM TERM_FROM_ATOM_INDEX(ATOMVM_POOL_OVERSIZED_ATOM_INDEX)
+
+#define MESSAGE_QUEUE_DATA_ATOM TERM_FROM_ATOM_INDEX(MESSAGE_QUEUE_DATA_ATOM_INDEX)
+#define ON_HEAP_ATOM TERM_FROM_ATOM_INDEX(ON_HEAP_ATOM_INDEX)
+#define OFF_HEAP_ATOM TERM_FROM_ATOM_INDEX(OFF_HEAP_ATOM_INDEX)
+
+#define AVOIDED_FORCED_GCS_ATOM TERM_FROM_ATOM_INDEX(AVOIDED_FORCED_GCS_ATOM_INDEX)
+
 void defaultatoms_init(GlobalContext *glb);
 
 void platform_defaultatoms_init(GlobalContext *glb);
@@ -21,98 +21,295 @@
 #include "dictionary.h"
 
 #include "defaultatoms.h"
-#include "list.h"
 #include "term.h"
 
 #include <stdlib.h>
+#include <string.h>
 
-static DictionaryFunctionResult dictionary_find(
-    struct ListHead *dictionary, term key, struct DictEntry **found, GlobalContext *global)
+#define DICTIONARY_MIN_CAPACITY 8
+// keys are hashed up to this depth and only the first elements of
+// containers and binaries are hashed, so hashing is bounded
+#define DICTIONARY_HASH_MAX_DEPTH 3
+#define DICTIONARY_HASH_MAX_ELEMENTS 8
+#define DICTIONARY_HASH_MAX_BYTES 64
+
+enum DictionaryHashTag
+{
+    DictionaryHashInteger = 1,
+    DictionaryHashFloat,
+    DictionaryHashImmediate,
+    DictionaryHashReference,
+    DictionaryHashBinary,
+    DictionaryHashTuple,
+    DictionaryHashList,
+    DictionaryHashMap,
+    DictionaryHashOther
+};
+
+static inline uint32_t hash_mix(uint32_t h, uint32_t value)
+{
+    return (h ^ value) * 0x01000193;
+}
+
+static inline uint32_t hash_mix64(uint32_t h, uint64_t value)
+{
+    return hash_mix(hash_mix(h, (uint32_t) value), (uint32_t) (value >> 32));
+}
+
+// Terms that are equal when compared with TermCompareExact must have the same
+// hash, and the hash must not depend on where boxed terms are allocated since
+// it is kept across garbage collections.
+static uint32_t hash_term(uint32_t h, term t, int depth)
+{
+    if (term_is_any_integer(t)) {
+        return hash_mix64(hash_mix(h, DictionaryHashInteger), (uint64_t) term_maybe_unbox_int64(t));
+
+    } else if (term_is_float(t)) {
+        avm_float_t f = term_to_float(t);
+        if (f == 0) {
+            // 0.0 and -0.0 compare equal
+            f = 0;
+        }
+        uint8_t bytes[sizeof(avm_float_t)];
+        memcpy(bytes, &f, sizeof(avm_float_t));
+        h = hash_mix(h, DictionaryHashFloat);
+        for (size_t i = 0; i < sizeof(avm_float_t); i++) {
+            h = hash_mix(h, bytes[i]);
+        }
+        return h;
+
+    } else if ((t & 0x3) == 0x3) {
+        // atoms, pids, nil and other immediates are equal only if identical
+        return hash_mix64(hash_mix(h, DictionaryHashImmediate), (uint64_t) t);
+    }
+
+    if (depth >= DICTIONARY_HASH_MAX_DEPTH) {
+        return hash_mix(h, DictionaryHashOther);
+    }
+
+    if (term_is_reference(t)) {
+        return hash_mix64(hash_mix(h, DictionaryHashReference), (uint64_t) term_to_ref_ticks(t));
+
+    } else if (term_is_binary(t)) {
+        size_t size = term_binary_size(t);
+        const uint8_t *data = (const uint8_t *) term_binary_data(t);
+        h = hash_mix(hash_mix(h, DictionaryHashBinary), (uint32_t) size);
+        size_t hashed_size = size < DICTIONARY_HASH_MAX_BYTES ? size : DICTIONARY_HASH_MAX_BYTES;
+        for (size_t i = 0; i < hashed_size; i++) {
+            h = hash_mix(h, data[i]);
+        }
+        return h;
+
+    } else if (term_is_tuple(t)) {
+        int arity = term_get_tuple_arity(t);
+        h = hash_mix(hash_mix(h, DictionaryHashTuple), arity);
+        for (int i = 0; i < arity && i < DICTIONARY_HASH_MAX_ELEMENTS; i++) {
+            h = hash_term(h, term_get_tuple_element(t, i), depth + 1);
+        }
+        return h;
+
+    } else if (term_is_nonempty_list(t)) {
+        h = hash_mix(h, DictionaryHashList);
+        for (int i = 0; i < DICTIONARY_HASH_MAX_ELEMENTS && term_is_nonempty_list(t); i++) {
+            h = hash_term(h, term_get_list_head(t), depth + 1);
+            t = term_get_list_tail(t);
+        }
+        return h;
+
+    } else if (term_is_map(t)) {
+        int size = term_get_map_size(t);
+        h = hash_mix(hash_mix(h, DictionaryHashMap), size);
+        for (int i = 0; i < size && i < DICTIONARY_HASH_MAX_ELEMENTS; i++) {
+            h = hash_term(h, term_get_map_key(t, i), depth + 1);
+            h = hash_term(h, term_get_map_value(t, i), depth + 1);
+        }
+        return h;
+
+    } else {
+        // funs are compared by identity, their address changes with garbage collection
+        return hash_mix(h, DictionaryHashOther);
+    }
+}
+
+static uint32_t dictionary_hash(term key)
+{
+    uint32_t h = hash_term(0x811C9DC5, key, 0);
+
+    // spread high bits to low bits, which are used to pick the slot
+    h ^= h >> 16;
+    h *= 0x85EBCA6B;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35;
+    h ^= h >> 16;
+
+    return h;
+}
+
+static DictionaryFunctionResult dictionary_find(struct Dictionary *dict, term key, uint32_t hash,
+    size_t *pos, bool *found, GlobalContext *global)
 {
-    struct ListHead *item;
-    LIST_FOR_EACH (item, dictionary) {
-        struct DictEntry *entry = GET_LIST_ENTRY(item, struct DictEntry, head);
-        TermCompareResult result = term_compare(entry->key, key, TermCompareExact, global);
-        if (result == TermEquals) {
-            *found = entry;
-            return DictionaryOk;
-        } else if (UNLIKELY(result == TermCompareMemoryAllocFail)) {
-            return DictionaryMemoryAllocFail;
+    *found = false;
+    if (dict->capacity == 0) {
+        return DictionaryOk;
+    }
+
+    size_t mask = dict->capacity - 1;
+    size_t i = hash & mask;
+    // capacity is always larger than count, so an empty slot is eventually found
+    while (dictionary_entry_is_used(&dict->entries[i])) {
+        struct DictEntry *entry = &dict->entries[i];
+        if (entry->hash == hash) {
+            TermCompareResult result = term_compare(entry->key, key, TermCompareExact, global);
+            if (result == TermEquals) {
+                *pos = i;
+                *found = true;
+                return DictionaryOk;
+            } else if (UNLIKELY(result == TermCompareMemoryAllocFail)) {
+                return DictionaryMemoryAllocFail;
+            }
+        }
+        i = (i + 1) & mask;
+    }
+
+    *pos = i;
+    return DictionaryOk;
+}
+
+static size_t dictionary_free_slot(const struct Dictionary *dict, uint32_t hash)
+{
+    size_t mask = dict->capacity - 1;
+    size_t i = hash & mask;
+    while (dictionary_entry_is_used(&dict->entries[i])) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+static DictionaryFunctionResult dictionary_resize(struct Dictionary *dict, size_t new_capacity)
+{
+    struct DictEntry *new_entries = malloc(new_capacity * sizeof(struct DictEntry));
+    if (IS_NULL_PTR(new_entries)) {
+        return DictionaryMemoryAllocFail;
+    }
+    for (size_t i = 0; i < new_capacity; i++) {
+        new_entries[i].key = term_invalid_term();
+    }
+
+    struct DictEntry *old_entries = dict->entries;
+    size_t old_capacity = dict->capacity;
+    dict->entries = new_entries;
+    dict->capacity = new_capacity;
+
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (dictionary_entry_is_used(&old_entries[i])) {
+            dict->entries[dictionary_free_slot(dict, old_entries[i].hash)] = old_entries[i];
         }
     }
+    free(old_entries);
 
-    *found = NULL;
     return DictionaryOk;
 }
 
+void dictionary_init(struct Dictionary *dict)
+{
+    dict->entries = NULL;
+    dict->capacity = 0;
+    dict->count = 0;
+}
+
 DictionaryFunctionResult dictionary_put(
-    struct ListHead *dict, term key, term value, term *old, GlobalContext *global)
+    struct Dictionary *dict, term key, term value, term *old, GlobalContext *global)
 {
-    struct DictEntry *entry;
-    DictionaryFunctionResult result = dictionary_find(dict, key, &entry, global);
+    uint32_t hash = dictionary_hash(key);
+    size_t pos;
+    bool found;
+    DictionaryFunctionResult result = dictionary_find(dict, key, hash, &pos, &found, global);
     if (UNLIKELY(result != DictionaryOk)) {
         return result;
     }
 
-    if (entry) {
-        *old = entry->value;
-        entry->value = value;
+    if (found) {
+        *old = dict->entries[pos].value;
+        dict->entries[pos].value = value;
+        return DictionaryOk;
+    }
 
-    } else {
-        entry = malloc(sizeof(struct DictEntry));
-        if (IS_NULL_PTR(entry)) {
-            return DictionaryMemoryAllocFail;
+    // keep the load factor below 3/4
+    if ((dict->count + 1) * 4 > dict->capacity * 3) {
+        size_t new_capacity = dict->capacity ? dict->capacity * 2 : DICTIONARY_MIN_CAPACITY;
+        result = dictionary_resize(dict, new_capacity);
+        if (UNLIKELY(result != DictionaryOk)) {
+            return result;
         }
-        entry->key = key;
-        entry->value = value;
-        list_prepend(dict, &entry->head);
-
-        *old = UNDEFINED_ATOM;
+        pos = dictionary_free_slot(dict, hash);
     }
 
+    struct DictEntry *entry = &dict->entries[pos];
+    entry->key = key;
+    entry->value = value;
+    entry->hash = hash;
+    dict->count++;
+
+    *old = UNDEFINED_ATOM;
     return DictionaryOk;
 }
 
 DictionaryFunctionResult dictionary_get(
-    struct ListHead *dict, term key, term *old, GlobalContext *global)
+    struct Dictionary *dict, term key, term *old, GlobalContext *global)
 {
-    struct DictEntry *entry;
-    DictionaryFunctionResult result = dictionary_find(dict, key, &entry, global);
+    size_t pos;
+    bool found;
+    DictionaryFunctionResult result = dictionary_find(dict, key, dictionary_hash(key), &pos, &found, global);
     if (UNLIKELY(result != DictionaryOk)) {
         return result;
     }
 
-    *old = entry ? entry->value : UNDEFINED_ATOM;
+    *old = found ? dict->entries[pos].value : UNDEFINED_ATOM;
     return DictionaryOk;
 }
 
 DictionaryFunctionResult dictionary_erase(
-    struct ListHead *dict, term key, term *old, GlobalContext *global)
+    struct Dictionary *dict, term key, term *old, GlobalContext *global)
 {
-    struct DictEntry *entry;
-    DictionaryFunctionResult result = dictionary_find(dict, key, &entry, global);
+    size_t pos;
+    bool found;
+    DictionaryFunctionResult result = dictionary_find(dict, key, dictionary_hash(key), &pos, &found, global);
     if (UNLIKELY(result != DictionaryOk)) {
         return result;
     }
 
-    if (!entry) {
+    if (!found) {
         *old = UNDEFINED_ATOM;
         return DictionaryOk;
     }
-    *old = entry->value;
+    *old = dict->entries[pos].value;
+
+    // move back the following entries of the probe sequence, so lookups
+    // don't need tombstones
+    size_t mask = dict->capacity - 1;
+    size_t hole = pos;
+    size_t i = (pos + 1) & mask;
+    while (dictionary_entry_is_used(&dict->entries[i])) {
+        size_t home = dict->entries[i].hash & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            dict->entries[hole] = dict->entries[i];
+            hole = i;
+        }
+        i = (i + 1) & mask;
+    }
+    dict->entries[hole].key = term_invalid_term();
+    dict->count--;
 
-    list_remove(&entry->head);
-    free(entry);
+    if (dict->capacity > DICTIONARY_MIN_CAPACITY && dict->count * 8 <= dict->capacity) {
+        // shrinking is optional, keep the current table if it fails
+        dictionary_resize(dict, dict->capacity / 2);
+    }
 
     return DictionaryOk;
 }
 
-void dictionary_destroy(struct ListHead *dict)
+void dictionary_destroy(struct Dictionary *dict)
 {
-    struct ListHead *item;
-    struct ListHead *tmp;
-    MUTABLE_LIST_FOR_EACH (item, tmp, dict) {
-        struct DictEntry *entry = GET_LIST_ENTRY(item, struct DictEntry, head);
-        free(entry);
-    }
+    free(dict->entries);
+    dictionary_init(dict);
 }
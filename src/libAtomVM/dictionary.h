@@ -25,7 +25,9 @@
 extern "C" {
 #endif
 
-#include "list.h"
+#include <stdbool.h>
+#include <stdint.h>
+
 #include "term.h"
 
 typedef enum
@@ -34,20 +36,34 @@ typedef enum
     DictionaryMemoryAllocFail
 } DictionaryFunctionResult;
 
+// Slots of an open addressing hash table, empty slots have an invalid key.
 struct DictEntry
 {
-    struct ListHead head;
     term key;
     term value;
+    uint32_t hash;
+};
+
+struct Dictionary
+{
+    struct DictEntry *entries;
+    size_t capacity;
+    size_t count;
 };
 
+void dictionary_init(struct Dictionary *dict);
 DictionaryFunctionResult dictionary_put(
-    struct ListHead *dict, term key, term value, term *old, GlobalContext *ctx);
+    struct Dictionary *dict, term key, term value, term *old, GlobalContext *ctx);
 DictionaryFunctionResult dictionary_get(
-    struct ListHead *dict, term key, term *old, GlobalContext *ctx);
+    struct Dictionary *dict, term key, term *old, GlobalContext *ctx);
 DictionaryFunctionResult dictionary_erase(
-    struct ListHead *dict, term key, term *old, GlobalContext *ctx);
-void dictionary_destroy(struct ListHead *dict);
+    struct Dictionary *dict, term key, term *old, GlobalContext *ctx);
+void dictionary_destroy(struct Dictionary *dict);
+
+static inline bool dictionary_entry_is_used(const struct DictEntry *entry)
+{
+    return entry->key != term_invalid_term();
+}
 
 #ifdef __cplusplus
 }
@@ -46,6 +46,7 @@ typedef term (*GCBifImpl2)(Context *ctx, int live, term arg1, term arg2);
 typedef term (*GCBifImpl3)(Context *ctx, int live, term arg1, term arg2, term arg3);
 
 typedef term (*NifImpl)(Context *ctx, int argc, term argv[]);
+typedef size_t (*NifHeapNeedImpl)(Context *ctx, int argc, const term argv[]);
 
 enum FunctionType
 {
@@ -88,6 +89,9 @@ struct Nif
 {
     struct ExportedFunction base;
     NifImpl nif_ptr;
+    // Optional, returns an upper bound of the heap words the NIF allocates,
+    // which are reserved before it is called
+    NifHeapNeedImpl heap_need_ptr;
 };
 
 struct UnresolvedFunctionCall
@@ -128,6 +128,27 @@ term externalterm_to_term(const void *external_term, size_t size, Context *ctx,
     return externalterm_to_term_internal(external_term, size, ctx, opts, &bytes_read, false);
 }
 
+term externalterm_to_term_with_heap(const void *external_term, size_t size, Heap *heap, GlobalContext *glb)
+{
+    const uint8_t *external_term_buf = (const uint8_t *) external_term;
+
+    if (UNLIKELY(size == 0 || external_term_buf[0] != EXTERNAL_TERM_TAG)) {
+        return term_invalid_term();
+    }
+
+    size_t eterm_size;
+    int heap_usage = calculate_heap_usage(external_term_buf + 1, size - 1, &eterm_size, false);
+    if (heap_usage == INVALID_TERM_SIZE) {
+        return term_invalid_term();
+    }
+
+    if (UNLIKELY(memory_init_heap(heap, heap_usage) != MEMORY_GC_OK)) {
+        return term_invalid_term();
+    }
+
+    return parse_external_terms(external_term_buf + 1, &eterm_size, false, heap, glb);
+}
+
 enum ExternalTermResult externalterm_from_binary(Context *ctx, term *dst, term binary, size_t *bytes_read)
 {
     if (!term_is_binary(binary)) {
@@ -575,6 +596,10 @@ static term parse_external_terms(const uint8_t *external_term_buf, size_t *eterm
 
                 term_set_map_assoc(map, i, key, value);
             }
+            // Keys of large maps are encoded in hash order by BEAM
+            if (UNLIKELY(!term_sort_map(map, glb))) {
+                return term_invalid_term();
+            }
             *eterm_size = buf_pos;
             return map;
         }
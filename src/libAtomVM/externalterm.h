@@ -64,6 +64,21 @@ typedef enum
 term externalterm_to_term(
     const void *external_term, size_t size, Context *ctx, ExternalTermOpts opts);
 
+/**
+ * @brief Gets a term from external term data, storing it in a new heap.
+ *
+ * @details Deserialize an external term into a newly initialized heap that is
+ * not owned by any context, sized to exactly fit the term. Binaries are not
+ * copied and reference external_term data, which must outlive the heap.
+ * @param external_term the external term that will be deserialized.
+ * @param size the size of the external term data.
+ * @param heap the heap that will be initialized and will hold the term.
+ * @param glb the global context.
+ * @returns a term, or an invalid term if data is not valid or if the heap
+ * couldn't be allocated, in which case the heap is left uninitialized.
+ */
+term externalterm_to_term_with_heap(const void *external_term, size_t size, Heap *heap, GlobalContext *glb);
+
 /**
  * @brief Create a term from a binary.
  *
@@ -29,13 +29,14 @@
 #include "defaultatoms.h"
 #include "erl_nif_priv.h"
 #include "list.h"
+#include "memory_pool.h"
 #include "posix_nifs.h"
 #include "refc_binary.h"
 #include "resources.h"
+#include "scheduler.h"
 #include "synclist.h"
 #include "sys.h"
 #include "utils.h"
-#include "valueshashtable.h"
 
 #ifndef AVM_NO_SMP
 #define SMP_SPINLOCK_LOCK(spinlock) smp_spinlock_lock(spinlock)
@@ -57,32 +58,104 @@
 
 struct RegisteredProcess
 {
-    struct ListHead registered_processes_list_head;
+    struct RegisteredProcess *next_by_name;
+    struct RegisteredProcess *next_by_process_id;
 
     int atom_index;
     int local_process_id;
 };
 
+#define DEFAULT_ATOMS_IDS_CAPACITY 512
+#define DEFAULT_PROCESSES_INDEX_CAPACITY 64
+#define DEFAULT_REGISTERED_PROCESSES_CAPACITY 16
+#define DEFAULT_MONITORS_INDEX_CAPACITY 64
+
+static struct AtomsIdsTable *atoms_ids_table_new(int capacity)
+{
+    struct AtomsIdsTable *table = calloc(1, sizeof(struct AtomsIdsTable) + capacity * sizeof(AtomString));
+    if (IS_NULL_PTR(table)) {
+        return NULL;
+    }
+    table->sort_keys = calloc(capacity, sizeof(uint64_t));
+    if (IS_NULL_PTR(table->sort_keys)) {
+        free(table);
+        return NULL;
+    }
+    table->capacity = capacity;
+    table->previous = NULL;
+
+    return table;
+}
+
+static struct AtomsIdsTable *atoms_ids_table_grow(struct AtomsIdsTable *table)
+{
+    struct AtomsIdsTable *new_table = atoms_ids_table_new(table->capacity * 2);
+    if (IS_NULL_PTR(new_table)) {
+        return NULL;
+    }
+    for (int i = 0; i < table->capacity; i++) {
+        new_table->sort_keys[i] = table->sort_keys[i];
+        new_table->strings[i] = table->strings[i];
+    }
+    new_table->previous = table;
+
+    return new_table;
+}
+
+static void atoms_ids_table_destroy(struct AtomsIdsTable *table)
+{
+    while (table) {
+        struct AtomsIdsTable *previous = table->previous;
+        free(table->sort_keys);
+        free(table);
+        table = previous;
+    }
+}
+
+static void atoms_tables_destroy(GlobalContext *glb)
+{
+#ifndef AVM_NO_SMP
+    smp_mutex_destroy(glb->atoms_mutex);
+#endif
+    atoms_ids_table_destroy(glb->atoms_ids_table);
+    atomshashtable_destroy(glb->atoms_table);
+}
+
 GlobalContext *globalcontext_new()
 {
     GlobalContext *glb = malloc(sizeof(GlobalContext));
     if (IS_NULL_PTR(glb)) {
         return NULL;
     }
-    list_init(&glb->ready_processes);
-    list_init(&glb->running_processes);
-    list_init(&glb->waiting_processes);
+    for (int i = 0; i < PROCESS_PRIORITIES; i++) {
+        list_init(&glb->ready_processes[i]);
+    }
+    glb->ready_picks = 0;
 #ifndef AVM_NO_SMP
     smp_spinlock_init(&glb->processes_spinlock);
 #endif
     synclist_init(&glb->avmpack_data);
     synclist_init(&glb->refc_binaries);
     synclist_init(&glb->processes_table);
-    synclist_init(&glb->registered_processes);
+    glb->monitors_index = NULL;
+    glb->monitors_index_capacity = 0;
+    glb->monitors_count = 0;
+#ifndef AVM_NO_SMP
+    smp_spinlock_init(&glb->monitors_spinlock);
+#endif
+
+    glb->registered_processes_by_name = NULL;
+    glb->registered_processes_by_process_id = NULL;
+    glb->registered_processes_capacity = 0;
+    glb->registered_processes_count = 0;
     synclist_init(&glb->listeners);
     synclist_init(&glb->resource_types);
     synclist_init(&glb->select_events);
 
+    glb->processes_index = NULL;
+    glb->processes_index_capacity = 0;
+    glb->processes_count = 0;
+
     glb->last_process_id = 0;
 
     glb->atoms_table = atomshashtable_new();
@@ -90,30 +163,38 @@ GlobalContext *globalcontext_new()
         free(glb);
         return NULL;
     }
-    glb->atoms_ids_table = valueshashtable_new();
+    glb->atoms_ids_table = atoms_ids_table_new(DEFAULT_ATOMS_IDS_CAPACITY);
     if (IS_NULL_PTR(glb->atoms_ids_table)) {
-        free(glb->atoms_table);
+        atomshashtable_destroy(glb->atoms_table);
         free(glb);
         return NULL;
     }
 
+#ifndef AVM_NO_SMP
+    glb->atoms_mutex = smp_mutex_create();
+    if (IS_NULL_PTR(glb->atoms_mutex)) {
+        atoms_ids_table_destroy(glb->atoms_ids_table);
+        atomshashtable_destroy(glb->atoms_table);
+        free(glb);
+        return NULL;
+    }
+#endif
+
     defaultatoms_init(glb);
 
     glb->modules_by_index = NULL;
     glb->loaded_modules_count = 0;
     glb->modules_table = atomshashtable_new();
     if (IS_NULL_PTR(glb->modules_table)) {
-        free(glb->atoms_ids_table);
-        free(glb->atoms_table);
+        atoms_tables_destroy(glb);
         free(glb);
         return NULL;
     }
 #ifndef AVM_NO_SMP
     glb->modules_lock = smp_rwlock_create();
     if (IS_NULL_PTR(glb->modules_lock)) {
-        free(glb->modules_table);
-        free(glb->atoms_ids_table);
-        free(glb->atoms_table);
+        atomshashtable_destroy(glb->modules_table);
+        atoms_tables_destroy(glb);
         free(glb);
         return NULL;
     }
@@ -123,12 +204,23 @@ GlobalContext *globalcontext_new()
 #ifndef AVM_NO_SMP
     smp_spinlock_init(&glb->timer_spinlock);
 #endif
+    glb->erlang_timers_index = NULL;
+    glb->erlang_timers_index_capacity = 0;
+    glb->erlang_timers_count = 0;
+    list_init(&glb->fired_erlang_timers);
 
     glb->ref_ticks = 0;
 #if !defined(AVM_NO_SMP) && ATOMIC_LLONG_LOCK_FREE != 2
     smp_spinlock_init(&glb->ref_ticks_spinlock);
 #endif
 
+    glb->fullsweep_after = DEFAULT_FULLSWEEP_AFTER;
+    glb->gc_count = 0;
+    glb->gc_words_reclaimed = 0;
+#if !defined(AVM_NO_SMP) && ATOMIC_LLONG_LOCK_FREE != 2
+    smp_spinlock_init(&glb->gc_stats_spinlock);
+#endif
+
 #if HAVE_OPEN && HAVE_CLOSE
     ErlNifEnv env;
     erl_nif_env_partial_init_from_globalcontext(&env, glb);
@@ -137,9 +229,8 @@ GlobalContext *globalcontext_new()
 #ifndef AVM_NO_SMP
         smp_rwlock_destroy(glb->modules_lock);
 #endif
-        free(glb->modules_table);
-        free(glb->atoms_ids_table);
-        free(glb->atoms_table);
+        atomshashtable_destroy(glb->modules_table);
+        atoms_tables_destroy(glb);
         free(glb);
         return NULL;
     }
@@ -154,9 +245,8 @@ GlobalContext *globalcontext_new()
         resource_type_destroy(glb->posix_fd_resource_type);
 #endif
         smp_rwlock_destroy(glb->modules_lock);
-        free(glb->modules_table);
-        free(glb->atoms_ids_table);
-        free(glb->atoms_table);
+        atomshashtable_destroy(glb->modules_table);
+        atoms_tables_destroy(glb);
         free(glb);
         return NULL;
     }
@@ -167,20 +257,81 @@ GlobalContext *globalcontext_new()
         resource_type_destroy(glb->posix_fd_resource_type);
 #endif
         smp_rwlock_destroy(glb->modules_lock);
-        free(glb->modules_table);
-        free(glb->atoms_ids_table);
-        free(glb->atoms_table);
+        atomshashtable_destroy(glb->modules_table);
+        atoms_tables_destroy(glb);
+        free(glb);
+        return NULL;
+    }
+    glb->registered_processes_lock = smp_rwlock_create();
+    if (IS_NULL_PTR(glb->registered_processes_lock)) {
+        smp_condvar_destroy(glb->schedulers_cv);
+        smp_mutex_destroy(glb->schedulers_mutex);
+#if HAVE_OPEN && HAVE_CLOSE
+        resource_type_destroy(glb->posix_fd_resource_type);
+#endif
+        smp_rwlock_destroy(glb->modules_lock);
+        atomshashtable_destroy(glb->modules_table);
+        atoms_tables_destroy(glb);
         free(glb);
         return NULL;
     }
     glb->online_schedulers = smp_get_online_processors();
     glb->running_schedulers = 0;
     glb->waiting_scheduler = false;
+    glb->scheduler_queues_count = smp_get_online_processors();
+    glb->scheduler_queues = malloc(glb->scheduler_queues_count * sizeof(struct SchedulerQueue));
+    if (IS_NULL_PTR(glb->scheduler_queues)) {
+        smp_rwlock_destroy(glb->registered_processes_lock);
+        smp_condvar_destroy(glb->schedulers_cv);
+        smp_mutex_destroy(glb->schedulers_mutex);
+#if HAVE_OPEN && HAVE_CLOSE
+        resource_type_destroy(glb->posix_fd_resource_type);
+#endif
+        smp_rwlock_destroy(glb->modules_lock);
+        atomshashtable_destroy(glb->modules_table);
+        atoms_tables_destroy(glb);
+        free(glb);
+        return NULL;
+    }
+    for (int i = 0; i < glb->scheduler_queues_count; i++) {
+        for (int j = 0; j < PROCESS_PRIORITIES; j++) {
+            list_init(&glb->scheduler_queues[i].ready_processes[j]);
+        }
+        smp_spinlock_init(&glb->scheduler_queues[i].lock);
+        glb->scheduler_queues[i].ready_picks = 0;
+        glb->scheduler_queues[i].local_picks = 0;
+        glb->scheduler_queues[i].active = false;
+    }
 
     smp_spinlock_init(&glb->env_spinlock);
 #endif
     glb->scheduler_stop_all = false;
 
+#ifndef AVM_NO_SMP
+    int pool_schedulers = glb->scheduler_queues_count;
+#else
+    int pool_schedulers = 0;
+#endif
+    if (UNLIKELY(!memory_pool_init(glb, pool_schedulers))) {
+        sys_free_platform(glb);
+#ifndef AVM_NO_SMP
+        free(glb->scheduler_queues);
+        smp_rwlock_destroy(glb->registered_processes_lock);
+        smp_condvar_destroy(glb->schedulers_cv);
+        smp_mutex_destroy(glb->schedulers_mutex);
+#endif
+#if HAVE_OPEN && HAVE_CLOSE
+        resource_type_destroy(glb->posix_fd_resource_type);
+#endif
+#ifndef AVM_NO_SMP
+        smp_rwlock_destroy(glb->modules_lock);
+#endif
+        atomshashtable_destroy(glb->modules_table);
+        atoms_tables_destroy(glb);
+        free(glb);
+        return NULL;
+    }
+
     return glb;
 }
 
@@ -188,6 +339,9 @@ COLD_FUNC void globalcontext_destroy(GlobalContext *glb)
 {
     sys_free_platform(glb);
 
+    // Pending timers messages may reference refc binaries
+    scheduler_destroy_timers(glb);
+
     struct ListHead *item;
     struct ListHead *tmp;
 
@@ -232,42 +386,53 @@ COLD_FUNC void globalcontext_destroy(GlobalContext *glb)
     smp_condvar_destroy(glb->schedulers_cv);
     smp_mutex_destroy(glb->schedulers_mutex);
     smp_rwlock_destroy(glb->modules_lock);
+    smp_rwlock_destroy(glb->registered_processes_lock);
+    free(glb->scheduler_queues);
 #endif
-    synclist_destroy(&glb->registered_processes);
+    for (unsigned int i = 0; i < glb->registered_processes_capacity; i++) {
+        struct RegisteredProcess *registered_process = glb->registered_processes_by_name[i];
+        while (registered_process) {
+            struct RegisteredProcess *next = registered_process->next_by_name;
+            free(registered_process);
+            registered_process = next;
+        }
+    }
+    free(glb->registered_processes_by_name);
+    free(glb->registered_processes_by_process_id);
+    atomshashtable_destroy(glb->modules_table);
+    atoms_tables_destroy(glb);
     synclist_destroy(&glb->processes_table);
+    free(glb->processes_index);
+    free(glb->monitors_index);
+
+    // Processes and their messages were destroyed
+    memory_pool_destroy(glb);
 
     free(glb);
 }
 
 Context *globalcontext_get_process_nolock(GlobalContext *glb, int32_t process_id)
 {
-    struct ListHead *item;
-    Context *p = NULL;
-
-    struct ListHead *processes_table_list = synclist_nolock(&glb->processes_table);
-    LIST_FOR_EACH (item, processes_table_list) {
-        p = GET_LIST_ENTRY(item, Context, processes_table_head);
+    if (UNLIKELY(glb->processes_index_capacity == 0)) {
+        return NULL;
+    }
 
-        if (p->process_id == process_id) {
-            return p;
-        }
+    // process ids are sequential so they are evenly spread among buckets
+    Context *p = glb->processes_index[process_id & (glb->processes_index_capacity - 1)];
+    while (p && p->process_id != process_id) {
+        p = p->processes_index_next;
     }
 
-    return NULL;
+    return p;
 }
 
 Context *globalcontext_get_process_lock(GlobalContext *glb, int32_t process_id)
 {
-    struct ListHead *item;
-    Context *p = NULL;
-
     struct ListHead *processes_table_list = synclist_rdlock(&glb->processes_table);
-    LIST_FOR_EACH (item, processes_table_list) {
-        p = GET_LIST_ENTRY(item, Context, processes_table_head);
-
-        if (p->process_id == process_id) {
-            return p;
-        }
+    UNUSED(processes_table_list);
+    Context *p = globalcontext_get_process_nolock(glb, process_id);
+    if (p) {
+        return p;
     }
     synclist_unlock(&glb->processes_table);
 
@@ -297,6 +462,15 @@ void globalcontext_send_message(GlobalContext *glb, int32_t process_id, term t)
     }
 }
 
+void globalcontext_send_message_on_scheduler(GlobalContext *glb, int scheduler_id, int32_t process_id, term t)
+{
+    Context *p = globalcontext_get_process_lock(glb, process_id);
+    if (p) {
+        mailbox_send_on_scheduler(p, scheduler_id, t);
+        globalcontext_get_process_unlock(glb, p);
+    }
+}
+
 void globalcontext_send_message_nolock(GlobalContext *glb, int32_t process_id, term t)
 {
     Context *p = globalcontext_get_process_nolock(glb, process_id);
@@ -305,27 +479,140 @@ void globalcontext_send_message_nolock(GlobalContext *glb, int32_t process_id, t
     }
 }
 
+static void processes_index_grow(GlobalContext *glb)
+{
+    unsigned int new_capacity = glb->processes_index_capacity ? glb->processes_index_capacity * 2 : DEFAULT_PROCESSES_INDEX_CAPACITY;
+    Context **new_index = calloc(new_capacity, sizeof(Context *));
+    if (IS_NULL_PTR(new_index)) {
+        if (glb->processes_index_capacity == 0) {
+            fprintf(stderr, "Unable to allocate memory for processes index\n");
+            AVM_ABORT();
+        }
+        // keep the current index, with longer chains
+        return;
+    }
+
+    for (unsigned int i = 0; i < glb->processes_index_capacity; i++) {
+        Context *p = glb->processes_index[i];
+        while (p) {
+            Context *next = p->processes_index_next;
+            unsigned int bucket = p->process_id & (new_capacity - 1);
+            p->processes_index_next = new_index[bucket];
+            new_index[bucket] = p;
+            p = next;
+        }
+    }
+
+    free(glb->processes_index);
+    glb->processes_index = new_index;
+    glb->processes_index_capacity = new_capacity;
+}
+
+void globalcontext_remove_process_nolock(GlobalContext *glb, Context *ctx)
+{
+    list_remove(&ctx->processes_table_head);
+
+    Context **p = &glb->processes_index[ctx->process_id & (glb->processes_index_capacity - 1)];
+    while (*p != ctx) {
+        p = &(*p)->processes_index_next;
+    }
+    *p = ctx->processes_index_next;
+    glb->processes_count--;
+}
+
 void globalcontext_init_process(GlobalContext *glb, Context *ctx)
 {
     ctx->global = glb;
 
-    synclist_append(&glb->processes_table, &ctx->processes_table_head);
     SMP_SPINLOCK_LOCK(&glb->processes_spinlock);
     ctx->process_id = ++glb->last_process_id;
-    list_append(&glb->waiting_processes, &ctx->processes_list_head);
     SMP_SPINLOCK_UNLOCK(&glb->processes_spinlock);
+
+    struct ListHead *processes_table_list = synclist_wrlock(&glb->processes_table);
+    list_append(processes_table_list, &ctx->processes_table_head);
+    if (glb->processes_count >= glb->processes_index_capacity) {
+        processes_index_grow(glb);
+    }
+    unsigned int bucket = ctx->process_id & (glb->processes_index_capacity - 1);
+    ctx->processes_index_next = glb->processes_index[bucket];
+    glb->processes_index[bucket] = ctx;
+    glb->processes_count++;
+    synclist_unlock(&glb->processes_table);
 }
 
-bool globalcontext_register_process(GlobalContext *glb, int atom_index, int local_process_id)
+static void registered_processes_grow(GlobalContext *glb)
 {
-    struct ListHead *registered_processes_list = synclist_wrlock(&glb->registered_processes);
-    struct ListHead *item;
-    LIST_FOR_EACH (item, registered_processes_list) {
-        const struct RegisteredProcess *registered_process = GET_LIST_ENTRY(item, struct RegisteredProcess, registered_processes_list_head);
-        if (registered_process->atom_index == atom_index) {
-            synclist_unlock(&glb->registered_processes);
-            return false;
+    unsigned int new_capacity = glb->registered_processes_capacity ? glb->registered_processes_capacity * 2 : DEFAULT_REGISTERED_PROCESSES_CAPACITY;
+    struct RegisteredProcess **by_name = calloc(new_capacity, sizeof(struct RegisteredProcess *));
+    struct RegisteredProcess **by_process_id = calloc(new_capacity, sizeof(struct RegisteredProcess *));
+    if (IS_NULL_PTR(by_name) || IS_NULL_PTR(by_process_id)) {
+        free(by_name);
+        free(by_process_id);
+        if (glb->registered_processes_capacity == 0) {
+            fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+            AVM_ABORT();
         }
+        // keep the current buckets, with longer chains
+        return;
+    }
+
+    for (unsigned int i = 0; i < glb->registered_processes_capacity; i++) {
+        struct RegisteredProcess *registered_process = glb->registered_processes_by_name[i];
+        while (registered_process) {
+            struct RegisteredProcess *next = registered_process->next_by_name;
+            unsigned int name_bucket = registered_process->atom_index & (new_capacity - 1);
+            registered_process->next_by_name = by_name[name_bucket];
+            by_name[name_bucket] = registered_process;
+            unsigned int process_id_bucket = registered_process->local_process_id & (new_capacity - 1);
+            registered_process->next_by_process_id = by_process_id[process_id_bucket];
+            by_process_id[process_id_bucket] = registered_process;
+            registered_process = next;
+        }
+    }
+
+    free(glb->registered_processes_by_name);
+    free(glb->registered_processes_by_process_id);
+    glb->registered_processes_by_name = by_name;
+    glb->registered_processes_by_process_id = by_process_id;
+    glb->registered_processes_capacity = new_capacity;
+}
+
+static struct RegisteredProcess *registered_processes_find_by_name(GlobalContext *glb, int atom_index)
+{
+    if (glb->registered_processes_capacity == 0) {
+        return NULL;
+    }
+    struct RegisteredProcess *registered_process = glb->registered_processes_by_name[atom_index & (glb->registered_processes_capacity - 1)];
+    while (registered_process && registered_process->atom_index != atom_index) {
+        registered_process = registered_process->next_by_name;
+    }
+    return registered_process;
+}
+
+static void registered_processes_remove(GlobalContext *glb, struct RegisteredProcess *registered_process)
+{
+    struct RegisteredProcess **by_name_link = &glb->registered_processes_by_name[registered_process->atom_index & (glb->registered_processes_capacity - 1)];
+    while (*by_name_link != registered_process) {
+        by_name_link = &(*by_name_link)->next_by_name;
+    }
+    *by_name_link = registered_process->next_by_name;
+
+    struct RegisteredProcess **by_process_id_link = &glb->registered_processes_by_process_id[registered_process->local_process_id & (glb->registered_processes_capacity - 1)];
+    while (*by_process_id_link != registered_process) {
+        by_process_id_link = &(*by_process_id_link)->next_by_process_id;
+    }
+    *by_process_id_link = registered_process->next_by_process_id;
+
+    glb->registered_processes_count--;
+    free(registered_process);
+}
+
+bool globalcontext_register_process(GlobalContext *glb, int atom_index, int local_process_id)
+{
+    SMP_RWLOCK_WRLOCK(glb->registered_processes_lock);
+    if (registered_processes_find_by_name(glb, atom_index)) {
+        SMP_RWLOCK_UNLOCK(glb->registered_processes_lock);
+        return false;
     }
 
     struct RegisteredProcess *registered_process = malloc(sizeof(struct RegisteredProcess));
@@ -336,62 +623,83 @@ bool globalcontext_register_process(GlobalContext *glb, int atom_index, int loca
     registered_process->atom_index = atom_index;
     registered_process->local_process_id = local_process_id;
 
-    list_append(registered_processes_list, &registered_process->registered_processes_list_head);
-    synclist_unlock(&glb->registered_processes);
+    if (glb->registered_processes_count >= glb->registered_processes_capacity) {
+        registered_processes_grow(glb);
+    }
+    unsigned int name_bucket = atom_index & (glb->registered_processes_capacity - 1);
+    registered_process->next_by_name = glb->registered_processes_by_name[name_bucket];
+    glb->registered_processes_by_name[name_bucket] = registered_process;
+    unsigned int process_id_bucket = local_process_id & (glb->registered_processes_capacity - 1);
+    registered_process->next_by_process_id = glb->registered_processes_by_process_id[process_id_bucket];
+    glb->registered_processes_by_process_id[process_id_bucket] = registered_process;
+    glb->registered_processes_count++;
+
+    SMP_RWLOCK_UNLOCK(glb->registered_processes_lock);
 
     return true;
 }
 
 bool globalcontext_unregister_process(GlobalContext *glb, int atom_index)
 {
-    struct ListHead *registered_processes_list = synclist_wrlock(&glb->registered_processes);
-    struct ListHead *item;
-    LIST_FOR_EACH (item, registered_processes_list) {
-        struct RegisteredProcess *registered_process = GET_LIST_ENTRY(item, struct RegisteredProcess, registered_processes_list_head);
-        if (registered_process->atom_index == atom_index) {
-            list_remove(item);
-            free(registered_process);
-            synclist_unlock(&glb->registered_processes);
-            return true;
-        }
+    SMP_RWLOCK_WRLOCK(glb->registered_processes_lock);
+    struct RegisteredProcess *registered_process = registered_processes_find_by_name(glb, atom_index);
+    if (registered_process) {
+        registered_processes_remove(glb, registered_process);
+        SMP_RWLOCK_UNLOCK(glb->registered_processes_lock);
+        return true;
     }
 
-    synclist_unlock(&glb->registered_processes);
+    SMP_RWLOCK_UNLOCK(glb->registered_processes_lock);
 
     return false;
 }
 
-void globalcontext_maybe_unregister_process_id(GlobalContext *glb, int target_process_id)
+static bool registered_processes_has_process_id(GlobalContext *glb, int target_process_id)
 {
-    struct ListHead *registered_processes_list = synclist_wrlock(&glb->registered_processes);
-    struct ListHead *item;
-    struct ListHead *tmp;
-    MUTABLE_LIST_FOR_EACH (item, tmp, registered_processes_list) {
-        struct RegisteredProcess *registered_process = GET_LIST_ENTRY(item, struct RegisteredProcess, registered_processes_list_head);
+    if (glb->registered_processes_capacity == 0) {
+        return false;
+    }
+    const struct RegisteredProcess *registered_process = glb->registered_processes_by_process_id[target_process_id & (glb->registered_processes_capacity - 1)];
+    while (registered_process) {
         if (registered_process->local_process_id == target_process_id) {
-            list_remove(item);
-            free(registered_process);
+            return true;
         }
+        registered_process = registered_process->next_by_process_id;
     }
-    synclist_unlock(&glb->registered_processes);
+    return false;
 }
 
-int globalcontext_get_registered_process(GlobalContext *glb, int atom_index)
+void globalcontext_maybe_unregister_process_id(GlobalContext *glb, int target_process_id)
 {
-    struct ListHead *registered_processes_list = synclist_rdlock(&glb->registered_processes);
-    struct ListHead *item;
-    LIST_FOR_EACH (item, registered_processes_list) {
-        const struct RegisteredProcess *registered_process = GET_LIST_ENTRY(item, struct RegisteredProcess, registered_processes_list_head);
-        if (registered_process->atom_index == atom_index) {
-            int result = registered_process->local_process_id;
-            synclist_unlock(&glb->registered_processes);
-            return result;
+    // most processes are not registered: check with a read lock first
+    SMP_RWLOCK_RDLOCK(glb->registered_processes_lock);
+    bool registered = registered_processes_has_process_id(glb, target_process_id);
+    SMP_RWLOCK_UNLOCK(glb->registered_processes_lock);
+    if (!registered) {
+        return;
+    }
+
+    SMP_RWLOCK_WRLOCK(glb->registered_processes_lock);
+    // a process may be registered with several names
+    struct RegisteredProcess *registered_process = glb->registered_processes_by_process_id[target_process_id & (glb->registered_processes_capacity - 1)];
+    while (registered_process) {
+        struct RegisteredProcess *next = registered_process->next_by_process_id;
+        if (registered_process->local_process_id == target_process_id) {
+            registered_processes_remove(glb, registered_process);
         }
+        registered_process = next;
     }
+    SMP_RWLOCK_UNLOCK(glb->registered_processes_lock);
+}
 
-    synclist_unlock(&glb->registered_processes);
+int globalcontext_get_registered_process(GlobalContext *glb, int atom_index)
+{
+    SMP_RWLOCK_RDLOCK(glb->registered_processes_lock);
+    const struct RegisteredProcess *registered_process = registered_processes_find_by_name(glb, atom_index);
+    int result = registered_process ? registered_process->local_process_id : 0;
+    SMP_RWLOCK_UNLOCK(glb->registered_processes_lock);
 
-    return 0;
+    return result;
 }
 
 int globalcontext_insert_atom(GlobalContext *glb, AtomString atom_string)
@@ -404,33 +712,59 @@ int globalcontext_insert_atom_maybe_copy(GlobalContext *glb, AtomString atom_str
     struct AtomsHashTable *htable = glb->atoms_table;
 
     unsigned long atom_index = atomshashtable_get_value(htable, atom_string, ULONG_MAX);
-    if (atom_index == ULONG_MAX) {
-        if (copy) {
-            uint8_t len = *((uint8_t *) atom_string);
-            uint8_t *buf = malloc(1 + len);
-            if (UNLIKELY(IS_NULL_PTR(buf))) {
-                fprintf(stderr, "Unable to allocate memory for atom string\n");
-                AVM_ABORT();
-            }
-            memcpy(buf, atom_string, 1 + len);
-            atom_string = buf;
+    if (atom_index != ULONG_MAX) {
+        return (int) atom_index;
+    }
+
+    SMP_MUTEX_LOCK(glb->atoms_mutex);
+    // check again, another scheduler may have inserted the atom meanwhile
+    atom_index = atomshashtable_get_value(htable, atom_string, ULONG_MAX);
+    if (atom_index != ULONG_MAX) {
+        SMP_MUTEX_UNLOCK(glb->atoms_mutex);
+        return (int) atom_index;
+    }
+    if (copy) {
+        uint8_t len = *((uint8_t *) atom_string);
+        uint8_t *buf = malloc(1 + len);
+        if (UNLIKELY(IS_NULL_PTR(buf))) {
+            fprintf(stderr, "Unable to allocate memory for atom string\n");
+            AVM_ABORT();
         }
-        atom_index = htable->count;
-        if (!atomshashtable_insert(htable, atom_string, atom_index)) {
+        memcpy(buf, atom_string, 1 + len);
+        atom_string = buf;
+    }
+    atom_index = htable->count;
+    // the string must be published before the index can be found
+    struct AtomsIdsTable *ids_table = glb->atoms_ids_table;
+    if (atom_index >= (unsigned long) ids_table->capacity) {
+        ids_table = atoms_ids_table_grow(ids_table);
+        if (IS_NULL_PTR(ids_table)) {
+            if (copy) {
+                free((void *) atom_string);
+            }
+            SMP_MUTEX_UNLOCK(glb->atoms_mutex);
             return -1;
         }
-        if (!valueshashtable_insert(glb->atoms_ids_table, atom_index, (unsigned long) atom_string)) {
-            return -1;
+        glb->atoms_ids_table = ids_table;
+    }
+    ids_table->sort_keys[atom_index] = atom_string_sort_key(atom_string);
+    ids_table->strings[atom_index] = atom_string;
+    if (!atomshashtable_insert(htable, atom_string, atom_index)) {
+        ids_table->strings[atom_index] = NULL;
+        if (copy) {
+            free((void *) atom_string);
         }
+        SMP_MUTEX_UNLOCK(glb->atoms_mutex);
+        return -1;
     }
+    SMP_MUTEX_UNLOCK(glb->atoms_mutex);
 
     return (int) atom_index;
 }
 
 bool globalcontext_is_atom_index_equal_to_atom_string(GlobalContext *glb, int atom_index_a, AtomString atom_string_b)
 {
-    AtomString atom_string_a;
-    atom_string_a = (AtomString) valueshashtable_get_value(glb->atoms_ids_table, atom_index_a, 0);
+    AtomString atom_string_a = globalcontext_atomstring_from_index(glb, atom_index_a);
     return atom_are_equals(atom_string_a, atom_string_b);
 }
 
@@ -439,13 +773,7 @@ AtomString globalcontext_atomstring_from_term(GlobalContext *glb, term t)
     if (!term_is_atom(t)) {
         AVM_ABORT();
     }
-    unsigned long atom_index = term_to_atom_index(t);
-    unsigned long ret;
-    ret = valueshashtable_get_value(glb->atoms_ids_table, atom_index, ULONG_MAX);
-    if (ret == ULONG_MAX) {
-        return NULL;
-    }
-    return (AtomString) ret;
+    return globalcontext_atomstring_from_index(glb, term_to_atom_index(t));
 }
 
 term globalcontext_existing_term_from_atom_string(GlobalContext *glb, AtomString atom_string)
@@ -488,6 +816,11 @@ int globalcontext_insert_module(GlobalContext *global, Module *module)
     global->loaded_modules_count++;
     SMP_RWLOCK_UNLOCK(global->modules_lock);
 
+#ifdef AVM_EAGER_IMPORT_RESOLUTION
+    // Module is in the table, so circular imports will find it
+    module_resolve_imports(module, global);
+#endif
+
     return module_index;
 }
 
@@ -524,26 +857,125 @@ Module *globalcontext_get_module_by_index(GlobalContext *global, int index)
     return result;
 }
 
-bool globalcontext_demonitor(GlobalContext *global, uint64_t ref_ticks)
+static unsigned int monitor_hash(uint64_t ref_ticks, int32_t owner_process_id, term monitor_obj)
 {
-    struct ListHead *pitem;
+    if (ref_ticks) {
+        return (unsigned int) ref_ticks;
+    }
+    return ((uint32_t) owner_process_id * 2654435761U) ^ (unsigned int) (monitor_obj >> 4);
+}
 
-    struct ListHead *processes_table_list = synclist_wrlock(&global->processes_table);
-    LIST_FOR_EACH (pitem, processes_table_list) {
-        Context *p = GET_LIST_ENTRY(pitem, Context, processes_table_head);
+static void monitors_index_grow(GlobalContext *global)
+{
+    unsigned int new_capacity = global->monitors_index_capacity ? global->monitors_index_capacity * 2 : DEFAULT_MONITORS_INDEX_CAPACITY;
+    struct Monitor **new_index = calloc(new_capacity, sizeof(struct Monitor *));
+    if (IS_NULL_PTR(new_index)) {
+        if (global->monitors_index_capacity == 0) {
+            fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+            AVM_ABORT();
+        }
+        // keep the current index, with longer chains
+        return;
+    }
+
+    for (unsigned int i = 0; i < global->monitors_index_capacity; i++) {
+        struct Monitor *monitor = global->monitors_index[i];
+        while (monitor) {
+            struct Monitor *next = monitor->index_next;
+            unsigned int bucket = monitor_hash(monitor->ref_ticks, monitor->owner_process_id, monitor->monitor_obj) & (new_capacity - 1);
+            monitor->index_next = new_index[bucket];
+            new_index[bucket] = monitor;
+            monitor = next;
+        }
+    }
 
-        struct ListHead *item;
-        LIST_FOR_EACH (item, &p->monitors_head) {
-            struct Monitor *monitor = GET_LIST_ENTRY(item, struct Monitor, monitor_list_head);
-            if (monitor->ref_ticks == ref_ticks) {
+    free(global->monitors_index);
+    global->monitors_index = new_index;
+    global->monitors_index_capacity = new_capacity;
+}
+
+static void monitors_index_remove(GlobalContext *global, struct Monitor *monitor)
+{
+    unsigned int bucket = monitor_hash(monitor->ref_ticks, monitor->owner_process_id, monitor->monitor_obj) & (global->monitors_index_capacity - 1);
+    struct Monitor **link = &global->monitors_index[bucket];
+    while (*link != monitor) {
+        link = &(*link)->index_next;
+    }
+    *link = monitor->index_next;
+    global->monitors_count--;
+}
+
+void globalcontext_add_monitor(GlobalContext *global, Context *ctx, struct Monitor *monitor)
+{
+    monitor->owner_process_id = ctx->process_id;
+
+    SMP_SPINLOCK_LOCK(&global->monitors_spinlock);
+    list_append(&ctx->monitors_head, &monitor->monitor_list_head);
+    if (global->monitors_count >= global->monitors_index_capacity) {
+        monitors_index_grow(global);
+    }
+    unsigned int bucket = monitor_hash(monitor->ref_ticks, monitor->owner_process_id, monitor->monitor_obj) & (global->monitors_index_capacity - 1);
+    monitor->index_next = global->monitors_index[bucket];
+    global->monitors_index[bucket] = monitor;
+    global->monitors_count++;
+    SMP_SPINLOCK_UNLOCK(&global->monitors_spinlock);
+}
+
+void globalcontext_remove_monitor(GlobalContext *global, struct Monitor *monitor)
+{
+    SMP_SPINLOCK_LOCK(&global->monitors_spinlock);
+    list_remove(&monitor->monitor_list_head);
+    monitors_index_remove(global, monitor);
+    SMP_SPINLOCK_UNLOCK(&global->monitors_spinlock);
+}
+
+bool globalcontext_unlink(GlobalContext *global, Context *ctx, term link_pid)
+{
+    SMP_SPINLOCK_LOCK(&global->monitors_spinlock);
+    if (global->monitors_index_capacity) {
+        unsigned int bucket = monitor_hash(0, ctx->process_id, link_pid) & (global->monitors_index_capacity - 1);
+        struct Monitor *monitor = global->monitors_index[bucket];
+        while (monitor) {
+            if (monitor->ref_ticks == 0 && monitor->owner_process_id == ctx->process_id && monitor->monitor_obj == link_pid) {
                 list_remove(&monitor->monitor_list_head);
+                monitors_index_remove(global, monitor);
+                SMP_SPINLOCK_UNLOCK(&global->monitors_spinlock);
                 free(monitor);
+                return true;
+            }
+            monitor = monitor->index_next;
+        }
+    }
+    SMP_SPINLOCK_UNLOCK(&global->monitors_spinlock);
+
+    return false;
+}
+
+bool globalcontext_demonitor(GlobalContext *global, uint64_t ref_ticks)
+{
+    // a read lock is enough to prevent the process holding the monitor from
+    // being destroyed, monitors lists and index are protected by the spinlock
+    struct ListHead *processes_table_list = synclist_rdlock(&global->processes_table);
+    UNUSED(processes_table_list);
+    SMP_SPINLOCK_LOCK(&global->monitors_spinlock);
+
+    if (global->monitors_index_capacity) {
+        unsigned int bucket = monitor_hash(ref_ticks, 0, 0) & (global->monitors_index_capacity - 1);
+        struct Monitor *monitor = global->monitors_index[bucket];
+        while (monitor) {
+            if (monitor->ref_ticks == ref_ticks) {
+                list_remove(&monitor->monitor_list_head);
+                monitors_index_remove(global, monitor);
+                SMP_SPINLOCK_UNLOCK(&global->monitors_spinlock);
                 synclist_unlock(&global->processes_table);
+                free(monitor);
                 return true;
             }
+            monitor = monitor->index_next;
         }
     }
 
+    SMP_SPINLOCK_UNLOCK(&global->monitors_spinlock);
     synclist_unlock(&global->processes_table);
     return false;
 }
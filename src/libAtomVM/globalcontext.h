@@ -44,6 +44,9 @@ extern "C" {
 
 #define INVALID_PROCESS_ID 0
 
+// Number of minor garbage collections between full sweeps, as in BEAM
+#define DEFAULT_FULLSWEEP_AFTER 65535
+
 struct Context;
 
 #ifndef TYPEDEF_CONTEXT
@@ -51,7 +54,21 @@ struct Context;
 typedef struct Context Context;
 #endif
 
+struct ErlangTimer;
 struct Module;
+struct Monitor;
+struct RegisteredProcess;
+
+struct AtomsIdsTable
+{
+    int capacity;
+    // tables replaced when growing are kept until the global context is
+    // destroyed, since lock-free readers may still be using them
+    struct AtomsIdsTable *previous;
+    // atom_string_sort_key of each atom, written before the string is published
+    uint64_t *sort_keys;
+    AtomString ATOMIC strings[];
+};
 
 #ifndef TYPEDEF_MODULE
 #define TYPEDEF_MODULE
@@ -63,19 +80,76 @@ typedef struct Module Module;
 typedef struct GlobalContext GlobalContext;
 #endif
 
+// Process priority levels, from the lowest to the highest. Each run queue
+// has a list of ready processes per level.
+enum ProcessPriority
+{
+    PriorityLow = 0,
+    PriorityNormal = 1,
+    PriorityHigh = 2,
+    PriorityMax = 3
+};
+
+#define PROCESS_PRIORITIES 4
+
+#ifndef AVM_NO_SMP
+// Run queue of a scheduler thread. Processes are appended to it by the
+// thread that owns it, when it runs a process that makes another one ready,
+// and are removed from it by any thread, as idle schedulers steal processes.
+struct SchedulerQueue
+{
+    SpinLock lock;
+    struct ListHead ready_processes[PROCESS_PRIORITIES]; // GUARDED_BY(lock)
+    // Number of processes picked, only accessed by the owner
+    unsigned int ready_picks;
+    // Number of processes picked from this queue since the global queue was
+    // last checked first, only accessed by the owner
+    unsigned int local_picks;
+    // Owned by a running scheduler thread, protected by processes_spinlock
+    bool active;
+};
+#endif
+
 struct GlobalContext
 {
-    struct ListHead ready_processes;
-    struct ListHead running_processes;
-    struct ListHead waiting_processes;
-    // This lock is held when manipulating the process list and also
-    // when running native handlers.
+    // Global run queue. With SMP, processes are also queued on the run queue
+    // of the scheduler that made them ready (see scheduler_queues).
+    // A process is linked to a run queue only while it is ready and not
+    // running.
+    struct ListHead ready_processes[PROCESS_PRIORITIES];
+    // Number of processes picked, used to give lower priority levels a turn.
+    // With SMP, each scheduler counts its own picks instead.
+    unsigned int ready_picks;
+    // This lock is held when manipulating the global run queue and when
+    // acquiring or releasing a scheduler run queue.
 #ifndef AVM_NO_SMP
     SpinLock processes_spinlock;
 #endif
     struct SyncList refc_binaries;
     struct SyncList processes_table;
-    struct SyncList registered_processes;
+    // processes_table indexed by process id, protected by processes_table lock.
+    // Buckets are chained through Context processes_index_next.
+    Context **processes_index;
+    unsigned int processes_index_capacity;
+    unsigned int processes_count;
+#ifndef AVM_NO_SMP
+    RWLock *registered_processes_lock;
+#endif
+    // registered names, indexed both by name atom index and by process id
+    struct RegisteredProcess **registered_processes_by_name;
+    struct RegisteredProcess **registered_processes_by_process_id;
+    unsigned int registered_processes_capacity;
+    unsigned int registered_processes_count;
+    // monitors and half links of all processes, indexed by reference for
+    // monitors and by pids for links
+    struct Monitor **monitors_index;
+    unsigned int monitors_index_capacity;
+    unsigned int monitors_count;
+#ifndef AVM_NO_SMP
+    // held when changing the index or monitors lists, together with the
+    // processes_table lock
+    SpinLock monitors_spinlock;
+#endif
     struct SyncList listeners;
     struct SyncList resource_types;
     struct SyncList select_events;
@@ -83,7 +157,12 @@ struct GlobalContext
     int32_t last_process_id;
 
     struct AtomsHashTable *atoms_table;
-    struct ValuesHashTable *atoms_ids_table;
+    // atom strings indexed by atom index
+    struct AtomsIdsTable *ATOMIC atoms_ids_table;
+#ifndef AVM_NO_SMP
+    // held while inserting a new atom, readers never take it
+    Mutex *atoms_mutex;
+#endif
     struct AtomsHashTable *modules_table;
 
 #ifndef AVM_NO_SMP
@@ -98,6 +177,13 @@ struct GlobalContext
 #ifndef AVM_NO_SMP
     SpinLock timer_spinlock;
 #endif
+    // timers of erlang:send_after/3 and erlang:start_timer/3,4 indexed by
+    // reference, and the ones that fired and are waiting to be sent, guarded
+    // by timer_spinlock
+    struct ErlangTimer **erlang_timers_index;
+    unsigned int erlang_timers_index_capacity;
+    unsigned int erlang_timers_count;
+    struct ListHead fired_erlang_timers;
 
 #if !defined(AVM_NO_SMP) && ATOMIC_LLONG_LOCK_FREE == 2
     unsigned long long ATOMIC ref_ticks;
@@ -108,10 +194,29 @@ struct GlobalContext
 #endif
 #endif
 
+    // default fullsweep_after of new processes
+    unsigned int ATOMIC fullsweep_after;
+#if !defined(AVM_NO_SMP) && ATOMIC_LLONG_LOCK_FREE == 2
+    unsigned long long ATOMIC gc_count;
+    unsigned long long ATOMIC gc_words_reclaimed;
+#else
+    unsigned long long gc_count;
+    unsigned long long gc_words_reclaimed;
+#ifndef AVM_NO_SMP
+    SpinLock gc_stats_spinlock;
+#endif
+#endif
+
+#ifdef AVM_MEMORY_POOL
+    struct MemoryPool *memory_pool;
+#endif
+
 #ifndef AVM_NO_SMP
     int ATOMIC online_schedulers;
     int running_schedulers; // GUARDED_BY(schedulers_mutex)
     bool ATOMIC waiting_scheduler;
+    struct SchedulerQueue *scheduler_queues;
+    int scheduler_queues_count;
     Mutex *schedulers_mutex;
     CondVar *schedulers_cv;
     bool ATOMIC scheduler_stop_all;
@@ -200,6 +305,19 @@ bool globalcontext_process_exists(GlobalContext *glb, int32_t process_id);
  */
 void globalcontext_send_message(GlobalContext *glb, int32_t process_id, term t);
 
+/**
+ * @brief Send a message to a process identified by its id from a scheduler.
+ *
+ * @details Same as `globalcontext_send_message` but the message is allocated
+ * from the memory pool cache of the scheduler running the sender.
+ *
+ * @param glb the global context (that owns the process table).
+ * @param scheduler_id the scheduler of the calling thread.
+ * @param process_id the local process id.
+ * @param t the message to send.
+ */
+void globalcontext_send_message_on_scheduler(GlobalContext *glb, int scheduler_id, int32_t process_id, term t);
+
 /**
  * @brief Send a message to a process from another process.
  * There should be a lock on the process table. This variant can be used by
@@ -215,6 +333,16 @@ void globalcontext_send_message(GlobalContext *glb, int32_t process_id, term t);
  */
 void globalcontext_send_message_nolock(GlobalContext *glb, int32_t process_id, term t);
 
+/**
+ * @brief Removes a process from the process table.
+ *
+ * @details This is unsafe unless a write lock on the process table has been
+ * obtained previously.
+ * @param glb the global context.
+ * @param ctx the process to remove
+ */
+void globalcontext_remove_process_nolock(GlobalContext *glb, Context *ctx);
+
 /**
  * @brief Initialize a new process, providing it with a process id.
  *
@@ -329,6 +457,42 @@ static inline term globalcontext_make_atom(GlobalContext *glb, AtomString string
     return term_from_atom_index(global_atom_index);
 }
 
+/**
+ * @brief   Returns the AtomString value of an atom index.
+ *
+ * @details This function does not take any lock.  If no such atom is
+ *          registered in the global table, this function returns NULL.
+ *          The caller should NOT free the data associated with the returned
+ *          value.
+ * @param   glb the global context
+ * @param   atom_index the atom index
+ * @returns the AtomString associated with the supplied atom index.
+ */
+static inline AtomString globalcontext_atomstring_from_index(const GlobalContext *glb, unsigned long atom_index)
+{
+    const struct AtomsIdsTable *table = glb->atoms_ids_table;
+    if (UNLIKELY(atom_index >= (unsigned long) table->capacity)) {
+        return NULL;
+    }
+    return table->strings[atom_index];
+}
+
+/**
+ * @brief   Returns the sort key of an atom index.
+ *
+ * @details This function does not take any lock.  The atom index must be a
+ *          registered atom.  Atoms with different sort keys compare like their
+ *          keys, see \c atom_string_sort_key.
+ * @param   glb the global context
+ * @param   atom_index the atom index
+ * @returns the sort key of the atom.
+ */
+static inline uint64_t globalcontext_atom_sort_key_from_index(const GlobalContext *glb, unsigned long atom_index)
+{
+    const struct AtomsIdsTable *table = glb->atoms_ids_table;
+    return table->sort_keys[atom_index];
+}
+
 /**
  * @brief   Returns the AtomString value of a term.
  *
@@ -387,11 +551,44 @@ Module *globalcontext_get_module_by_index(GlobalContext *global, int index);
  */
 Module *globalcontext_get_module(GlobalContext *global, AtomString module_name_atom);
 
+/**
+ * @brief Add a monitor or a half link to a process
+ *
+ * @details Append the monitor to the monitors list of the process and index
+ * it. A lock on the process table must be held.
+ * @param global the global context
+ * @param ctx the process holding the monitor
+ * @param monitor the monitor to add
+ */
+void globalcontext_add_monitor(GlobalContext *global, Context *ctx, struct Monitor *monitor);
+
+/**
+ * @brief Remove a monitor or a half link from a process
+ *
+ * @details Remove the monitor from the monitors list of its process and from
+ * the index, the monitor is not freed. A lock on the process table must be
+ * held.
+ * @param global the global context
+ * @param monitor the monitor to remove
+ */
+void globalcontext_remove_monitor(GlobalContext *global, struct Monitor *monitor);
+
+/**
+ * @brief Remove a half link
+ *
+ * @details Find the half link to a given pid held by a process using the
+ * index, remove it and free it. A lock on the process table must be held.
+ * @param global the global context
+ * @param ctx the process holding the link
+ * @param link_pid the linked pid
+ * @return true if the link was found
+ */
+bool globalcontext_unlink(GlobalContext *global, Context *ctx, term link_pid);
+
 /**
  * @brief remove a monitor
  *
- * @details iterate on the list of all processes and then on each monitor
- * to find a given monitor, and remove it
+ * @details find a given monitor using the index, and remove it
  * @param global the global context
  * @param ref_ticks the reference to the monitor
  * @return true if the monitor was found
@@ -410,6 +607,45 @@ static inline uint64_t globalcontext_get_ref_ticks(GlobalContext *global)
     return value;
 #endif
 }
+
+/**
+ * @brief Account for a garbage collection of a process heap.
+ *
+ * @param global the global context
+ * @param words_reclaimed number of heap words that were freed
+ */
+static inline void globalcontext_count_gc(GlobalContext *global, unsigned long long words_reclaimed)
+{
+#if defined(AVM_NO_SMP) || ATOMIC_LLONG_LOCK_FREE == 2
+    global->gc_count++;
+    global->gc_words_reclaimed += words_reclaimed;
+#else
+    smp_spinlock_lock(&global->gc_stats_spinlock);
+    global->gc_count++;
+    global->gc_words_reclaimed += words_reclaimed;
+    smp_spinlock_unlock(&global->gc_stats_spinlock);
+#endif
+}
+
+/**
+ * @brief Get the number of garbage collections and of words they reclaimed.
+ *
+ * @param global the global context
+ * @param gc_count on output, number of garbage collections since startup
+ * @param words_reclaimed on output, number of words they reclaimed
+ */
+static inline void globalcontext_get_gc_stats(GlobalContext *global, unsigned long long *gc_count, unsigned long long *words_reclaimed)
+{
+#if defined(AVM_NO_SMP) || ATOMIC_LLONG_LOCK_FREE == 2
+    *gc_count = global->gc_count;
+    *words_reclaimed = global->gc_words_reclaimed;
+#else
+    smp_spinlock_lock(&global->gc_stats_spinlock);
+    *gc_count = global->gc_count;
+    *words_reclaimed = global->gc_words_reclaimed;
+    smp_spinlock_unlock(&global->gc_stats_spinlock);
+#endif
+}
 #endif
 
 #ifdef __cplusplus
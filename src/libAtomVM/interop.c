@@ -25,7 +25,6 @@
 #include "tempstack.h"
 #include "term.h"
 #include "term_typedef.h"
-#include "valueshashtable.h"
 #include <stdint.h>
 
 char *interop_term_to_string(term t, int *ok)
@@ -140,7 +139,7 @@ char *interop_list_to_string(term list, int *ok)
 char *interop_atom_to_string(Context *ctx, term atom)
 {
     int atom_index = term_to_atom_index(atom);
-    AtomString atom_string = (AtomString) valueshashtable_get_value(ctx->global->atoms_ids_table, atom_index, (unsigned long) NULL);
+    AtomString atom_string = globalcontext_atomstring_from_index(ctx->global, atom_index);
     int len = atom_string_len(atom_string);
 
     char *str = malloc(len + 1);
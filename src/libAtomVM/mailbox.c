@@ -21,6 +21,7 @@
 #include "mailbox.h"
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include "memory.h"
 #include "scheduler.h"
@@ -29,6 +30,10 @@
 
 #define ADDITIONAL_PROCESSING_MEMORY_SIZE 4
 
+// Terms larger than this are not measured before being copied: they are copied
+// in a single pass to a storage of this size extended with fragments.
+#define MAILBOX_SINGLE_PASS_COPY_SIZE 256
+
 void mailbox_init(Mailbox *mbx)
 {
     mbx->outer_first = NULL;
@@ -49,8 +54,10 @@ _Static_assert(offsetof(struct Message, message) == offsetof(HeapFragment, stora
     "Message.message doesn't match HeapFragment.storage[0]");
 _Static_assert(offsetof(struct Message, heap_end) == offsetof(HeapFragment, storage[1]) ? 1 : 0,
     "Message.heap_end doesn't match HeapFragment.storage[1]");
-_Static_assert(sizeof(struct Message) == sizeof(HeapFragment) + 2 * sizeof(term) ? 1 : 0,
-    "sizeof(Message) doesn't match sizeof(HeapFragment) + 2 terms");
+_Static_assert(offsetof(struct Message, fragments) == offsetof(HeapFragment, storage[2]) ? 1 : 0,
+    "Message.fragments doesn't match HeapFragment.storage[2]");
+_Static_assert(sizeof(struct Message) == sizeof(HeapFragment) + 3 * sizeof(term) ? 1 : 0,
+    "sizeof(Message) doesn't match sizeof(HeapFragment) + 3 terms");
 _Static_assert(offsetof(struct TermSignal, base) + offsetof(struct MailboxMessage, next) == offsetof(HeapFragment, next) ? 1 : 0,
     "TermSignal.base.next doesn't match HeapFragment.next");
 _Static_assert(offsetof(struct TermSignal, base) + offsetof(struct MailboxMessage, type) == offsetof(HeapFragment, heap_end) ? 1 : 0,
@@ -59,21 +66,30 @@ _Static_assert(offsetof(struct TermSignal, signal_term) == offsetof(HeapFragment
     "TermSignal.signal_term doesn't match HeapFragment.storage[0]");
 _Static_assert(offsetof(struct TermSignal, heap_end) == offsetof(HeapFragment, storage[1]) ? 1 : 0,
     "TermSignal.heap_end doesn't match HeapFragment.storage[1]");
-_Static_assert(sizeof(struct TermSignal) == sizeof(HeapFragment) + 2 * sizeof(term) ? 1 : 0,
-    "sizeof(TermSignal) doesn't match sizeof(HeapFragment) + 2 terms");
+_Static_assert(offsetof(struct TermSignal, fragments) == offsetof(HeapFragment, storage[2]) ? 1 : 0,
+    "TermSignal.fragments doesn't match HeapFragment.storage[2]");
+_Static_assert(sizeof(struct TermSignal) == sizeof(HeapFragment) + 3 * sizeof(term) ? 1 : 0,
+    "sizeof(TermSignal) doesn't match sizeof(HeapFragment) + 3 terms");
 
-HeapFragment *mailbox_message_to_heap_fragment(void *m, term *heap_end)
+HeapFragment *mailbox_message_to_heap_fragment(void *m, term *heap_end, HeapFragment *fragments)
 {
     HeapFragment *fragment = (HeapFragment *) m;
-    fragment->next = NULL; // MailboxMessage.next
+    fragment->next = fragments; // MailboxMessage.next
     fragment->heap_end = heap_end; // MailboxMessage.type/heap_fragment_end
     // We don't need to erase Message.message/TermSignal.signal_term as they are valid terms
-    // Message.heap_end or TrapSignal.heap_end are not valid terms, put nil
+    // Message.heap_end/fragments or TrapSignal.heap_end/fragments are not valid terms, put nil
     fragment->storage[1] = term_nil(); // Message/TrapSignal.heap_end
+    fragment->storage[2] = term_nil(); // Message/TrapSignal.fragments
 
     return fragment;
 }
 
+HeapFragment *mailbox_message_to_fragment(Message *m, term *mso_list)
+{
+    *mso_list = m->storage[STORAGE_MSO_LIST_INDEX];
+    return mailbox_message_to_heap_fragment(m, m->heap_end, m->fragments);
+}
+
 // Dispose message. Normal / signal messages are not destroyed, instead they
 // are appended to the current heap.
 void mailbox_message_dispose(MailboxMessage *m, Heap *heap)
@@ -82,7 +98,7 @@ void mailbox_message_dispose(MailboxMessage *m, Heap *heap)
         case NormalMessage: {
             Message *normal_message = CONTAINER_OF(m, Message, base);
             term mso_list = normal_message->storage[STORAGE_MSO_LIST_INDEX];
-            HeapFragment *fragment = mailbox_message_to_heap_fragment(normal_message, normal_message->heap_end);
+            HeapFragment *fragment = mailbox_message_to_heap_fragment(normal_message, normal_message->heap_end, normal_message->fragments);
             memory_heap_append_fragment(heap, fragment, mso_list);
             break;
         }
@@ -90,29 +106,29 @@ void mailbox_message_dispose(MailboxMessage *m, Heap *heap)
         case TrapAnswerSignal: {
             struct TermSignal *term_signal = CONTAINER_OF(m, struct TermSignal, base);
             term mso_list = term_signal->storage[STORAGE_MSO_LIST_INDEX];
-            HeapFragment *fragment = mailbox_message_to_heap_fragment(term_signal, term_signal->heap_end);
+            HeapFragment *fragment = mailbox_message_to_heap_fragment(term_signal, term_signal->heap_end, term_signal->fragments);
             memory_heap_append_fragment(heap, fragment, mso_list);
             break;
         }
         case ProcessInfoRequestSignal: {
             struct BuiltInAtomRequestSignal *request_signal
                 = CONTAINER_OF(m, struct BuiltInAtomRequestSignal, base);
-            free(request_signal);
+            memory_pool_free(request_signal);
             break;
         }
         case TrapExceptionSignal: {
             struct BuiltInAtomSignal *atom_signal = CONTAINER_OF(m, struct BuiltInAtomSignal, base);
-            free(atom_signal);
+            memory_pool_free(atom_signal);
             break;
         }
         case FlushMonitorSignal:
         case FlushInfoMonitorSignal: {
             struct RefSignal *ref_signal = CONTAINER_OF(m, struct RefSignal, base);
-            free(ref_signal);
+            memory_pool_free(ref_signal);
             break;
         }
         case GCSignal:
-            free(m);
+            memory_pool_free(m);
             break;
     }
 }
@@ -149,6 +165,15 @@ size_t mailbox_len(Mailbox *mbox)
     return result;
 }
 
+static size_t mailbox_message_size(const Message *m)
+{
+    size_t result = sizeof(Message) + m->heap_end - m->storage;
+    for (const HeapFragment *fragment = m->fragments; fragment; fragment = fragment->next) {
+        result += sizeof(HeapFragment) + fragment->heap_end - fragment->storage;
+    }
+    return result;
+}
+
 size_t mailbox_size(Mailbox *mbox)
 {
     size_t result = 0;
@@ -156,21 +181,19 @@ size_t mailbox_size(Mailbox *mbox)
     while (msg) {
         // We don't count signals.
         if (msg->type == NormalMessage) {
-            Message *normal_message = CONTAINER_OF(msg, Message, base);
-            result += sizeof(Message) + normal_message->heap_end - normal_message->storage;
+            result += mailbox_message_size(CONTAINER_OF(msg, Message, base));
         }
         msg = msg->next;
     }
     msg = mbox->inner_first;
     while (msg) {
-        Message *normal_message = CONTAINER_OF(msg, Message, base);
-        result += sizeof(Message) + normal_message->heap_end - normal_message->storage;
+        result += mailbox_message_size(CONTAINER_OF(msg, Message, base));
         msg = msg->next;
     }
     return result;
 }
 
-static void mailbox_post_message(Context *c, MailboxMessage *m)
+static void mailbox_post_message_on_scheduler(Context *c, int scheduler_id, MailboxMessage *m)
 {
     m->next = NULL;
 
@@ -185,44 +208,129 @@ static void mailbox_post_message(Context *c, MailboxMessage *m)
     c->mailbox.outer_first = m;
 #endif
 
-    scheduler_signal_message(c);
+    scheduler_signal_message_on_scheduler(c, scheduler_id);
 }
 
-void mailbox_send(Context *c, term t)
+static void mailbox_post_message(Context *c, MailboxMessage *m)
+{
+    mailbox_post_message_on_scheduler(c, MEMORY_POOL_SHARED_CACHE, m);
+}
+
+// Allocate a message or a term signal, which share the same layout, and copy
+// t to its storage. Small terms are measured to be copied to a storage of the
+// exact size while large terms are copied in a single pass.
+static void *mailbox_alloc_with_term(GlobalContext *global, int scheduler_id, size_t header_size, term t, term *copy, term **heap_end, HeapFragment **fragments)
 {
-    unsigned long estimated_mem_usage = memory_estimate_usage(t) + 1; // mso_list
+#ifdef AVM_SHARING_PRESERVING_COPY
+    // Subterms referenced several times are copied once. The table is filled
+    // while copying, so sharing doesn't need a measuring pass either: the flat
+    // size of small terms is enough for their copy.
+    struct SharedTerms shared_terms;
+    memory_init_shared_terms(&shared_terms);
+    struct SharedTerms *shared = &shared_terms;
+#else
+    struct SharedTerms *shared = NULL;
+#endif
+    unsigned long estimated_mem_usage = memory_estimate_usage_up_to(t, MAILBOX_SINGLE_PASS_COPY_SIZE);
+    bool single_pass = estimated_mem_usage > MAILBOX_SINGLE_PASS_COPY_SIZE;
+    size_t storage_size = (single_pass ? MAILBOX_SINGLE_PASS_COPY_SIZE : estimated_mem_usage) + 1; // mso_list
 
-    Message *msg = malloc(sizeof(Message) + estimated_mem_usage * sizeof(term));
-    if (IS_NULL_PTR(msg)) {
+    uint8_t *block = memory_pool_alloc(global, scheduler_id, header_size + storage_size * sizeof(term));
+    if (IS_NULL_PTR(block)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
-        return;
+    } else if (!single_pass) {
+        term *storage = (term *) (block + header_size);
+        if (shared) {
+            *copy = memory_copy_shared_term_tree_to_storage(storage, heap_end, t, shared);
+        } else {
+            *copy = memory_copy_term_tree_to_storage(storage, heap_end, t);
+        }
+        *fragments = NULL;
+    } else {
+        term *storage = (term *) (block + header_size);
+        *copy = memory_copy_term_tree_to_chunked_storage(global, scheduler_id, storage, storage_size, heap_end, fragments, t, shared);
+        if (UNLIKELY(term_is_invalid_term(*copy))) {
+            fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+            memory_pool_free(block);
+            block = NULL;
+        }
+    }
+
+#ifdef AVM_SHARING_PRESERVING_COPY
+    memory_destroy_shared_terms(&shared_terms);
+#endif
+    return block;
+}
+
+Message *mailbox_message_create_from_term(GlobalContext *global, int scheduler_id, term t)
+{
+    term message;
+    term *heap_end;
+    HeapFragment *fragments;
+    Message *msg = mailbox_alloc_with_term(global, scheduler_id, sizeof(Message), t, &message, &heap_end, &fragments);
+    if (IS_NULL_PTR(msg)) {
+        return NULL;
     }
     msg->base.type = NormalMessage;
-    msg->message = memory_copy_term_tree_to_storage(msg->storage, &msg->heap_end, t);
+    msg->message = message;
+    msg->heap_end = heap_end;
+    msg->fragments = fragments;
+
+    return msg;
+}
 
+void mailbox_send_message(Context *c, Message *m)
+{
+    TRACE("Sending %p to pid %i\n", (void *) m->message, c->process_id);
+
+    mailbox_post_message(c, &m->base);
+}
+
+void mailbox_message_destroy(Message *m, GlobalContext *global)
+{
+    memory_sweep_mso_list(m->storage[STORAGE_MSO_LIST_INDEX], global);
+    if (m->fragments) {
+        memory_destroy_heap_fragment(m->fragments);
+    }
+    memory_pool_free(m);
+}
+
+void mailbox_send(Context *c, term t)
+{
+    mailbox_send_on_scheduler(c, MEMORY_POOL_SHARED_CACHE, t);
+}
+
+void mailbox_send_on_scheduler(Context *c, int scheduler_id, term t)
+{
+    Message *msg = mailbox_message_create_from_term(c->global, scheduler_id, t);
+    if (IS_NULL_PTR(msg)) {
+        return;
+    }
     TRACE("Sending %p to pid %i\n", (void *) msg->message, c->process_id);
 
-    mailbox_post_message(c, &msg->base);
+    mailbox_post_message_on_scheduler(c, scheduler_id, &msg->base);
 }
 
 void mailbox_send_term_signal(Context *c, enum MessageType type, term t)
 {
-    unsigned long estimated_mem_usage = memory_estimate_usage(t) + 1; // mso_list
-
-    struct TermSignal *ts = malloc(sizeof(struct TermSignal) + estimated_mem_usage * sizeof(term));
+    term signal_term;
+    term *heap_end;
+    HeapFragment *fragments;
+    struct TermSignal *ts = mailbox_alloc_with_term(c->global, MEMORY_POOL_SHARED_CACHE, sizeof(struct TermSignal), t, &signal_term, &heap_end, &fragments);
     if (IS_NULL_PTR(ts)) {
-        fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         return;
     }
     ts->base.type = type;
-    ts->signal_term = memory_copy_term_tree_to_storage(ts->storage, &ts->heap_end, t);
+    ts->signal_term = signal_term;
+    ts->heap_end = heap_end;
+    ts->fragments = fragments;
 
     mailbox_post_message(c, &ts->base);
 }
 
 void mailbox_send_built_in_atom_signal(Context *c, enum MessageType type, term atom)
 {
-    struct BuiltInAtomSignal *atom_signal = malloc(sizeof(struct BuiltInAtomSignal));
+    struct BuiltInAtomSignal *atom_signal = memory_pool_alloc(c->global, MEMORY_POOL_SHARED_CACHE, sizeof(struct BuiltInAtomSignal));
     if (IS_NULL_PTR(atom_signal)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         return;
@@ -236,7 +344,7 @@ void mailbox_send_built_in_atom_signal(Context *c, enum MessageType type, term a
 void mailbox_send_built_in_atom_request_signal(
     Context *c, enum MessageType type, int32_t pid, term atom)
 {
-    struct BuiltInAtomRequestSignal *atom_request = malloc(sizeof(struct BuiltInAtomRequestSignal));
+    struct BuiltInAtomRequestSignal *atom_request = memory_pool_alloc(c->global, MEMORY_POOL_SHARED_CACHE, sizeof(struct BuiltInAtomRequestSignal));
     if (IS_NULL_PTR(atom_request)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         return;
@@ -250,7 +358,7 @@ void mailbox_send_built_in_atom_request_signal(
 
 void mailbox_send_ref_signal(Context *c, enum MessageType type, uint64_t ref_ticks)
 {
-    struct RefSignal *ref_signal = malloc(sizeof(struct RefSignal));
+    struct RefSignal *ref_signal = memory_pool_alloc(c->global, MEMORY_POOL_SHARED_CACHE, sizeof(struct RefSignal));
     if (IS_NULL_PTR(ref_signal)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         return;
@@ -263,7 +371,7 @@ void mailbox_send_ref_signal(Context *c, enum MessageType type, uint64_t ref_tic
 
 void mailbox_send_empty_body_signal(Context *c, enum MessageType type)
 {
-    MailboxMessage *m = malloc(sizeof(MailboxMessage));
+    MailboxMessage *m = memory_pool_alloc(c->global, MEMORY_POOL_SHARED_CACHE, sizeof(MailboxMessage));
     if (IS_NULL_PTR(m)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         return;
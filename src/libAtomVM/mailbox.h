@@ -47,6 +47,13 @@ struct Context;
 typedef struct Context Context;
 #endif
 
+struct GlobalContext;
+
+#ifndef TYPEDEF_GLOBALCONTEXT
+#define TYPEDEF_GLOBALCONTEXT
+typedef struct GlobalContext GlobalContext;
+#endif
+
 struct Heap;
 
 #ifndef TYPEDEF_HEAP
@@ -86,6 +93,7 @@ struct Message
 
     term message;
     term *heap_end;
+    struct HeapFragment *fragments; // chain holding the end of large terms, or NULL
     term storage[];
 };
 
@@ -95,6 +103,7 @@ struct TermSignal
 
     term signal_term;
     term *heap_end;
+    struct HeapFragment *fragments; // chain holding the end of large terms, or NULL
     term storage[];
 };
 
@@ -178,6 +187,50 @@ MailboxMessage *mailbox_process_outer_list(Mailbox *mbox);
  */
 void mailbox_send(Context *c, term t);
 
+/**
+ * @brief Sends a message to a certain mailbox from a scheduler.
+ *
+ * @details Same as `mailbox_send` but the message is allocated from the
+ * memory pool cache of the scheduler running the sender, and the receiver is
+ * queued on the run queue of this scheduler if it is made ready.
+ * @param c the process context.
+ * @param scheduler_id the scheduler of the calling thread, or
+ * `MEMORY_POOL_SHARED_CACHE`.
+ * @param t the term that will be sent.
+ */
+void mailbox_send_on_scheduler(Context *c, int scheduler_id, term t);
+
+/**
+ * @brief Create a message without sending it.
+ *
+ * @details Copies a term into a new message that can later be sent with
+ * `mailbox_send_message` or destroyed with `mailbox_message_destroy`.
+ * @param global the global context owning the memory pool.
+ * @param scheduler_id the scheduler of the calling thread, or
+ * `MEMORY_POOL_SHARED_CACHE`.
+ * @param t the term that will be sent.
+ * @return the new message or NULL if allocation failed.
+ */
+Message *mailbox_message_create_from_term(GlobalContext *global, int scheduler_id, term t);
+
+/**
+ * @brief Sends a message created with `mailbox_message_create_from_term`.
+ *
+ * @details The mailbox takes ownership of the message. Can be called from
+ * another process.
+ * @param c the process context.
+ * @param m the message to send.
+ */
+void mailbox_send_message(Context *c, Message *m);
+
+/**
+ * @brief Destroy a message that was not sent.
+ *
+ * @param m the message to destroy.
+ * @param global the global context, used to release referenced binaries.
+ */
+void mailbox_message_destroy(Message *m, GlobalContext *global);
+
 /**
  * @brief Sends a term-based signal to a certain mailbox.
  *
@@ -305,6 +358,16 @@ void mailbox_destroy(Mailbox *mbox, Heap *heap);
  */
 void mailbox_message_dispose(MailboxMessage *m, Heap *heap);
 
+/**
+ * @brief Convert a (processed) normal message to a heap fragment, to be
+ * merged into a heap by garbage collection.
+ *
+ * @param m the message to convert.
+ * @param mso_list set to the mso list of the message.
+ * @returns the fragment, followed by the fragments of the message.
+ */
+struct HeapFragment *mailbox_message_to_fragment(Message *m, term *mso_list);
+
 /**
  * @brief Remove next message from mailbox.
  *
@@ -18,6 +18,7 @@
  * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
  */
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -39,13 +40,45 @@
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 #endif
 
-static void memory_scan_and_copy(HeapFragment *old_fragment, term *mem_start, const term *mem_end, term **new_heap_pos, term *mso_list, bool move);
-static term memory_shallow_copy_term(HeapFragment *old_fragment, term t, term **new_heap, bool move);
-static enum MemoryGCResult memory_gc(Context *ctx, size_t new_size, size_t num_roots, term *roots);
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+
+// Number of messages consumed off heap after which they are merged into the
+// heap at the next safe point, as messages consumed on heap are
+#define CONSUMED_MESSAGES_MAX_COUNT 64
+
+// Number of heap fragments kept at safe points before a collection is forced
+#define TOLERATED_FRAGMENTS_MAX_COUNT 16
+
+// Kinds of collection of a process heap.
+// Terms that survived a collection are mature, they sit between ctx->mature_start
+// and ctx->mature_end in the young heap. A minor collection promotes them to the
+// old heap and only scans the young heap, with registers, stack, dictionary and
+// other roots acting as the remembered set: terms are immutable, so older terms
+// cannot reference younger ones.
+enum MemoryGCKind
+{
+    MemoryGCMinor, // promote mature terms, copy other live young terms
+    MemoryGCFullsweep, // copy live terms of both generations into a new young heap
+    MemoryGCResize // copy live young terms into a heap of a different size
+};
+
+static void memory_scan_and_copy(HeapFragment *old_fragment, term *mem_start, const term *mem_end, term **new_heap_pos, term *mso_list, bool move, const term *mature_start, const term *mature_end, term **old_heap_pos);
+static term memory_shallow_copy_term(HeapFragment *old_fragment, term t, term **new_heap, bool move, const term *mature_start, const term *mature_end, term **old_heap_pos);
+static enum MemoryGCResult memory_gc(Context *ctx, size_t new_size, size_t num_roots, term *roots, enum MemoryGCKind kind);
+static unsigned long memory_estimate_usage_internal(term t, unsigned long limit, struct SharedTerms *shared);
+static term memory_shared_copy_term(struct SharedTerms *shared, term t, term **heap_ptr);
+static void memory_shared_scan_and_copy(term *scan, const term *scan_end, term **heap_ptr, term *mso_list, struct SharedTerms *shared);
 
 enum MemoryGCResult memory_init_heap(Heap *heap, size_t size)
 {
-    HeapFragment *fragment = (HeapFragment *) malloc(sizeof(HeapFragment) + size * sizeof(term));
+    return memory_init_pooled_heap(heap, size, NULL, MEMORY_POOL_SHARED_CACHE);
+}
+
+enum MemoryGCResult memory_init_pooled_heap(Heap *heap, size_t size, GlobalContext *global, int scheduler_id)
+{
+    HeapFragment *fragment = (HeapFragment *) memory_pool_alloc(global, scheduler_id, sizeof(HeapFragment) + size * sizeof(term));
     if (IS_NULL_PTR(fragment)) {
         return MEMORY_GC_ERROR_FAILED_ALLOCATION;
     }
@@ -63,12 +96,12 @@ void memory_init_heap_root_fragment(Heap *heap, HeapFragment *root, size_t size)
     heap->heap_end = heap->heap_start + size;
 }
 
-static inline enum MemoryGCResult memory_heap_alloc_new_fragment(Heap *heap, size_t size)
+static inline enum MemoryGCResult memory_heap_alloc_new_fragment(Heap *heap, size_t size, GlobalContext *global, int scheduler_id)
 {
     HeapFragment *root_fragment = heap->root;
     term *old_end = heap->heap_end;
     term mso_list = root_fragment->mso_list;
-    if (UNLIKELY(memory_init_heap(heap, size) != MEMORY_GC_OK)) {
+    if (UNLIKELY(memory_init_pooled_heap(heap, size, global, scheduler_id) != MEMORY_GC_OK)) {
         TRACE("Unable to allocate memory fragment.  size=%u\n", size);
         return MEMORY_GC_ERROR_FAILED_ALLOCATION;
     }
@@ -79,6 +112,24 @@ static inline enum MemoryGCResult memory_heap_alloc_new_fragment(Heap *heap, siz
     return MEMORY_GC_OK;
 }
 
+// Heap sizes of the Fibonacci growth strategy, as in BEAM
+static const size_t fibonacci_heap_sizes[] = {
+    12, 38, 51, 90, 142, 233, 376, 610, 987, 1598, 2586, 4185, 6772, 10958,
+    17731, 28690, 46422, 75113, 121536, 196650, 318187, 514838, 833026,
+    1347865, 2180892, 3528758, 5709651
+};
+
+static size_t next_fibonacci_heap_size(size_t size)
+{
+    for (size_t i = 0; i < sizeof(fibonacci_heap_sizes) / sizeof(fibonacci_heap_sizes[0]); i++) {
+        if (size <= fibonacci_heap_sizes[i]) {
+            return fibonacci_heap_sizes[i];
+        }
+    }
+    // Then grow by 20%
+    return size + size / 5;
+}
+
 enum MemoryGCResult memory_erl_nif_env_ensure_free(ErlNifEnv *env, size_t size)
 {
     if (erl_nif_env_is_context(env)) {
@@ -89,10 +140,10 @@ enum MemoryGCResult memory_erl_nif_env_ensure_free(ErlNifEnv *env, size_t size)
             // We have no stack pointer, free memory is the difference.
             size_t free_space = env->heap.heap_end - env->heap.heap_ptr;
             if (free_space < size) {
-                return memory_heap_alloc_new_fragment(&env->heap, size);
+                return memory_heap_alloc_new_fragment(&env->heap, size, env->global, MEMORY_POOL_SHARED_CACHE);
             }
         } else {
-            if (UNLIKELY(memory_init_heap(&env->heap, size) != MEMORY_GC_OK)) {
+            if (UNLIKELY(memory_init_pooled_heap(&env->heap, size, env->global, MEMORY_POOL_SHARED_CACHE) != MEMORY_GC_OK)) {
                 TRACE("Unable to allocate memory fragment.  size=%u\n", size);
                 return MEMORY_GC_ERROR_FAILED_ALLOCATION;
             }
@@ -106,27 +157,89 @@ enum MemoryGCResult memory_ensure_free_with_roots(Context *c, size_t size, size_
     size_t free_space = context_avail_free_memory(c);
     if (alloc_mode == MEMORY_NO_GC) {
         if (free_space < size) {
-            return memory_heap_alloc_new_fragment(&c->heap, size);
+            return memory_heap_alloc_new_fragment(&c->heap, size, c->global, context_scheduler_id(c));
         }
     } else {
         size_t maximum_free_space = 2 * (size + MIN_FREE_SPACE_SIZE);
-        if (free_space < size || (alloc_mode == MEMORY_FORCE_SHRINK) || ((alloc_mode == MEMORY_CAN_SHRINK) && free_space > maximum_free_space)) {
-            size_t memory_size = memory_heap_memory_size(&c->heap);
-            if (UNLIKELY(memory_gc(c, memory_size + size + MIN_FREE_SPACE_SIZE, num_roots, roots) != MEMORY_GC_OK)) {
+        // Consumed messages are merged into the new heap by the collection
+        size_t memory_size = memory_heap_memory_size(&c->heap) + c->consumed_messages_size;
+        bool should_gc = free_space < size || (alloc_mode == MEMORY_FORCE_SHRINK) || context_stack_in_fragment(c);
+        if (!should_gc && alloc_mode == MEMORY_CAN_SHRINK) {
+            switch (c->heap_growth_strategy) {
+                case BoundedFreeHeapGrowth:
+                    should_gc = free_space > maximum_free_space;
+                    break;
+                case MinimumHeapGrowth:
+                    // Shrink once the heap is more than twice what it needs,
+                    // so a steady allocator does not collect at each call
+                    should_gc = free_space > size + MIN_FREE_SPACE_SIZE + (memory_size - free_space);
+                    break;
+                case FibonacciHeapGrowth:
+                    should_gc = free_space - size > 3 * memory_size / 4;
+                    // bounded_free would collect here once, and then stay
+                    // below its free space limit until the next collection
+                    if (!should_gc && free_space > maximum_free_space && !c->gc_avoided) {
+                        c->avoided_gcs++;
+                        c->gc_avoided = true;
+                    }
+                    break;
+            }
+        }
+        if (should_gc) {
+            size_t used_size = memory_size - free_space;
+            size_t target_size;
+            switch (c->heap_growth_strategy) {
+                case BoundedFreeHeapGrowth:
+                    target_size = memory_size + size + MIN_FREE_SPACE_SIZE;
+                    break;
+                case MinimumHeapGrowth:
+                    target_size = used_size + size + MIN_FREE_SPACE_SIZE;
+                    break;
+                case FibonacciHeapGrowth:
+                    target_size = next_fibonacci_heap_size(used_size + size);
+                    break;
+                default:
+                    UNREACHABLE();
+            }
+            enum MemoryGCKind kind = MemoryGCMinor;
+            if (alloc_mode == MEMORY_FORCE_SHRINK || c->minor_gcs >= c->fullsweep_after) {
+                kind = MemoryGCFullsweep;
+            }
+            if (UNLIKELY(memory_gc(c, target_size, num_roots, roots, kind) != MEMORY_GC_OK)) {
                 // TODO: handle this more gracefully
                 TRACE("Unable to allocate memory for GC.  memory_size=%zu size=%u\n", memory_size, size);
                 return MEMORY_GC_ERROR_FAILED_ALLOCATION;
             }
             if (alloc_mode != MEMORY_NO_SHRINK) {
                 size_t new_free_space = context_avail_free_memory(c);
-                if (new_free_space > maximum_free_space) {
-                    size_t new_memory_size = memory_heap_memory_size(&c->heap);
-                    size_t new_requested_size = (new_memory_size - new_free_space) + maximum_free_space;
-                    if (!c->has_min_heap_size || (c->min_heap_size < new_requested_size)) {
-                        if (UNLIKELY(memory_gc(c, new_requested_size, num_roots, roots) != MEMORY_GC_OK)) {
-                            TRACE("Unable to allocate memory for GC shrink.  new_memory_size=%zu new_free_space=%zu new_minimum_free_space=%zu size=%u\n", new_memory_size, new_free_space, maximum_free_space, size);
-                            return MEMORY_GC_ERROR_FAILED_ALLOCATION;
+                size_t new_memory_size = memory_heap_memory_size(&c->heap);
+                size_t new_used_size = new_memory_size - new_free_space;
+                size_t new_requested_size = new_memory_size;
+                switch (c->heap_growth_strategy) {
+                    case BoundedFreeHeapGrowth:
+                        if (new_free_space > maximum_free_space) {
+                            new_requested_size = new_used_size + maximum_free_space;
+                        }
+                        break;
+                    case MinimumHeapGrowth:
+                        if (new_free_space > size + MIN_FREE_SPACE_SIZE + new_used_size) {
+                            new_requested_size = new_used_size + size + MIN_FREE_SPACE_SIZE;
                         }
+                        break;
+                    case FibonacciHeapGrowth:
+                        if (new_free_space - size > 3 * new_memory_size / 4) {
+                            new_requested_size = next_fibonacci_heap_size(new_used_size + size + MIN_FREE_SPACE_SIZE);
+                        } else if (new_free_space > maximum_free_space) {
+                            // bounded_free would have resized the heap
+                            c->avoided_gcs++;
+                            c->gc_avoided = true;
+                        }
+                        break;
+                }
+                if (new_requested_size != new_memory_size && (!c->has_min_heap_size || (c->min_heap_size < new_requested_size))) {
+                    if (UNLIKELY(memory_gc(c, new_requested_size, num_roots, roots, MemoryGCResize) != MEMORY_GC_OK)) {
+                        TRACE("Unable to allocate memory for GC shrink.  new_memory_size=%zu new_free_space=%zu new_minimum_free_space=%zu size=%u\n", new_memory_size, new_free_space, maximum_free_space, size);
+                        return MEMORY_GC_ERROR_FAILED_ALLOCATION;
                     }
                 }
             }
@@ -136,39 +249,164 @@ enum MemoryGCResult memory_ensure_free_with_roots(Context *c, size_t size, size_
     return MEMORY_GC_OK;
 }
 
+enum MemoryGCResult memory_collect_heap_fragments(Context *ctx)
+{
+    HeapFragment *fragments = ctx->heap.root->next;
+    if (fragments == NULL) {
+        return MEMORY_GC_OK;
+    }
+    size_t heap_size = ctx->heap.heap_end - ctx->heap.heap_start;
+    size_t fragments_size = 0;
+    unsigned int fragments_count = 0;
+    HeapFragment *fragment = fragments;
+    // Stop at the limit, so a long chain is not walked at each safe point
+    while (fragment && fragments_count < TOLERATED_FRAGMENTS_MAX_COUNT) {
+        size_t size = fragment->heap_end - fragment->storage;
+        if (ctx->e >= fragment->storage && ctx->e <= fragment->heap_end) {
+            // Heap the process ran on before a NIF allocated a new root
+            heap_size += size;
+        } else {
+            fragments_size += size;
+        }
+        fragments_count++;
+        fragment = fragment->next;
+    }
+    if (fragment || fragments_size > heap_size) {
+        return memory_ensure_free_opt(ctx, 0, MEMORY_FORCE_SHRINK);
+    }
+    // New fragments are prepended, so the chain only has the same head if
+    // none were added since the last safe point
+    if (fragments != ctx->tolerated_fragments) {
+        ctx->tolerated_fragments = fragments;
+        ctx->avoided_forced_gcs++;
+    }
+    return MEMORY_GC_OK;
+}
+
 static inline void push_to_stack(term **stack, term value)
 {
     *stack = (*stack) - 1;
     **stack = value;
 }
 
-static enum MemoryGCResult memory_gc(Context *ctx, size_t new_size, size_t num_roots, term *roots)
+static size_t memory_heap_used_size(const Heap *heap)
+{
+    size_t result = heap->heap_ptr - heap->heap_start;
+    if (heap->root->next) {
+        result += memory_heap_fragment_memory_size(heap->root->next);
+    }
+    return result;
+}
+
+static bool memory_reserve_old_heap(Context *ctx)
+{
+    size_t mature_size = ctx->mature_end - ctx->mature_start;
+    if (mature_size == 0) {
+        return true;
+    }
+    if (ctx->old_heap) {
+        // Promoted terms cannot take more than the mature area
+        return (size_t) (ctx->old_heap->heap_end - ctx->old_heap_ptr) >= mature_size;
+    }
+    // Leave room for the promotions of next minor collections
+    size_t old_heap_size = 2 * mature_size;
+    HeapFragment *old_heap = (HeapFragment *) memory_pool_alloc(ctx->global, context_scheduler_id(ctx), sizeof(HeapFragment) + old_heap_size * sizeof(term));
+    if (IS_NULL_PTR(old_heap)) {
+        return false;
+    }
+    old_heap->next = NULL;
+    old_heap->heap_end = old_heap->storage + old_heap_size;
+    ctx->old_heap = old_heap;
+    ctx->old_heap_ptr = old_heap->storage;
+    ctx->old_mso_list = term_nil();
+    return true;
+}
+
+void memory_destroy_old_heap(Context *ctx)
+{
+    if (ctx->old_heap) {
+        memory_sweep_mso_list(ctx->old_mso_list, ctx->global);
+        memory_destroy_heap_fragment(ctx->old_heap);
+        ctx->old_heap = NULL;
+        ctx->old_heap_ptr = NULL;
+        ctx->old_mso_list = term_nil();
+    }
+}
+
+static enum MemoryGCResult memory_gc(Context *ctx, size_t new_size, size_t num_roots, term *roots, enum MemoryGCKind kind)
 {
     TRACE("Going to perform gc on process %i\n", ctx->process_id);
+    ctx->gc_avoided = false;
     size_t min_heap_size = ctx->has_min_heap_size ? ctx->min_heap_size : 0;
     new_size = MAX(new_size, min_heap_size);
 
+    if (kind == MemoryGCMinor && !memory_reserve_old_heap(ctx)) {
+        kind = MemoryGCFullsweep;
+    }
+    if (kind != MemoryGCFullsweep && ctx->old_heap && ctx->has_max_heap_size
+        && new_size + (ctx->old_heap->heap_end - ctx->old_heap->storage) > ctx->max_heap_size) {
+        kind = MemoryGCFullsweep;
+    }
+    size_t old_heap_used = 0;
+    if (kind == MemoryGCFullsweep && ctx->old_heap) {
+        // Survivors of the old generation are copied to the new young heap
+        old_heap_used = ctx->old_heap_ptr - ctx->old_heap->storage;
+        new_size += old_heap_used;
+    }
+
     if (UNLIKELY(ctx->has_max_heap_size && (new_size > ctx->max_heap_size))) {
         return MEMORY_GC_DENIED_ALLOCATION;
     }
 
+    size_t used_size = memory_heap_used_size(&ctx->heap) + ctx->consumed_messages_size + old_heap_used;
     term old_mso_list = ctx->heap.root->mso_list;
     term *old_stack_ptr = context_stack_base(ctx);
     term *old_heap_end = ctx->heap.heap_end;
     HeapFragment *old_root_fragment = ctx->heap.root;
 
-    if (UNLIKELY(memory_init_heap(&ctx->heap, new_size) != MEMORY_GC_OK)) {
+    if (UNLIKELY(memory_init_pooled_heap(&ctx->heap, new_size, ctx->global, context_scheduler_id(ctx)) != MEMORY_GC_OK)) {
         return MEMORY_GC_ERROR_FAILED_ALLOCATION;
     }
     // We need old heap fragment to only copy terms that were in the heap (as opposed to in messages)
     old_root_fragment->heap_end = old_heap_end;
 
+    // Messages consumed off heap are collected with the young heap fragments
+    if (ctx->consumed_messages) {
+        HeapFragment *tail = ctx->consumed_messages;
+        while (tail->next) {
+            tail = tail->next;
+        }
+        tail->next = old_root_fragment->next;
+        old_root_fragment->next = ctx->consumed_messages;
+        ctx->consumed_messages = NULL;
+        ctx->consumed_messages_size = 0;
+        ctx->consumed_messages_count = 0;
+    }
+
+    // Mature terms are promoted by minor collections only
+    const term *mature_start = NULL;
+    const term *mature_end = NULL;
+    term **old_heap_pos = NULL;
+    term *promoted_start = NULL;
+    if (kind == MemoryGCMinor && ctx->old_heap) {
+        mature_start = ctx->mature_start;
+        mature_end = ctx->mature_end;
+        old_heap_pos = &ctx->old_heap_ptr;
+        promoted_start = ctx->old_heap_ptr;
+    } else if (kind == MemoryGCFullsweep && ctx->old_heap) {
+        // Old heap is collected with the young heap fragments. It is inserted
+        // after the root fragment as it is more likely to hold live terms
+        // than message fragments.
+        ctx->old_heap->next = old_root_fragment->next;
+        old_root_fragment->next = ctx->old_heap;
+    }
+
     term *new_heap = ctx->heap.heap_start;
     TRACE("- Allocated %i words for new heap at address 0x%p\n", (int) new_size, (void *) new_heap);
 
     TRACE("- Running copy GC on registers\n");
     for (int i = 0; i < MAX_REG; i++) {
-        term new_root = memory_shallow_copy_term(old_root_fragment, ctx->x[i], &ctx->heap.heap_ptr, true);
+        term new_root = memory_shallow_copy_term(old_root_fragment, ctx->x[i], &ctx->heap.heap_ptr, true, mature_start, mature_end, old_heap_pos);
         ctx->x[i] = new_root;
     }
     TRACE("- after registers, heap.heap_ptr now is at %p, heap.heap_start = %p\n", (void *) ctx->heap.heap_ptr, (void *) ctx->heap.heap_start);
@@ -176,44 +414,78 @@ static enum MemoryGCResult memory_gc(Context *ctx, size_t new_size, size_t num_r
     TRACE("- Running copy GC on stack (stack size: %i)\n", (int) (old_stack_ptr - ctx->e));
     term *stack_ptr = new_heap + new_size;
     while (old_stack_ptr > ctx->e) {
-        term new_root = memory_shallow_copy_term(old_root_fragment, *(--old_stack_ptr), &ctx->heap.heap_ptr, true);
+        term new_root = memory_shallow_copy_term(old_root_fragment, *(--old_stack_ptr), &ctx->heap.heap_ptr, true, mature_start, mature_end, old_heap_pos);
         push_to_stack(&stack_ptr, new_root);
     }
     ctx->e = stack_ptr;
 
-    struct ListHead *item;
     TRACE("- Running copy GC on process dictionary\n");
-    LIST_FOR_EACH (item, &ctx->dictionary) {
-        struct DictEntry *entry = GET_LIST_ENTRY(item, struct DictEntry, head);
-        entry->key = memory_shallow_copy_term(old_root_fragment, entry->key, &ctx->heap.heap_ptr, true);
-        entry->value = memory_shallow_copy_term(old_root_fragment, entry->value, &ctx->heap.heap_ptr, true);
+    for (size_t i = 0; i < ctx->dictionary.capacity; i++) {
+        struct DictEntry *entry = &ctx->dictionary.entries[i];
+        if (!dictionary_entry_is_used(entry)) {
+            continue;
+        }
+        entry->key = memory_shallow_copy_term(old_root_fragment, entry->key, &ctx->heap.heap_ptr, true, mature_start, mature_end, old_heap_pos);
+        entry->value = memory_shallow_copy_term(old_root_fragment, entry->value, &ctx->heap.heap_ptr, true, mature_start, mature_end, old_heap_pos);
     }
 
     TRACE("- Running copy GC on exit reason\n");
-    ctx->exit_reason = memory_shallow_copy_term(old_root_fragment, ctx->exit_reason, &ctx->heap.heap_ptr, true);
+    ctx->exit_reason = memory_shallow_copy_term(old_root_fragment, ctx->exit_reason, &ctx->heap.heap_ptr, true, mature_start, mature_end, old_heap_pos);
 
     TRACE("- Running copy GC on provided roots\n");
     for (size_t i = 0; i < num_roots; i++) {
-        roots[i] = memory_shallow_copy_term(old_root_fragment, roots[i], &ctx->heap.heap_ptr, 1);
+        roots[i] = memory_shallow_copy_term(old_root_fragment, roots[i], &ctx->heap.heap_ptr, 1, mature_start, mature_end, old_heap_pos);
     }
 
     term *temp_start = new_heap;
     term *temp_end = ctx->heap.heap_ptr;
+    term *old_temp_start = promoted_start;
+    term *old_temp_end = old_heap_pos ? *old_heap_pos : NULL;
     term new_mso_list = term_nil();
     do {
         term *next_end = temp_end;
         TRACE("- Running scan and copy GC from %p to %p\n", (void *) temp_start, (void *) temp_end);
-        memory_scan_and_copy(old_root_fragment, temp_start, temp_end, &next_end, &new_mso_list, true);
+        memory_scan_and_copy(old_root_fragment, temp_start, temp_end, &next_end, &new_mso_list, true, mature_start, mature_end, old_heap_pos);
         temp_start = temp_end;
         temp_end = next_end;
-    } while (temp_start != temp_end);
+        if (old_heap_pos) {
+            // Promoted terms can only reference mature terms, that are promoted as well
+            old_temp_end = *old_heap_pos;
+            TRACE("- Running scan and copy GC of promoted terms from %p to %p\n", (void *) old_temp_start, (void *) old_temp_end);
+            memory_scan_and_copy(old_root_fragment, old_temp_start, old_temp_end, &temp_end, &ctx->old_mso_list, true, mature_start, mature_end, old_heap_pos);
+            old_temp_start = old_temp_end;
+            old_temp_end = *old_heap_pos;
+        }
+    } while (temp_start != temp_end || old_temp_start != old_temp_end);
 
     ctx->heap.heap_ptr = temp_end;
 
     memory_sweep_mso_list(old_mso_list, ctx->global);
     ctx->heap.root->mso_list = new_mso_list;
 
+    size_t live_size = ctx->heap.heap_ptr - ctx->heap.heap_start;
+    if (old_heap_pos) {
+        live_size += ctx->old_heap_ptr - promoted_start;
+    }
+    if (kind == MemoryGCFullsweep && ctx->old_heap) {
+        // Old heap is freed with the young heap fragments
+        memory_sweep_mso_list(ctx->old_mso_list, ctx->global);
+        ctx->old_heap = NULL;
+        ctx->old_heap_ptr = NULL;
+        ctx->old_mso_list = term_nil();
+    }
     memory_destroy_heap_fragment(old_root_fragment);
+    ctx->tolerated_fragments = NULL;
+
+    // Every young term survived this collection
+    ctx->mature_start = ctx->heap.heap_start;
+    ctx->mature_end = ctx->heap.heap_ptr;
+    if (kind == MemoryGCMinor) {
+        ctx->minor_gcs++;
+    } else if (kind == MemoryGCFullsweep) {
+        ctx->minor_gcs = 0;
+    }
+    globalcontext_count_gc(ctx->global, used_size > live_size ? used_size - live_size : 0);
 
     return MEMORY_GC_OK;
 }
@@ -240,12 +512,12 @@ static term memory_copy_term_tree_internal(term **heap_ptr, term *mso_list, term
     TRACE("Copy term tree: %p, heap_ptr: %p\n", (void *) t, (void *) *heap_ptr);
 
     term *temp_start = *heap_ptr;
-    term copied_term = memory_shallow_copy_term(NULL, t, heap_ptr, false);
+    term copied_term = memory_shallow_copy_term(NULL, t, heap_ptr, false, NULL, NULL, NULL);
     term *temp_end = *heap_ptr;
 
     do {
         term *next_end = temp_end;
-        memory_scan_and_copy(NULL, temp_start, temp_end, &next_end, mso_list, false);
+        memory_scan_and_copy(NULL, temp_start, temp_end, &next_end, mso_list, false, NULL, NULL, NULL);
         temp_start = temp_end;
         temp_end = next_end;
     } while (temp_start != temp_end);
@@ -269,7 +541,409 @@ term memory_copy_term_tree_to_storage(term *storage, term **heap_end, term t)
     return result;
 }
 
+// Largest fragment allocated by memory_copy_term_tree_to_chunked_storage,
+// unless a single term needs a larger one.
+#define CHUNKED_STORAGE_MAX_FRAGMENT_SIZE 32768
+
+struct ChunkedStorage
+{
+    GlobalContext *global;
+    int scheduler_id;
+    term *storage_end; // end of the data in the storage once it is full
+    HeapFragment *first;
+    HeapFragment *last; // fragment being filled, NULL while filling the storage
+    term *dest;
+    term *dest_end;
+    size_t next_fragment_size;
+};
+
+// Size of the copy memory_shallow_copy_term makes of t
+static inline size_t memory_shallow_copy_size(term t)
+{
+    if (term_is_boxed(t)) {
+        size_t boxed_size = term_boxed_size(t) + 1;
+        // Empty tuples are not copied
+        return boxed_size == 1 ? 0 : boxed_size;
+    } else if (term_is_nonempty_list(t)) {
+        return 2;
+    }
+    return 0;
+}
+
+// Size of the object memory_scan_and_copy scans at ptr: a boxed term or a
+// single term, such as the head or the tail of a list cell.
+static inline size_t memory_scanned_object_size(const term *ptr)
+{
+    term t = *ptr;
+    if ((t & 0x3) == 0x0) {
+        return term_get_size_from_boxed_header(t) + 1;
+    }
+    return 1;
+}
+
+// Range [*first, *end) of the slots of the boxed term at ptr that hold terms
+// copied by memory_scan_and_copy
+static inline void memory_boxed_children(const term *ptr, size_t *first, size_t *end)
+{
+    term t = *ptr;
+    size_t boxed_size = term_get_size_from_boxed_header(t);
+    *first = 1;
+    *end = 1;
+    switch (t & TERM_BOXED_TAG_MASK) {
+        case TERM_BOXED_TUPLE:
+            *end = boxed_size + 1;
+            break;
+
+        case TERM_BOXED_BIN_MATCH_STATE:
+            *end = 2;
+            break;
+
+        case TERM_BOXED_FUN:
+            // first term is the boxed header, followed by module and fun index.
+            *first = 3;
+            *end = boxed_size + 1;
+            break;
+
+        case TERM_BOXED_SUB_BINARY:
+            *first = 3;
+            *end = 4;
+            break;
+
+        case TERM_BOXED_MAP:
+            // keys tuple followed by values
+            *first = term_get_map_keys_offset();
+            *end = term_get_map_value_offset() + boxed_size - 1;
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Size of the copies memory_scan_and_copy makes when scanning the object at ptr
+static size_t memory_scan_copy_size(const term *ptr)
+{
+    term t = *ptr;
+    if ((t & 0x3) != 0x0) {
+        return memory_shallow_copy_size(t);
+    }
+
+    size_t first;
+    size_t end;
+    memory_boxed_children(ptr, &first, &end);
+    size_t result = 0;
+    for (size_t i = first; i < end; i++) {
+        result += memory_shallow_copy_size(ptr[i]);
+    }
+    return result;
+}
+
+// Make sure size terms can be copied to dest, appending a fragment to the
+// chain if the current one is full.
+static bool memory_chunked_storage_reserve(struct ChunkedStorage *chunks, size_t size)
+{
+    if (chunks->dest + size <= chunks->dest_end) {
+        return true;
+    }
+    size_t fragment_size = MAX(size, chunks->next_fragment_size);
+    HeapFragment *fragment = memory_pool_alloc(chunks->global, chunks->scheduler_id, sizeof(HeapFragment) + fragment_size * sizeof(term));
+    if (IS_NULL_PTR(fragment)) {
+        return false;
+    }
+    fragment->next = NULL;
+    fragment->heap_end = fragment->storage + fragment_size;
+    if (chunks->last) {
+        chunks->last->heap_end = chunks->dest;
+        chunks->last->next = fragment;
+    } else {
+        chunks->storage_end = chunks->dest;
+        chunks->first = fragment;
+    }
+    chunks->last = fragment;
+    chunks->dest = fragment->storage;
+    chunks->dest_end = fragment->storage + fragment_size;
+    chunks->next_fragment_size = MIN(fragment_size * 2, CHUNKED_STORAGE_MAX_FRAGMENT_SIZE);
+    return true;
+}
+
+// End of the data to scan in fragment, NULL being the storage
+static inline term *memory_chunked_storage_end(const struct ChunkedStorage *chunks, const HeapFragment *fragment)
+{
+    if (fragment == chunks->last) {
+        return chunks->dest;
+    }
+    return fragment ? fragment->heap_end : chunks->storage_end;
+}
+
+term memory_copy_term_tree_to_chunked_storage(GlobalContext *global, int scheduler_id, term *storage, size_t storage_size, term **heap_end, HeapFragment **fragments, term t, struct SharedTerms *shared)
+{
+    struct ChunkedStorage chunks = {
+        .global = global,
+        .scheduler_id = scheduler_id,
+        .storage_end = NULL,
+        .first = NULL,
+        .last = NULL,
+        .dest = storage + STORAGE_HEAP_START_INDEX,
+        .dest_end = storage + storage_size,
+        .next_fragment_size = MIN(storage_size * 2, CHUNKED_STORAGE_MAX_FRAGMENT_SIZE)
+    };
+    storage[STORAGE_MSO_LIST_INDEX] = term_nil();
+
+    // Terms are scanned in the order they were copied, following the chain
+    HeapFragment *scan_fragment = NULL;
+    term *scan = chunks.dest;
+    term result = term_invalid_term();
+    if (memory_chunked_storage_reserve(&chunks, memory_shallow_copy_size(t))) {
+        if (shared) {
+            result = memory_shared_copy_term(shared, t, &chunks.dest);
+        } else {
+            result = memory_shallow_copy_term(NULL, t, &chunks.dest, false, NULL, NULL, NULL);
+        }
+        while (true) {
+            term *scan_end = memory_chunked_storage_end(&chunks, scan_fragment);
+            if (scan == scan_end) {
+                if (scan_fragment == chunks.last) {
+                    break;
+                }
+                scan_fragment = scan_fragment ? scan_fragment->next : chunks.first;
+                scan = scan_fragment->storage;
+                continue;
+            }
+            // Scan as many objects as their copies fit in the current fragment.
+            // With sharing, subterms already copied make this an upper bound.
+            size_t available = chunks.dest_end - chunks.dest;
+            size_t copy_size = 0;
+            term *run_end = scan;
+            while (run_end < scan_end) {
+                size_t object_copy_size = memory_scan_copy_size(run_end);
+                if (copy_size + object_copy_size > available) {
+                    break;
+                }
+                copy_size += object_copy_size;
+                run_end += memory_scanned_object_size(run_end);
+            }
+            if (run_end == scan) {
+                if (UNLIKELY(!memory_chunked_storage_reserve(&chunks, memory_scan_copy_size(scan)))) {
+                    result = term_invalid_term();
+                    break;
+                }
+                run_end = scan + memory_scanned_object_size(scan);
+            }
+            if (shared) {
+                memory_shared_scan_and_copy(scan, run_end, &chunks.dest, &storage[STORAGE_MSO_LIST_INDEX], shared);
+            } else {
+                memory_scan_and_copy(NULL, scan, run_end, &chunks.dest, &storage[STORAGE_MSO_LIST_INDEX], false, NULL, NULL, NULL);
+            }
+            scan = run_end;
+        }
+    }
+
+    if (UNLIKELY(term_is_invalid_term(result))) {
+        // Copied refc binaries that were not scanned yet are not in the mso
+        // list but their refcount was incremented
+        while (true) {
+            term *scan_end = memory_chunked_storage_end(&chunks, scan_fragment);
+            while (scan < scan_end) {
+                term header = *scan;
+                if ((header & 0x3) == 0x0 && (header & TERM_BOXED_TAG_MASK) == TERM_BOXED_REFC_BINARY) {
+                    term ref = ((term) scan) | TERM_BOXED_VALUE_TAG;
+                    if (!term_refc_binary_is_const(ref)) {
+                        refc_binary_decrement_refcount((struct RefcBinary *) term_refc_binary_ptr(ref), global);
+                    }
+                }
+                scan += memory_scanned_object_size(scan);
+            }
+            if (scan_fragment == chunks.last) {
+                break;
+            }
+            scan_fragment = scan_fragment ? scan_fragment->next : chunks.first;
+            scan = scan_fragment->storage;
+        }
+        memory_sweep_mso_list(storage[STORAGE_MSO_LIST_INDEX], global);
+        if (chunks.first) {
+            memory_destroy_heap_fragment(chunks.first);
+        }
+        return result;
+    }
+
+    if (chunks.last) {
+        chunks.last->heap_end = chunks.dest;
+        *heap_end = chunks.storage_end;
+    } else {
+        *heap_end = chunks.dest;
+    }
+    *fragments = chunks.first;
+
+    return result;
+}
+
+#define SHARED_TERMS_MIN_CAPACITY 64
+
+struct SharedTermsEntry
+{
+    const term *ptr; // NULL if the entry is free
+    term copy; // term_invalid_term() until the subterm is copied
+};
+
+static inline size_t memory_shared_terms_hash(const term *ptr)
+{
+    return (size_t) (((uintptr_t) ptr >> 2) * 2654435761U);
+}
+
+static struct SharedTermsEntry *memory_shared_terms_insert(struct SharedTerms *shared, const term *ptr)
+{
+    size_t mask = shared->capacity - 1;
+    size_t i = memory_shared_terms_hash(ptr) & mask;
+    while (shared->entries[i].ptr) {
+        i = (i + 1) & mask;
+    }
+    shared->entries[i].ptr = ptr;
+    shared->entries[i].copy = term_invalid_term();
+    shared->count++;
+    return &shared->entries[i];
+}
+
+static void memory_shared_terms_grow(struct SharedTerms *shared)
+{
+    size_t old_capacity = shared->capacity;
+    struct SharedTermsEntry *old_entries = shared->entries;
+    size_t new_capacity = old_capacity ? old_capacity * 2 : SHARED_TERMS_MIN_CAPACITY;
+    struct SharedTermsEntry *new_entries = calloc(new_capacity, sizeof(struct SharedTermsEntry));
+    if (IS_NULL_PTR(new_entries)) {
+        // TODO: handle failed malloc
+        AVM_ABORT();
+    }
+    shared->entries = new_entries;
+    shared->capacity = new_capacity;
+    shared->count = 0;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old_entries[i].ptr) {
+            struct SharedTermsEntry *entry = memory_shared_terms_insert(shared, old_entries[i].ptr);
+            entry->copy = old_entries[i].copy;
+        }
+    }
+    free(old_entries);
+}
+
+// Find the entry of the subterm at ptr, adding it if it was not visited yet
+static struct SharedTermsEntry *memory_shared_terms_get(struct SharedTerms *shared, const term *ptr, bool *visited)
+{
+    if (shared->capacity) {
+        size_t mask = shared->capacity - 1;
+        size_t i = memory_shared_terms_hash(ptr) & mask;
+        while (shared->entries[i].ptr) {
+            if (shared->entries[i].ptr == ptr) {
+                *visited = true;
+                return &shared->entries[i];
+            }
+            i = (i + 1) & mask;
+        }
+    }
+    *visited = false;
+    if ((shared->count + 1) * 2 > shared->capacity) {
+        memory_shared_terms_grow(shared);
+    }
+    return memory_shared_terms_insert(shared, ptr);
+}
+
+void memory_destroy_shared_terms(struct SharedTerms *shared)
+{
+    free(shared->entries);
+    shared->entries = NULL;
+    shared->capacity = 0;
+    shared->count = 0;
+}
+
+static term memory_shared_copy_term(struct SharedTerms *shared, term t, term **heap_ptr)
+{
+    const term *ptr;
+    if (term_is_boxed(t)) {
+        ptr = term_to_const_term_ptr(t);
+    } else if (term_is_nonempty_list(t)) {
+        ptr = term_get_list_ptr(t);
+    } else {
+        return t;
+    }
+    bool visited;
+    struct SharedTermsEntry *entry = memory_shared_terms_get(shared, ptr, &visited);
+    if (term_is_invalid_term(entry->copy)) {
+        entry->copy = memory_shallow_copy_term(NULL, t, heap_ptr, false, NULL, NULL, NULL);
+    }
+    return entry->copy;
+}
+
+// Copy the subterms of the objects in [scan, scan_end), which were copied with
+// memory_shared_copy_term
+static void memory_shared_scan_and_copy(term *scan, const term *scan_end, term **heap_ptr, term *mso_list, struct SharedTerms *shared)
+{
+    while (scan < scan_end) {
+        term header = *scan;
+        if ((header & 0x3) == 0x0) {
+            size_t first;
+            size_t end;
+            memory_boxed_children(scan, &first, &end);
+            for (size_t i = first; i < end; i++) {
+                scan[i] = memory_shared_copy_term(shared, scan[i], heap_ptr);
+            }
+            if ((header & TERM_BOXED_TAG_MASK) == TERM_BOXED_REFC_BINARY) {
+                term ref = ((term) scan) | TERM_BOXED_VALUE_TAG;
+                if (!term_refc_binary_is_const(ref)) {
+                    *mso_list = term_list_init_prepend(scan + REFC_BINARY_CONS_OFFSET, ref, *mso_list);
+                }
+            }
+            scan += term_get_size_from_boxed_header(header) + 1;
+        } else {
+            *scan = memory_shared_copy_term(shared, header, heap_ptr);
+            scan++;
+        }
+    }
+}
+
+static term memory_copy_shared_term_tree_internal(term **heap_ptr, term *mso_list, term t, struct SharedTerms *shared)
+{
+    term *scan = *heap_ptr;
+    term copied_term = memory_shared_copy_term(shared, t, heap_ptr);
+
+    while (scan < *heap_ptr) {
+        term *scan_end = *heap_ptr;
+        memory_shared_scan_and_copy(scan, scan_end, heap_ptr, mso_list, shared);
+        scan = scan_end;
+    }
+
+    return copied_term;
+}
+
+term memory_copy_shared_term_tree(Heap *new_heap, term t, struct SharedTerms *shared)
+{
+    return memory_copy_shared_term_tree_internal(&new_heap->heap_ptr, &new_heap->root->mso_list, t, shared);
+}
+
+term memory_copy_shared_term_tree_to_storage(term *storage, term **heap_end, term t, struct SharedTerms *shared)
+{
+    term *heap_ptr = storage + STORAGE_HEAP_START_INDEX;
+    storage[STORAGE_MSO_LIST_INDEX] = term_nil(); // mso_list
+    term result = memory_copy_shared_term_tree_internal(&heap_ptr, &storage[STORAGE_MSO_LIST_INDEX], t, shared);
+    *heap_end = heap_ptr;
+    return result;
+}
+
 unsigned long memory_estimate_usage(term t)
+{
+    return memory_estimate_usage_up_to(t, ULONG_MAX);
+}
+
+unsigned long memory_estimate_usage_up_to(term t, unsigned long limit)
+{
+    return memory_estimate_usage_internal(t, limit, NULL);
+}
+
+unsigned long memory_estimate_shared_usage(term t, struct SharedTerms *shared)
+{
+    return memory_estimate_usage_internal(t, ULONG_MAX, shared);
+}
+
+// When shared is not NULL, subterms are counted once and recorded in shared
+static unsigned long memory_estimate_usage_internal(term t, unsigned long limit, struct SharedTerms *shared)
 {
     unsigned long acc = 0;
 
@@ -284,7 +958,18 @@ unsigned long memory_estimate_usage(term t)
         AVM_ABORT();
     }
 
-    while (!temp_stack_is_empty(&temp_stack)) {
+    while (!temp_stack_is_empty(&temp_stack) && acc <= limit) {
+        if (shared && (term_is_boxed(t) || term_is_nonempty_list(t))) {
+            const term *ptr = term_is_boxed(t) ? term_to_const_term_ptr(t) : term_get_list_ptr(t);
+            bool visited;
+            memory_shared_terms_get(shared, ptr, &visited);
+            if (visited) {
+                shared->has_shared = true;
+                t = temp_stack_pop(&temp_stack);
+                continue;
+            }
+        }
+
         if (term_is_atom(t)) {
             t = temp_stack_pop(&temp_stack);
 
@@ -346,6 +1031,19 @@ unsigned long memory_estimate_usage(term t)
                 t = term_nil();
             }
 
+        } else if (term_is_function(t)) {
+            int fun_size = term_boxed_size(t);
+            acc += fun_size + 1;
+            // first term is the boxed header, followed by module and fun index.
+            const term *boxed_value = term_to_const_term_ptr(t);
+            for (int i = 3; i <= fun_size; i++) {
+                if (UNLIKELY(temp_stack_push(&temp_stack, boxed_value[i]) != TempStackOk)) {
+                    // TODO: handle failed malloc
+                    AVM_ABORT();
+                }
+            }
+            t = temp_stack_pop(&temp_stack);
+
         } else if (term_is_boxed(t)) {
             acc += term_boxed_size(t) + 1;
             if (term_is_sub_binary(t)) {
@@ -370,7 +1068,7 @@ unsigned long memory_estimate_usage(term t)
     return acc;
 }
 
-static void memory_scan_and_copy(HeapFragment *old_fragment, term *mem_start, const term *mem_end, term **new_heap_pos, term *mso_list, bool move)
+static void memory_scan_and_copy(HeapFragment *old_fragment, term *mem_start, const term *mem_end, term **new_heap_pos, term *mso_list, bool move, const term *mature_start, const term *mature_end, term **old_heap_pos)
 {
     term *ptr = mem_start;
     term *new_heap = *new_heap_pos;
@@ -404,14 +1102,14 @@ static void memory_scan_and_copy(HeapFragment *old_fragment, term *mem_start, co
 
                     for (int i = 1; i <= arity; i++) {
                         TRACE("-- Elem: %" TERM_X_FMT "\n", ptr[i]);
-                        ptr[i] = memory_shallow_copy_term(old_fragment, ptr[i], &new_heap, move);
+                        ptr[i] = memory_shallow_copy_term(old_fragment, ptr[i], &new_heap, move, mature_start, mature_end, old_heap_pos);
                     }
                     break;
                 }
 
                 case TERM_BOXED_BIN_MATCH_STATE: {
                     TRACE("- Found bin match state.\n");
-                    ptr[1] = memory_shallow_copy_term(old_fragment, ptr[1], &new_heap, move);
+                    ptr[1] = memory_shallow_copy_term(old_fragment, ptr[1], &new_heap, move, mature_start, mature_end, old_heap_pos);
                     break;
                 }
 
@@ -431,7 +1129,7 @@ static void memory_scan_and_copy(HeapFragment *old_fragment, term *mem_start, co
 
                     for (int i = 3; i <= fun_size; i++) {
                         TRACE("-- Frozen: %" TERM_X_FMT "\n", ptr[i]);
-                        ptr[i] = memory_shallow_copy_term(old_fragment, ptr[i], &new_heap, move);
+                        ptr[i] = memory_shallow_copy_term(old_fragment, ptr[i], &new_heap, move, mature_start, mature_end, old_heap_pos);
                     }
                     break;
                 }
@@ -451,7 +1149,7 @@ static void memory_scan_and_copy(HeapFragment *old_fragment, term *mem_start, co
 
                 case TERM_BOXED_SUB_BINARY: {
                     TRACE("- Found sub binary.\n");
-                    ptr[3] = memory_shallow_copy_term(old_fragment, ptr[3], &new_heap, move);
+                    ptr[3] = memory_shallow_copy_term(old_fragment, ptr[3], &new_heap, move, mature_start, mature_end, old_heap_pos);
                     break;
                 }
 
@@ -465,10 +1163,10 @@ static void memory_scan_and_copy(HeapFragment *old_fragment, term *mem_start, co
                     size_t keys_offset = term_get_map_keys_offset();
                     size_t value_offset = term_get_map_value_offset();
                     TRACE("-- Map keys: %" TERM_X_FMT "\n", ptr[keys_offset]);
-                    ptr[keys_offset] = memory_shallow_copy_term(old_fragment, ptr[keys_offset], &new_heap, move);
+                    ptr[keys_offset] = memory_shallow_copy_term(old_fragment, ptr[keys_offset], &new_heap, move, mature_start, mature_end, old_heap_pos);
                     for (size_t i = value_offset; i < value_offset + map_size; ++i) {
                         TRACE("-- Map Value: %" TERM_X_FMT "\n", ptr[i]);
-                        ptr[i] = memory_shallow_copy_term(old_fragment, ptr[i], &new_heap, move);
+                        ptr[i] = memory_shallow_copy_term(old_fragment, ptr[i], &new_heap, move, mature_start, mature_end, old_heap_pos);
                     }
                 } break;
 
@@ -481,12 +1179,12 @@ static void memory_scan_and_copy(HeapFragment *old_fragment, term *mem_start, co
 
         } else if (term_is_nonempty_list(t)) {
             TRACE("Found nonempty list (%p)\n", (void *) t);
-            *ptr = memory_shallow_copy_term(old_fragment, t, &new_heap, move);
+            *ptr = memory_shallow_copy_term(old_fragment, t, &new_heap, move, mature_start, mature_end, old_heap_pos);
             ptr++;
 
         } else if (term_is_boxed(t)) {
             TRACE("Found boxed (%p)\n", (void *) t);
-            *ptr = memory_shallow_copy_term(old_fragment, t, &new_heap, move);
+            *ptr = memory_shallow_copy_term(old_fragment, t, &new_heap, move, mature_start, mature_end, old_heap_pos);
             ptr++;
 
         } else {
@@ -509,7 +1207,7 @@ HOT_FUNC static inline bool memory_heap_fragment_contains_pointer(HeapFragment *
     return false;
 }
 
-HOT_FUNC static term memory_shallow_copy_term(HeapFragment *old_fragment, term t, term **new_heap, bool move)
+HOT_FUNC static term memory_shallow_copy_term(HeapFragment *old_fragment, term t, term **new_heap, bool move, const term *mature_start, const term *mature_end, term **old_heap_pos)
 {
     if (term_is_atom(t)) {
         return t;
@@ -552,6 +1250,10 @@ HOT_FUNC static term memory_shallow_copy_term(HeapFragment *old_fragment, term t
             return ((term) &empty_tuple) | TERM_BOXED_VALUE_TAG;
         }
 
+        // Mature terms are promoted to the old heap
+        if (boxed_value >= mature_start && boxed_value < mature_end) {
+            new_heap = old_heap_pos;
+        }
         term *dest = *new_heap;
         for (int i = 0; i < boxed_size; i++) {
             dest[i] = boxed_value[i];
@@ -580,6 +1282,9 @@ HOT_FUNC static term memory_shallow_copy_term(HeapFragment *old_fragment, term t
             return memory_dereference_moved_marker(list_ptr);
         }
 
+        if (list_ptr >= mature_start && list_ptr < mature_end) {
+            new_heap = old_heap_pos;
+        }
         term *dest = *new_heap;
         dest[0] = list_ptr[0];
         dest[1] = list_ptr[1];
@@ -599,20 +1304,8 @@ HOT_FUNC static term memory_shallow_copy_term(HeapFragment *old_fragment, term t
     }
 }
 
-void memory_heap_append_fragment(Heap *heap, HeapFragment *fragment, term mso_list)
+static void memory_heap_prepend_mso_list(Heap *heap, term mso_list)
 {
-    // The fragment we are appending may have next fragments
-    // So we take our current next and we add it to the tail of the passed list
-    if (heap->root->next) {
-        HeapFragment *tail = fragment;
-        while (tail->next != NULL) {
-            tail = tail->next;
-        }
-        tail->next = heap->root->next;
-    }
-    // The passed fragment is set as next, heap's root fragment is unmodified
-    // as root fragment is different, holding the mso list
-    heap->root->next = fragment;
     if (!term_is_nil(mso_list)) {
         // Suppose fragment mso_list is smaller and append heap mso at the end
         term old_mso = heap->root->mso_list;
@@ -629,6 +1322,56 @@ void memory_heap_append_fragment(Heap *heap, HeapFragment *fragment, term mso_li
     }
 }
 
+void memory_heap_append_fragment(Heap *heap, HeapFragment *fragment, term mso_list)
+{
+    // The fragment we are appending may have next fragments
+    // So we take our current next and we add it to the tail of the passed list
+    if (heap->root->next) {
+        HeapFragment *tail = fragment;
+        while (tail->next != NULL) {
+            tail = tail->next;
+        }
+        tail->next = heap->root->next;
+    }
+    // The passed fragment is set as next, heap's root fragment is unmodified
+    // as root fragment is different, holding the mso list
+    heap->root->next = fragment;
+    memory_heap_prepend_mso_list(heap, mso_list);
+}
+
+void memory_append_consumed_message(Context *ctx, HeapFragment *fragment, term mso_list)
+{
+    // Binaries of the message are swept with the heap ones by the garbage
+    // collection that merges the message
+    memory_heap_prepend_mso_list(&ctx->heap, mso_list);
+    HeapFragment *tail = fragment;
+    ctx->consumed_messages_size += tail->heap_end - tail->storage;
+    while (tail->next != NULL) {
+        tail = tail->next;
+        ctx->consumed_messages_size += tail->heap_end - tail->storage;
+    }
+    tail->next = ctx->consumed_messages;
+    ctx->consumed_messages = fragment;
+    ctx->consumed_messages_count++;
+
+    // Bound the memory held by consumed messages and the length of the chain
+    // the garbage collection looks pointers up in
+    if (ctx->consumed_messages_size > (size_t) (ctx->heap.heap_end - ctx->heap.heap_start)
+        || ctx->consumed_messages_count >= CONSUMED_MESSAGES_MAX_COUNT) {
+        memory_flush_consumed_messages(ctx);
+    }
+}
+
+void memory_flush_consumed_messages(Context *ctx)
+{
+    if (ctx->consumed_messages) {
+        memory_heap_append_fragment(&ctx->heap, ctx->consumed_messages, term_nil());
+        ctx->consumed_messages = NULL;
+        ctx->consumed_messages_size = 0;
+        ctx->consumed_messages_count = 0;
+    }
+}
+
 void memory_sweep_mso_list(term mso_list, GlobalContext *global)
 {
     term l = mso_list;
@@ -26,6 +26,7 @@ extern "C" {
 #endif
 
 #include "erl_nif.h"
+#include "memory_pool.h"
 #include "term_typedef.h"
 #include "utils.h"
 
@@ -92,6 +93,25 @@ struct Heap
 typedef struct Heap Heap;
 #endif
 
+struct SharedTermsEntry;
+
+/**
+ * @brief Table of the subterms visited while measuring or copying a term
+ * preserving its sharing
+ *
+ * @details subterms referenced several times are counted and copied once. The
+ * same table is used to measure a term with `memory_estimate_shared_usage`
+ * and then to copy it with `memory_copy_shared_term_tree`. Copy functions
+ * also accept an empty table, filled as subterms are copied.
+ */
+struct SharedTerms
+{
+    struct SharedTermsEntry *entries;
+    size_t capacity;
+    size_t count;
+    bool has_shared; // true if a subterm is referenced more than once
+};
+
 #define BEGIN_WITH_STACK_HEAP(size, name) \
     struct                                \
     {                                     \
@@ -135,6 +155,19 @@ void memory_init_heap_root_fragment(Heap *heap, HeapFragment *root, size_t size)
  */
 enum MemoryGCResult memory_init_heap(Heap *heap, size_t size) MUST_CHECK;
 
+/**
+ * @brief Initialize a root heap allocated from the memory pool of a global
+ * context.
+ *
+ * @param heap heap to initialize.
+ * @param size capacity of the heap to create, not including the mso_list.
+ * @param global the global context owning the memory pool, or NULL.
+ * @param scheduler_id the scheduler of the calling thread, or
+ * `MEMORY_POOL_SHARED_CACHE`.
+ * @returns MEMORY_GC_OK or MEMORY_GC_ERROR_FAILED_ALLOCATION depending on the outcome.
+ */
+enum MemoryGCResult memory_init_pooled_heap(Heap *heap, size_t size, GlobalContext *global, int scheduler_id) MUST_CHECK;
+
 /**
  * @brief return the total memory size of a heap fragment and its children.
  *
@@ -261,6 +294,28 @@ MUST_CHECK enum MemoryGCResult memory_erl_nif_env_ensure_free(ErlNifEnv *env, si
  */
 term memory_copy_term_tree_to_storage(term *storage, term **heap_end, term t);
 
+/**
+ * @brief copies a term to a storage in a single pass, extending it with heap
+ * fragments as needed
+ *
+ * @details unlike `memory_copy_term_tree_to_storage`, the size of the term
+ * does not need to be computed first. Once the storage is full, terms are
+ * copied to a chain of fragments allocated from the memory pool, that should
+ * be destroyed with the storage. If shared is not NULL, subterms referenced
+ * several times are copied once, still in a single pass.
+ * @param global the global context, for the memory pool
+ * @param scheduler_id scheduler of the calling thread or `MEMORY_POOL_SHARED_CACHE`
+ * @param storage storage for the copied data
+ * @param storage_size size of the storage in terms, including the mso list
+ * @param heap_end on output, pointer to the end of the copied data in the storage.
+ * @param fragments on output, chain of fragments or NULL if the term fits in the storage.
+ * @param t term to copy
+ * @param shared table of copied subterms, or NULL to copy every reference.
+ * @returns a term pointer to the new term, or `term_invalid_term()` if fragments
+ * could not be allocated.
+ */
+term memory_copy_term_tree_to_chunked_storage(GlobalContext *global, int scheduler_id, term *storage, size_t storage_size, term **heap_end, HeapFragment **fragments, term t, struct SharedTerms *shared);
+
 /**
  * @brief calculates term memory usage
  *
@@ -270,6 +325,74 @@ term memory_copy_term_tree_to_storage(term *storage, term **heap_end, term t);
  */
 unsigned long memory_estimate_usage(term t);
 
+/**
+ * @brief calculates term memory usage, stopping once it exceeds a limit
+ *
+ * @details same as `memory_estimate_usage` but the calculation stops as soon
+ * as the usage is known to be above limit.
+ * @param t root term on which used memory calculation will be performed.
+ * @param limit usage above which the calculation stops.
+ * @returns used memory terms count, or a value greater than limit.
+ */
+unsigned long memory_estimate_usage_up_to(term t, unsigned long limit);
+
+/**
+ * @brief initialize a table of shared subterms, entries are allocated lazily
+ *
+ * @param shared the table to initialize
+ */
+static inline void memory_init_shared_terms(struct SharedTerms *shared)
+{
+    shared->entries = NULL;
+    shared->capacity = 0;
+    shared->count = 0;
+    shared->has_shared = false;
+}
+
+/**
+ * @brief free the entries of a table of shared subterms
+ *
+ * @param shared the table to destroy
+ */
+void memory_destroy_shared_terms(struct SharedTerms *shared);
+
+/**
+ * @brief calculates term memory usage, counting shared subterms once
+ *
+ * @details same as `memory_estimate_usage` but subterms already visited are
+ * not counted again. Visited subterms are added to the table, that can be
+ * reused to measure other terms that will be copied along with this one.
+ * @param t root term on which used memory calculation will be performed.
+ * @param shared table of visited subterms
+ * @returns used memory terms count in term units.
+ */
+unsigned long memory_estimate_shared_usage(term t, struct SharedTerms *shared);
+
+/**
+ * @brief copies a term to a destination heap, preserving sharing of subterms
+ *
+ * @details subterms referenced several times are copied once. Terms copied
+ * with the same table share their common subterms.
+ * @param new_heap the destination heap where terms will be copied.
+ * @param t term to copy
+ * @param shared table of copied subterms, empty or filled by `memory_estimate_shared_usage`
+ * @returns a new term that is stored on the new heap.
+ */
+term memory_copy_shared_term_tree(Heap *new_heap, term t, struct SharedTerms *shared);
+
+/**
+ * @brief copies a term to a storage, preserving sharing of subterms
+ *
+ * @details same as `memory_copy_term_tree_to_storage` but subterms referenced
+ * several times are copied once.
+ * @param storage storage for the copied data, should be large enough
+ * @param heap_end on output, pointer to the end of the term.
+ * @param t term to copy
+ * @param shared table of copied subterms, empty or filled by `memory_estimate_shared_usage`
+ * @returns a boxed term pointer to the new term content that is stored in the storage.
+ */
+term memory_copy_shared_term_tree_to_storage(term *storage, term **heap_end, term t, struct SharedTerms *shared);
+
 /**
  * @brief append a fragment to a heap. The MSO list is merged. The fragment will then be owned by the heap.
  *
@@ -313,6 +436,50 @@ static inline void memory_heap_append_heap(Heap *target, Heap *source)
  */
 void memory_sweep_mso_list(term mso_list, GlobalContext *global);
 
+/**
+ * @brief Destroy the old generation of a process heap. First sweep its mso list.
+ *
+ * @details The old generation holds terms that survived two garbage collections.
+ * It is collected with the young generation by full sweeps.
+ * @param ctx the context owning the old generation.
+ */
+void memory_destroy_old_heap(Context *ctx);
+
+/**
+ * @brief Append a message removed from the mailbox to the messages consumed
+ * by a process while its `message_queue_data` flag is `off_heap`.
+ *
+ * @details Unlike fragments appended to the heap, consumed messages do not
+ * force a garbage collection at the next safe point: they are merged into the
+ * heap by the next collection. Once they take more memory than the heap or
+ * are too many, they are moved to the heap fragments.
+ * @param ctx the context that consumed the message
+ * @param fragment the message fragment, which may have next fragments
+ * @param mso_list associated mso list or nil
+ */
+void memory_append_consumed_message(Context *ctx, HeapFragment *fragment, term mso_list);
+
+/**
+ * @brief Move the messages consumed off heap by a process to its heap
+ * fragments, so they are merged at the next safe point.
+ *
+ * @param ctx the context owning the consumed messages
+ */
+void memory_flush_consumed_messages(Context *ctx);
+
+/**
+ * @brief Collect the heap fragments of a process at a safe point, if they
+ * take too much memory.
+ *
+ * @details Fragments are left by NIFs that allocated with `MEMORY_NO_GC` and
+ * by received messages. They are kept until the next garbage collection the
+ * process needs anyway, unless they hold more words than the heap or are too
+ * many, in which case a full collection is forced.
+ * @param ctx the context to collect the fragments of
+ * @returns MEMORY_GC_OK or MEMORY_GC_ERROR_FAILED_ALLOCATION depending on the outcome.
+ */
+enum MemoryGCResult memory_collect_heap_fragments(Context *ctx) MUST_CHECK;
+
 /**
  * @brief Destroy a chain of heap fragments.
  *
@@ -322,10 +489,10 @@ static inline void memory_destroy_heap_fragment(HeapFragment *fragment)
 {
     while (fragment->next) {
         HeapFragment *next = fragment->next;
-        free(fragment);
+        memory_pool_free(fragment);
         fragment = next;
     }
-    free(fragment);
+    memory_pool_free(fragment);
 }
 
 /**
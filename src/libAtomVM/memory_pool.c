@@ -0,0 +1,287 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+#include "memory_pool.h"
+
+#ifdef AVM_MEMORY_POOL
+
+#include <stdint.h>
+
+#include "globalcontext.h"
+#include "smp.h"
+#include "utils.h"
+
+#ifndef AVM_NO_SMP
+#define SMP_SPINLOCK_LOCK(spinlock) smp_spinlock_lock(spinlock)
+#define SMP_SPINLOCK_UNLOCK(spinlock) smp_spinlock_unlock(spinlock)
+#else
+#define SMP_SPINLOCK_LOCK(spinlock)
+#define SMP_SPINLOCK_UNLOCK(spinlock)
+#endif
+
+#ifndef MEMORY_POOL_CHUNK_SIZE
+#define MEMORY_POOL_CHUNK_SIZE 65536
+#endif
+
+// Blocks sizes, including their header, are powers of two starting from
+// MEMORY_POOL_MIN_BLOCK_SIZE.
+#define MEMORY_POOL_MIN_BLOCK_SIZE 64
+#define MEMORY_POOL_SIZE_CLASSES 7
+#define MEMORY_POOL_MAX_BLOCK_SIZE (MEMORY_POOL_MIN_BLOCK_SIZE << (MEMORY_POOL_SIZE_CLASSES - 1))
+
+// Header of every block, aligning the block data on two pointers.
+// Blocks larger than MEMORY_POOL_MAX_BLOCK_SIZE are allocated with malloc and
+// hold their size instead of their size class.
+struct MemoryPoolBlock
+{
+    struct MemoryPoolCache *cache; // NULL if allocated without a pool
+    uintptr_t size_class;
+};
+
+struct MemoryPoolFreeBlock
+{
+    struct MemoryPoolBlock header;
+    struct MemoryPoolFreeBlock *next;
+};
+
+struct MemoryPoolChunk
+{
+    struct MemoryPoolChunk *next;
+    uintptr_t padding;
+};
+
+struct MemoryPoolCache
+{
+    struct MemoryPool *pool;
+    struct MemoryPoolFreeBlock *free_lists[MEMORY_POOL_SIZE_CLASSES];
+    // Blocks freed by any thread, taken as free lists when they are empty
+    struct MemoryPoolFreeBlock *ATOMIC remote_free_lists[MEMORY_POOL_SIZE_CLASSES];
+    uint8_t *chunk_ptr;
+    uint8_t *chunk_end;
+    struct MemoryPoolChunk *chunks;
+};
+
+struct MemoryPool
+{
+    size_t ATOMIC reserved_size;
+    size_t ATOMIC oversized_size;
+#ifndef AVM_NO_SMP
+    SpinLock shared_spinlock;
+#endif
+    struct MemoryPoolCache shared;
+    int schedulers;
+    struct MemoryPoolCache caches[];
+};
+
+static void memory_pool_cache_init(struct MemoryPoolCache *cache, struct MemoryPool *pool)
+{
+    cache->pool = pool;
+    for (int i = 0; i < MEMORY_POOL_SIZE_CLASSES; i++) {
+        cache->free_lists[i] = NULL;
+        cache->remote_free_lists[i] = NULL;
+    }
+    cache->chunk_ptr = NULL;
+    cache->chunk_end = NULL;
+    cache->chunks = NULL;
+}
+
+static void memory_pool_cache_destroy(struct MemoryPoolCache *cache)
+{
+    struct MemoryPoolChunk *chunk = cache->chunks;
+    while (chunk) {
+        struct MemoryPoolChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+}
+
+bool memory_pool_init(GlobalContext *global, int schedulers)
+{
+    struct MemoryPool *pool = malloc(sizeof(struct MemoryPool) + schedulers * sizeof(struct MemoryPoolCache));
+    if (IS_NULL_PTR(pool)) {
+        return false;
+    }
+    pool->reserved_size = 0;
+    pool->oversized_size = 0;
+#ifndef AVM_NO_SMP
+    smp_spinlock_init(&pool->shared_spinlock);
+#endif
+    memory_pool_cache_init(&pool->shared, pool);
+    pool->schedulers = schedulers;
+    for (int i = 0; i < schedulers; i++) {
+        memory_pool_cache_init(&pool->caches[i], pool);
+    }
+    global->memory_pool = pool;
+    return true;
+}
+
+void memory_pool_destroy(GlobalContext *global)
+{
+    struct MemoryPool *pool = global->memory_pool;
+    memory_pool_cache_destroy(&pool->shared);
+    for (int i = 0; i < pool->schedulers; i++) {
+        memory_pool_cache_destroy(&pool->caches[i]);
+    }
+    free(pool);
+    global->memory_pool = NULL;
+}
+
+static inline unsigned int memory_pool_size_class(size_t block_size)
+{
+    unsigned int size_class = 0;
+    size_t class_size = MEMORY_POOL_MIN_BLOCK_SIZE;
+    while (class_size < block_size) {
+        class_size <<= 1;
+        size_class++;
+    }
+    return size_class;
+}
+
+static inline void memory_pool_push_free_block(struct MemoryPoolCache *cache, struct MemoryPoolFreeBlock *block)
+{
+    unsigned int size_class = block->header.size_class;
+    block->next = cache->free_lists[size_class];
+    cache->free_lists[size_class] = block;
+}
+
+// Take the blocks of size_class freed by any thread.
+static struct MemoryPoolFreeBlock *memory_pool_take_remote_free_list(struct MemoryPoolCache *cache, unsigned int size_class)
+{
+    struct MemoryPoolFreeBlock *block = cache->remote_free_lists[size_class];
+#ifndef AVM_NO_SMP
+    while (block && !ATOMIC_COMPARE_EXCHANGE_WEAK(&cache->remote_free_lists[size_class], &block, NULL)) {
+    }
+#else
+    cache->remote_free_lists[size_class] = NULL;
+#endif
+    return block;
+}
+
+// Carve a block of size_class out of the current chunk, allocating a new chunk
+// if it is full. The end of the previous chunk is split in smaller blocks.
+static struct MemoryPoolFreeBlock *memory_pool_carve_block(struct MemoryPoolCache *cache, unsigned int size_class)
+{
+    size_t block_size = (size_t) MEMORY_POOL_MIN_BLOCK_SIZE << size_class;
+    if ((size_t) (cache->chunk_end - cache->chunk_ptr) < block_size) {
+        for (int i = (int) size_class - 1; i >= 0; i--) {
+            size_t remaining_block_size = (size_t) MEMORY_POOL_MIN_BLOCK_SIZE << i;
+            if ((size_t) (cache->chunk_end - cache->chunk_ptr) >= remaining_block_size) {
+                struct MemoryPoolFreeBlock *remaining_block = (struct MemoryPoolFreeBlock *) cache->chunk_ptr;
+                remaining_block->header.cache = cache;
+                remaining_block->header.size_class = i;
+                memory_pool_push_free_block(cache, remaining_block);
+                cache->chunk_ptr += remaining_block_size;
+            }
+        }
+        struct MemoryPoolChunk *chunk = malloc(MEMORY_POOL_CHUNK_SIZE);
+        if (IS_NULL_PTR(chunk)) {
+            return NULL;
+        }
+        chunk->next = cache->chunks;
+        cache->chunks = chunk;
+        cache->chunk_ptr = (uint8_t *) (chunk + 1);
+        cache->chunk_end = ((uint8_t *) chunk) + MEMORY_POOL_CHUNK_SIZE;
+        cache->pool->reserved_size += MEMORY_POOL_CHUNK_SIZE;
+    }
+    struct MemoryPoolFreeBlock *block = (struct MemoryPoolFreeBlock *) cache->chunk_ptr;
+    block->header.cache = cache;
+    block->header.size_class = size_class;
+    cache->chunk_ptr += block_size;
+    return block;
+}
+
+static void *memory_pool_cache_alloc(struct MemoryPoolCache *cache, unsigned int size_class)
+{
+    struct MemoryPoolFreeBlock *block = cache->free_lists[size_class];
+    if (block == NULL) {
+        block = memory_pool_take_remote_free_list(cache, size_class);
+    }
+    if (block) {
+        cache->free_lists[size_class] = block->next;
+    } else {
+        block = memory_pool_carve_block(cache, size_class);
+        if (IS_NULL_PTR(block)) {
+            return NULL;
+        }
+    }
+    return &block->next;
+}
+
+void *memory_pool_alloc(GlobalContext *global, int scheduler_id, size_t size)
+{
+    size_t block_size = sizeof(struct MemoryPoolBlock) + size;
+    if (global == NULL || block_size > MEMORY_POOL_MAX_BLOCK_SIZE) {
+        struct MemoryPoolBlock *block = malloc(block_size);
+        if (IS_NULL_PTR(block)) {
+            return NULL;
+        }
+        block->cache = NULL;
+        block->size_class = block_size;
+        if (global) {
+            block->cache = &global->memory_pool->shared;
+            global->memory_pool->oversized_size += block_size;
+        }
+        return block + 1;
+    }
+
+    unsigned int size_class = memory_pool_size_class(block_size);
+    struct MemoryPool *pool = global->memory_pool;
+    if (scheduler_id >= 0 && scheduler_id < pool->schedulers) {
+        return memory_pool_cache_alloc(&pool->caches[scheduler_id], size_class);
+    }
+    SMP_SPINLOCK_LOCK(&pool->shared_spinlock);
+    void *result = memory_pool_cache_alloc(&pool->shared, size_class);
+    SMP_SPINLOCK_UNLOCK(&pool->shared_spinlock);
+    return result;
+}
+
+void memory_pool_free(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    struct MemoryPoolBlock *block = ((struct MemoryPoolBlock *) ptr) - 1;
+    struct MemoryPoolCache *cache = block->cache;
+    if (cache == NULL || block->size_class >= MEMORY_POOL_SIZE_CLASSES) {
+        if (cache) {
+            cache->pool->oversized_size -= block->size_class;
+        }
+        free(block);
+        return;
+    }
+    struct MemoryPoolFreeBlock *free_block = (struct MemoryPoolFreeBlock *) block;
+#ifndef AVM_NO_SMP
+    struct MemoryPoolFreeBlock *ATOMIC *remote_free_list = &cache->remote_free_lists[block->size_class];
+    struct MemoryPoolFreeBlock *current_first = *remote_free_list;
+    do {
+        free_block->next = current_first;
+    } while (!ATOMIC_COMPARE_EXCHANGE_WEAK(remote_free_list, &current_first, free_block));
+#else
+    memory_pool_push_free_block(cache, free_block);
+#endif
+}
+
+void memory_pool_get_stats(GlobalContext *global, size_t *reserved_size, size_t *oversized_size)
+{
+    *reserved_size = global->memory_pool->reserved_size;
+    *oversized_size = global->memory_pool->oversized_size;
+}
+
+#endif
@@ -0,0 +1,147 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+/**
+ * @file memory_pool.h
+ * @brief Size-class pooled allocator for heap fragments, messages and contexts.
+ *
+ * @details When AtomVM is built with `AVM_MEMORY_POOL`, blocks are carved out
+ * of large chunks and recycled through per size class free lists instead of
+ * being returned to libc. Each scheduler has its own cache that it uses
+ * without locking, and a shared cache protected by a spinlock serves other
+ * threads. Blocks can be freed from any thread: they are pushed to a lock-free
+ * list of the cache that allocated them, which this cache drains when it runs
+ * out of blocks. Without `AVM_MEMORY_POOL`, these functions are wrappers around
+ * `malloc` and `free`.
+ */
+
+#ifndef _MEMORY_POOL_H_
+#define _MEMORY_POOL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "utils.h"
+
+#ifndef TYPEDEF_GLOBALCONTEXT
+#define TYPEDEF_GLOBALCONTEXT
+typedef struct GlobalContext GlobalContext;
+#endif
+
+// Cache used by threads that do not run a scheduler or when the scheduler is
+// not known, such as when a process is created.
+#define MEMORY_POOL_SHARED_CACHE -1
+
+#ifdef AVM_MEMORY_POOL
+
+struct MemoryPool;
+
+/**
+ * @brief Create the memory pool of a global context, with one cache per
+ * scheduler.
+ *
+ * @param global the global context
+ * @param schedulers number of schedulers, 0 if only the shared cache is used
+ * @returns true on success, false if allocation failed.
+ */
+bool memory_pool_init(GlobalContext *global, int schedulers);
+
+/**
+ * @brief Destroy the memory pool of a global context and release its chunks.
+ *
+ * @details All blocks allocated from the pool should have been freed.
+ * @param global the global context
+ */
+void memory_pool_destroy(GlobalContext *global);
+
+/**
+ * @brief Allocate a block.
+ *
+ * @param global the global context owning the pool or NULL to allocate the
+ * block with `malloc`
+ * @param scheduler_id the scheduler of the calling thread, or
+ * `MEMORY_POOL_SHARED_CACHE`
+ * @param size the size of the block
+ * @returns the block or NULL if allocation failed.
+ */
+void *memory_pool_alloc(GlobalContext *global, int scheduler_id, size_t size);
+
+/**
+ * @brief Free a block allocated with `memory_pool_alloc`. Can be called from
+ * any thread.
+ *
+ * @param ptr the block to free, or NULL.
+ */
+void memory_pool_free(void *ptr);
+
+/**
+ * @brief Get statistics of the pool.
+ *
+ * @param global the global context
+ * @param reserved_size set to the size of the chunks blocks are carved from
+ * @param oversized_size set to the size of allocated blocks too large for
+ * size classes
+ */
+void memory_pool_get_stats(GlobalContext *global, size_t *reserved_size, size_t *oversized_size);
+
+#else
+
+static inline bool memory_pool_init(GlobalContext *global, int schedulers)
+{
+    UNUSED(global);
+    UNUSED(schedulers);
+    return true;
+}
+
+static inline void memory_pool_destroy(GlobalContext *global)
+{
+    UNUSED(global);
+}
+
+static inline void *memory_pool_alloc(GlobalContext *global, int scheduler_id, size_t size)
+{
+    UNUSED(global);
+    UNUSED(scheduler_id);
+    return malloc(size);
+}
+
+static inline void memory_pool_free(void *ptr)
+{
+    free(ptr);
+}
+
+static inline void memory_pool_get_stats(GlobalContext *global, size_t *reserved_size, size_t *oversized_size)
+{
+    UNUSED(global);
+    *reserved_size = 0;
+    *oversized_size = 0;
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -109,7 +109,9 @@ static enum ModuleLoadResult module_build_imported_functions_table(Module *this_
         fprintf(stderr, "Cannot allocate memory while loading module (line: %i).\n", __LINE__);
         return MODULE_ERROR_FAILED_ALLOCATION;
     }
+    this_module->imported_funcs_count = functions_count;
 
+    int unresolved_count = 0;
     for (int i = 0; i < functions_count; i++) {
         int local_module_atom_index = READ_32_ALIGNED(table_data + i * 12 + 12);
         int local_function_atom_index = READ_32_ALIGNED(table_data + i * 12 + 4 + 12);
@@ -126,18 +128,37 @@ static enum ModuleLoadResult module_build_imported_functions_table(Module *this_
         }
 
         if (!this_module->imported_funcs[i]) {
-            struct UnresolvedFunctionCall *unresolved = malloc(sizeof(struct UnresolvedFunctionCall));
-            if (IS_NULL_PTR(unresolved)) {
-                fprintf(stderr, "Cannot allocate memory while loading module (line: %i).\n", __LINE__);
-                return MODULE_ERROR_FAILED_ALLOCATION;
-            }
-            unresolved->base.type = UnresolvedFunctionCall;
-            unresolved->module_atom_index = this_module->local_atoms_to_global_table[local_module_atom_index];
-            unresolved->function_atom_index = this_module->local_atoms_to_global_table[local_function_atom_index];
-            unresolved->arity = arity;
+            unresolved_count++;
+        }
+    }
 
-            this_module->imported_funcs[i] = &unresolved->base;
+    if (unresolved_count == 0) {
+        return MODULE_LOAD_OK;
+    }
+
+    // Unresolved calls are allocated at once and are only freed with the module
+    this_module->unresolved_funcs = calloc(unresolved_count, sizeof(struct UnresolvedFunctionCall));
+    if (IS_NULL_PTR(this_module->unresolved_funcs)) {
+        fprintf(stderr, "Cannot allocate memory while loading module (line: %i).\n", __LINE__);
+        return MODULE_ERROR_FAILED_ALLOCATION;
+    }
+
+    struct UnresolvedFunctionCall *unresolved = this_module->unresolved_funcs;
+    for (int i = 0; i < functions_count; i++) {
+        if (this_module->imported_funcs[i]) {
+            continue;
         }
+        int local_module_atom_index = READ_32_ALIGNED(table_data + i * 12 + 12);
+        int local_function_atom_index = READ_32_ALIGNED(table_data + i * 12 + 4 + 12);
+        uint32_t arity = READ_32_ALIGNED(table_data + i * 12 + 8 + 12);
+
+        unresolved->base.type = UnresolvedFunctionCall;
+        unresolved->module_atom_index = this_module->local_atoms_to_global_table[local_module_atom_index];
+        unresolved->function_atom_index = this_module->local_atoms_to_global_table[local_function_atom_index];
+        unresolved->arity = arity;
+
+        this_module->imported_funcs[i] = &unresolved->base;
+        unresolved++;
     }
 
     return MODULE_LOAD_OK;
@@ -329,8 +350,16 @@ Module *module_new_from_iff_binary(GlobalContext *global, const void *iff_binary
 COLD_FUNC void module_destroy(Module *module)
 {
     free(module->labels);
+    for (int i = 0; i < module->select_tables_count; i++) {
+        free(module->select_tables[i]);
+    }
+    free(module->select_tables);
     free(module->imported_funcs);
+    free(module->unresolved_funcs);
     free(module->literals_table);
+    if (module->literals_fragments) {
+        memory_destroy_heap_fragment(module->literals_fragments);
+    }
     if (module->free_literals_data) {
         free(module->literals_data);
     }
@@ -400,20 +429,40 @@ static struct LiteralEntry *module_build_literals_table(const void *literalsBuf)
 
 term module_load_literal(Module *mod, int index, Context *ctx)
 {
-    term t = externalterm_to_term(mod->literals_table[index].data, mod->literals_table[index].size,
-        ctx, ExternalTermToHeapFragment);
+    struct LiteralEntry *literal = &mod->literals_table[index];
+    term t = literal->decoded;
+    if (LIKELY(!term_is_invalid_term(t))) {
+        return t;
+    }
+
+    SMP_MODULE_LOCK(mod);
+    // Another scheduler may have decoded the literal in the meantime
+    t = literal->decoded;
     if (term_is_invalid_term(t)) {
-        fprintf(stderr, "Invalid term reading literals_table[%i] from module\n", index);
-        AVM_ABORT();
+        Heap heap;
+        t = externalterm_to_term_with_heap(literal->data, literal->size, &heap, ctx->global);
+        if (term_is_invalid_term(t)) {
+            SMP_MODULE_UNLOCK(mod);
+            fprintf(stderr, "Invalid term reading literals_table[%i] from module\n", index);
+            AVM_ABORT();
+        }
+        // Convert the root fragment to a regular fragment and keep it
+        HeapFragment *fragment = heap.root;
+        fragment->heap_end = heap.heap_end;
+        fragment->next = mod->literals_fragments;
+        mod->literals_fragments = fragment;
+        literal->decoded = t;
     }
+    SMP_MODULE_UNLOCK(mod);
+
     return t;
 }
 
 const struct ExportedFunction *module_resolve_function0(Module *mod, int import_table_index, struct UnresolvedFunctionCall *unresolved, GlobalContext *glb)
 {
 
-    AtomString module_name_atom = (AtomString) valueshashtable_get_value(glb->atoms_ids_table, unresolved->module_atom_index, (unsigned long) NULL);
-    AtomString function_name_atom = (AtomString) valueshashtable_get_value(glb->atoms_ids_table, unresolved->function_atom_index, (unsigned long) NULL);
+    AtomString module_name_atom = globalcontext_atomstring_from_index(glb, unresolved->module_atom_index);
+    AtomString function_name_atom = globalcontext_atomstring_from_index(glb, unresolved->function_atom_index);
     int arity = unresolved->arity;
 
     Module *found_module = globalcontext_get_module(glb, module_name_atom);
@@ -435,7 +484,7 @@ const struct ExportedFunction *module_resolve_function0(Module *mod, int import_
         mfunc->target = found_module;
         mfunc->label = exported_label;
 
-        free(unresolved);
+        // unresolved is not freed as other schedulers may still be reading it
         mod->imported_funcs[import_table_index] = &mfunc->base;
         return &mfunc->base;
     } else {
@@ -446,6 +495,27 @@ const struct ExportedFunction *module_resolve_function0(Module *mod, int import_
     }
 }
 
+void module_resolve_imports(Module *mod, GlobalContext *glb)
+{
+    for (int i = 0; i < mod->imported_funcs_count; i++) {
+        const struct ExportedFunction *func = mod->imported_funcs[i];
+        if (func->type != UnresolvedFunctionCall) {
+            continue;
+        }
+        const struct UnresolvedFunctionCall *unresolved = EXPORTED_FUNCTION_TO_UNRESOLVED_FUNCTION_CALL(func);
+        AtomString module_name_atom = globalcontext_atomstring_from_index(glb, unresolved->module_atom_index);
+        AtomString function_name_atom = globalcontext_atomstring_from_index(glb, unresolved->function_atom_index);
+
+        // Silently skip functions that cannot be resolved yet, so a warning
+        // is only printed if they are actually called.
+        Module *found_module = globalcontext_get_module(glb, module_name_atom);
+        if (found_module == NULL || module_search_exported_function(found_module, function_name_atom, unresolved->arity, glb) == 0) {
+            continue;
+        }
+        module_resolve_function(mod, i, glb);
+    }
+}
+
 static uint16_t *parse_line_refs(uint8_t **data, size_t num_refs, size_t len)
 {
     uint16_t *ref_table = malloc((num_refs + 1) * sizeof(uint16_t));
@@ -642,3 +712,69 @@ int module_find_line(Module *mod, unsigned int offset)
     AVM_ABORT();
     return -1;
 }
+
+static int select_entry_compare(const void *a, const void *b)
+{
+    term value_a = ((const struct SelectEntry *) a)->value;
+    term value_b = ((const struct SelectEntry *) b)->value;
+    return (value_a > value_b) - (value_a < value_b);
+}
+
+void module_add_select_table(Module *mod, unsigned int offset, struct SelectEntry *entries, unsigned int count)
+{
+    bool all_integers = true;
+    avm_int_t min = 0;
+    avm_int_t max = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        if (!term_is_integer(entries[i].value)) {
+            all_integers = false;
+            break;
+        }
+        avm_int_t value = term_to_int(entries[i].value);
+        if (i == 0 || value < min) {
+            min = value;
+        }
+        if (i == 0 || value > max) {
+            max = value;
+        }
+    }
+
+    // a dense table is used when at least half of its slots are in use
+    bool dense = all_integers && (avm_uint_t) (max - min) < 2 * (avm_uint_t) count;
+    unsigned int size = dense ? (unsigned int) (max - min) + 1 : count;
+    size_t items_size = dense ? size * sizeof(uint32_t) : size * sizeof(struct SelectEntry);
+
+    struct SelectTable **new_tables = realloc(mod->select_tables, (mod->select_tables_count + 1) * sizeof(struct SelectTable *));
+    if (IS_NULL_PTR(new_tables)) {
+        free(entries);
+        return;
+    }
+    mod->select_tables = new_tables;
+
+    struct SelectTable *table = malloc(sizeof(struct SelectTable) + items_size);
+    if (IS_NULL_PTR(table)) {
+        free(entries);
+        return;
+    }
+    table->offset = offset;
+    table->size = size;
+    table->first = min;
+    if (dense) {
+        table->dense_labels = (uint32_t *) (table + 1);
+        table->entries = NULL;
+        memset(table->dense_labels, 0, items_size);
+        // fill backwards so the first choice wins, as with a linear scan
+        for (unsigned int i = count; i > 0; i--) {
+            table->dense_labels[term_to_int(entries[i - 1].value) - min] = entries[i - 1].label;
+        }
+    } else {
+        table->dense_labels = NULL;
+        table->entries = (struct SelectEntry *) (table + 1);
+        memcpy(table->entries, entries, items_size);
+        qsort(table->entries, count, sizeof(struct SelectEntry), select_entry_compare);
+    }
+    free(entries);
+
+    mod->select_tables[mod->select_tables_count] = table;
+    mod->select_tables_count++;
+}
@@ -41,7 +41,6 @@ extern "C" {
 #include "exportedfunction.h"
 #include "globalcontext.h"
 #include "term.h"
-#include "valueshashtable.h"
 
 #ifndef AVM_NO_SMP
 
@@ -79,6 +78,34 @@ struct LiteralEntry
 {
     uint32_t size;
     void const *data;
+    // decoded term, shared by all processes, or invalid term if not decoded yet
+    term ATOMIC decoded;
+};
+
+/**
+ * @brief Minimum number of choices of a select_val or select_tuple_arity
+ * instruction for which a lookup table is built at load time.
+ */
+#define SELECT_TABLE_MIN_ENTRIES 8
+
+struct SelectEntry
+{
+    term value;
+    uint32_t label;
+};
+
+struct SelectTable
+{
+    // offset of the select instruction in the code chunk
+    unsigned int offset;
+    // number of entries, or number of slots when the table is dense
+    unsigned int size;
+    // integer value of the first slot of a dense table
+    avm_int_t first;
+    // dense tables map small integers to labels, 0 is used for missing values
+    uint32_t *dense_labels;
+    // otherwise entries are sorted by value
+    struct SelectEntry *entries;
 };
 
 struct ModuleFilename
@@ -112,13 +139,25 @@ struct Module
     struct ModuleFilename *filenames;
     struct ListHead line_ref_offsets;
 
-    const struct ExportedFunction **imported_funcs;
+    // Resolved functions are published atomically, so they can be read
+    // without holding the module lock.
+    const struct ExportedFunction *ATOMIC *imported_funcs;
+    int imported_funcs_count;
+    // Unresolved function calls, freed with the module so a stale pointer
+    // read from imported_funcs stays valid.
+    struct UnresolvedFunctionCall *unresolved_funcs;
 
     void **labels;
 
+    // lookup tables of large select instructions, sorted by offset
+    struct SelectTable **select_tables;
+    int select_tables_count;
+
     void *literals_data;
 
     struct LiteralEntry *literals_table;
+    // heap fragments holding decoded literals, they are never garbage collected
+    HeapFragment *literals_fragments;
 
     int *local_atoms_to_global_table;
 
@@ -226,7 +265,10 @@ Module *module_new_from_iff_binary(GlobalContext *global, const void *iff_binary
 /**
  * @brief Gets a literal stored on the literal table of the specified module
  *
- * @details Loads and deserialize a term stored in the literal table and returns a term.
+ * @details Returns the term stored in the literal table. The literal is
+ * deserialized on first use into a module-owned heap fragment that is shared by
+ * all processes and never garbage collected nor modified, as GC skips terms
+ * that are not in the process heap.
  * @param mod The module that owns that is going to be loaded.
  * @param index a valid literal index.
  * @param ctx the target context.
@@ -244,7 +286,7 @@ term module_load_literal(Module *mod, int index, Context *ctx);
 static inline AtomString module_get_atom_string_by_id(const Module *mod, int local_atom_id, GlobalContext *glb)
 {
     int global_id = mod->local_atoms_to_global_table[local_atom_id];
-    return (AtomString) valueshashtable_get_value(glb->atoms_ids_table, global_id, (unsigned long) NULL);
+    return globalcontext_atomstring_from_index(glb, global_id);
 }
 
 /**
@@ -263,6 +305,19 @@ static inline term module_get_atom_term_by_id(const Module *mod, int local_atom_
 
 const struct ExportedFunction *module_resolve_function0(Module *mod, int import_table_index, struct UnresolvedFunctionCall *unresolved, GlobalContext *glb);
 
+/**
+ * @brief Resolves all unresolved function references of a module
+ *
+ * @details Resolves every imported function that belongs to a module that can
+ * be loaded and that exports it, loading modules as required. Other imports
+ * are left unresolved and will be resolved (or reported) when called.
+ * The module must already be in the modules table so circular dependencies
+ * don't load it again.
+ * @param mod the module to resolve imports of.
+ * @param glb the global context
+ */
+void module_resolve_imports(Module *mod, GlobalContext *glb);
+
 /**
  * @brief Get the module name, as an atom term.
  *
@@ -287,11 +342,14 @@ static inline term module_get_name(const Module *mod)
  */
 static inline const struct ExportedFunction *module_resolve_function(Module *mod, int import_table_index, GlobalContext *glb)
 {
-    SMP_MODULE_LOCK(mod);
-    // We cannot optimistically read the unresolved function call.
-    // While reads of imported_funcs can happen outside the lock, read of the func
-    // pointer itself cannot, as UnresolvedFunctionCall pointers are freed.
+    // Once resolved, the function is read with a single atomic load.
     const struct ExportedFunction *func = mod->imported_funcs[import_table_index];
+    if (LIKELY(func->type != UnresolvedFunctionCall)) {
+        return func;
+    }
+    SMP_MODULE_LOCK(mod);
+    // Another scheduler may have resolved the function in the meantime
+    func = mod->imported_funcs[import_table_index];
     if (func->type != UnresolvedFunctionCall) {
         SMP_MODULE_UNLOCK(mod);
         return func;
@@ -360,6 +418,81 @@ static inline const uint8_t *module_get_str(Module *mod, size_t offset, size_t *
     return ((const uint8_t *) mod->str_table) + 8 + offset;
 }
 
+/**
+ * @brief Adds a lookup table for a select instruction
+ *
+ * @details This function is used when loading a module, for select_val and
+ * select_tuple_arity instructions with at least SELECT_TABLE_MIN_ENTRIES
+ * choices. Tables must be added in increasing offset order. The table is
+ * dense when the values are small integers close enough to each other,
+ * otherwise entries are sorted so they can be binary searched.
+ * If memory cannot be allocated the table is not added and the instruction
+ * keeps using a linear scan.
+ * @param mod the module
+ * @param offset the offset of the select instruction in the code chunk
+ * @param entries the choices of the instruction, the array is owned by this function
+ * @param count the number of choices
+ */
+void module_add_select_table(Module *mod, unsigned int offset, struct SelectEntry *entries, unsigned int count);
+
+/**
+ * @brief Gets the lookup table of a select instruction
+ *
+ * @param mod the module
+ * @param offset the offset of the select instruction in the code chunk
+ * @return the lookup table or NULL if no table was built for the instruction.
+ */
+static inline const struct SelectTable *module_get_select_table(const Module *mod, unsigned int offset)
+{
+    int low = 0;
+    int high = mod->select_tables_count - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        const struct SelectTable *table = mod->select_tables[mid];
+        if (table->offset == offset) {
+            return table;
+        } else if (table->offset < offset) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Looks up a value in the lookup table of a select instruction
+ *
+ * @param table the lookup table
+ * @param value the value to look for, an atom or an integer
+ * @return the label to jump to, or 0 when the value is not in the table.
+ */
+static inline uint32_t module_select_table_lookup(const struct SelectTable *table, term value)
+{
+    if (table->dense_labels) {
+        if (!term_is_integer(value)) {
+            return 0;
+        }
+        avm_uint_t index = (avm_uint_t) (term_to_int(value) - table->first);
+        return index < table->size ? table->dense_labels[index] : 0;
+    }
+
+    int low = 0;
+    int high = (int) table->size - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        term mid_value = table->entries[mid].value;
+        if (mid_value == value) {
+            return table->entries[mid].label;
+        } else if (mid_value < value) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return 0;
+}
+
 /*
  * @brief Get the function name and arity of a function from a label.
  *
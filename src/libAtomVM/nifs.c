@@ -63,8 +63,20 @@
 #define MAX(x, y) (((x) > (y)) ? (x) : (y))
 #endif
 
+#ifndef MIN
+#define MIN(x, y) (((x) < (y)) ? (x) : (y))
+#endif
+
 #define NOT_FOUND (0xFF)
 
+// Longest list built by lists NIFs, so heap needs can't overflow
+#define LISTS_MAX_LENGTH (AVM_INT_MAX / 8)
+// Most elements processed by a call to a lists chunk NIF. The functions of
+// lists.erl call them in a loop, so the process can be preempted in between.
+#define LISTS_CHUNK_LENGTH 1024
+// Least elements a flatten chunk processes, it then uses the free heap
+#define LISTS_MIN_CHUNK_LENGTH 32
+
 #ifdef ENABLE_ADVANCED_TRACE
 static const char *const trace_calls_atom = "\xB" "trace_calls";
 static const char *const trace_call_args_atom = "\xF" "trace_call_args";
@@ -131,10 +143,22 @@ static term nif_erlang_universaltime_0(Context *ctx, int argc, term argv[]);
 static term nif_erlang_localtime(Context *ctx, int argc, term argv[]);
 static term nif_erlang_timestamp_0(Context *ctx, int argc, term argv[]);
 static term nif_erts_debug_flat_size(Context *ctx, int argc, term argv[]);
+static term nif_erts_debug_size(Context *ctx, int argc, term argv[]);
 static term nif_erlang_process_flag(Context *ctx, int argc, term argv[]);
+
+// Heap needs of NIFs, reserved by nifs_call before they are called
+static size_t atom_to_binary_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t atom_to_list_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t binary_to_list_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t integer_to_binary_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t integer_to_list_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t tuple_to_list_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t list_to_tuple_heap_need(Context *ctx, int argc, const term argv[]);
 static term nif_erlang_processes(Context *ctx, int argc, term argv[]);
 static term nif_erlang_process_info(Context *ctx, int argc, term argv[]);
 static term nif_erlang_put_2(Context *ctx, int argc, term argv[]);
+static term nif_erlang_get_keys(Context *ctx, int argc, term argv[]);
+static size_t get_keys_heap_need(Context *ctx, int argc, const term argv[]);
 static term nif_erlang_system_info(Context *ctx, int argc, term argv[]);
 static term nif_erlang_system_flag(Context *ctx, int argc, term argv[]);
 static term nif_erlang_binary_to_term(Context *ctx, int argc, term argv[]);
@@ -146,11 +170,16 @@ static term nif_erlang_ref_to_list(Context *ctx, int argc, term argv[]);
 static term nif_erlang_fun_to_list(Context *ctx, int argc, term argv[]);
 static term nif_erlang_function_exported(Context *ctx, int argc, term argv[]);
 static term nif_erlang_garbage_collect(Context *ctx, int argc, term argv[]);
+static term nif_erlang_statistics(Context *ctx, int argc, term argv[]);
 static term nif_erlang_group_leader(Context *ctx, int argc, term argv[]);
 static term nif_erlang_get_module_info(Context *ctx, int argc, term argv[]);
 static term nif_erlang_memory(Context *ctx, int argc, term argv[]);
 static term nif_erlang_monitor(Context *ctx, int argc, term argv[]);
 static term nif_erlang_demonitor(Context *ctx, int argc, term argv[]);
+static term nif_erlang_send_after_3(Context *ctx, int argc, term argv[]);
+static term nif_erlang_start_timer(Context *ctx, int argc, term argv[]);
+static term nif_erlang_cancel_timer_1(Context *ctx, int argc, term argv[]);
+static term nif_erlang_read_timer_1(Context *ctx, int argc, term argv[]);
 static term nif_erlang_unlink(Context *ctx, int argc, term argv[]);
 static term nif_atomvm_add_avm_pack_binary(Context *ctx, int argc, term argv[]);
 static term nif_atomvm_add_avm_pack_file(Context *ctx, int argc, term argv[]);
@@ -165,6 +194,38 @@ static term nif_base64_decode_to_string(Context *ctx, int argc, term argv[]);
 static term nif_code_load_abs(Context *ctx, int argc, term argv[]);
 static term nif_code_load_binary(Context *ctx, int argc, term argv[]);
 static term nif_maps_next(Context *ctx, int argc, term argv[]);
+static term nif_maps_get_3(Context *ctx, int argc, term argv[]);
+static term nif_maps_find_2(Context *ctx, int argc, term argv[]);
+static term nif_maps_put_3(Context *ctx, int argc, term argv[]);
+static term nif_maps_update_3(Context *ctx, int argc, term argv[]);
+static term nif_maps_remove_2(Context *ctx, int argc, term argv[]);
+static term nif_maps_merge_2(Context *ctx, int argc, term argv[]);
+static term nif_maps_keys_1(Context *ctx, int argc, term argv[]);
+static term nif_maps_values_1(Context *ctx, int argc, term argv[]);
+static term nif_maps_to_list_1(Context *ctx, int argc, term argv[]);
+static term nif_maps_from_list_1(Context *ctx, int argc, term argv[]);
+static size_t maps_find_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t maps_put_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t maps_update_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t maps_remove_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t maps_merge_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t maps_keys_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t maps_to_list_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t maps_from_list_heap_need(Context *ctx, int argc, const term argv[]);
+static term nif_lists_reverse_chunk(Context *ctx, int argc, term argv[]);
+static term nif_lists_member_2(Context *ctx, int argc, term argv[]);
+static term nif_lists_keyfind(Context *ctx, int argc, term argv[]);
+static term nif_lists_keymember(Context *ctx, int argc, term argv[]);
+static term nif_lists_keydelete(Context *ctx, int argc, term argv[]);
+static term nif_lists_flatten_chunk(Context *ctx, int argc, term argv[]);
+static term nif_lists_seq_chunk(Context *ctx, int argc, term argv[]);
+static term nif_lists_duplicate(Context *ctx, int argc, term argv[]);
+static term nif_lists_sort_chunk(Context *ctx, int argc, term argv[]);
+static size_t lists_chunk_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t lists_keydelete_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t lists_flatten_chunk_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t lists_seq_chunk_heap_need(Context *ctx, int argc, const term argv[]);
+static size_t lists_duplicate_heap_need(Context *ctx, int argc, const term argv[]);
 static term nif_unicode_characters_to_list(Context *ctx, int argc, term argv[]);
 static term nif_unicode_characters_to_binary(Context *ctx, int argc, term argv[]);
 
@@ -233,13 +294,15 @@ static const struct Nif make_ref_nif =
 static const struct Nif atom_to_binary_nif =
 {
     .base.type = NIFFunctionType,
-    .nif_ptr = nif_erlang_atom_to_binary_2
+    .nif_ptr = nif_erlang_atom_to_binary_2,
+    .heap_need_ptr = atom_to_binary_heap_need
 };
 
 static const struct Nif atom_to_list_nif =
 {
     .base.type = NIFFunctionType,
-    .nif_ptr = nif_erlang_atom_to_list_1
+    .nif_ptr = nif_erlang_atom_to_list_1,
+    .heap_need_ptr = atom_to_list_heap_need
 };
 
 static const struct Nif binary_to_atom_nif =
@@ -263,7 +326,8 @@ static const struct Nif binary_to_integer_nif =
 static const struct Nif binary_to_list_nif =
 {
     .base.type = NIFFunctionType,
-    .nif_ptr = nif_erlang_binary_to_list_1
+    .nif_ptr = nif_erlang_binary_to_list_1,
+    .heap_need_ptr = binary_to_list_heap_need
 };
 
 static const struct Nif binary_to_existing_atom_nif =
@@ -311,13 +375,15 @@ static const struct Nif insert_element_nif =
 static const struct Nif integer_to_binary_nif =
 {
     .base.type = NIFFunctionType,
-    .nif_ptr = nif_erlang_integer_to_binary_2
+    .nif_ptr = nif_erlang_integer_to_binary_2,
+    .heap_need_ptr = integer_to_binary_heap_need
 };
 
 static const struct Nif integer_to_list_nif =
 {
     .base.type = NIFFunctionType,
-    .nif_ptr = nif_erlang_integer_to_list_2
+    .nif_ptr = nif_erlang_integer_to_list_2,
+    .heap_need_ptr = integer_to_list_heap_need
 };
 
 static const struct Nif float_to_binary_nif =
@@ -371,7 +437,8 @@ static const struct Nif list_to_float_nif =
 static const struct Nif list_to_tuple_nif =
 {
     .base.type = NIFFunctionType,
-    .nif_ptr = nif_erlang_list_to_tuple_1
+    .nif_ptr = nif_erlang_list_to_tuple_1,
+    .heap_need_ptr = list_to_tuple_heap_need
 };
 
 static const struct Nif iolist_size_nif =
@@ -497,7 +564,8 @@ static const struct Nif system_time_to_universal_time_nif =
 static const struct Nif tuple_to_list_nif =
 {
     .base.type = NIFFunctionType,
-    .nif_ptr = nif_erlang_tuple_to_list_1
+    .nif_ptr = nif_erlang_tuple_to_list_1,
+    .heap_need_ptr = tuple_to_list_heap_need
 };
 
 static const struct Nif flat_size_nif =
@@ -506,6 +574,12 @@ static const struct Nif flat_size_nif =
     .nif_ptr = nif_erts_debug_flat_size
 };
 
+static const struct Nif size_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_erts_debug_size
+};
+
 static const struct Nif process_flag_nif =
 {
     .base.type = NIFFunctionType,
@@ -530,6 +604,13 @@ static const struct Nif put_nif =
     .nif_ptr = nif_erlang_put_2
 };
 
+static const struct Nif get_keys_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_erlang_get_keys,
+    .heap_need_ptr = get_keys_heap_need
+};
+
 static const struct Nif system_info_nif =
 {
     .base.type = NIFFunctionType,
@@ -590,6 +671,12 @@ static const struct Nif garbage_collect_nif =
     .nif_ptr = nif_erlang_garbage_collect
 };
 
+static const struct Nif statistics_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_erlang_statistics
+};
+
 static const struct Nif make_fun_nif =
 {
     .base.type = NIFFunctionType,
@@ -614,6 +701,30 @@ static const struct Nif demonitor_nif =
     .nif_ptr = nif_erlang_demonitor
 };
 
+static const struct Nif send_after_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_erlang_send_after_3
+};
+
+static const struct Nif start_timer_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_erlang_start_timer
+};
+
+static const struct Nif cancel_timer_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_erlang_cancel_timer_1
+};
+
+static const struct Nif read_timer_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_erlang_read_timer_1
+};
+
 static const struct Nif link_nif =
 {
     .base.type = NIFFunctionType,
@@ -709,6 +820,116 @@ static const struct Nif maps_next_nif =
     .base.type = NIFFunctionType,
     .nif_ptr = nif_maps_next
 };
+static const struct Nif maps_get_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_maps_get_3
+};
+static const struct Nif maps_find_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_maps_find_2,
+    .heap_need_ptr = maps_find_heap_need
+};
+static const struct Nif maps_put_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_maps_put_3,
+    .heap_need_ptr = maps_put_heap_need
+};
+static const struct Nif maps_update_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_maps_update_3,
+    .heap_need_ptr = maps_update_heap_need
+};
+static const struct Nif maps_remove_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_maps_remove_2,
+    .heap_need_ptr = maps_remove_heap_need
+};
+static const struct Nif maps_merge_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_maps_merge_2,
+    .heap_need_ptr = maps_merge_heap_need
+};
+static const struct Nif maps_keys_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_maps_keys_1,
+    .heap_need_ptr = maps_keys_heap_need
+};
+static const struct Nif maps_values_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_maps_values_1,
+    .heap_need_ptr = maps_keys_heap_need
+};
+static const struct Nif maps_to_list_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_maps_to_list_1,
+    .heap_need_ptr = maps_to_list_heap_need
+};
+static const struct Nif maps_from_list_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_maps_from_list_1,
+    .heap_need_ptr = maps_from_list_heap_need
+};
+static const struct Nif lists_reverse_chunk_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_lists_reverse_chunk,
+    .heap_need_ptr = lists_chunk_heap_need
+};
+static const struct Nif lists_member_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_lists_member_2
+};
+static const struct Nif lists_keyfind_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_lists_keyfind
+};
+static const struct Nif lists_keymember_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_lists_keymember
+};
+static const struct Nif lists_keydelete_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_lists_keydelete,
+    .heap_need_ptr = lists_keydelete_heap_need
+};
+static const struct Nif lists_flatten_chunk_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_lists_flatten_chunk,
+    .heap_need_ptr = lists_flatten_chunk_heap_need
+};
+static const struct Nif lists_seq_chunk_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_lists_seq_chunk,
+    .heap_need_ptr = lists_seq_chunk_heap_need
+};
+static const struct Nif lists_duplicate_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_lists_duplicate,
+    .heap_need_ptr = lists_duplicate_heap_need
+};
+static const struct Nif lists_sort_chunk_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_lists_sort_chunk,
+    .heap_need_ptr = lists_chunk_heap_need
+};
 static const struct Nif unicode_characters_to_list_nif =
 {
     .base.type = NIFFunctionType,
@@ -1081,6 +1302,41 @@ static NativeHandlerResult process_console_mailbox(Context *ctx)
     return result;
 }
 
+// Copy the spawn arguments or the frozen values of a fun to the registers of
+// the new process, starting at register first_reg. With
+// AVM_SHARING_PRESERVING_COPY, they are measured and copied with the same
+// table so they keep sharing their common subterms.
+static void spawn_copy_args(Context *new_ctx, const term args[], int count, int first_reg, size_t min_heap_size)
+{
+    size_t size = 0;
+#ifdef AVM_SHARING_PRESERVING_COPY
+    struct SharedTerms shared;
+    memory_init_shared_terms(&shared);
+    for (int i = 0; i < count; i++) {
+        size += memory_estimate_shared_usage(args[i], &shared);
+    }
+#else
+    for (int i = 0; i < count; i++) {
+        size += memory_estimate_usage(args[i]);
+    }
+#endif
+    if (UNLIKELY(memory_ensure_free_opt(new_ctx, MAX(size, min_heap_size), MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
+        //TODO: new process should be terminated, however a new pid is returned anyway
+        fprintf(stderr, "Unable to allocate sufficient memory to spawn process.\n");
+        AVM_ABORT();
+    }
+    for (int i = 0; i < count; i++) {
+#ifdef AVM_SHARING_PRESERVING_COPY
+        new_ctx->x[first_reg + i] = memory_copy_shared_term_tree(&new_ctx->heap, args[i], &shared);
+#else
+        new_ctx->x[first_reg + i] = memory_copy_term_tree(&new_ctx->heap, args[i]);
+#endif
+    }
+#ifdef AVM_SHARING_PRESERVING_COPY
+    memory_destroy_shared_terms(&shared);
+#endif
+}
+
 static term nif_erlang_spawn_fun(Context *ctx, int argc, term argv[])
 {
     term fun_term = argv[0];
@@ -1095,8 +1351,34 @@ static term nif_erlang_spawn_fun(Context *ctx, int argc, term argv[])
         opts_term = term_nil();
     }
 
+    enum ProcessPriority priority = PriorityNormal;
+    term priority_term = interop_proplist_get_value(opts_term, PRIORITY_ATOM);
+    if (priority_term != term_nil() && UNLIKELY(!context_priority_from_atom(priority_term, &priority))) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+    term fullsweep_after_term = interop_proplist_get_value(opts_term, FULLSWEEP_AFTER_ATOM);
+    if (fullsweep_after_term != term_nil() && UNLIKELY(!term_is_integer(fullsweep_after_term) || term_to_int(fullsweep_after_term) < 0)) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+    enum HeapGrowthStrategy heap_growth_strategy = BoundedFreeHeapGrowth;
+    term heap_growth_term = interop_proplist_get_value(opts_term, ATOMVM_HEAP_GROWTH_ATOM);
+    if (heap_growth_term != term_nil() && UNLIKELY(!context_heap_growth_strategy_from_atom(heap_growth_term, &heap_growth_strategy))) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+    bool message_queue_off_heap = false;
+    term message_queue_data_term = interop_proplist_get_value(opts_term, MESSAGE_QUEUE_DATA_ATOM);
+    if (message_queue_data_term != term_nil() && UNLIKELY(!context_message_queue_data_from_atom(message_queue_data_term, &message_queue_off_heap))) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+
     Context *new_ctx = context_new(ctx->global);
     new_ctx->group_leader = ctx->group_leader;
+    new_ctx->priority = priority;
+    new_ctx->heap_growth_strategy = heap_growth_strategy;
+    new_ctx->message_queue_off_heap = message_queue_off_heap;
+    if (fullsweep_after_term != term_nil()) {
+        new_ctx->fullsweep_after = term_to_int(fullsweep_after_term);
+    }
 
     const term *boxed_value = term_to_const_term_ptr(fun_term);
 
@@ -1117,18 +1399,7 @@ static term nif_erlang_spawn_fun(Context *ctx, int argc, term argv[])
 
     // TODO: new process should fail with badarity if arity != 0
 
-    int size = 0;
-    for (uint32_t i = 0; i < n_freeze; i++) {
-        size += memory_estimate_usage(boxed_value[i + 3]);
-    }
-    if (UNLIKELY(memory_ensure_free_opt(new_ctx, size, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
-        //TODO: new process should be terminated, however a new pid is returned anyway
-        fprintf(stderr, "Unable to allocate sufficient memory to spawn process.\n");
-        AVM_ABORT();
-    }
-    for (uint32_t i = 0; i < n_freeze; i++) {
-        new_ctx->x[i + arity - n_freeze] = memory_copy_term_tree(&new_ctx->heap, boxed_value[i + 3]);
-    }
+    spawn_copy_args(new_ctx, boxed_value + 3, n_freeze, arity - n_freeze, 0);
 
     new_ctx->saved_module = fun_module;
     new_ctx->saved_ip = fun_module->labels[label];
@@ -1166,8 +1437,34 @@ static term nif_erlang_spawn(Context *ctx, int argc, term argv[])
         opts_term = term_nil();
     }
 
+    enum ProcessPriority priority = PriorityNormal;
+    term priority_term = interop_proplist_get_value(opts_term, PRIORITY_ATOM);
+    if (priority_term != term_nil() && UNLIKELY(!context_priority_from_atom(priority_term, &priority))) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+    term fullsweep_after_term = interop_proplist_get_value(opts_term, FULLSWEEP_AFTER_ATOM);
+    if (fullsweep_after_term != term_nil() && UNLIKELY(!term_is_integer(fullsweep_after_term) || term_to_int(fullsweep_after_term) < 0)) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+    enum HeapGrowthStrategy heap_growth_strategy = BoundedFreeHeapGrowth;
+    term heap_growth_term = interop_proplist_get_value(opts_term, ATOMVM_HEAP_GROWTH_ATOM);
+    if (heap_growth_term != term_nil() && UNLIKELY(!context_heap_growth_strategy_from_atom(heap_growth_term, &heap_growth_strategy))) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+    bool message_queue_off_heap = false;
+    term message_queue_data_term = interop_proplist_get_value(opts_term, MESSAGE_QUEUE_DATA_ATOM);
+    if (message_queue_data_term != term_nil() && UNLIKELY(!context_message_queue_data_from_atom(message_queue_data_term, &message_queue_off_heap))) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+
     Context *new_ctx = context_new(ctx->global);
     new_ctx->group_leader = ctx->group_leader;
+    new_ctx->priority = priority;
+    new_ctx->heap_growth_strategy = heap_growth_strategy;
+    new_ctx->message_queue_off_heap = message_queue_off_heap;
+    if (fullsweep_after_term != term_nil()) {
+        new_ctx->fullsweep_after = term_to_int(fullsweep_after_term);
+    }
 
     AtomString module_string = globalcontext_atomstring_from_term(ctx->global, argv[0]);
     AtomString function_string = globalcontext_atomstring_from_term(ctx->global, argv[1]);
@@ -1243,24 +1540,22 @@ static term nif_erlang_spawn(Context *ctx, int argc, term argv[])
         }
     }
 
-    //TODO: check available registers count
-    int reg_index = 0;
+    term args[MAX_REG];
+    int args_count = 0;
     term t = argv[2];
-    avm_int_t size = MAX((unsigned long) term_to_int(min_heap_size_term), memory_estimate_usage(t));
-    if (UNLIKELY(memory_ensure_free_opt(new_ctx, size, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
-        //TODO: new process should be terminated, however a new pid is returned anyway
-        fprintf(stderr, "Unable to allocate sufficient memory to spawn process.\n");
-        AVM_ABORT();
-    }
     while (term_is_nonempty_list(t)) {
-        new_ctx->x[reg_index] = memory_copy_term_tree(&new_ctx->heap, term_get_list_head(t));
-        reg_index++;
+        if (UNLIKELY(args_count == MAX_REG)) {
+            RAISE_ERROR(BADARG_ATOM);
+        }
+        args[args_count] = term_get_list_head(t);
+        args_count++;
 
         t = term_get_list_tail(t);
         if (!term_is_list(t)) {
             RAISE_ERROR(BADARG_ATOM);
         }
     }
+    spawn_copy_args(new_ctx, args, args_count, 0, term_to_int(min_heap_size_term));
 
     term new_pid = term_from_local_process_id(new_ctx->process_id);
 
@@ -1295,7 +1590,7 @@ static term nif_erlang_send_2(Context *ctx, int argc, term argv[])
     if (term_is_pid(target)) {
         int32_t local_process_id = term_to_local_process_id(target);
 
-        globalcontext_send_message(glb, local_process_id, argv[1]);
+        globalcontext_send_message_on_scheduler(glb, context_scheduler_id(ctx), local_process_id, argv[1]);
 
     } else if (term_is_atom(target)) {
         // We need to hold a lock on the processes_table until the message is sent to avoid a race condition,
@@ -1318,7 +1613,7 @@ static term nif_erlang_send_2(Context *ctx, int argc, term argv[])
             RAISE_ERROR(BADARG_ATOM);
         }
 
-        globalcontext_send_message_nolock(glb, local_process_id, argv[1]);
+        mailbox_send_on_scheduler(p, context_scheduler_id(ctx), argv[1]);
         synclist_unlock(&glb->processes_table);
     } else {
         RAISE_ERROR(BADARG_ATOM);
@@ -1714,6 +2009,17 @@ static term nif_erlang_setelement_3(Context *ctx, int argc, term argv[])
     return new_tuple;
 }
 
+static size_t tuple_to_list_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+
+    if (!term_is_tuple(argv[0])) {
+        return 0;
+    }
+    return CONS_SIZE * term_get_tuple_arity(argv[0]);
+}
+
 static term nif_erlang_tuple_to_list_1(Context *ctx, int argc, term argv[])
 {
     UNUSED(argc);
@@ -1722,10 +2028,6 @@ static term nif_erlang_tuple_to_list_1(Context *ctx, int argc, term argv[])
 
     int tuple_size = term_get_tuple_arity(argv[0]);
 
-    if (UNLIKELY(memory_ensure_free_opt(ctx, tuple_size * 2, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
-        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
-    }
-
     term tuple = argv[0];
     term prev = term_nil();
 
@@ -1736,6 +2038,19 @@ static term nif_erlang_tuple_to_list_1(Context *ctx, int argc, term argv[])
     return prev;
 }
 
+static size_t list_to_tuple_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+
+    if (!term_is_list(argv[0])) {
+        return 0;
+    }
+    int proper;
+    avm_int_t len = term_list_length(argv[0], &proper);
+    return TUPLE_SIZE(len);
+}
+
 static term nif_erlang_list_to_tuple_1(Context *ctx, int argc, term argv[])
 {
     UNUSED(argc);
@@ -1748,9 +2063,6 @@ static term nif_erlang_list_to_tuple_1(Context *ctx, int argc, term argv[])
         RAISE_ERROR(BADARG_ATOM);
     }
 
-    if (UNLIKELY(memory_ensure_free_opt(ctx, TUPLE_SIZE(len), MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
-        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
-    }
     term tuple = term_alloc_tuple(len, &ctx->heap);
 
     term l = argv[0];
@@ -1890,6 +2202,17 @@ static term nif_erlang_list_to_float_1(Context *ctx, int argc, term argv[])
     return res_term;
 }
 
+static size_t binary_to_list_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+
+    if (!term_is_binary(argv[0])) {
+        return 0;
+    }
+    return CONS_SIZE * term_binary_size(argv[0]);
+}
+
 static term nif_erlang_binary_to_list_1(Context *ctx, int argc, term argv[])
 {
     UNUSED(argc);
@@ -1898,9 +2221,6 @@ static term nif_erlang_binary_to_list_1(Context *ctx, int argc, term argv[])
     VALIDATE_VALUE(value, term_is_binary);
 
     int bin_size = term_binary_size(value);
-    if (UNLIKELY(memory_ensure_free_opt(ctx, bin_size * 2, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
-        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
-    }
 
     const uint8_t *bin_data = (const uint8_t *) term_binary_data(argv[0]);
 
@@ -2010,6 +2330,17 @@ term list_to_atom(Context *ctx, int argc, term argv[], int create_new)
     }
 }
 
+static size_t atom_to_binary_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(argc);
+
+    if (!term_is_atom(argv[0])) {
+        return 0;
+    }
+    AtomString atom_string = globalcontext_atomstring_from_index(ctx->global, term_to_atom_index(argv[0]));
+    return term_binary_heap_size(atom_string_len(atom_string));
+}
+
 static term nif_erlang_atom_to_binary_2(Context *ctx, int argc, term argv[])
 {
     UNUSED(argc);
@@ -2022,18 +2353,25 @@ static term nif_erlang_atom_to_binary_2(Context *ctx, int argc, term argv[])
     }
 
     int atom_index = term_to_atom_index(atom_term);
-    AtomString atom_string = (AtomString) valueshashtable_get_value(ctx->global->atoms_ids_table, atom_index, (unsigned long) NULL);
+    AtomString atom_string = globalcontext_atomstring_from_index(ctx->global, atom_index);
 
     int atom_len = atom_string_len(atom_string);
 
-    if (UNLIKELY(memory_ensure_free_opt(ctx, term_binary_heap_size(atom_len), MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
-        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
-    }
-
     const char *atom_data = (const char *) atom_string_data(atom_string);
     return term_from_literal_binary(atom_data, atom_len, &ctx->heap, ctx->global);
 }
 
+static size_t atom_to_list_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(argc);
+
+    if (!term_is_atom(argv[0])) {
+        return 0;
+    }
+    AtomString atom_string = globalcontext_atomstring_from_index(ctx->global, term_to_atom_index(argv[0]));
+    return CONS_SIZE * atom_string_len(atom_string);
+}
+
 static term nif_erlang_atom_to_list_1(Context *ctx, int argc, term argv[])
 {
     UNUSED(argc);
@@ -2042,14 +2380,10 @@ static term nif_erlang_atom_to_list_1(Context *ctx, int argc, term argv[])
     VALIDATE_VALUE(atom_term, term_is_atom);
 
     int atom_index = term_to_atom_index(atom_term);
-    AtomString atom_string = (AtomString) valueshashtable_get_value(ctx->global->atoms_ids_table, atom_index, (unsigned long) NULL);
+    AtomString atom_string = globalcontext_atomstring_from_index(ctx->global, atom_index);
 
     int atom_len = atom_string_len(atom_string);
 
-    if (UNLIKELY(memory_ensure_free_opt(ctx, atom_len * 2, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
-        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
-    }
-
     term prev = term_nil();
     for (int i = atom_len - 1; i >= 0; i--) {
         char c = ((const char *) atom_string_data(atom_string))[i];
@@ -2093,6 +2427,37 @@ static size_t lltoa(avm_int64_t int_value, unsigned base, char *integer_string)
     return integer_string_len;
 }
 
+// Number of characters of an integer term in a given base, or 0 if arguments
+// are not valid
+static size_t integer_to_string_len(int argc, const term argv[])
+{
+    if (!term_is_any_integer(argv[0])) {
+        return 0;
+    }
+    unsigned base = 10;
+    if (argc > 1) {
+        if (!term_is_integer(argv[1]) || term_to_int(argv[1]) < 2 || term_to_int(argv[1]) > 36) {
+            return 0;
+        }
+        base = term_to_int(argv[1]);
+    }
+    return lltoa(term_maybe_unbox_int64(argv[0]), base, NULL);
+}
+
+static size_t integer_to_binary_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+
+    return term_binary_heap_size(integer_to_string_len(argc, argv));
+}
+
+static size_t integer_to_list_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+
+    return CONS_SIZE * integer_to_string_len(argc, argv);
+}
+
 static term nif_erlang_integer_to_binary_2(Context *ctx, int argc, term argv[])
 {
     term value = argv[0];
@@ -2109,9 +2474,6 @@ static term nif_erlang_integer_to_binary_2(Context *ctx, int argc, term argv[])
     avm_int64_t int_value = term_maybe_unbox_int64(value);
     size_t len = lltoa(int_value, base, NULL);
 
-    if (UNLIKELY(memory_ensure_free_opt(ctx, term_binary_heap_size(len), MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
-        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
-    }
     term result = term_create_empty_binary(len, &ctx->heap, ctx->global);
     lltoa(int_value, base, (char *) term_binary_data(result));
     return result;
@@ -2135,10 +2497,6 @@ static term nif_erlang_integer_to_list_2(Context *ctx, int argc, term argv[])
     char integer_string[integer_string_len];
     lltoa(int_value, base, integer_string);
 
-    if (UNLIKELY(memory_ensure_free_opt(ctx, integer_string_len * 2, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
-        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
-    }
-
     term prev = term_nil();
     for (int i = integer_string_len - 1; i >= 0; i--) {
         prev = term_list_prepend(term_from_int11(integer_string[i]), prev, &ctx->heap);
@@ -2504,6 +2862,30 @@ static term nif_erlang_process_flag(Context *ctx, int argc, term argv[])
                 }
                 return prev;
             }
+            case MESSAGE_QUEUE_DATA_ATOM: {
+                term prev = ctx->message_queue_off_heap ? OFF_HEAP_ATOM : ON_HEAP_ATOM;
+                bool off_heap;
+                if (UNLIKELY(!context_message_queue_data_from_atom(value, &off_heap))) {
+                    RAISE_ERROR(BADARG_ATOM);
+                }
+                ctx->message_queue_off_heap = off_heap;
+                if (!off_heap) {
+                    // Messages consumed off heap are merged at the next safe point
+                    memory_flush_consumed_messages(ctx);
+                }
+                return prev;
+            }
+            case PRIORITY_ATOM: {
+                term prev = context_priority_to_atom(ctx->priority);
+                enum ProcessPriority priority;
+                if (UNLIKELY(!context_priority_from_atom(value, &priority))) {
+                    RAISE_ERROR(BADARG_ATOM);
+                }
+                // The new priority is effective the next time the process is
+                // made ready
+                ctx->priority = priority;
+                return prev;
+            }
         }
 
         // TODO: check erlang:process_flag/3 implementation
@@ -2702,6 +3084,15 @@ static term nif_erlang_system_info(Context *ctx, int argc, term argv[])
         return term_from_int32(1);
 #endif
     }
+    if (key == FULLSWEEP_AFTER_ATOM) {
+        if (UNLIKELY(memory_ensure_free_opt(ctx, TUPLE_SIZE(2), MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        }
+        term ret = term_alloc_tuple(2, &ctx->heap);
+        term_put_tuple_element(ret, 0, FULLSWEEP_AFTER_ATOM);
+        term_put_tuple_element(ret, 1, term_from_int32(ctx->global->fullsweep_after));
+        return ret;
+    }
     return sys_get_info(ctx, key);
 }
 
@@ -2729,9 +3120,17 @@ static term nif_erlang_system_flag(Context *ctx, int argc, term argv[])
         while (!ATOMIC_COMPARE_EXCHANGE_WEAK(&ctx->global->online_schedulers, &old_value, new_value)) {};
         return term_from_int32(old_value);
     }
-#else
-    UNUSED(value);
 #endif
+    if (key == FULLSWEEP_AFTER_ATOM) {
+        VALIDATE_VALUE(value, term_is_integer);
+        avm_int_t new_value = term_to_int(value);
+        if (UNLIKELY(new_value < 0)) {
+            RAISE_ERROR(BADARG_ATOM);
+        }
+        unsigned int old_value = ctx->global->fullsweep_after;
+        ctx->global->fullsweep_after = new_value;
+        return term_from_int32(old_value);
+    }
     RAISE_ERROR(BADARG_ATOM);
 }
 
@@ -2969,6 +3368,19 @@ static term nif_erts_debug_flat_size(Context *ctx, int argc, term argv[])
     return term_from_int32(terms_count);
 }
 
+static term nif_erts_debug_size(Context *ctx, int argc, term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+
+    struct SharedTerms shared;
+    memory_init_shared_terms(&shared);
+    unsigned long terms_count = memory_estimate_shared_usage(argv[0], &shared);
+    memory_destroy_shared_terms(&shared);
+
+    return term_from_int32(terms_count);
+}
+
 static term nif_erlang_pid_to_list(Context *ctx, int argc, term argv[])
 {
     UNUSED(argc);
@@ -3133,6 +3545,28 @@ static term nif_erlang_garbage_collect(Context *ctx, int argc, term argv[])
     return TRUE_ATOM;
 }
 
+static term nif_erlang_statistics(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+    term key = argv[0];
+
+    if (key == GARBAGE_COLLECTION_ATOM) {
+        unsigned long long gc_count;
+        unsigned long long words_reclaimed;
+        globalcontext_get_gc_stats(ctx->global, &gc_count, &words_reclaimed);
+        if (UNLIKELY(memory_ensure_free_opt(ctx, TUPLE_SIZE(3) + 2 * BOXED_INT64_SIZE, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        }
+        term ret = term_alloc_tuple(3, &ctx->heap);
+        term_put_tuple_element(ret, 0, term_make_maybe_boxed_int64(gc_count, &ctx->heap));
+        term_put_tuple_element(ret, 1, term_make_maybe_boxed_int64(words_reclaimed, &ctx->heap));
+        term_put_tuple_element(ret, 2, term_from_int(0));
+        return ret;
+    }
+
+    RAISE_ERROR(BADARG_ATOM);
+}
+
 static term nif_erlang_error(Context *ctx, int argc, term argv[])
 {
     UNUSED(argc);
@@ -3195,15 +3629,57 @@ static term nif_erlang_erase_1(Context *ctx, int argc, term argv[])
     return old;
 }
 
-static term nif_erlang_memory(Context *ctx, int argc, term argv[])
+static size_t get_keys_heap_need(Context *ctx, int argc, const term argv[])
 {
     UNUSED(argc);
+    UNUSED(argv);
 
-    term type = argv[0];
-    VALIDATE_VALUE(type, term_is_atom);
+    return CONS_SIZE * ctx->dictionary.count;
+}
 
-    if (type == BINARY_ATOM) {
-        size_t size = refc_binary_total_size(ctx);
+static term nif_erlang_get_keys(Context *ctx, int argc, term argv[])
+{
+    struct Dictionary *dict = &ctx->dictionary;
+    term result = term_nil();
+
+    for (size_t i = 0; i < dict->capacity; i++) {
+        struct DictEntry *entry = &dict->entries[i];
+        if (!dictionary_entry_is_used(entry)) {
+            continue;
+        }
+        if (argc == 1) {
+            TermCompareResult cmp = term_compare(entry->value, argv[0], TermCompareExact, ctx->global);
+            if (UNLIKELY(cmp == TermCompareMemoryAllocFail)) {
+                RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+            } else if (cmp != TermEquals) {
+                continue;
+            }
+        }
+        result = term_list_prepend(entry->key, result, &ctx->heap);
+    }
+
+    return result;
+}
+
+static term nif_erlang_memory(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term type = argv[0];
+    VALIDATE_VALUE(type, term_is_atom);
+
+    if (type == BINARY_ATOM) {
+        size_t size = refc_binary_total_size(ctx);
+        size_t term_size = term_boxed_integer_size(size);
+        if (UNLIKELY(memory_ensure_free_opt(ctx, term_size, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        }
+        return term_make_maybe_boxed_int64(size, &ctx->heap);
+    } else if (type == ATOMVM_POOL_RESERVED_ATOM || type == ATOMVM_POOL_OVERSIZED_ATOM) {
+        size_t reserved_size;
+        size_t oversized_size;
+        memory_pool_get_stats(ctx->global, &reserved_size, &oversized_size);
+        size_t size = type == ATOMVM_POOL_RESERVED_ATOM ? reserved_size : oversized_size;
         size_t term_size = term_boxed_integer_size(size);
         if (UNLIKELY(memory_ensure_free_opt(ctx, term_size, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
@@ -3286,6 +3762,99 @@ static term nif_erlang_demonitor(Context *ctx, int argc, term argv[])
     return !info || result ? TRUE_ATOM : FALSE_ATOM;
 }
 
+static term start_timer(Context *ctx, term argv[], bool timeout_message)
+{
+    term time = argv[0];
+    term dest = argv[1];
+
+    VALIDATE_VALUE(time, term_is_any_integer);
+    avm_int64_t timeout = term_maybe_unbox_int64(time);
+    if (UNLIKELY(timeout < 0 || timeout > UINT32_MAX)) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+    if (UNLIKELY(!term_is_pid(dest) && !term_is_atom(dest))) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+
+    size_t required = timeout_message ? REF_SIZE + TUPLE_SIZE(3) : REF_SIZE;
+    if (UNLIKELY(memory_ensure_free_opt(ctx, required, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+    uint64_t ref_ticks = globalcontext_get_ref_ticks(ctx->global);
+    term ref = term_from_ref_ticks(ref_ticks, &ctx->heap);
+
+    term msg = argv[2];
+    if (timeout_message) {
+        term timeout_tuple = term_alloc_tuple(3, &ctx->heap);
+        term_put_tuple_element(timeout_tuple, 0, TIMEOUT_ATOM);
+        term_put_tuple_element(timeout_tuple, 1, ref);
+        term_put_tuple_element(timeout_tuple, 2, msg);
+        msg = timeout_tuple;
+    }
+
+    // The message is copied now, so the timer doesn't depend on the caller
+    Message *message = mailbox_message_create_from_term(ctx->global, context_scheduler_id(ctx), msg);
+    if (IS_NULL_PTR(message)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+    if (UNLIKELY(!scheduler_start_timer(ctx->global, ref_ticks, timeout, dest, message))) {
+        mailbox_message_destroy(message, ctx->global);
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    return ref;
+}
+
+static term nif_erlang_send_after_3(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    return start_timer(ctx, argv, false);
+}
+
+static term nif_erlang_start_timer(Context *ctx, int argc, term argv[])
+{
+    if (argc == 4) {
+        // Options are currently ignored
+        VALIDATE_VALUE(argv[3], term_is_list);
+    }
+
+    return start_timer(ctx, argv, true);
+}
+
+static term timer_remaining_to_term(Context *ctx, bool found, avm_int64_t remaining)
+{
+    if (!found) {
+        return FALSE_ATOM;
+    }
+    if (UNLIKELY(memory_ensure_free_opt(ctx, term_boxed_integer_size(remaining), MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+    return term_make_maybe_boxed_int64(remaining, &ctx->heap);
+}
+
+static term nif_erlang_cancel_timer_1(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    VALIDATE_VALUE(argv[0], term_is_reference);
+    avm_int64_t remaining = 0;
+    bool found = scheduler_cancel_timer(ctx->global, term_to_ref_ticks(argv[0]), &remaining);
+
+    return timer_remaining_to_term(ctx, found, remaining);
+}
+
+static term nif_erlang_read_timer_1(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    VALIDATE_VALUE(argv[0], term_is_reference);
+    avm_int64_t remaining = 0;
+    bool found = scheduler_read_timer(ctx->global, term_to_ref_ticks(argv[0]), &remaining);
+
+    return timer_remaining_to_term(ctx, found, remaining);
+}
+
 static term nif_erlang_link(Context *ctx, int argc, term argv[])
 {
     UNUSED(argc);
@@ -3706,8 +4275,7 @@ static term nif_atomvm_read_priv(Context *ctx, int argc, term argv[])
     }
 
     int atom_index = term_to_atom_index(app_term);
-    AtomString atom_string = (AtomString) valueshashtable_get_value(glb->atoms_ids_table,
-        atom_index, (unsigned long) NULL);
+    AtomString atom_string = globalcontext_atomstring_from_index(glb, atom_index);
 
     int app_len = atom_string_len(atom_string);
     char *app = malloc(app_len + 1);
@@ -4234,6 +4802,913 @@ static term nif_maps_next(Context *ctx, int argc, term argv[])
     return ret;
 }
 
+static term raise_map_error(Context *ctx, term error_atom, term value)
+{
+    if (UNLIKELY(memory_ensure_free_with_roots(ctx, TUPLE_SIZE(2), 1, &value, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+    term error = term_alloc_tuple(2, &ctx->heap);
+    term_put_tuple_element(error, 0, error_atom);
+    term_put_tuple_element(error, 1, value);
+
+    RAISE_ERROR(error);
+}
+
+// Binary search of key in the sorted keys of map. Returns the position of key
+// if it is found, the position where it should be inserted otherwise, or -1 if
+// memory allocation failed.
+static int maps_search_key(term map, term key, bool *found, GlobalContext *global)
+{
+    term keys = term_get_map_keys(map);
+    int low = 0;
+    int high = term_get_tuple_arity(keys);
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        switch (term_compare(key, term_get_tuple_element(keys, mid), TermCompareExact, global)) {
+            case TermEquals:
+                *found = true;
+                return mid;
+            case TermLessThan:
+                high = mid;
+                break;
+            case TermGreaterThan:
+                low = mid + 1;
+                break;
+            case TermCompareMemoryAllocFail:
+                return -1;
+        }
+    }
+
+    *found = false;
+    return low;
+}
+
+// Copy map replacing the value at pos, the copy shares the keys of map
+static term maps_replace_value(Context *ctx, term map, int pos, term value)
+{
+    if (term_get_map_value(map, pos) == value) {
+        return map;
+    }
+
+    int size = term_get_map_size(map);
+    term new_map = term_alloc_map_maybe_shared(size, term_get_map_keys(map), &ctx->heap);
+    for (int i = 0; i < size; i++) {
+        term_set_map_assoc(new_map, i, term_get_map_key(map, i), term_get_map_value(map, i));
+    }
+    term_set_map_assoc(new_map, pos, term_get_map_key(map, pos), value);
+
+    return new_map;
+}
+
+static term nif_maps_get_3(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term map = argv[1];
+    if (UNLIKELY(!term_is_map(map))) {
+        return raise_map_error(ctx, BADMAP_ATOM, map);
+    }
+
+    int pos = term_find_map_pos(map, argv[0], ctx->global);
+    if (pos == TERM_MAP_NOT_FOUND) {
+        return argv[2];
+    } else if (UNLIKELY(pos == TERM_MAP_MEMORY_ALLOC_FAIL)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    return term_get_map_value(map, pos);
+}
+
+static size_t maps_find_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+    UNUSED(argv);
+
+    return TUPLE_SIZE(2);
+}
+
+static term nif_maps_find_2(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term map = argv[1];
+    if (UNLIKELY(!term_is_map(map))) {
+        return raise_map_error(ctx, BADMAP_ATOM, map);
+    }
+
+    int pos = term_find_map_pos(map, argv[0], ctx->global);
+    if (pos == TERM_MAP_NOT_FOUND) {
+        return ERROR_ATOM;
+    } else if (UNLIKELY(pos == TERM_MAP_MEMORY_ALLOC_FAIL)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    term result = term_alloc_tuple(2, &ctx->heap);
+    term_put_tuple_element(result, 0, OK_ATOM);
+    term_put_tuple_element(result, 1, term_get_map_value(map, pos));
+
+    return result;
+}
+
+static size_t maps_put_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+
+    if (!term_is_map(argv[2])) {
+        return 0;
+    }
+    return term_map_size_in_terms(term_get_map_size(argv[2]) + 1);
+}
+
+static term nif_maps_put_3(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term key = argv[0];
+    term value = argv[1];
+    term map = argv[2];
+    if (UNLIKELY(!term_is_map(map))) {
+        return raise_map_error(ctx, BADMAP_ATOM, map);
+    }
+
+    bool found;
+    int pos = maps_search_key(map, key, &found, ctx->global);
+    if (UNLIKELY(pos < 0)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+    if (found) {
+        return maps_replace_value(ctx, map, pos, value);
+    }
+
+    int size = term_get_map_size(map);
+    term new_map = term_alloc_map(size + 1, &ctx->heap);
+    for (int i = 0; i < pos; i++) {
+        term_set_map_assoc(new_map, i, term_get_map_key(map, i), term_get_map_value(map, i));
+    }
+    term_set_map_assoc(new_map, pos, key, value);
+    for (int i = pos; i < size; i++) {
+        term_set_map_assoc(new_map, i + 1, term_get_map_key(map, i), term_get_map_value(map, i));
+    }
+
+    return new_map;
+}
+
+static size_t maps_update_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+
+    if (!term_is_map(argv[2])) {
+        return 0;
+    }
+    return term_map_size_in_terms_maybe_shared(term_get_map_size(argv[2]), true);
+}
+
+static term nif_maps_update_3(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term map = argv[2];
+    if (UNLIKELY(!term_is_map(map))) {
+        return raise_map_error(ctx, BADMAP_ATOM, map);
+    }
+
+    int pos = term_find_map_pos(map, argv[0], ctx->global);
+    if (pos == TERM_MAP_NOT_FOUND) {
+        return raise_map_error(ctx, BADKEY_ATOM, argv[0]);
+    } else if (UNLIKELY(pos == TERM_MAP_MEMORY_ALLOC_FAIL)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    return maps_replace_value(ctx, map, pos, argv[1]);
+}
+
+static size_t maps_remove_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+
+    term map = argv[1];
+    if (term_is_nonempty_list(map)) {
+        map = term_get_list_tail(map);
+        if (!term_is_map(map)) {
+            return 0;
+        }
+        return term_map_size_in_terms(term_get_map_size(map));
+    }
+    if (!term_is_map(map) || term_get_map_size(map) == 0) {
+        return 0;
+    }
+    return term_map_size_in_terms(term_get_map_size(map) - 1);
+}
+
+static term nif_maps_remove_2(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term map = argv[1];
+    int start = 0;
+    if (term_is_nonempty_list(map)) {
+        // iterators are also accepted, entries before the iterator position are removed
+        term iterator_pos = term_get_list_head(map);
+        map = term_get_list_tail(map);
+        if (UNLIKELY(!term_is_integer(iterator_pos) || !term_is_map(map))) {
+            return raise_map_error(ctx, BADMAP_ATOM, argv[1]);
+        }
+        start = term_to_int(iterator_pos);
+        if (start < 0) {
+            start = 0;
+        } else if (start > term_get_map_size(map)) {
+            start = term_get_map_size(map);
+        }
+    } else if (UNLIKELY(!term_is_map(map))) {
+        return raise_map_error(ctx, BADMAP_ATOM, map);
+    }
+
+    int pos = term_find_map_pos(map, argv[0], ctx->global);
+    if (UNLIKELY(pos == TERM_MAP_MEMORY_ALLOC_FAIL)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+    bool found = pos != TERM_MAP_NOT_FOUND && pos >= start;
+    if (!found && start == 0) {
+        return map;
+    }
+
+    int size = term_get_map_size(map);
+    term new_map = term_alloc_map(size - start - (found ? 1 : 0), &ctx->heap);
+    for (int i = start, j = 0; i < size; i++) {
+        if (!found || i != pos) {
+            term_set_map_assoc(new_map, j, term_get_map_key(map, i), term_get_map_value(map, i));
+            j++;
+        }
+    }
+
+    return new_map;
+}
+
+static size_t maps_merge_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+
+    if (!term_is_map(argv[0]) || !term_is_map(argv[1])) {
+        return 0;
+    }
+    return term_map_size_in_terms(term_get_map_size(argv[0]) + term_get_map_size(argv[1]));
+}
+
+static term nif_maps_merge_2(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term map1 = argv[0];
+    term map2 = argv[1];
+    if (UNLIKELY(!term_is_map(map1))) {
+        return raise_map_error(ctx, BADMAP_ATOM, map1);
+    }
+    if (UNLIKELY(!term_is_map(map2))) {
+        return raise_map_error(ctx, BADMAP_ATOM, map2);
+    }
+
+    int size1 = term_get_map_size(map1);
+    int size2 = term_get_map_size(map2);
+    if (size2 == 0) {
+        return map1;
+    }
+
+    // keys are sorted, count the keys of the merged map with a linear merge
+    int i = 0;
+    int j = 0;
+    int common = 0;
+    while (i < size1 && j < size2) {
+        TermCompareResult result = term_compare(term_get_map_key(map1, i), term_get_map_key(map2, j), TermCompareExact, ctx->global);
+        if (result == TermLessThan) {
+            i++;
+        } else if (result == TermGreaterThan) {
+            j++;
+        } else if (result == TermEquals) {
+            i++;
+            j++;
+            common++;
+        } else {
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        }
+    }
+    if (common == size1) {
+        // every key of map1 is overwritten
+        return map2;
+    }
+
+    int size = size1 + size2 - common;
+    term new_map;
+    if (common == size2) {
+        // no new key, share the keys of map1
+        new_map = term_alloc_map_maybe_shared(size, term_get_map_keys(map1), &ctx->heap);
+    } else {
+        new_map = term_alloc_map(size, &ctx->heap);
+    }
+
+    i = 0;
+    j = 0;
+    int k = 0;
+    while (i < size1 && j < size2) {
+        term key1 = term_get_map_key(map1, i);
+        term key2 = term_get_map_key(map2, j);
+        TermCompareResult result = term_compare(key1, key2, TermCompareExact, ctx->global);
+        if (result == TermLessThan) {
+            term_set_map_assoc(new_map, k++, key1, term_get_map_value(map1, i++));
+        } else if (result == TermGreaterThan) {
+            term_set_map_assoc(new_map, k++, key2, term_get_map_value(map2, j++));
+        } else if (result == TermEquals) {
+            term_set_map_assoc(new_map, k++, key1, term_get_map_value(map2, j++));
+            i++;
+        } else {
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        }
+    }
+    while (i < size1) {
+        term_set_map_assoc(new_map, k++, term_get_map_key(map1, i), term_get_map_value(map1, i));
+        i++;
+    }
+    while (j < size2) {
+        term_set_map_assoc(new_map, k++, term_get_map_key(map2, j), term_get_map_value(map2, j));
+        j++;
+    }
+
+    return new_map;
+}
+
+static size_t maps_keys_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+
+    if (!term_is_map(argv[0])) {
+        return 0;
+    }
+    return CONS_SIZE * term_get_map_size(argv[0]);
+}
+
+static term nif_maps_keys_1(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term map = argv[0];
+    if (UNLIKELY(!term_is_map(map))) {
+        return raise_map_error(ctx, BADMAP_ATOM, map);
+    }
+
+    term result = term_nil();
+    for (int i = term_get_map_size(map) - 1; i >= 0; i--) {
+        result = term_list_prepend(term_get_map_key(map, i), result, &ctx->heap);
+    }
+
+    return result;
+}
+
+static term nif_maps_values_1(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term map = argv[0];
+    if (UNLIKELY(!term_is_map(map))) {
+        return raise_map_error(ctx, BADMAP_ATOM, map);
+    }
+
+    term result = term_nil();
+    for (int i = term_get_map_size(map) - 1; i >= 0; i--) {
+        result = term_list_prepend(term_get_map_value(map, i), result, &ctx->heap);
+    }
+
+    return result;
+}
+
+static size_t maps_to_list_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+
+    if (!term_is_map(argv[0])) {
+        return 0;
+    }
+    return (CONS_SIZE + TUPLE_SIZE(2)) * term_get_map_size(argv[0]);
+}
+
+static term nif_maps_to_list_1(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term map = argv[0];
+    if (UNLIKELY(!term_is_map(map))) {
+        return raise_map_error(ctx, BADMAP_ATOM, map);
+    }
+
+    term result = term_nil();
+    for (int i = term_get_map_size(map) - 1; i >= 0; i--) {
+        term entry = term_alloc_tuple(2, &ctx->heap);
+        term_put_tuple_element(entry, 0, term_get_map_key(map, i));
+        term_put_tuple_element(entry, 1, term_get_map_value(map, i));
+        result = term_list_prepend(entry, result, &ctx->heap);
+    }
+
+    return result;
+}
+
+// Returns the length of a proper list of 2-tuples, or -1
+static int maps_entries_list_length(term list)
+{
+    int len = 0;
+    while (term_is_nonempty_list(list)) {
+        term entry = term_get_list_head(list);
+        if (!term_is_tuple(entry) || term_get_tuple_arity(entry) != 2) {
+            return -1;
+        }
+        len++;
+        list = term_get_list_tail(list);
+    }
+    return term_is_nil(list) ? len : -1;
+}
+
+static size_t maps_from_list_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+
+    int len = maps_entries_list_length(argv[0]);
+    if (len < 0) {
+        return 0;
+    }
+    return term_map_size_in_terms(len);
+}
+
+static term nif_maps_from_list_1(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    int len = maps_entries_list_length(argv[0]);
+    if (UNLIKELY(len < 0)) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+    if (len == 0) {
+        return term_alloc_map(0, &ctx->heap);
+    }
+
+    struct MapEntry *entries = malloc(len * sizeof(struct MapEntry));
+    if (IS_NULL_PTR(entries)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+    term list = argv[0];
+    for (int i = 0; i < len; i++) {
+        term entry = term_get_list_head(list);
+        entries[i].key = term_get_tuple_element(entry, 0);
+        entries[i].value = term_get_tuple_element(entry, 1);
+        list = term_get_list_tail(list);
+    }
+
+    // the sort is stable, so the last entry of a key is the last of its run
+    if (UNLIKELY(!term_sort_map_entries(entries, len, ctx->global))) {
+        free(entries);
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+    int size = 1;
+    for (int i = 1; i < len; i++) {
+        TermCompareResult result = term_compare(entries[size - 1].key, entries[i].key, TermCompareExact, ctx->global);
+        if (UNLIKELY(result == TermCompareMemoryAllocFail)) {
+            free(entries);
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        }
+        if (result != TermEquals) {
+            size++;
+        }
+        entries[size - 1] = entries[i];
+    }
+
+    term map = term_alloc_map(size, &ctx->heap);
+    for (int i = 0; i < size; i++) {
+        term_set_map_assoc(map, i, entries[i].key, entries[i].value);
+    }
+    free(entries);
+
+    return map;
+}
+
+// Count the cells of list, up to LISTS_CHUNK_LENGTH
+static avm_int_t lists_chunk_length(term list)
+{
+    avm_int_t len = 0;
+    while (len < LISTS_CHUNK_LENGTH && term_is_nonempty_list(list)) {
+        len++;
+        list = term_get_list_tail(list);
+    }
+    return len;
+}
+
+static size_t lists_chunk_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+
+    return CONS_SIZE * lists_chunk_length(argv[0]) + TUPLE_SIZE(2);
+}
+
+// Prepend the next chunk of argv[0] reversed to argv[1], and return
+// {Rest, Acc}. Rest is [] once the whole list is reversed.
+static term nif_lists_reverse_chunk(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term list = argv[0];
+    term result = argv[1];
+
+    avm_int_t len = 0;
+    while (len < LISTS_CHUNK_LENGTH && term_is_nonempty_list(list)) {
+        result = term_list_prepend(term_get_list_head(list), result, &ctx->heap);
+        list = term_get_list_tail(list);
+        len++;
+    }
+    if (UNLIKELY(!term_is_list(list))) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+    ctx->reductions += len;
+
+    term chunk = term_alloc_tuple(2, &ctx->heap);
+    term_put_tuple_element(chunk, 0, list);
+    term_put_tuple_element(chunk, 1, result);
+
+    return chunk;
+}
+
+static size_t lists_keydelete_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+
+    // the cells before an improper tail may be copied before it is found
+    int proper;
+    int len = term_list_length(argv[2], &proper);
+    return CONS_SIZE * len;
+}
+
+static term nif_lists_member_2(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term list = argv[1];
+    while (term_is_nonempty_list(list)) {
+        TermCompareResult result = term_compare(argv[0], term_get_list_head(list), TermCompareExact, ctx->global);
+        if (result == TermEquals) {
+            return TRUE_ATOM;
+        } else if (UNLIKELY(result == TermCompareMemoryAllocFail)) {
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        }
+        list = term_get_list_tail(list);
+    }
+    if (UNLIKELY(!term_is_nil(list))) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+
+    return FALSE_ATOM;
+}
+
+enum ListsResult
+{
+    ListsOk,
+    ListsBadArg,
+    ListsMemoryAllocFail
+};
+
+// Find the first tuple of list whose n-th element compares equal to key.
+// found is set to the list cell holding the tuple, or to nil.
+static enum ListsResult lists_keyfind(term key, term n, term list, term *found, GlobalContext *global)
+{
+    if (UNLIKELY(!term_is_integer(n) || term_to_int(n) < 1)) {
+        return ListsBadArg;
+    }
+    avm_int_t index = term_to_int(n) - 1;
+
+    while (term_is_nonempty_list(list)) {
+        term element = term_get_list_head(list);
+        if (term_is_tuple(element) && index < term_get_tuple_arity(element)) {
+            TermCompareResult result = term_compare(key, term_get_tuple_element(element, index), TermCompareNoOpts, global);
+            if (result == TermEquals) {
+                *found = list;
+                return ListsOk;
+            } else if (UNLIKELY(result == TermCompareMemoryAllocFail)) {
+                return ListsMemoryAllocFail;
+            }
+        }
+        list = term_get_list_tail(list);
+    }
+    if (UNLIKELY(!term_is_nil(list))) {
+        return ListsBadArg;
+    }
+
+    *found = term_nil();
+    return ListsOk;
+}
+
+static term nif_lists_keyfind(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term found;
+    switch (lists_keyfind(argv[0], argv[1], argv[2], &found, ctx->global)) {
+        case ListsOk:
+            break;
+        case ListsBadArg:
+            RAISE_ERROR(BADARG_ATOM);
+        case ListsMemoryAllocFail:
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    return term_is_nil(found) ? FALSE_ATOM : term_get_list_head(found);
+}
+
+static term nif_lists_keymember(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term found;
+    switch (lists_keyfind(argv[0], argv[1], argv[2], &found, ctx->global)) {
+        case ListsOk:
+            break;
+        case ListsBadArg:
+            RAISE_ERROR(BADARG_ATOM);
+        case ListsMemoryAllocFail:
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    return term_is_nil(found) ? FALSE_ATOM : TRUE_ATOM;
+}
+
+static term nif_lists_keydelete(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term found;
+    switch (lists_keyfind(argv[0], argv[1], argv[2], &found, ctx->global)) {
+        case ListsOk:
+            break;
+        case ListsBadArg:
+            RAISE_ERROR(BADARG_ATOM);
+        case ListsMemoryAllocFail:
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+    if (term_is_nil(found)) {
+        return argv[2];
+    }
+
+    // copy the elements before the deleted one, the rest of the list is shared
+    term result = term_get_list_tail(found);
+    term *last_cell = NULL;
+    for (term list = argv[2]; list != found; list = term_get_list_tail(list)) {
+        term *cell = term_list_alloc(&ctx->heap);
+        term new_list = term_list_init_prepend(cell, term_get_list_head(list), term_get_list_tail(found));
+        if (last_cell) {
+            last_cell[0] = new_list;
+        } else {
+            result = new_list;
+        }
+        last_cell = cell;
+    }
+
+    return result;
+}
+
+static size_t lists_flatten_chunk_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+    UNUSED(argv);
+
+    // the chunk is as long as free heap allows, this only ensures progress
+    return CONS_SIZE * (LISTS_MIN_CHUNK_LENGTH + 1) + TUPLE_SIZE(2);
+}
+
+// Flatten the next chunk of a deep list, prepending its elements to argv[1].
+// argv[0] is the stack of lists left to flatten. Returns the reversed flat
+// list once the stack is empty, or {Stack, Acc}.
+static term nif_lists_flatten_chunk(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term stack = argv[0];
+    term result = argv[1];
+
+    // each step allocates at most one cell, and the last one may push t
+    size_t avail = context_avail_free_memory(ctx) - TUPLE_SIZE(2);
+    avm_int_t max_steps = MIN(avail / CONS_SIZE - 1, LISTS_CHUNK_LENGTH);
+
+    term t = term_nil();
+    for (avm_int_t steps = 0; steps < max_steps; steps++) {
+        if (term_is_nonempty_list(t)) {
+            term head = term_get_list_head(t);
+            if (term_is_list(head)) {
+                stack = term_list_prepend(term_get_list_tail(t), stack, &ctx->heap);
+                t = head;
+            } else {
+                result = term_list_prepend(head, result, &ctx->heap);
+                t = term_get_list_tail(t);
+            }
+        } else if (term_is_nil(t)) {
+            if (term_is_nil(stack)) {
+                ctx->reductions += steps;
+                return result;
+            }
+            t = term_get_list_head(stack);
+            stack = term_get_list_tail(stack);
+        } else {
+            RAISE_ERROR(BADARG_ATOM);
+        }
+    }
+    ctx->reductions += max_steps;
+    if (!term_is_nil(t)) {
+        stack = term_list_prepend(t, stack, &ctx->heap);
+    }
+
+    term chunk = term_alloc_tuple(2, &ctx->heap);
+    term_put_tuple_element(chunk, 0, stack);
+    term_put_tuple_element(chunk, 1, result);
+
+    return chunk;
+}
+
+// Get the length of the next chunk of lists:seq(argv[0], argv[1]), which is
+// built backwards from argv[1], or -1 for invalid arguments
+static avm_int_t lists_seq_chunk_length(const term argv[])
+{
+    if (!term_is_any_integer(argv[0]) || !term_is_any_integer(argv[1])) {
+        return -1;
+    }
+    avm_int64_t from = term_maybe_unbox_int64(argv[0]);
+    avm_int64_t to = term_maybe_unbox_int64(argv[1]);
+    if (to < from) {
+        return to == from - 1 ? 0 : -1;
+    }
+    uint64_t last_index = (uint64_t) to - (uint64_t) from;
+    if (last_index >= LISTS_CHUNK_LENGTH - 1) {
+        return LISTS_CHUNK_LENGTH;
+    }
+    return (avm_int_t) last_index + 1;
+}
+
+static size_t lists_seq_chunk_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+
+    avm_int_t len = lists_seq_chunk_length(argv);
+    if (len <= 0) {
+        return 0;
+    }
+    // boxed integers are larger the further they are from 0
+    size_t from_size = term_boxed_integer_size(term_maybe_unbox_int64(argv[0]));
+    size_t to_size = term_boxed_integer_size(term_maybe_unbox_int64(argv[1]));
+    return (CONS_SIZE + MAX(from_size, to_size)) * (len + 1) + TUPLE_SIZE(2);
+}
+
+// Prepend the last chunk of lists:seq(argv[0], argv[1]) to argv[2]. Returns
+// the list once it starts with argv[0], or {To, Acc} where To is the end of
+// the next chunk.
+static term nif_lists_seq_chunk(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    avm_int_t len = lists_seq_chunk_length(argv);
+    if (UNLIKELY(len < 0)) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+    ctx->reductions += len;
+
+    avm_int64_t from = term_maybe_unbox_int64(argv[0]);
+    avm_int64_t to = term_maybe_unbox_int64(argv[1]);
+    term result = argv[2];
+    for (avm_int_t i = 0; i < len; i++) {
+        term value = term_make_maybe_boxed_int64(to - i, &ctx->heap);
+        result = term_list_prepend(value, result, &ctx->heap);
+    }
+    if (len == 0 || (uint64_t) to - (uint64_t) from == (uint64_t) (len - 1)) {
+        return result;
+    }
+
+    term next_to = term_make_maybe_boxed_int64(to - len, &ctx->heap);
+    term chunk = term_alloc_tuple(2, &ctx->heap);
+    term_put_tuple_element(chunk, 0, next_to);
+    term_put_tuple_element(chunk, 1, result);
+
+    return chunk;
+}
+
+static size_t lists_duplicate_heap_need(Context *ctx, int argc, const term argv[])
+{
+    UNUSED(ctx);
+    UNUSED(argc);
+
+    if (!term_is_integer(argv[0]) || term_to_int(argv[0]) < 0 || term_to_int(argv[0]) > LISTS_MAX_LENGTH) {
+        return 0;
+    }
+    return CONS_SIZE * term_to_int(argv[0]);
+}
+
+static term nif_lists_duplicate(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    if (UNLIKELY(!term_is_integer(argv[0]) || term_to_int(argv[0]) < 0 || term_to_int(argv[0]) > LISTS_MAX_LENGTH)) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+
+    term result = term_nil();
+    for (avm_int_t i = term_to_int(argv[0]); i > 0; i--) {
+        result = term_list_prepend(argv[1], result, &ctx->heap);
+    }
+
+    return result;
+}
+
+// Stable merge sort of terms, buffer must hold len terms
+static bool lists_sort_terms(term *terms, term *buffer, size_t len, GlobalContext *global)
+{
+    if (len < 2) {
+        return true;
+    }
+    size_t half = len / 2;
+    if (UNLIKELY(!lists_sort_terms(terms, buffer, half, global) || !lists_sort_terms(terms + half, buffer, len - half, global))) {
+        return false;
+    }
+    memcpy(buffer, terms, len * sizeof(term));
+    size_t i = 0;
+    size_t j = half;
+    size_t k = 0;
+    while (i < half && j < len) {
+        TermCompareResult result = term_compare(buffer[j], buffer[i], TermCompareNoOpts, global);
+        if (UNLIKELY(result == TermCompareMemoryAllocFail)) {
+            return false;
+        }
+        terms[k++] = result == TermLessThan ? buffer[j++] : buffer[i++];
+    }
+    while (i < half) {
+        terms[k++] = buffer[i++];
+    }
+    while (j < len) {
+        terms[k++] = buffer[j++];
+    }
+    return true;
+}
+
+// Sort the next chunk of argv[0]. Returns the sorted list if it was the last
+// chunk, or {Run, Rest} where Run is the sorted chunk.
+static term nif_lists_sort_chunk(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    term list = argv[0];
+    avm_int_t len = lists_chunk_length(list);
+    if (len < 2) {
+        // a list of zero or one element is sorted
+        term tail = len == 0 ? list : term_get_list_tail(list);
+        if (UNLIKELY(!term_is_nil(tail))) {
+            RAISE_ERROR(BADARG_ATOM);
+        }
+        return list;
+    }
+
+    term *terms = malloc(2 * len * sizeof(term));
+    if (IS_NULL_PTR(terms)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+    for (avm_int_t i = 0; i < len; i++) {
+        terms[i] = term_get_list_head(list);
+        list = term_get_list_tail(list);
+    }
+    if (UNLIKELY(!term_is_list(list))) {
+        free(terms);
+        RAISE_ERROR(BADARG_ATOM);
+    }
+    if (UNLIKELY(!lists_sort_terms(terms, terms + len, len, ctx->global))) {
+        free(terms);
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+    ctx->reductions += len;
+
+    term result = term_nil();
+    for (avm_int_t i = len - 1; i >= 0; i--) {
+        result = term_list_prepend(terms[i], result, &ctx->heap);
+    }
+    free(terms);
+    if (term_is_nil(list)) {
+        return result;
+    }
+
+    term chunk = term_alloc_tuple(2, &ctx->heap);
+    term_put_tuple_element(chunk, 0, result);
+    term_put_tuple_element(chunk, 1, list);
+
+    return chunk;
+}
+
 static term nif_unicode_characters_to_list(Context *ctx, int argc, term argv[])
 {
     enum CharDataEncoding in_encoding = UTF8Encoding;
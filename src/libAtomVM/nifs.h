@@ -32,7 +32,9 @@ extern "C" {
 
 #include "atom.h"
 #include "context.h"
+#include "defaultatoms.h"
 #include "exportedfunction.h"
+#include "memory.h"
 
 #define VALIDATE_VALUE(value, verify_function) \
     if (UNLIKELY(!verify_function((value)))) { \
@@ -48,6 +50,32 @@ extern "C" {
 
 const struct Nif *nifs_get(AtomString module, AtomString function, int arity);
 
+/**
+ * @brief Call a NIF with the heap space it needs.
+ *
+ * @details If the NIF declares its heap need with `heap_need_ptr` and the heap
+ * has not enough free space, the heap is collected once before the call, with
+ * the arguments as only live registers. The NIF then allocates on the heap
+ * without calling `memory_ensure_free`.
+ * @param ctx the calling process, with arguments in x registers.
+ * @param nif the NIF to call.
+ * @param argc the number of arguments.
+ * @returns the value returned by the NIF.
+ */
+static inline term nifs_call(Context *ctx, const struct Nif *nif, int argc)
+{
+    if (nif->heap_need_ptr) {
+        size_t heap_need = nif->heap_need_ptr(ctx, argc, ctx->x);
+        if (context_avail_free_memory(ctx) < heap_need) {
+            context_clean_registers(ctx, argc);
+            if (UNLIKELY(memory_ensure_free_opt(ctx, heap_need, MEMORY_NO_SHRINK) != MEMORY_GC_OK)) {
+                RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+            }
+        }
+    }
+    return nif->nif_ptr(ctx, argc, ctx->x);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -702,6 +702,21 @@ typedef union
         fprintf(stderr, "going to jump to %i\n", i)
 #endif
 
+// In the execute loop, opcodes are dispatched through a table of handler
+// addresses (labels as values) instead of the switch: this removes the range
+// check and lets the compiler replicate the indirect jump at the end of every
+// handler, so each opcode jumps directly to the next one (threaded code).
+#ifdef IMPL_EXECUTE_LOOP
+    #define DISPATCH_TARGET(opcode) opcode##_HANDLER:
+    #define DISPATCH_ENTRY(opcode) [opcode] = &&opcode##_HANDLER
+    #define DISPATCH_OPCODE() goto *dispatch_table[code[i]]
+#else
+    // The loader refers to a constant declared by the DISPATCH_ENTRY of each
+    // opcode it accepts, so an opcode missing from the table fails to compile
+    #define DISPATCH_TARGET(opcode) (void) opcode##_DISPATCHED;
+    #define DISPATCH_ENTRY(opcode) opcode##_DISPATCHED
+#endif
+
 #define SCHEDULE_NEXT(restore_mod, restore_to) \
     {                                                                                             \
         ctx->saved_ip = restore_to;                                                               \
@@ -879,12 +894,12 @@ typedef union
         AtomString function_name = globalcontext_atomstring_from_term(glb, index_or_function); \
         struct Nif *nif = (struct Nif *) nifs_get(module_name, function_name, fun_arity); \
         if (!IS_NULL_PTR(nif)) {                                        \
-            term return_value = nif->nif_ptr(ctx, fun_arity, ctx->x);   \
+            term return_value = nifs_call(ctx, nif, fun_arity);         \
             NEXT_INSTRUCTION(next_off);                                 \
             PROCESS_MAYBE_TRAP_RETURN_VALUE(return_value);              \
             ctx->x[0] = return_value;                                   \
             if (ctx->heap.root->next) {                                 \
-                if (UNLIKELY(memory_ensure_free_opt(ctx, 0, MEMORY_FORCE_SHRINK) != MEMORY_GC_OK)) { \
+                if (UNLIKELY(memory_collect_heap_fragments(ctx) != MEMORY_GC_OK)) { \
                     RAISE_ERROR(OUT_OF_MEMORY_ATOM);                    \
                 }                                                       \
             }                                                           \
@@ -1318,7 +1333,7 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
 
     struct Nif *nif = (struct Nif *) nifs_get(module_name, function_name, arity);
     if (nif) {
-        *return_value = nif->nif_ptr(ctx, arity, ctx->x);
+        *return_value = nifs_call(ctx, nif, arity);
         return true;
     }
 
@@ -1420,6 +1435,47 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
 
 #endif
 
+#ifdef IMPL_CODE_LOADER
+
+// Decodes a select_val choice at load time. Only atoms and small integers are
+// put in select tables: any other operand prevents the table from being built.
+static bool select_value_from_compact_term(const Module *mod, const uint8_t *compact_term, term *value)
+{
+    uint8_t first_byte = compact_term[0];
+    switch (first_byte & 0xF) {
+        case COMPACT_INTEGER:
+            *value = term_from_int4(first_byte >> 4);
+            return true;
+
+        case COMPACT_ATOM:
+            if (first_byte == COMPACT_ATOM) {
+                *value = term_nil();
+            } else {
+                *value = module_get_atom_term_by_id(mod, first_byte >> 4);
+            }
+            return true;
+
+        case COMPACT_LARGE_INTEGER:
+            if ((first_byte & COMPACT_LARGE_IMM_MASK) == COMPACT_11BITS_VALUE) {
+                *value = term_from_int11(((first_byte & 0xE0) << 3) | compact_term[1]);
+                return true;
+            }
+            return false;
+
+        case COMPACT_LARGE_ATOM:
+            if ((first_byte & COMPACT_LARGE_IMM_MASK) == COMPACT_11BITS_VALUE) {
+                *value = module_get_atom_term_by_id(mod, ((first_byte & 0xE0) << 3) | compact_term[1]);
+                return true;
+            }
+            return false;
+
+        default:
+            return false;
+    }
+}
+
+#endif
+
 #ifndef __clang__
 #pragma GCC diagnostic push
 #ifdef __GNUC__
@@ -1502,7 +1558,184 @@ HOT_FUNC int scheduler_entry_point(GlobalContext *glb)
     term *x_regs;
     uintptr_t i;
     int remaining_reductions;
+#endif
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#ifndef __clang__
+#pragma GCC diagnostic ignored "-Woverride-init"
+#else
+#pragma clang diagnostic ignored "-Winitializer-overrides"
+#endif
+#ifdef IMPL_EXECUTE_LOOP
+    static const void *const dispatch_table[256] = {
+        [0 ... 255] = &&undecoded_opcode,
+#else
+    enum DispatchedOpcode
+    {
+#endif
+        DISPATCH_ENTRY(OP_LABEL),
+        DISPATCH_ENTRY(OP_FUNC_INFO),
+        DISPATCH_ENTRY(OP_INT_CALL_END),
+        DISPATCH_ENTRY(OP_CALL),
+        DISPATCH_ENTRY(OP_CALL_LAST),
+        DISPATCH_ENTRY(OP_CALL_ONLY),
+        DISPATCH_ENTRY(OP_CALL_EXT),
+        DISPATCH_ENTRY(OP_CALL_EXT_LAST),
+        DISPATCH_ENTRY(OP_BIF0),
+        DISPATCH_ENTRY(OP_BIF1),
+        DISPATCH_ENTRY(OP_BIF2),
+        DISPATCH_ENTRY(OP_ALLOCATE),
+        DISPATCH_ENTRY(OP_ALLOCATE_HEAP),
+        DISPATCH_ENTRY(OP_ALLOCATE_ZERO),
+        DISPATCH_ENTRY(OP_ALLOCATE_HEAP_ZERO),
+        DISPATCH_ENTRY(OP_TEST_HEAP),
+        DISPATCH_ENTRY(OP_KILL),
+        DISPATCH_ENTRY(OP_DEALLOCATE),
+        DISPATCH_ENTRY(OP_RETURN),
+        DISPATCH_ENTRY(OP_SEND),
+        DISPATCH_ENTRY(OP_REMOVE_MESSAGE),
+        DISPATCH_ENTRY(OP_TIMEOUT),
+        DISPATCH_ENTRY(OP_LOOP_REC),
+        DISPATCH_ENTRY(OP_LOOP_REC_END),
+        DISPATCH_ENTRY(OP_WAIT),
+        DISPATCH_ENTRY(OP_WAIT_TIMEOUT),
+        DISPATCH_ENTRY(OP_IS_LT),
+        DISPATCH_ENTRY(OP_IS_GE),
+        DISPATCH_ENTRY(OP_IS_EQUAL),
+        DISPATCH_ENTRY(OP_IS_NOT_EQUAL),
+        DISPATCH_ENTRY(OP_IS_EQ_EXACT),
+        DISPATCH_ENTRY(OP_IS_NOT_EQ_EXACT),
+        DISPATCH_ENTRY(OP_IS_INTEGER),
+        DISPATCH_ENTRY(OP_IS_FLOAT),
+        DISPATCH_ENTRY(OP_IS_NUMBER),
+        DISPATCH_ENTRY(OP_IS_BINARY),
+        DISPATCH_ENTRY(OP_IS_LIST),
+        DISPATCH_ENTRY(OP_IS_NONEMPTY_LIST),
+        DISPATCH_ENTRY(OP_IS_NIL),
+        DISPATCH_ENTRY(OP_IS_ATOM),
+        DISPATCH_ENTRY(OP_IS_PID),
+        DISPATCH_ENTRY(OP_IS_REFERENCE),
+        DISPATCH_ENTRY(OP_IS_PORT),
+        DISPATCH_ENTRY(OP_IS_TUPLE),
+        DISPATCH_ENTRY(OP_TEST_ARITY),
+        DISPATCH_ENTRY(OP_SELECT_VAL),
+        DISPATCH_ENTRY(OP_SELECT_TUPLE_ARITY),
+        DISPATCH_ENTRY(OP_JUMP),
+        DISPATCH_ENTRY(OP_MOVE),
+        DISPATCH_ENTRY(OP_GET_LIST),
+        DISPATCH_ENTRY(OP_GET_TUPLE_ELEMENT),
+        DISPATCH_ENTRY(OP_SET_TUPLE_ELEMENT),
+        DISPATCH_ENTRY(OP_PUT_LIST),
+        DISPATCH_ENTRY(OP_PUT_TUPLE),
+        DISPATCH_ENTRY(OP_BADMATCH),
+        DISPATCH_ENTRY(OP_IF_END),
+        DISPATCH_ENTRY(OP_CASE_END),
+        DISPATCH_ENTRY(OP_CALL_FUN),
+        DISPATCH_ENTRY(OP_IS_FUNCTION),
+        DISPATCH_ENTRY(OP_CALL_EXT_ONLY),
+        DISPATCH_ENTRY(OP_MAKE_FUN2),
+        DISPATCH_ENTRY(OP_TRY),
+        DISPATCH_ENTRY(OP_TRY_END),
+        DISPATCH_ENTRY(OP_TRY_CASE),
+        DISPATCH_ENTRY(OP_TRY_CASE_END),
+        DISPATCH_ENTRY(OP_RAISE),
+        DISPATCH_ENTRY(OP_CATCH),
+        DISPATCH_ENTRY(OP_CATCH_END),
+        DISPATCH_ENTRY(OP_BS_ADD),
+        DISPATCH_ENTRY(OP_BS_INIT2),
+        DISPATCH_ENTRY(OP_BS_INIT_BITS),
+        DISPATCH_ENTRY(OP_BS_UTF8_SIZE),
+        DISPATCH_ENTRY(OP_BS_PUT_UTF8),
+        DISPATCH_ENTRY(OP_BS_GET_UTF8),
+        DISPATCH_ENTRY(OP_BS_SKIP_UTF8),
+        DISPATCH_ENTRY(OP_BS_UTF16_SIZE),
+        DISPATCH_ENTRY(OP_BS_PUT_UTF16),
+        DISPATCH_ENTRY(OP_BS_GET_UTF16),
+        DISPATCH_ENTRY(OP_BS_SKIP_UTF16),
+        DISPATCH_ENTRY(OP_BS_PUT_UTF32),
+        DISPATCH_ENTRY(OP_BS_GET_UTF32),
+        DISPATCH_ENTRY(OP_BS_SKIP_UTF32),
+        DISPATCH_ENTRY(OP_BS_INIT_WRITABLE),
+        DISPATCH_ENTRY(OP_BS_APPEND),
+        DISPATCH_ENTRY(OP_BS_PRIVATE_APPEND),
+        DISPATCH_ENTRY(OP_BS_PUT_INTEGER),
+        DISPATCH_ENTRY(OP_BS_PUT_BINARY),
+        DISPATCH_ENTRY(OP_BS_PUT_STRING),
+        DISPATCH_ENTRY(OP_BS_START_MATCH2),
+        DISPATCH_ENTRY(OP_BS_START_MATCH3),
+        DISPATCH_ENTRY(OP_BS_GET_POSITION),
+        DISPATCH_ENTRY(OP_BS_GET_TAIL),
+        DISPATCH_ENTRY(OP_BS_SET_POSITION),
+        DISPATCH_ENTRY(OP_BS_MATCH_STRING),
+        DISPATCH_ENTRY(OP_BS_SAVE2),
+        DISPATCH_ENTRY(OP_BS_RESTORE2),
+        DISPATCH_ENTRY(OP_BS_SKIP_BITS2),
+        DISPATCH_ENTRY(OP_BS_TEST_UNIT),
+        DISPATCH_ENTRY(OP_BS_TEST_TAIL2),
+        DISPATCH_ENTRY(OP_BS_GET_INTEGER2),
+        DISPATCH_ENTRY(OP_BS_GET_BINARY2),
+        DISPATCH_ENTRY(OP_BS_CONTEXT_TO_BINARY),
+        DISPATCH_ENTRY(OP_APPLY),
+        DISPATCH_ENTRY(OP_APPLY_LAST),
+        DISPATCH_ENTRY(OP_IS_BOOLEAN),
+        DISPATCH_ENTRY(OP_IS_FUNCTION2),
+        DISPATCH_ENTRY(OP_GC_BIF1),
+        DISPATCH_ENTRY(OP_GC_BIF2),
+        DISPATCH_ENTRY(OP_IS_BITSTR),
+        DISPATCH_ENTRY(OP_GC_BIF3),
+        DISPATCH_ENTRY(OP_TRIM),
+        DISPATCH_ENTRY(OP_RECV_MARK),
+        DISPATCH_ENTRY(OP_RECV_SET),
+        DISPATCH_ENTRY(OP_LINE),
+        DISPATCH_ENTRY(OP_PUT_MAP_ASSOC),
+        DISPATCH_ENTRY(OP_PUT_MAP_EXACT),
+        DISPATCH_ENTRY(OP_IS_MAP),
+        DISPATCH_ENTRY(OP_HAS_MAP_FIELDS),
+        DISPATCH_ENTRY(OP_GET_MAP_ELEMENTS),
+        DISPATCH_ENTRY(OP_IS_TAGGED_TUPLE),
+        DISPATCH_ENTRY(OP_FCLEARERROR),
+        DISPATCH_ENTRY(OP_FCHECKERROR),
+        DISPATCH_ENTRY(OP_FMOVE),
+        DISPATCH_ENTRY(OP_FCONV),
+        DISPATCH_ENTRY(OP_FADD),
+        DISPATCH_ENTRY(OP_FSUB),
+        DISPATCH_ENTRY(OP_FMUL),
+        DISPATCH_ENTRY(OP_FDIV),
+        DISPATCH_ENTRY(OP_FNEGATE),
+        DISPATCH_ENTRY(OP_BUILD_STACKTRACE),
+#ifdef ENABLE_OTP21
+        DISPATCH_ENTRY(OP_GET_HD),
+        DISPATCH_ENTRY(OP_GET_TL),
+#endif
+#ifdef ENABLE_OTP22
+        DISPATCH_ENTRY(OP_PUT_TUPLE2),
+#endif
+#ifdef ENABLE_OTP23
+        DISPATCH_ENTRY(OP_SWAP),
+        DISPATCH_ENTRY(OP_BS_START_MATCH4),
+#endif
+#ifdef ENABLE_OTP24
+        DISPATCH_ENTRY(OP_MAKE_FUN3),
+        DISPATCH_ENTRY(OP_INIT_YREGS),
+        DISPATCH_ENTRY(OP_RECV_MARKER_BIND),
+        DISPATCH_ENTRY(OP_RECV_MARKER_CLEAR),
+        DISPATCH_ENTRY(OP_RECV_MARKER_RESERVE),
+        DISPATCH_ENTRY(OP_RECV_MARKER_USE),
+#endif
+#ifdef ENABLE_OTP25
+        DISPATCH_ENTRY(OP_BS_CREATE_BIN),
+        DISPATCH_ENTRY(OP_CALL_FUN2),
+        DISPATCH_ENTRY(OP_BADRECORD),
+#endif
+#ifdef ENABLE_OTP26
+        DISPATCH_ENTRY(OP_UPDATE_RECORD),
+        DISPATCH_ENTRY(OP_BS_MATCH),
+#endif
+    };
+#pragma GCC diagnostic pop
 
+#ifdef IMPL_EXECUTE_LOOP
     Context *ctx = scheduler_run(glb);
 
 // This is where loop starts after context switching.
@@ -1536,8 +1769,15 @@ schedule_in:
     while (1) {
     TRACE("-- loop -- i = %d\n", (int) i);
 
+#ifdef IMPL_EXECUTE_LOOP
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+        DISPATCH_OPCODE();
+#pragma GCC diagnostic pop
+#endif
+
         switch (code[i]) {
-            case OP_LABEL: {
+            case OP_LABEL: DISPATCH_TARGET(OP_LABEL) {
                 uint32_t label;
                 int next_off = 1;
                 DECODE_LITERAL(label, code, i, next_off)
@@ -1554,7 +1794,7 @@ schedule_in:
                 break;
             }
 
-            case OP_FUNC_INFO: {
+            case OP_FUNC_INFO: DISPATCH_TARGET(OP_FUNC_INFO) {
                 int next_off = 1;
                 int module_atom;
                 DECODE_ATOM(module_atom, code, i, next_off)
@@ -1576,7 +1816,7 @@ schedule_in:
                 break;
             }
 
-            case OP_INT_CALL_END: {
+            case OP_INT_CALL_END: DISPATCH_TARGET(OP_INT_CALL_END) {
                 TRACE("int_call_end!\n");
 
             #ifdef IMPL_CODE_LOADER
@@ -1590,7 +1830,7 @@ schedule_in:
             #endif
             }
 
-            case OP_CALL: {
+            case OP_CALL: DISPATCH_TARGET(OP_CALL) {
                 int next_off = 1;
                 uint32_t arity;
                 DECODE_LITERAL(arity, code, i, next_off);
@@ -1620,7 +1860,7 @@ schedule_in:
                 break;
             }
 
-            case OP_CALL_LAST: {
+            case OP_CALL_LAST: DISPATCH_TARGET(OP_CALL_LAST) {
                 int next_off = 1;
                 uint32_t arity;
                 DECODE_LITERAL(arity, code, i, next_off);
@@ -1656,7 +1896,7 @@ schedule_in:
                 break;
             }
 
-            case OP_CALL_ONLY: {
+            case OP_CALL_ONLY: DISPATCH_TARGET(OP_CALL_ONLY) {
                 int next_off = 1;
                 uint32_t arity;
                 DECODE_LITERAL(arity, code, i, next_off);
@@ -1686,7 +1926,7 @@ schedule_in:
                 break;
             }
 
-            case OP_CALL_EXT: {
+            case OP_CALL_EXT: DISPATCH_TARGET(OP_CALL_EXT) {
                 int next_off = 1;
                 uint32_t arity;
                 DECODE_LITERAL(arity, code, i, next_off);
@@ -1722,11 +1962,11 @@ schedule_in:
                     switch (func->type) {
                         case NIFFunctionType: {
                             const struct Nif *nif = EXPORTED_FUNCTION_TO_NIF(func);
-                            term return_value = nif->nif_ptr(ctx, arity, ctx->x);
+                            term return_value = nifs_call(ctx, nif, arity);
                             PROCESS_MAYBE_TRAP_RETURN_VALUE_RESTORE_I(return_value, orig_i);
                             ctx->x[0] = return_value;
                             if (ctx->heap.root->next) {
-                                if (UNLIKELY(memory_ensure_free_opt(ctx, 0, MEMORY_FORCE_SHRINK) != MEMORY_GC_OK)) {
+                                if (UNLIKELY(memory_collect_heap_fragments(ctx) != MEMORY_GC_OK)) {
                                     RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                                 }
                             }
@@ -1770,7 +2010,7 @@ schedule_in:
                 break;
             }
 
-            case OP_CALL_EXT_LAST: {
+            case OP_CALL_EXT_LAST: DISPATCH_TARGET(OP_CALL_EXT_LAST) {
                 int next_off = 1;
                 uint32_t arity;
                 DECODE_LITERAL(arity, code, i, next_off);
@@ -1800,7 +2040,7 @@ schedule_in:
                     switch (func->type) {
                         case NIFFunctionType: {
                             const struct Nif *nif = EXPORTED_FUNCTION_TO_NIF(func);
-                            term return_value = nif->nif_ptr(ctx, arity, ctx->x);
+                            term return_value = nifs_call(ctx, nif, arity);
                             PROCESS_MAYBE_TRAP_RETURN_VALUE_LAST(return_value);
                             ctx->x[0] = return_value;
 
@@ -1812,7 +2052,7 @@ schedule_in:
                             ctx->e += (n_words + 1);
 
                             if (ctx->heap.root->next) {
-                                if (UNLIKELY(memory_ensure_free_opt(ctx, 0, MEMORY_FORCE_SHRINK) != MEMORY_GC_OK)) {
+                                if (UNLIKELY(memory_collect_heap_fragments(ctx) != MEMORY_GC_OK)) {
                                     RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                                 }
                             }
@@ -1873,7 +2113,7 @@ schedule_in:
                 break;
             }
 
-            case OP_BIF0: {
+            case OP_BIF0: DISPATCH_TARGET(OP_BIF0) {
                 int next_off = 1;
                 uint32_t bif;
                 DECODE_LITERAL(bif, code, i, next_off);
@@ -1899,7 +2139,7 @@ schedule_in:
             }
 
             //TODO: implement me
-            case OP_BIF1: {
+            case OP_BIF1: DISPATCH_TARGET(OP_BIF1) {
                 int next_off = 1;
                 uint32_t fail_label;
                 DECODE_LABEL(fail_label, code, i, next_off);
@@ -1936,7 +2176,7 @@ schedule_in:
             }
 
             //TODO: implement me
-            case OP_BIF2: {
+            case OP_BIF2: DISPATCH_TARGET(OP_BIF2) {
                 int next_off = 1;
                 uint32_t fail_label;
                 DECODE_LABEL(fail_label, code, i, next_off);
@@ -1975,7 +2215,7 @@ schedule_in:
                 break;
             }
 
-            case OP_ALLOCATE: {
+            case OP_ALLOCATE: DISPATCH_TARGET(OP_ALLOCATE) {
                 int next_off = 1;
                 uint32_t stack_need;
                 DECODE_LITERAL(stack_need, code, i, next_off);
@@ -1995,7 +2235,7 @@ schedule_in:
                 #ifdef IMPL_EXECUTE_LOOP
                     context_clean_registers(ctx, live);
 
-                    if (ctx->heap.root->next || ((ctx->heap.heap_ptr > ctx->e - (stack_need + 1)))) {
+                    if (context_stack_in_fragment(ctx) || ((ctx->heap.heap_ptr > ctx->e - (stack_need + 1)))) {
                         if (UNLIKELY(memory_ensure_free_opt(ctx, stack_need + 1, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
                             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                         }
@@ -2008,7 +2248,7 @@ schedule_in:
                 break;
             }
 
-            case OP_ALLOCATE_HEAP: {
+            case OP_ALLOCATE_HEAP: DISPATCH_TARGET(OP_ALLOCATE_HEAP) {
                 int next_off = 1;
                 uint32_t stack_need;
                 DECODE_LITERAL(stack_need, code, i, next_off);
@@ -2031,7 +2271,7 @@ schedule_in:
                 #ifdef IMPL_EXECUTE_LOOP
                     context_clean_registers(ctx, live);
 
-                    if (ctx->heap.root->next || ((ctx->heap.heap_ptr + heap_need) > ctx->e - (stack_need + 1))) {
+                    if (context_stack_in_fragment(ctx) || ((ctx->heap.heap_ptr + heap_need) > ctx->e - (stack_need + 1))) {
                         if (UNLIKELY(memory_ensure_free_opt(ctx, heap_need + stack_need + 1, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
                             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                         }
@@ -2044,7 +2284,7 @@ schedule_in:
                 break;
             }
 
-            case OP_ALLOCATE_ZERO: {
+            case OP_ALLOCATE_ZERO: DISPATCH_TARGET(OP_ALLOCATE_ZERO) {
                 int next_off = 1;
                 uint32_t stack_need;
                 DECODE_LITERAL(stack_need, code, i, next_off);
@@ -2064,7 +2304,7 @@ schedule_in:
                 #ifdef IMPL_EXECUTE_LOOP
                     context_clean_registers(ctx, live);
 
-                    if (ctx->heap.root->next || ((ctx->heap.heap_ptr > ctx->e - (stack_need + 1)))) {
+                    if (context_stack_in_fragment(ctx) || ((ctx->heap.heap_ptr > ctx->e - (stack_need + 1)))) {
                         if (UNLIKELY(memory_ensure_free_opt(ctx, stack_need + 1, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
                             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                         }
@@ -2081,7 +2321,7 @@ schedule_in:
                 break;
             }
 
-            case OP_ALLOCATE_HEAP_ZERO: {
+            case OP_ALLOCATE_HEAP_ZERO: DISPATCH_TARGET(OP_ALLOCATE_HEAP_ZERO) {
                 int next_off = 1;
                 uint32_t stack_need;
                 DECODE_LITERAL(stack_need, code, i, next_off);
@@ -2104,7 +2344,7 @@ schedule_in:
                 #ifdef IMPL_EXECUTE_LOOP
                     context_clean_registers(ctx, live);
 
-                    if (ctx->heap.root->next || ((ctx->heap.heap_ptr + heap_need) > ctx->e - (stack_need + 1))) {
+                    if (context_stack_in_fragment(ctx) || ((ctx->heap.heap_ptr + heap_need) > ctx->e - (stack_need + 1))) {
                         if (UNLIKELY(memory_ensure_free_opt(ctx, heap_need + stack_need + 1, MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
                             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                         }
@@ -2120,7 +2360,7 @@ schedule_in:
                 break;
             }
 
-            case OP_TEST_HEAP: {
+            case OP_TEST_HEAP: DISPATCH_TARGET(OP_TEST_HEAP) {
                 int next_off = 1;
                 uint32_t heap_need;
                 DECODE_ALLOCATOR_LIST(heap_need, code, i, next_off);
@@ -2154,7 +2394,7 @@ schedule_in:
                 break;
             }
 
-            case OP_KILL: {
+            case OP_KILL: DISPATCH_TARGET(OP_KILL) {
                 int next_off = 1;
                 uint32_t target;
                 DECODE_YREG(target, code, i, next_off);
@@ -2170,7 +2410,7 @@ schedule_in:
                 break;
             }
 
-            case OP_DEALLOCATE: {
+            case OP_DEALLOCATE: DISPATCH_TARGET(OP_DEALLOCATE) {
                 int next_off = 1;
                 uint32_t n_words;
                 DECODE_LITERAL(n_words, code, i, next_off);
@@ -2185,7 +2425,7 @@ schedule_in:
                     ctx->e += n_words + 1;
                     DEBUG_DUMP_STACK(ctx);
                     if (ctx->heap.root->next) {
-                        if (UNLIKELY(memory_ensure_free_opt(ctx, 0, MEMORY_FORCE_SHRINK) != MEMORY_GC_OK)) {
+                        if (UNLIKELY(memory_collect_heap_fragments(ctx) != MEMORY_GC_OK)) {
                             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                         }
                     }
@@ -2195,7 +2435,7 @@ schedule_in:
                 break;
             }
 
-            case OP_RETURN: {
+            case OP_RETURN: DISPATCH_TARGET(OP_RETURN) {
                 TRACE("return/0\n");
 
                 #ifdef IMPL_EXECUTE_LOOP
@@ -2215,7 +2455,7 @@ schedule_in:
             }
 
             //TODO: implement send/0
-            case OP_SEND: {
+            case OP_SEND: DISPATCH_TARGET(OP_SEND) {
                 #ifdef IMPL_CODE_LOADER
                     TRACE("send/0\n");
                 #endif
@@ -2224,7 +2464,7 @@ schedule_in:
                     int local_process_id = term_to_local_process_id(ctx->x[0]);
                     TRACE("send/0 target_pid=%i\n", local_process_id);
                     TRACE_SEND(ctx, ctx->x[0], ctx->x[1]);
-                    globalcontext_send_message(ctx->global, local_process_id, ctx->x[1]);
+                    globalcontext_send_message_on_scheduler(ctx->global, context_scheduler_id(ctx), local_process_id, ctx->x[1]);
 
                     ctx->x[0] = ctx->x[1];
                 #endif
@@ -2233,7 +2473,7 @@ schedule_in:
                 break;
             }
 
-            case OP_REMOVE_MESSAGE: {
+            case OP_REMOVE_MESSAGE: DISPATCH_TARGET(OP_REMOVE_MESSAGE) {
                 TRACE("remove_message/0\n");
 
                 #ifdef IMPL_EXECUTE_LOOP
@@ -2244,7 +2484,7 @@ schedule_in:
 #pragma GCC diagnostic ignored "-Wpedantic"
                     PROCESS_SIGNAL_MESSAGES();
 #pragma GCC diagnostic pop
-                    mailbox_remove_message(&ctx->mailbox, &ctx->heap);
+                    context_remove_message(ctx);
                     // Cannot GC now as remove_message is GC neutral
                 #endif
 
@@ -2252,7 +2492,7 @@ schedule_in:
                 break;
             }
 
-            case OP_TIMEOUT: {
+            case OP_TIMEOUT: DISPATCH_TARGET(OP_TIMEOUT) {
                 TRACE("timeout/0\n");
 
                 #ifdef IMPL_EXECUTE_LOOP
@@ -2265,7 +2505,7 @@ schedule_in:
                 break;
             }
 
-            case OP_LOOP_REC: {
+            case OP_LOOP_REC: DISPATCH_TARGET(OP_LOOP_REC) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2299,7 +2539,7 @@ schedule_in:
                 break;
             }
 
-            case OP_LOOP_REC_END: {
+            case OP_LOOP_REC_END: DISPATCH_TARGET(OP_LOOP_REC_END) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off);
@@ -2321,7 +2561,7 @@ schedule_in:
             }
 
             //TODO: implement wait/1
-            case OP_WAIT: {
+            case OP_WAIT: DISPATCH_TARGET(OP_WAIT) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2347,7 +2587,7 @@ schedule_in:
             }
 
             //TODO: implement wait_timeout/2
-            case OP_WAIT_TIMEOUT: {
+            case OP_WAIT_TIMEOUT: DISPATCH_TARGET(OP_WAIT_TIMEOUT) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2441,7 +2681,7 @@ wait_timeout_trap_handler:
             }
 #endif
 
-            case OP_IS_LT: {
+            case OP_IS_LT: DISPATCH_TARGET(OP_IS_LT) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off);
@@ -2473,7 +2713,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_GE: {
+            case OP_IS_GE: DISPATCH_TARGET(OP_IS_GE) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off);
@@ -2505,7 +2745,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_EQUAL: {
+            case OP_IS_EQUAL: DISPATCH_TARGET(OP_IS_EQUAL) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2537,7 +2777,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_NOT_EQUAL: {
+            case OP_IS_NOT_EQUAL: DISPATCH_TARGET(OP_IS_NOT_EQUAL) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2569,7 +2809,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_EQ_EXACT: {
+            case OP_IS_EQ_EXACT: DISPATCH_TARGET(OP_IS_EQ_EXACT) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2601,7 +2841,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_NOT_EQ_EXACT: {
+            case OP_IS_NOT_EQ_EXACT: DISPATCH_TARGET(OP_IS_NOT_EQ_EXACT) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2633,7 +2873,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_INTEGER: {
+            case OP_IS_INTEGER: DISPATCH_TARGET(OP_IS_INTEGER) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2660,7 +2900,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_FLOAT: {
+            case OP_IS_FLOAT: DISPATCH_TARGET(OP_IS_FLOAT) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2687,7 +2927,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_NUMBER: {
+            case OP_IS_NUMBER: DISPATCH_TARGET(OP_IS_NUMBER) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2715,7 +2955,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_BINARY: {
+            case OP_IS_BINARY: DISPATCH_TARGET(OP_IS_BINARY) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2741,7 +2981,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_LIST: {
+            case OP_IS_LIST: DISPATCH_TARGET(OP_IS_LIST) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2767,7 +3007,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_NONEMPTY_LIST: {
+            case OP_IS_NONEMPTY_LIST: DISPATCH_TARGET(OP_IS_NONEMPTY_LIST) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2793,7 +3033,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_NIL: {
+            case OP_IS_NIL: DISPATCH_TARGET(OP_IS_NIL) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2819,7 +3059,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_ATOM: {
+            case OP_IS_ATOM: DISPATCH_TARGET(OP_IS_ATOM) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2845,7 +3085,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_PID: {
+            case OP_IS_PID: DISPATCH_TARGET(OP_IS_PID) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2871,7 +3111,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_REFERENCE: {
+            case OP_IS_REFERENCE: DISPATCH_TARGET(OP_IS_REFERENCE) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2897,7 +3137,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_PORT: {
+            case OP_IS_PORT: DISPATCH_TARGET(OP_IS_PORT) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2934,7 +3174,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_TUPLE: {
+            case OP_IS_TUPLE: DISPATCH_TARGET(OP_IS_TUPLE) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -2961,7 +3201,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_TEST_ARITY: {
+            case OP_TEST_ARITY: DISPATCH_TARGET(OP_TEST_ARITY) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off);
@@ -2990,7 +3230,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_SELECT_VAL: {
+            case OP_SELECT_VAL: DISPATCH_TARGET(OP_SELECT_VAL) {
                 int next_off = 1;
                 term src_value;
                 DECODE_COMPACT_TERM(src_value, code, i, next_off)
@@ -3006,13 +3246,32 @@ wait_timeout_trap_handler:
 
                 #ifdef IMPL_CODE_LOADER
                     UNUSED(src_value);
+                    struct SelectEntry *entries = NULL;
+                    if (size / 2 >= SELECT_TABLE_MIN_ENTRIES) {
+                        entries = malloc((size / 2) * sizeof(struct SelectEntry));
+                    }
                 #endif
 
                 #ifdef IMPL_EXECUTE_LOOP
+                    if (size / 2 >= SELECT_TABLE_MIN_ENTRIES) {
+                        const struct SelectTable *table = module_get_select_table(mod, i);
+                        if (table) {
+                            uint32_t label = module_select_table_lookup(table, src_value);
+                            JUMP_TO_ADDRESS(mod->labels[label ? label : default_label]);
+                            break;
+                        }
+                    }
                     void *jump_to_address = NULL;
                 #endif
 
                 for (uint32_t j = 0; j < size / 2; j++) {
+                    #ifdef IMPL_CODE_LOADER
+                        if (entries && !select_value_from_compact_term(mod, code + i + next_off, &entries[j].value)) {
+                            free(entries);
+                            entries = NULL;
+                        }
+                    #endif
+
                     term cmp_value;
                     DECODE_COMPACT_TERM(cmp_value, code, i, next_off)
                     uint32_t jmp_label;
@@ -3020,11 +3279,15 @@ wait_timeout_trap_handler:
 
                     #ifdef IMPL_CODE_LOADER
                         UNUSED(cmp_value);
+                        if (entries) {
+                            entries[j].label = jmp_label;
+                        }
                     #endif
 
                     #ifdef IMPL_EXECUTE_LOOP
-                        if (!jump_to_address && (src_value == cmp_value)) {
+                        if (src_value == cmp_value) {
                             jump_to_address = mod->labels[jmp_label];
+                            break;
                         }
                     #endif
                 }
@@ -3038,13 +3301,16 @@ wait_timeout_trap_handler:
                 #endif
 
                 #ifdef IMPL_CODE_LOADER
+                    if (entries) {
+                        module_add_select_table(mod, i, entries, size / 2);
+                    }
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
                 break;
             }
 
-            case OP_SELECT_TUPLE_ARITY: {
+            case OP_SELECT_TUPLE_ARITY: DISPATCH_TARGET(OP_SELECT_TUPLE_ARITY) {
                 int next_off = 1;
                 term src_value;
                 DECODE_COMPACT_TERM(src_value, code, i, next_off)
@@ -3060,37 +3326,49 @@ wait_timeout_trap_handler:
 
                 #ifdef IMPL_CODE_LOADER
                     UNUSED(src_value);
+                    struct SelectEntry *entries = NULL;
+                    if (size / 2 >= SELECT_TABLE_MIN_ENTRIES) {
+                        entries = malloc((size / 2) * sizeof(struct SelectEntry));
+                    }
                 #endif
 
                 #ifdef IMPL_EXECUTE_LOOP
-                    void *jump_to_address = NULL;
-                #endif
-
-                #ifdef IMPL_EXECUTE_LOOP
-                if (LIKELY(term_is_tuple(src_value))) {
+                    if (!term_is_tuple(src_value)) {
+                        JUMP_TO_ADDRESS(mod->labels[default_label]);
+                        break;
+                    }
                     int arity = term_get_tuple_arity(src_value);
+                    if (size / 2 >= SELECT_TABLE_MIN_ENTRIES) {
+                        const struct SelectTable *table = module_get_select_table(mod, i);
+                        if (table) {
+                            uint32_t label = module_select_table_lookup(table, term_from_int(arity));
+                            JUMP_TO_ADDRESS(mod->labels[label ? label : default_label]);
+                            break;
+                        }
+                    }
+                    void *jump_to_address = NULL;
                 #endif
 
-                    for (uint32_t j = 0; j < size / 2; j++) {
-                        uint32_t cmp_value;
-                        DECODE_LITERAL(cmp_value, code, i, next_off)
-                        uint32_t jmp_label;
-                        DECODE_LABEL(jmp_label, code, i, next_off)
+                for (uint32_t j = 0; j < size / 2; j++) {
+                    uint32_t cmp_value;
+                    DECODE_LITERAL(cmp_value, code, i, next_off)
+                    uint32_t jmp_label;
+                    DECODE_LABEL(jmp_label, code, i, next_off)
 
-                        #ifdef IMPL_CODE_LOADER
-                            UNUSED(cmp_value);
-                        #endif
+                    #ifdef IMPL_CODE_LOADER
+                        if (entries) {
+                            entries[j].value = term_from_int(cmp_value);
+                            entries[j].label = jmp_label;
+                        }
+                    #endif
 
-                        #ifdef IMPL_EXECUTE_LOOP
-                            //TODO: check if src_value is a tuple
-                            if (!jump_to_address && ((uint32_t) arity == cmp_value)) {
-                                jump_to_address = mod->labels[jmp_label];
-                            }
-                        #endif
-                    }
-                #ifdef IMPL_EXECUTE_LOOP
+                    #ifdef IMPL_EXECUTE_LOOP
+                        if ((uint32_t) arity == cmp_value) {
+                            jump_to_address = mod->labels[jmp_label];
+                            break;
+                        }
+                    #endif
                 }
-                #endif
 
                 #ifdef IMPL_EXECUTE_LOOP
                     if (!jump_to_address) {
@@ -3101,13 +3379,16 @@ wait_timeout_trap_handler:
                 #endif
 
                 #ifdef IMPL_CODE_LOADER
+                    if (entries) {
+                        module_add_select_table(mod, i, entries, size / 2);
+                    }
                     NEXT_INSTRUCTION(next_off);
                 #endif
 
                 break;
             }
 
-            case OP_JUMP: {
+            case OP_JUMP: DISPATCH_TARGET(OP_JUMP) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -3134,7 +3415,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_MOVE: {
+            case OP_MOVE: DISPATCH_TARGET(OP_MOVE) {
                 int next_off = 1;
                 term src_value;
                 DECODE_COMPACT_TERM(src_value, code, i, next_off);
@@ -3157,7 +3438,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_GET_LIST: {
+            case OP_GET_LIST: DISPATCH_TARGET(OP_GET_LIST) {
                 int next_off = 1;
                 term src_value;
                 DECODE_COMPACT_TERM(src_value, code, i, next_off)
@@ -3187,7 +3468,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_GET_TUPLE_ELEMENT: {
+            case OP_GET_TUPLE_ELEMENT: DISPATCH_TARGET(OP_GET_TUPLE_ELEMENT) {
                 int next_off = 1;
                 term src_value;
                 DECODE_COMPACT_TERM(src_value, code, i, next_off);
@@ -3217,7 +3498,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_SET_TUPLE_ELEMENT: {
+            case OP_SET_TUPLE_ELEMENT: DISPATCH_TARGET(OP_SET_TUPLE_ELEMENT) {
                 int next_off = 1;
                 term new_element;
                 DECODE_COMPACT_TERM(new_element, code, i, next_off);
@@ -3245,7 +3526,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_PUT_LIST: {
+            case OP_PUT_LIST: DISPATCH_TARGET(OP_PUT_LIST) {
 
                 int next_off = 1;
                 term head;
@@ -3276,7 +3557,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_PUT_TUPLE: {
+            case OP_PUT_TUPLE: DISPATCH_TARGET(OP_PUT_TUPLE) {
                 int next_off = 1;
                 uint32_t size;
                 DECODE_LITERAL(size, code, i, next_off);
@@ -3315,7 +3596,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BADMATCH: {
+            case OP_BADMATCH: DISPATCH_TARGET(OP_BADMATCH) {
                 #ifdef IMPL_EXECUTE_LOOP
                     // We can gc as we are raising
                     if (UNLIKELY(memory_ensure_free_opt(ctx, TUPLE_SIZE(2), MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
@@ -3349,7 +3630,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IF_END: {
+            case OP_IF_END: DISPATCH_TARGET(OP_IF_END) {
                 TRACE("if_end/0\n");
 
                 #ifdef IMPL_EXECUTE_LOOP
@@ -3366,7 +3647,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_CASE_END: {
+            case OP_CASE_END: DISPATCH_TARGET(OP_CASE_END) {
                 #ifdef IMPL_EXECUTE_LOOP
                     // We can gc as we are raising
                     if (UNLIKELY(memory_ensure_free_opt(ctx, TUPLE_SIZE(2), MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
@@ -3400,7 +3681,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_CALL_FUN: {
+            case OP_CALL_FUN: DISPATCH_TARGET(OP_CALL_FUN) {
                 int next_off = 1;
                 uint32_t args_count;
                 DECODE_LITERAL(args_count, code, i, next_off)
@@ -3436,7 +3717,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-           case OP_IS_FUNCTION: {
+            case OP_IS_FUNCTION: DISPATCH_TARGET(OP_IS_FUNCTION) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -3463,7 +3744,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_CALL_EXT_ONLY: {
+            case OP_CALL_EXT_ONLY: DISPATCH_TARGET(OP_CALL_EXT_ONLY) {
                 int next_off = 1;
                 uint32_t arity;
                 DECODE_LITERAL(arity, code, i, next_off);
@@ -3494,12 +3775,12 @@ wait_timeout_trap_handler:
                     switch (func->type) {
                         case NIFFunctionType: {
                             const struct Nif *nif = EXPORTED_FUNCTION_TO_NIF(func);
-                            term return_value = nif->nif_ptr(ctx, arity, ctx->x);
+                            term return_value = nifs_call(ctx, nif, arity);
                             PROCESS_MAYBE_TRAP_RETURN_VALUE_LAST(return_value);
                             ctx->x[0] = return_value;
 
                             if (ctx->heap.root->next) {
-                                if (UNLIKELY(memory_ensure_free_opt(ctx, 0, MEMORY_FORCE_SHRINK) != MEMORY_GC_OK)) {
+                                if (UNLIKELY(memory_collect_heap_fragments(ctx) != MEMORY_GC_OK)) {
                                     RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                                 }
                             }
@@ -3548,7 +3829,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_MAKE_FUN2: {
+            case OP_MAKE_FUN2: DISPATCH_TARGET(OP_MAKE_FUN2) {
                 int next_off = 1;
                 uint32_t fun_index;
                 DECODE_LITERAL(fun_index, code, i, next_off)
@@ -3567,7 +3848,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_TRY: {
+            case OP_TRY: DISPATCH_TARGET(OP_TRY) {
                 int next_off = 1;
                 dreg_t dreg;
                 dreg_type_t dreg_type;
@@ -3587,7 +3868,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_TRY_END: {
+            case OP_TRY_END: DISPATCH_TARGET(OP_TRY_END) {
                 int next_off = 1;
                 dreg_t dreg;
                 dreg_type_t dreg_type;
@@ -3604,7 +3885,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_TRY_CASE: {
+            case OP_TRY_CASE: DISPATCH_TARGET(OP_TRY_CASE) {
                 int next_off = 1;
                 dreg_t dreg;
                 dreg_type_t dreg_type;
@@ -3621,7 +3902,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_TRY_CASE_END: {
+            case OP_TRY_CASE_END: DISPATCH_TARGET(OP_TRY_CASE_END) {
                 #ifdef IMPL_EXECUTE_LOOP
                     // We can gc as we are raising
                     if (UNLIKELY(memory_ensure_free_opt(ctx, TUPLE_SIZE(2), MEMORY_CAN_SHRINK) != MEMORY_GC_OK)) {
@@ -3652,7 +3933,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_RAISE: {
+            case OP_RAISE: DISPATCH_TARGET(OP_RAISE) {
                 int next_off = 1;
                 term stacktrace;
                 DECODE_COMPACT_TERM(stacktrace, code, i, next_off);
@@ -3677,7 +3958,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_CATCH: {
+            case OP_CATCH: DISPATCH_TARGET(OP_CATCH) {
                 int next_off = 1;
                 dreg_t dreg;
                 dreg_type_t dreg_type;
@@ -3697,7 +3978,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_CATCH_END: {
+            case OP_CATCH_END: DISPATCH_TARGET(OP_CATCH_END) {
                 int next_off = 1;
                 dreg_t dreg;
                 dreg_type_t dreg_type;
@@ -3748,7 +4029,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_ADD: {
+            case OP_BS_ADD: DISPATCH_TARGET(OP_BS_ADD) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -3780,7 +4061,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_INIT2: {
+            case OP_BS_INIT2: DISPATCH_TARGET(OP_BS_INIT2) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -3823,7 +4104,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_INIT_BITS: {
+            case OP_BS_INIT_BITS: DISPATCH_TARGET(OP_BS_INIT_BITS) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -3872,7 +4153,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_UTF8_SIZE: {
+            case OP_BS_UTF8_SIZE: DISPATCH_TARGET(OP_BS_UTF8_SIZE) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -3899,7 +4180,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_PUT_UTF8: {
+            case OP_BS_PUT_UTF8: DISPATCH_TARGET(OP_BS_PUT_UTF8) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -3938,7 +4219,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_GET_UTF8: {
+            case OP_BS_GET_UTF8: DISPATCH_TARGET(OP_BS_GET_UTF8) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -3981,7 +4262,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_SKIP_UTF8: {
+            case OP_BS_SKIP_UTF8: DISPATCH_TARGET(OP_BS_SKIP_UTF8) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4020,7 +4301,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-           case OP_BS_UTF16_SIZE: {
+            case OP_BS_UTF16_SIZE: DISPATCH_TARGET(OP_BS_UTF16_SIZE) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4047,7 +4328,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_PUT_UTF16: {
+            case OP_BS_PUT_UTF16: DISPATCH_TARGET(OP_BS_PUT_UTF16) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4086,7 +4367,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_GET_UTF16: {
+            case OP_BS_GET_UTF16: DISPATCH_TARGET(OP_BS_GET_UTF16) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4129,7 +4410,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_SKIP_UTF16: {
+            case OP_BS_SKIP_UTF16: DISPATCH_TARGET(OP_BS_SKIP_UTF16) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4168,7 +4449,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_PUT_UTF32: {
+            case OP_BS_PUT_UTF32: DISPATCH_TARGET(OP_BS_PUT_UTF32) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4206,7 +4487,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_GET_UTF32: {
+            case OP_BS_GET_UTF32: DISPATCH_TARGET(OP_BS_GET_UTF32) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4248,7 +4529,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_SKIP_UTF32: {
+            case OP_BS_SKIP_UTF32: DISPATCH_TARGET(OP_BS_SKIP_UTF32) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4286,7 +4567,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_INIT_WRITABLE: {
+            case OP_BS_INIT_WRITABLE: DISPATCH_TARGET(OP_BS_INIT_WRITABLE) {
                 int next_off = 1;
 
                 TRACE("bs_init_writable/0\n");
@@ -4306,7 +4587,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_APPEND: {
+            case OP_BS_APPEND: DISPATCH_TARGET(OP_BS_APPEND) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4373,7 +4654,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_PRIVATE_APPEND: {
+            case OP_BS_PRIVATE_APPEND: DISPATCH_TARGET(OP_BS_PRIVATE_APPEND) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4428,7 +4709,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_PUT_INTEGER: {
+            case OP_BS_PUT_INTEGER: DISPATCH_TARGET(OP_BS_PUT_INTEGER) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4466,7 +4747,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_PUT_BINARY: {
+            case OP_BS_PUT_BINARY: DISPATCH_TARGET(OP_BS_PUT_BINARY) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4526,7 +4807,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_PUT_STRING: {
+            case OP_BS_PUT_STRING: DISPATCH_TARGET(OP_BS_PUT_STRING) {
                 int next_off = 1;
                 uint32_t size;
                 DECODE_LITERAL(size, code, i, next_off);
@@ -4563,7 +4844,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_START_MATCH2: {
+            case OP_BS_START_MATCH2: DISPATCH_TARGET(OP_BS_START_MATCH2) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4614,7 +4895,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_START_MATCH3: {
+            case OP_BS_START_MATCH3: DISPATCH_TARGET(OP_BS_START_MATCH3) {
                 // MEMORY_CAN_SHRINK because bs_start_match is classified as gc in beam_ssa_codegen.erl
                 #ifdef IMPL_EXECUTE_LOOP
                     if (memory_ensure_free_opt(ctx, TERM_BOXED_BIN_MATCH_STATE_SIZE, MEMORY_CAN_SHRINK) != MEMORY_GC_OK) {
@@ -4656,7 +4937,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_GET_POSITION: {
+            case OP_BS_GET_POSITION: DISPATCH_TARGET(OP_BS_GET_POSITION) {
                 int next_off = 1;
                 term src;
                 DECODE_COMPACT_TERM(src, code, i, next_off);
@@ -4685,7 +4966,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_GET_TAIL: {
+            case OP_BS_GET_TAIL: DISPATCH_TARGET(OP_BS_GET_TAIL) {
                 int next_off = 1;
                 term src;
                 #ifdef IMPL_EXECUTE_LOOP
@@ -4740,7 +5021,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_SET_POSITION: {
+            case OP_BS_SET_POSITION: DISPATCH_TARGET(OP_BS_SET_POSITION) {
                 int next_off = 1;
                 term src;
                 DECODE_COMPACT_TERM(src, code, i, next_off);
@@ -4764,7 +5045,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_MATCH_STRING: {
+            case OP_BS_MATCH_STRING: DISPATCH_TARGET(OP_BS_MATCH_STRING) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4819,7 +5100,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_SAVE2: {
+            case OP_BS_SAVE2: DISPATCH_TARGET(OP_BS_SAVE2) {
                 int next_off = 1;
                 term src;
                 DECODE_COMPACT_TERM(src, code, i, next_off);
@@ -4851,7 +5132,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_RESTORE2: {
+            case OP_BS_RESTORE2: DISPATCH_TARGET(OP_BS_RESTORE2) {
                 int next_off = 1;
                 term src;
                 DECODE_COMPACT_TERM(src, code, i, next_off);
@@ -4882,7 +5163,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_SKIP_BITS2: {
+            case OP_BS_SKIP_BITS2: DISPATCH_TARGET(OP_BS_SKIP_BITS2) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4928,7 +5209,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_TEST_UNIT: {
+            case OP_BS_TEST_UNIT: DISPATCH_TARGET(OP_BS_TEST_UNIT) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4960,7 +5241,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_TEST_TAIL2: {
+            case OP_BS_TEST_TAIL2: DISPATCH_TARGET(OP_BS_TEST_TAIL2) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -4994,7 +5275,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_GET_INTEGER2: {
+            case OP_BS_GET_INTEGER2: DISPATCH_TARGET(OP_BS_GET_INTEGER2) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -5050,7 +5331,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_GET_BINARY2: {
+            case OP_BS_GET_BINARY2: DISPATCH_TARGET(OP_BS_GET_BINARY2) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off)
@@ -5132,7 +5413,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_CONTEXT_TO_BINARY: {
+            case OP_BS_CONTEXT_TO_BINARY: DISPATCH_TARGET(OP_BS_CONTEXT_TO_BINARY) {
                 int next_off = 1;
                 dreg_t dreg;
                 dreg_type_t dreg_type;
@@ -5176,7 +5457,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_APPLY: {
+            case OP_APPLY: DISPATCH_TARGET(OP_APPLY) {
                 int next_off = 1;
                 uint32_t arity;
                 DECODE_LITERAL(arity, code, i, next_off)
@@ -5230,7 +5511,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_APPLY_LAST: {
+            case OP_APPLY_LAST: DISPATCH_TARGET(OP_APPLY_LAST) {
                 int next_off = 1;
                 uint32_t arity;
                 DECODE_LITERAL(arity, code, i, next_off)
@@ -5283,7 +5564,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_BOOLEAN: {
+            case OP_IS_BOOLEAN: DISPATCH_TARGET(OP_IS_BOOLEAN) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -5310,7 +5591,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_FUNCTION2: {
+            case OP_IS_FUNCTION2: DISPATCH_TARGET(OP_IS_FUNCTION2) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -5364,7 +5645,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_GC_BIF1: {
+            case OP_GC_BIF1: DISPATCH_TARGET(OP_GC_BIF1) {
                 int next_off = 1;
                 uint32_t f_label;
                 DECODE_LABEL(f_label, code, i, next_off);
@@ -5407,7 +5688,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_GC_BIF2: {
+            case OP_GC_BIF2: DISPATCH_TARGET(OP_GC_BIF2) {
                 int next_off = 1;
                 uint32_t f_label;
                 DECODE_LABEL(f_label, code, i, next_off);
@@ -5454,7 +5735,7 @@ wait_timeout_trap_handler:
             }
 
             //TODO: stub, always false
-            case OP_IS_BITSTR: {
+            case OP_IS_BITSTR: DISPATCH_TARGET(OP_IS_BITSTR) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -5480,7 +5761,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_GC_BIF3: {
+            case OP_GC_BIF3: DISPATCH_TARGET(OP_GC_BIF3) {
                 int next_off = 1;
                 uint32_t f_label;
                 DECODE_LABEL(f_label, code, i, next_off);
@@ -5529,7 +5810,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_TRIM: {
+            case OP_TRIM: DISPATCH_TARGET(OP_TRIM) {
                 int next_off = 1;
                 uint32_t n_words;
                 DECODE_LITERAL(n_words, code, i, next_off);
@@ -5554,7 +5835,7 @@ wait_timeout_trap_handler:
 
             //TODO: stub, implement recv_mark/1
             //it looks like it can be safely left unimplemented
-            case OP_RECV_MARK: {
+            case OP_RECV_MARK: DISPATCH_TARGET(OP_RECV_MARK) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off);
@@ -5568,7 +5849,7 @@ wait_timeout_trap_handler:
 
             //TODO: stub, implement recv_set/1
             //it looks like it can be safely left unimplemented
-            case OP_RECV_SET: {
+            case OP_RECV_SET: DISPATCH_TARGET(OP_RECV_SET) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off);
@@ -5580,7 +5861,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_LINE: {
+            case OP_LINE: DISPATCH_TARGET(OP_LINE) {
                 int next_off = 1;
                 uint32_t line_number;
                 DECODE_LITERAL(line_number, code, i, next_off);
@@ -5595,7 +5876,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_PUT_MAP_ASSOC: {
+            case OP_PUT_MAP_ASSOC: DISPATCH_TARGET(OP_PUT_MAP_ASSOC) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -5731,7 +6012,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_PUT_MAP_EXACT: {
+            case OP_PUT_MAP_EXACT: DISPATCH_TARGET(OP_PUT_MAP_EXACT) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -5810,7 +6091,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_MAP: {
+            case OP_IS_MAP: DISPATCH_TARGET(OP_IS_MAP) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -5837,7 +6118,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_HAS_MAP_FIELDS: {
+            case OP_HAS_MAP_FIELDS: DISPATCH_TARGET(OP_HAS_MAP_FIELDS) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -5874,7 +6155,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_GET_MAP_ELEMENTS: {
+            case OP_GET_MAP_ELEMENTS: DISPATCH_TARGET(OP_GET_MAP_ELEMENTS) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -5917,7 +6198,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_IS_TAGGED_TUPLE: {
+            case OP_IS_TAGGED_TUPLE: DISPATCH_TARGET(OP_IS_TAGGED_TUPLE) {
                 int next_off = 1;
                 uint32_t label;
                 DECODE_LABEL(label, code, i, next_off)
@@ -5948,14 +6229,14 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_FCLEARERROR: {
+            case OP_FCLEARERROR: DISPATCH_TARGET(OP_FCLEARERROR) {
                 // This can be a noop as we raise from bifs
                 TRACE("fclearerror/0\n");
                 NEXT_INSTRUCTION(1);
                 break;
             }
 
-            case OP_FCHECKERROR: {
+            case OP_FCHECKERROR: DISPATCH_TARGET(OP_FCHECKERROR) {
                 int next_off = 1;
                 // This can be a noop as we raise from bifs
                 int fail_label;
@@ -5964,7 +6245,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_FMOVE: {
+            case OP_FMOVE: DISPATCH_TARGET(OP_FMOVE) {
                 int next_off = 1;
                 if (IS_EXTENDED_FP_REGISTER(code, i, next_off)) {
                     int freg;
@@ -6006,7 +6287,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_FCONV: {
+            case OP_FCONV: DISPATCH_TARGET(OP_FCONV) {
                 int next_off = 1;
                 term src_value;
                 DECODE_COMPACT_TERM(src_value, code, i, next_off);
@@ -6029,7 +6310,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_FADD: {
+            case OP_FADD: DISPATCH_TARGET(OP_FADD) {
                 #ifdef HAVE_PRAGMA_STDC_FENV_ACCESS
                     #pragma STDC FENV_ACCESS ON
                 #endif
@@ -6069,7 +6350,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_FSUB: {
+            case OP_FSUB: DISPATCH_TARGET(OP_FSUB) {
                 #ifdef HAVE_PRAGMA_STDC_FENV_ACCESS
                     #pragma STDC FENV_ACCESS ON
                 #endif
@@ -6109,7 +6390,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_FMUL: {
+            case OP_FMUL: DISPATCH_TARGET(OP_FMUL) {
                 #ifdef HAVE_PRAGMA_STDC_FENV_ACCESS
                     #pragma STDC FENV_ACCESS ON
                 #endif
@@ -6149,7 +6430,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_FDIV: {
+            case OP_FDIV: DISPATCH_TARGET(OP_FDIV) {
                 #ifdef HAVE_PRAGMA_STDC_FENV_ACCESS
                     #pragma STDC FENV_ACCESS ON
                 #endif
@@ -6189,7 +6470,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_FNEGATE: {
+            case OP_FNEGATE: DISPATCH_TARGET(OP_FNEGATE) {
                 int next_off = 1;
                 int fail_label;
                 DECODE_LABEL(fail_label, code, i, next_off);
@@ -6212,7 +6493,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BUILD_STACKTRACE: {
+            case OP_BUILD_STACKTRACE: DISPATCH_TARGET(OP_BUILD_STACKTRACE) {
                 int next_off = 1;
 
                 TRACE("build_stacktrace/0\n");
@@ -6229,7 +6510,7 @@ wait_timeout_trap_handler:
             }
 
 #ifdef ENABLE_OTP21
-            case OP_GET_HD: {
+            case OP_GET_HD: DISPATCH_TARGET(OP_GET_HD) {
                 int next_off = 1;
                 term src_value;
                 DECODE_COMPACT_TERM(src_value, code, i, next_off)
@@ -6254,7 +6535,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_GET_TL: {
+            case OP_GET_TL: DISPATCH_TARGET(OP_GET_TL) {
                 int next_off = 1;
                 term src_value;
                 DECODE_COMPACT_TERM(src_value, code, i, next_off)
@@ -6281,7 +6562,7 @@ wait_timeout_trap_handler:
 #endif
 
 #ifdef ENABLE_OTP22
-            case OP_PUT_TUPLE2: {
+            case OP_PUT_TUPLE2: DISPATCH_TARGET(OP_PUT_TUPLE2) {
                 int next_off = 1;
                 dreg_t dreg;
                 dreg_type_t dreg_type;
@@ -6324,7 +6605,7 @@ wait_timeout_trap_handler:
 #endif
 
 #ifdef ENABLE_OTP23
-            case OP_SWAP: {
+            case OP_SWAP: DISPATCH_TARGET(OP_SWAP) {
                 int next_off = 1;
                 dreg_t reg_a;
                 dreg_type_t reg_a_type;
@@ -6347,7 +6628,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_START_MATCH4: {
+            case OP_BS_START_MATCH4: DISPATCH_TARGET(OP_BS_START_MATCH4) {
                 #ifdef IMPL_EXECUTE_LOOP
                     // MEMORY_CAN_SHRINK because bs_start_match is classified as gc in beam_ssa_codegen.erl
                     if (memory_ensure_free_opt(ctx, TERM_BOXED_BIN_MATCH_STATE_SIZE, MEMORY_CAN_SHRINK) != MEMORY_GC_OK) {
@@ -6394,7 +6675,7 @@ wait_timeout_trap_handler:
 #endif
 
 #ifdef ENABLE_OTP24
-            case OP_MAKE_FUN3: {
+            case OP_MAKE_FUN3: DISPATCH_TARGET(OP_MAKE_FUN3) {
                 int next_off = 1;
                 uint32_t fun_index;
                 DECODE_LITERAL(fun_index, code, i, next_off);
@@ -6431,7 +6712,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_INIT_YREGS: {
+            case OP_INIT_YREGS: DISPATCH_TARGET(OP_INIT_YREGS) {
                 int next_off = 1;
                 DECODE_EXTENDED_LIST_TAG(code, i, next_off);
                 uint32_t size;
@@ -6447,7 +6728,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_RECV_MARKER_BIND: {
+            case OP_RECV_MARKER_BIND: DISPATCH_TARGET(OP_RECV_MARKER_BIND) {
                 int next_off = 1;
                 dreg_t reg_a;
                 dreg_type_t reg_a_type;
@@ -6460,7 +6741,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_RECV_MARKER_CLEAR: {
+            case OP_RECV_MARKER_CLEAR: DISPATCH_TARGET(OP_RECV_MARKER_CLEAR) {
                 int next_off = 1;
                 dreg_t reg_a;
                 dreg_type_t reg_a_type;
@@ -6470,7 +6751,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_RECV_MARKER_RESERVE: {
+            case OP_RECV_MARKER_RESERVE: DISPATCH_TARGET(OP_RECV_MARKER_RESERVE) {
                 int next_off = 1;
                 dreg_t reg_a;
                 dreg_type_t reg_a_type;
@@ -6484,7 +6765,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_RECV_MARKER_USE: {
+            case OP_RECV_MARKER_USE: DISPATCH_TARGET(OP_RECV_MARKER_USE) {
                 int next_off = 1;
                 dreg_t reg_a;
                 dreg_type_t reg_a_type;
@@ -6496,7 +6777,7 @@ wait_timeout_trap_handler:
 #endif
 
 #ifdef ENABLE_OTP25
-            case OP_BS_CREATE_BIN: {
+            case OP_BS_CREATE_BIN: DISPATCH_TARGET(OP_BS_CREATE_BIN) {
                 int next_off = 1;
                 uint32_t fail;
                 DECODE_LABEL(fail, code, i, next_off);
@@ -6764,7 +7045,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_CALL_FUN2: {
+            case OP_CALL_FUN2: DISPATCH_TARGET(OP_CALL_FUN2) {
                 int next_off = 1;
                 term tag;
                 DECODE_COMPACT_TERM(tag, code, i, next_off)
@@ -6802,7 +7083,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BADRECORD: {
+            case OP_BADRECORD: DISPATCH_TARGET(OP_BADRECORD) {
                 int next_off = 1;
                 TRACE("badrecord/1\n");
 
@@ -6830,7 +7111,7 @@ wait_timeout_trap_handler:
 #endif
 
 #ifdef ENABLE_OTP26
-            case OP_UPDATE_RECORD: {
+            case OP_UPDATE_RECORD: DISPATCH_TARGET(OP_UPDATE_RECORD) {
                 int next_off = 1;
                 #ifdef IMPL_CODE_LOADER
                     TRACE("update_record/5\n");
@@ -6896,7 +7177,7 @@ wait_timeout_trap_handler:
                 break;
             }
 
-            case OP_BS_MATCH: {
+            case OP_BS_MATCH: DISPATCH_TARGET(OP_BS_MATCH) {
                 int next_off = 1;
                 TRACE("bs_match/3\n");
 
@@ -7143,6 +7424,9 @@ bs_match_jump_to_fail:
 #endif
 
             default:
+#ifdef IMPL_EXECUTE_LOOP
+undecoded_opcode:
+#endif
                 printf("Undecoded opcode: %i\n", code[i]);
                 #ifdef IMPL_EXECUTE_LOOP
                     fprintf(stderr, "failed at %u\n", (unsigned int) i);
@@ -7200,8 +7484,7 @@ terminate_context:
         if (ctx->leader) {
             scheduler_stop_all(global);
         }
-        scheduler_terminate(ctx);
-        ctx = scheduler_run(global);
+        ctx = scheduler_terminate_and_run(ctx);
         goto schedule_in;
 #endif
     }
@@ -7214,3 +7497,6 @@ terminate_context:
 #endif
 
 #undef DECODE_COMPACT_TERM
+#undef DISPATCH_TARGET
+#undef DISPATCH_ENTRY
+#undef DISPATCH_OPCODE
@@ -341,7 +341,7 @@ int enif_demonitor_process(ErlNifEnv *env, void *obj, const ErlNifMonitor *mon)
         struct ResourceMonitor *monitor = GET_LIST_ENTRY(item, struct ResourceMonitor, resource_list_head);
         if (monitor->base.ref_ticks == *mon) {
             list_remove(&monitor->resource_list_head);
-            list_remove(&monitor->base.monitor_list_head);
+            globalcontext_remove_monitor(global, &monitor->base);
             free(monitor);
             synclist_unlock(&global->processes_table);
             return 0;
@@ -365,7 +365,7 @@ void destroy_resource_monitors(struct RefcBinary *resource, GlobalContext *globa
         struct ResourceMonitor *monitor = GET_LIST_ENTRY(item, struct ResourceMonitor, resource_list_head);
         if (monitor->base.monitor_obj == monitor_obj) {
             list_remove(&monitor->resource_list_head);
-            list_remove(&monitor->base.monitor_list_head);
+            globalcontext_remove_monitor(global, &monitor->base);
             free(monitor);
         }
     }
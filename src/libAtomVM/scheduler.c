@@ -21,9 +21,11 @@
 #include "scheduler.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "debug.h"
 #include "list.h"
+#include "mailbox.h"
 #include "smp.h"
 #include "sys.h"
 #include "utils.h"
@@ -42,8 +44,51 @@
 #define SMP_MUTEX_UNLOCK(mtx)
 #endif
 
+#ifdef AVM_TIMER_MICROSECONDS
+#define TIMER_TICKS_PER_MS 1000
+
+static uint64_t scheduler_timer_now()
+{
+    struct timespec ts;
+    sys_monotonic_time(&ts);
+    return ((uint64_t) ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+#else
+#define TIMER_TICKS_PER_MS 1
+
+static uint64_t scheduler_timer_now()
+{
+    return sys_monotonic_millis();
+}
+#endif
+
+#define DEFAULT_ERLANG_TIMERS_INDEX_CAPACITY 16
+
+#ifndef AVM_NO_SMP
+// A scheduler checks the global run queue before its own one every
+// GLOBAL_QUEUE_CHECK_INTERVAL picks, so processes made ready from other
+// threads are not starved by processes exchanging messages locally.
+#define GLOBAL_QUEUE_CHECK_INTERVAL 61
+#define SCHEDULER_ID(ctx) ((ctx)->scheduler_id)
+#else
+#define SCHEDULER_ID(ctx) 0
+#endif
+
+struct ErlangTimer
+{
+    struct TimerListItem timer_list_item;
+    struct ErlangTimer *index_next;
+    GlobalContext *global;
+    uint64_t ref_ticks;
+    term dest;
+    Message *message;
+};
+
 static void scheduler_timeout_callback(struct TimerListItem *it);
-static void scheduler_make_ready(Context *ctx);
+static void scheduler_erlang_timer_callback(struct TimerListItem *it);
+static void scheduler_send_fired_timers(GlobalContext *global);
+static void scheduler_make_ready(Context *ctx, int scheduler_id);
+static Context *scheduler_run_on(GlobalContext *global, int scheduler_id);
 
 static int update_timer_list(GlobalContext *global)
 {
@@ -52,34 +97,59 @@ static int update_timer_list(GlobalContext *global)
         // Do not fetch the current date if there is no timer
         return -1;
     }
-    uint64_t millis_now = sys_monotonic_millis();
-    timer_list_next(tw, millis_now, scheduler_timeout_callback);
+    uint64_t now = scheduler_timer_now();
+    timer_list_next(tw, now, scheduler_timeout_callback);
     if (tw->next_timer == 0) {
         return -1;
     }
-    uint64_t wait_timeout = tw->next_timer - millis_now;
+    // Round up so the scheduler doesn't wake up before the next timer
+    uint64_t wait_timeout = (tw->next_timer - now + TIMER_TICKS_PER_MS - 1) / TIMER_TICKS_PER_MS;
     if (wait_timeout > INT_MAX) {
         wait_timeout = INT_MAX;
     }
     return (int) wait_timeout;
 }
 
+// Append a ready process to the run queue of scheduler scheduler_id, or to
+// the global run queue if scheduler_id is negative. The run queue of a
+// scheduler is only appended to by the thread that owns it.
+static void scheduler_enqueue(GlobalContext *global, Context *ctx, int scheduler_id)
+{
+#ifndef AVM_NO_SMP
+    if (scheduler_id >= 0) {
+        struct SchedulerQueue *queue = &global->scheduler_queues[scheduler_id];
+        SMP_SPINLOCK_LOCK(&queue->lock);
+        list_append(&queue->ready_processes[ctx->priority], &ctx->processes_list_head);
+        SMP_SPINLOCK_UNLOCK(&queue->lock);
+        return;
+    }
+#else
+    UNUSED(scheduler_id);
+#endif
+    SMP_SPINLOCK_LOCK(&global->processes_spinlock);
+    list_append(&global->ready_processes[ctx->priority], &ctx->processes_list_head);
+    SMP_SPINLOCK_UNLOCK(&global->processes_spinlock);
+}
+
+// Clear the running flag of a process that is done running on its scheduler.
+// If it was made ready meanwhile, it was not queued then and it is queued now.
+static void scheduler_stop_running(Context *ctx)
+{
+    enum ContextFlags previous = context_update_flags(ctx, ~Running, NoFlags);
+    if (previous & Ready) {
+        scheduler_enqueue(ctx->global, ctx, SCHEDULER_ID(ctx));
+    }
+}
+
 Context *scheduler_wait(Context *ctx)
 {
 #ifdef DEBUG_PRINT_READY_PROCESSES
     debug_print_processes_list(global->ready_processes);
 #endif
     GlobalContext *global = ctx->global;
-    SMP_SPINLOCK_LOCK(&global->processes_spinlock);
-    context_update_flags(ctx, ~Running, NoFlags);
-    // Remove from running list, but do not remove from ready list.
-    if (!context_get_flags(ctx, Ready)) {
-        list_remove(&ctx->processes_list_head);
-        list_append(&global->waiting_processes, &ctx->processes_list_head);
-    }
-    SMP_SPINLOCK_UNLOCK(&global->processes_spinlock);
+    scheduler_stop_running(ctx);
 
-    return scheduler_run(global);
+    return scheduler_run_on(global, SCHEDULER_ID(ctx));
 }
 
 static void scheduler_process_native_signal_messages(Context *ctx)
@@ -102,7 +172,178 @@ static void scheduler_process_native_signal_messages(Context *ctx)
     }
 }
 
-static Context *scheduler_run0(GlobalContext *global)
+// Remove the first process from ready_list and mark it running.
+// Must be called with the lock of ready_list held.
+static Context *scheduler_pick_ready(struct ListHead *ready_list)
+{
+    if (list_is_empty(ready_list)) {
+        return NULL;
+    }
+    struct ListHead *next_ready = list_first(ready_list);
+    list_remove(next_ready);
+    Context *result = GET_LIST_ENTRY(next_ready, Context, processes_list_head);
+    context_update_flags(result, ~Ready, Running);
+    return result;
+}
+
+static Context *scheduler_pick_global(GlobalContext *global, enum ProcessPriority priority)
+{
+    SMP_SPINLOCK_LOCK(&global->processes_spinlock);
+    Context *result = scheduler_pick_ready(&global->ready_processes[priority]);
+    SMP_SPINLOCK_UNLOCK(&global->processes_spinlock);
+    return result;
+}
+
+#ifndef AVM_NO_SMP
+static Context *scheduler_pick_local(struct SchedulerQueue *queue, enum ProcessPriority priority)
+{
+    SMP_SPINLOCK_LOCK(&queue->lock);
+    Context *result = scheduler_pick_ready(&queue->ready_processes[priority]);
+    SMP_SPINLOCK_UNLOCK(&queue->lock);
+    return result;
+}
+
+// Steal a process with the given priority from the run queue of another
+// scheduler. Only queues with more than one process are considered, as the
+// owner of the queue is running a process and will pick the first one as
+// soon as it is done with it.
+static Context *scheduler_steal(GlobalContext *global, int scheduler_id, enum ProcessPriority priority)
+{
+    for (int i = 1; i < global->scheduler_queues_count; i++) {
+        int victim_id = (scheduler_id + i) % global->scheduler_queues_count;
+        struct SchedulerQueue *victim = &global->scheduler_queues[victim_id];
+        Context *result = NULL;
+        SMP_SPINLOCK_LOCK(&victim->lock);
+        struct ListHead *ready_list = &victim->ready_processes[priority];
+        if (!list_is_empty(ready_list) && list_first(ready_list) != list_last(ready_list)) {
+            result = scheduler_pick_ready(ready_list);
+        }
+        SMP_SPINLOCK_UNLOCK(&victim->lock);
+        if (result) {
+            return result;
+        }
+    }
+    return NULL;
+}
+#endif
+
+// Pick the next process with the given priority to run on scheduler
+// scheduler_id: first from its own run queue, then from the global run queue
+// and eventually from the run queue of another scheduler.
+static Context *scheduler_pick_priority(GlobalContext *global, int scheduler_id, enum ProcessPriority priority)
+{
+#ifndef AVM_NO_SMP
+    struct SchedulerQueue *queue = &global->scheduler_queues[scheduler_id];
+    Context *result = NULL;
+    if (queue->local_picks < GLOBAL_QUEUE_CHECK_INTERVAL) {
+        result = scheduler_pick_local(queue, priority);
+    }
+    if (result) {
+        queue->local_picks++;
+        return result;
+    }
+    result = scheduler_pick_global(global, priority);
+    if (result == NULL) {
+        result = scheduler_pick_local(queue, priority);
+    }
+    if (result == NULL) {
+        result = scheduler_steal(global, scheduler_id, priority);
+    }
+    if (result) {
+        queue->local_picks = 0;
+    }
+    return result;
+#else
+    UNUSED(scheduler_id);
+    return scheduler_pick_global(global, priority);
+#endif
+}
+
+// Priority level that is tried first for the n-th pick. Higher levels are
+// otherwise tried first, this gives lower levels a turn so they are never
+// starved: at least one pick out of 4 for high, 8 for normal and 32 for low.
+static enum ProcessPriority scheduler_pick_first_priority(unsigned int n)
+{
+    if (n % 32 == 31) {
+        return PriorityLow;
+    }
+    if (n % 8 == 7) {
+        return PriorityNormal;
+    }
+    if (n % 4 == 3) {
+        return PriorityHigh;
+    }
+    return PriorityMax;
+}
+
+// Pick the next process to run on scheduler scheduler_id.
+static Context *scheduler_pick(GlobalContext *global, int scheduler_id)
+{
+#ifndef AVM_NO_SMP
+    unsigned int *ready_picks = &global->scheduler_queues[scheduler_id].ready_picks;
+#else
+    unsigned int *ready_picks = &global->ready_picks;
+#endif
+    enum ProcessPriority first_priority = scheduler_pick_first_priority(*ready_picks);
+    Context *result = scheduler_pick_priority(global, scheduler_id, first_priority);
+    for (int priority = PriorityMax; result == NULL && priority >= PriorityLow; priority--) {
+        if (priority != (int) first_priority) {
+            result = scheduler_pick_priority(global, scheduler_id, (enum ProcessPriority) priority);
+        }
+    }
+    if (result) {
+        (*ready_picks)++;
+#ifndef AVM_NO_SMP
+        result->scheduler_id = scheduler_id;
+#endif
+    }
+    return result;
+}
+
+#ifndef AVM_NO_SMP
+static int scheduler_acquire_queue(GlobalContext *global)
+{
+    int scheduler_id = -1;
+    SMP_SPINLOCK_LOCK(&global->processes_spinlock);
+    for (int i = 0; i < global->scheduler_queues_count; i++) {
+        if (!global->scheduler_queues[i].active) {
+            global->scheduler_queues[i].active = true;
+            global->scheduler_queues[i].local_picks = 0;
+            scheduler_id = i;
+            break;
+        }
+    }
+    SMP_SPINLOCK_UNLOCK(&global->processes_spinlock);
+    if (UNLIKELY(scheduler_id < 0)) {
+        fprintf(stderr, "No run queue left for a new scheduler\n");
+        AVM_ABORT();
+    }
+    return scheduler_id;
+}
+
+// Move processes of the run queue of a scheduler that is going to sleep or
+// to stop to the global run queue, so other schedulers can pick them.
+static void scheduler_unload_queue(GlobalContext *global, int scheduler_id, bool release)
+{
+    struct SchedulerQueue *queue = &global->scheduler_queues[scheduler_id];
+    SMP_SPINLOCK_LOCK(&global->processes_spinlock);
+    SMP_SPINLOCK_LOCK(&queue->lock);
+    for (int i = 0; i < PROCESS_PRIORITIES; i++) {
+        while (!list_is_empty(&queue->ready_processes[i])) {
+            struct ListHead *item = list_first(&queue->ready_processes[i]);
+            list_remove(item);
+            list_append(&global->ready_processes[i], item);
+        }
+    }
+    SMP_SPINLOCK_UNLOCK(&queue->lock);
+    if (release) {
+        queue->active = false;
+    }
+    SMP_SPINLOCK_UNLOCK(&global->processes_spinlock);
+}
+#endif
+
+static Context *scheduler_run0(GlobalContext *global, int scheduler_id)
 {
     // This function should return a new process to run.
     // If running_schedulers is greater than online_schedulers, take the
@@ -111,6 +352,15 @@ static Context *scheduler_run0(GlobalContext *global)
     Context *result = NULL;
 
 #ifndef AVM_NO_SMP
+    // If another scheduler is polling the timers and the system events, pick
+    // a process without taking the schedulers mutex.
+    if (global->waiting_scheduler && !global->scheduler_stop_all) {
+        result = scheduler_pick(global, scheduler_id);
+        if (result) {
+            return result;
+        }
+    }
+
     SMP_MUTEX_LOCK(global->schedulers_mutex);
     bool is_waiting = !global->waiting_scheduler;
     if (is_waiting) {
@@ -142,12 +392,15 @@ static Context *scheduler_run0(GlobalContext *global)
                 }
                 global->running_schedulers = 0;
                 global->waiting_scheduler = false;
+                scheduler_unload_queue(global, scheduler_id, true);
                 SMP_MUTEX_UNLOCK(global->schedulers_mutex);
                 return NULL;
             }
             if (!main_thread
                 && (global->scheduler_stop_all
                     || global->running_schedulers > global->online_schedulers)) {
+                // Release the queue before another scheduler can be started
+                scheduler_unload_queue(global, scheduler_id, true);
                 global->running_schedulers--;
                 if (is_waiting) {
                     global->waiting_scheduler = false;
@@ -159,6 +412,7 @@ static Context *scheduler_run0(GlobalContext *global)
                 return NULL;
             }
             if (!is_waiting) {
+                scheduler_unload_queue(global, scheduler_id, false);
                 // Before entering the condition variable, signal the poll events
                 // so the thread polling on events can check the ready queue.
                 sys_signal(global);
@@ -181,27 +435,9 @@ static Context *scheduler_run0(GlobalContext *global)
         SMP_SPINLOCK_LOCK(&global->timer_spinlock);
         int32_t wait_timeout = update_timer_list(global);
         SMP_SPINLOCK_UNLOCK(&global->timer_spinlock);
+        scheduler_send_fired_timers(global);
 
-        SMP_SPINLOCK_LOCK(&global->processes_spinlock);
-        // Pick first ready which is not running.
-        struct ListHead *next_ready = list_first(&global->ready_processes);
-        while (next_ready != &global->ready_processes) {
-            result = GET_LIST_ENTRY(next_ready, Context, processes_list_head);
-            if (!(result->flags & Running)) {
-                list_remove(next_ready);
-                context_update_flags(result, ~Ready, Running);
-                if (result->native_handler) {
-                    // Native handlers are marked as waiting
-                    list_append(&global->waiting_processes, next_ready);
-                } else {
-                    list_append(&global->running_processes, next_ready);
-                }
-                break;
-            }
-            next_ready = next_ready->next;
-            result = NULL;
-        }
-        SMP_SPINLOCK_UNLOCK(&global->processes_spinlock);
+        result = scheduler_pick(global, scheduler_id);
 
         if (result == NULL && !global->scheduler_stop_all) {
             sys_poll_events(global, wait_timeout);
@@ -220,12 +456,12 @@ static Context *scheduler_run0(GlobalContext *global)
     return result;
 }
 
-Context *scheduler_run(GlobalContext *global)
+static Context *scheduler_run_on(GlobalContext *global, int scheduler_id)
 {
     // Outer loop to process native contexts.
     Context *result = NULL;
     do {
-        result = scheduler_run0(global);
+        result = scheduler_run0(global, scheduler_id);
         if (result == NULL) {
             break;
         }
@@ -237,14 +473,14 @@ Context *scheduler_run(GlobalContext *global)
                 if (mailbox_has_next(&result->mailbox)) {
                     if (result->native_handler(result) == NativeContinue) {
                         // If native handler has memory fragments, garbage collect
-                        // them
+                        // them once they take too much memory
                         if (result->heap.root->next) {
-                            if (UNLIKELY(memory_ensure_free_opt(result, 0, MEMORY_FORCE_SHRINK) != MEMORY_GC_OK)) {
+                            if (UNLIKELY(memory_collect_heap_fragments(result) != MEMORY_GC_OK)) {
                                 fprintf(stderr, "Out of memory error in native handler\n");
                                 AVM_ABORT();
                             }
                         }
-                        context_update_flags(result, ~Running, NoFlags);
+                        scheduler_stop_running(result);
                         // The context was marked ready for the first message
                         // However, another message may have arrived before it
                         // was marked running in scheduler_run0, so there can
@@ -252,7 +488,7 @@ Context *scheduler_run(GlobalContext *global)
                         // may have processed only one message. So we rechedule
                         // to make sure the handler process all messages.
                         if (mailbox_has_next(&result->mailbox)) {
-                            scheduler_make_ready(result);
+                            scheduler_make_ready(result, scheduler_id);
                         }
                     } else {
                         scheduler_terminate(result);
@@ -266,7 +502,7 @@ Context *scheduler_run(GlobalContext *global)
                     // ready, and in this case the mailbox may only contain
                     // signal messages that are processed and removed by
                     // `scheduler_process_native_signal_messages`.
-                    context_update_flags(result, ~Running, NoFlags);
+                    scheduler_stop_running(result);
                 }
             }
             result = NULL; // Schedule next process (native or not)
@@ -275,39 +511,49 @@ Context *scheduler_run(GlobalContext *global)
     return result;
 }
 
+Context *scheduler_run(GlobalContext *global)
+{
+#ifndef AVM_NO_SMP
+    return scheduler_run_on(global, scheduler_acquire_queue(global));
+#else
+    return scheduler_run_on(global, 0);
+#endif
+}
+
 Context *scheduler_next(GlobalContext *global, Context *c)
 {
     c->reductions += DEFAULT_REDUCTIONS_AMOUNT;
 
-    // Remove c from running and append it at the end of ready list
-    // c could already be in ready queue, if it received a message.
-    SMP_SPINLOCK_LOCK(&global->processes_spinlock);
-    list_remove(&c->processes_list_head);
-    list_append(&global->ready_processes, &c->processes_list_head);
-    context_update_flags(c, ~Running, NoFlags);
-    SMP_SPINLOCK_UNLOCK(&global->processes_spinlock);
+    // Mark c ready and append it at the end of the run queue of its
+    // scheduler. It was not queued while running, even if it received a
+    // message, and no other thread queues it once it is marked ready.
+    context_update_flags(c, ~Running, Ready);
+    scheduler_enqueue(global, c, SCHEDULER_ID(c));
 
     // Schedule.
-    return scheduler_run(global);
+    return scheduler_run_on(global, SCHEDULER_ID(c));
 }
 
-static void scheduler_make_ready(Context *ctx)
+// Make a process ready and queue it on the run queue of scheduler
+// scheduler_id, which is the scheduler of the calling thread, or on the global
+// run queue if scheduler_id is negative.
+static void scheduler_make_ready(Context *ctx, int scheduler_id)
 {
     GlobalContext *global = ctx->global;
-    SMP_SPINLOCK_LOCK(&global->processes_spinlock);
-    if (context_get_flags(ctx, Killed)) {
-        SMP_SPINLOCK_UNLOCK(&global->processes_spinlock);
+    // The process may be running (it would be signaled), so mark it as ready.
+    // It is queued here only if it was neither ready nor running: it is then
+    // already queued or it will be when it stops running.
+    enum ContextFlags previous = context_update_flags(ctx, ~NoFlags, Ready);
+    if (previous & (Ready | Running | Killed)) {
         return;
     }
-    list_remove(&ctx->processes_list_head);
 #ifndef AVM_NO_SMP
     bool waiting_scheduler = global->waiting_scheduler;
     if (!waiting_scheduler) {
         // Start a new scheduler if none are going to take this process.
         if (SMP_MUTEX_TRYLOCK(global->schedulers_mutex)) {
             if (global->running_schedulers > 0
-                && global->running_schedulers < global->online_schedulers
-                && !context_get_flags(ctx, Running)) {
+                && global->running_schedulers < global->online_schedulers) {
                 global->running_schedulers++;
                 smp_scheduler_start(global);
             }
@@ -315,12 +561,7 @@ static void scheduler_make_ready(Context *ctx)
         }
     }
 #endif
-    // Move to ready queue (from waiting or running)
-    // The process may be running (it would be signaled), so mark it
-    // as ready
-    context_update_flags(ctx, ~NoFlags, Ready);
-    list_append(&global->ready_processes, &ctx->processes_list_head);
-    SMP_SPINLOCK_UNLOCK(&global->processes_spinlock);
+    scheduler_enqueue(global, ctx, scheduler_id);
 #ifndef AVM_NO_SMP
     if (waiting_scheduler) {
         sys_signal(global);
@@ -330,25 +571,37 @@ static void scheduler_make_ready(Context *ctx)
 
 void scheduler_init_ready(Context *c)
 {
-    scheduler_make_ready(c);
+    scheduler_make_ready(c, -1);
 }
 
 void scheduler_signal_message(Context *c)
 {
-    scheduler_make_ready(c);
+    scheduler_make_ready(c, -1);
+}
+
+void scheduler_signal_message_on_scheduler(Context *c, int scheduler_id)
+{
+    scheduler_make_ready(c, scheduler_id);
 }
 
 void scheduler_terminate(Context *ctx)
 {
-    SMP_SPINLOCK_LOCK(&ctx->global->processes_spinlock);
+    // The process is either running or was never made ready, so it is not
+    // in any run queue.
     context_update_flags(ctx, ~NoFlags, Killed);
-    list_remove(&ctx->processes_list_head);
-    SMP_SPINLOCK_UNLOCK(&ctx->global->processes_spinlock);
     if (!ctx->leader) {
         context_destroy(ctx);
     }
 }
 
+Context *scheduler_terminate_and_run(Context *ctx)
+{
+    GlobalContext *global = ctx->global;
+    int scheduler_id = SCHEDULER_ID(ctx);
+    scheduler_terminate(ctx);
+    return scheduler_run_on(global, scheduler_id);
+}
+
 void scheduler_stop_all(GlobalContext *global)
 {
     global->scheduler_stop_all = true;
@@ -361,14 +614,14 @@ static void scheduler_timeout_callback(struct TimerListItem *it)
 {
     Context *ctx = GET_LIST_ENTRY(it, Context, timer_list_head);
     context_update_flags(ctx, ~WaitingTimeout, WaitingTimeoutExpired);
-    scheduler_make_ready(ctx);
+    scheduler_make_ready(ctx, -1);
 }
 
 void scheduler_set_timeout(Context *ctx, avm_int64_t timeout)
 {
     GlobalContext *glb = ctx->global;
-    uint64_t millis_now = sys_monotonic_millis();
-    uint64_t expiry = millis_now + timeout;
+    uint64_t now = scheduler_timer_now();
+    uint64_t expiry = now + timeout * TIMER_TICKS_PER_MS;
 
     context_update_flags(ctx, ~NoFlags, WaitingTimeout);
     struct TimerList *tw = &glb->timer_list;
@@ -398,3 +651,200 @@ void scheduler_cancel_timeout(Context *ctx)
     timer_list_remove(tw, &ctx->timer_list_head);
     SMP_SPINLOCK_UNLOCK(&glb->timer_spinlock);
 }
+
+static void erlang_timers_index_grow(GlobalContext *global)
+{
+    unsigned int new_capacity = global->erlang_timers_index_capacity ? global->erlang_timers_index_capacity * 2 : DEFAULT_ERLANG_TIMERS_INDEX_CAPACITY;
+    struct ErlangTimer **new_index = calloc(new_capacity, sizeof(struct ErlangTimer *));
+    if (IS_NULL_PTR(new_index)) {
+        if (global->erlang_timers_index_capacity == 0) {
+            fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+            AVM_ABORT();
+        }
+        // keep the current index, with longer chains
+        return;
+    }
+
+    for (unsigned int i = 0; i < global->erlang_timers_index_capacity; i++) {
+        struct ErlangTimer *timer = global->erlang_timers_index[i];
+        while (timer) {
+            struct ErlangTimer *next = timer->index_next;
+            unsigned int bucket = (unsigned int) timer->ref_ticks & (new_capacity - 1);
+            timer->index_next = new_index[bucket];
+            new_index[bucket] = timer;
+            timer = next;
+        }
+    }
+
+    free(global->erlang_timers_index);
+    global->erlang_timers_index = new_index;
+    global->erlang_timers_index_capacity = new_capacity;
+}
+
+// Find and optionally unlink a timer from the index, with timer_spinlock held
+static struct ErlangTimer *erlang_timers_index_find(GlobalContext *global, uint64_t ref_ticks, bool remove)
+{
+    if (global->erlang_timers_index_capacity == 0) {
+        return NULL;
+    }
+    unsigned int bucket = (unsigned int) ref_ticks & (global->erlang_timers_index_capacity - 1);
+    struct ErlangTimer **link = &global->erlang_timers_index[bucket];
+    while (*link) {
+        struct ErlangTimer *timer = *link;
+        if (timer->ref_ticks == ref_ticks) {
+            if (remove) {
+                *link = timer->index_next;
+                global->erlang_timers_count--;
+            }
+            return timer;
+        }
+        link = &timer->index_next;
+    }
+    return NULL;
+}
+
+static avm_int64_t erlang_timer_remaining(struct ErlangTimer *timer, uint64_t now)
+{
+    uint64_t expiry = timer->timer_list_item.expiry_time;
+    if (expiry <= now) {
+        return 0;
+    }
+    return (avm_int64_t) ((expiry - now) / TIMER_TICKS_PER_MS);
+}
+
+bool scheduler_start_timer(GlobalContext *glb, uint64_t ref_ticks, avm_int64_t timeout, term dest, Message *message)
+{
+    struct ErlangTimer *timer = malloc(sizeof(struct ErlangTimer));
+    if (IS_NULL_PTR(timer)) {
+        return false;
+    }
+    timer->global = glb;
+    timer->ref_ticks = ref_ticks;
+    timer->dest = dest;
+    timer->message = message;
+
+    uint64_t now = scheduler_timer_now();
+    timer_list_item_init(&timer->timer_list_item, now + timeout * TIMER_TICKS_PER_MS);
+    timer->timer_list_item.callback = scheduler_erlang_timer_callback;
+
+    SMP_SPINLOCK_LOCK(&glb->timer_spinlock);
+    if (glb->erlang_timers_count >= glb->erlang_timers_index_capacity) {
+        erlang_timers_index_grow(glb);
+    }
+    unsigned int bucket = (unsigned int) ref_ticks & (glb->erlang_timers_index_capacity - 1);
+    timer->index_next = glb->erlang_timers_index[bucket];
+    glb->erlang_timers_index[bucket] = timer;
+    glb->erlang_timers_count++;
+    timer_list_insert(&glb->timer_list, &timer->timer_list_item);
+    SMP_SPINLOCK_UNLOCK(&glb->timer_spinlock);
+
+#ifndef AVM_NO_SMP
+    if (glb->waiting_scheduler) {
+        sys_signal(glb);
+    }
+#endif
+
+    return true;
+}
+
+bool scheduler_cancel_timer(GlobalContext *glb, uint64_t ref_ticks, avm_int64_t *remaining)
+{
+    uint64_t now = scheduler_timer_now();
+
+    SMP_SPINLOCK_LOCK(&glb->timer_spinlock);
+    struct ErlangTimer *timer = erlang_timers_index_find(glb, ref_ticks, true);
+    if (timer) {
+        timer_list_remove(&glb->timer_list, &timer->timer_list_item);
+    }
+    SMP_SPINLOCK_UNLOCK(&glb->timer_spinlock);
+
+    if (timer == NULL) {
+        return false;
+    }
+    *remaining = erlang_timer_remaining(timer, now);
+    mailbox_message_destroy(timer->message, glb);
+    free(timer);
+
+    return true;
+}
+
+bool scheduler_read_timer(GlobalContext *glb, uint64_t ref_ticks, avm_int64_t *remaining)
+{
+    uint64_t now = scheduler_timer_now();
+
+    SMP_SPINLOCK_LOCK(&glb->timer_spinlock);
+    struct ErlangTimer *timer = erlang_timers_index_find(glb, ref_ticks, false);
+    if (timer) {
+        *remaining = erlang_timer_remaining(timer, now);
+    }
+    SMP_SPINLOCK_UNLOCK(&glb->timer_spinlock);
+
+    return timer != NULL;
+}
+
+// Called with timer_spinlock held: messages are sent later by
+// scheduler_send_fired_timers, as sending requires the processes table lock
+static void scheduler_erlang_timer_callback(struct TimerListItem *it)
+{
+    struct ErlangTimer *timer = GET_LIST_ENTRY(it, struct ErlangTimer, timer_list_item);
+    GlobalContext *glb = timer->global;
+    erlang_timers_index_find(glb, timer->ref_ticks, true);
+    list_append(&glb->fired_erlang_timers, &it->head);
+}
+
+static void scheduler_send_fired_timers(GlobalContext *global)
+{
+    // Only the scheduler updating the timer list appends to this list
+    if (list_is_empty(&global->fired_erlang_timers)) {
+        return;
+    }
+
+    struct ListHead *processes_table_list = synclist_rdlock(&global->processes_table);
+    UNUSED(processes_table_list);
+    struct ListHead *item;
+    struct ListHead *tmp;
+    MUTABLE_LIST_FOR_EACH (item, tmp, &global->fired_erlang_timers) {
+        struct ErlangTimer *timer = GET_LIST_ENTRY(item, struct ErlangTimer, timer_list_item.head);
+        int32_t local_process_id;
+        if (term_is_atom(timer->dest)) {
+            local_process_id = globalcontext_get_registered_process(global, term_to_atom_index(timer->dest));
+        } else {
+            local_process_id = term_to_local_process_id(timer->dest);
+        }
+        Context *target = local_process_id ? globalcontext_get_process_nolock(global, local_process_id) : NULL;
+        if (target) {
+            mailbox_send_message(target, timer->message);
+        } else {
+            mailbox_message_destroy(timer->message, global);
+        }
+        free(timer);
+    }
+    list_init(&global->fired_erlang_timers);
+    synclist_unlock(&global->processes_table);
+}
+
+void scheduler_destroy_timers(GlobalContext *glb)
+{
+    for (unsigned int i = 0; i < glb->erlang_timers_index_capacity; i++) {
+        struct ErlangTimer *timer = glb->erlang_timers_index[i];
+        while (timer) {
+            struct ErlangTimer *next = timer->index_next;
+            timer_list_remove(&glb->timer_list, &timer->timer_list_item);
+            mailbox_message_destroy(timer->message, glb);
+            free(timer);
+            timer = next;
+        }
+    }
+    struct ListHead *item;
+    struct ListHead *tmp;
+    MUTABLE_LIST_FOR_EACH (item, tmp, &glb->fired_erlang_timers) {
+        struct ErlangTimer *timer = GET_LIST_ENTRY(item, struct ErlangTimer, timer_list_item.head);
+        mailbox_message_destroy(timer->message, glb);
+        free(timer);
+    }
+    list_init(&glb->fired_erlang_timers);
+    free(glb->erlang_timers_index);
+    glb->erlang_timers_index = NULL;
+    glb->erlang_timers_index_capacity = 0;
+    glb->erlang_timers_count = 0;
+}
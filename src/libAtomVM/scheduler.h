@@ -34,12 +34,16 @@ extern "C" {
 
 #include "context.h"
 #include "globalcontext.h"
+#include "mailbox.h"
 
 #define DEFAULT_REDUCTIONS_AMOUNT 1024
 
 /**
  * @brief run the scheduler and return a process to be executed.
  *
+ * @details starts a new scheduler on the calling thread, with its own run
+ * queue. Further processes are picked with `scheduler_wait`,
+ * `scheduler_next` or `scheduler_terminate_and_run`.
  * @param global the global context.
  */
 Context *scheduler_run(GlobalContext *global);
@@ -66,6 +70,18 @@ void scheduler_init_ready(Context *c);
  */
 void scheduler_signal_message(Context *c);
 
+/**
+ * @brief Signal a process that a message was inserted in the mailbox by a
+ * process running on a given scheduler.
+ *
+ * @details The process is queued on the run queue of the sending scheduler,
+ * which is likely to run it next, instead of on the global run queue.
+ * @param c the process context.
+ * @param scheduler_id the scheduler of the calling thread, or
+ * `MEMORY_POOL_SHARED_CACHE` if the caller is not running on a scheduler.
+ */
+void scheduler_signal_message_on_scheduler(Context *c, int scheduler_id);
+
 /**
  * @brief Signal a process that it was killed.
  *
@@ -81,6 +97,15 @@ void scheduler_kill(Context *ctx);
  */
 void scheduler_terminate(Context *c);
 
+/**
+ * @brief terminates the running process and gets next runnable process
+ *
+ * @details terminates the process as `scheduler_terminate` does and picks the next process to run on the same scheduler.
+ * @param c the process that is going to be terminated.
+ * @returns runnable process or NULL if the scheduler should stop.
+ */
+Context *scheduler_terminate_and_run(Context *c);
+
 /**
  * @brief Terminate all schedulers. Every process is terminated gracefully at next scheduling point.
  *
@@ -109,6 +134,51 @@ void scheduler_set_timeout(Context *ctx, avm_int64_t timeout);
 
 void scheduler_cancel_timeout(Context *ctx);
 
+/**
+ * @brief starts a timer that sends a message when it expires
+ *
+ * @details Used by `erlang:send_after/3` and `erlang:start_timer/3,4`. When
+ * the timer expires, the message is sent to dest, a local pid or a
+ * registered name resolved at that time. If there is no such process, the
+ * message is dropped.
+ * @param glb the global context
+ * @param ref_ticks the reference identifying the timer
+ * @param timeout amount of time to be waited in milliseconds.
+ * @param dest the pid or registered name of the recipient
+ * @param message the message to send, owned by the timer on success
+ * @returns true on success, false if the timer could not be allocated
+ */
+bool scheduler_start_timer(GlobalContext *glb, uint64_t ref_ticks, avm_int64_t timeout, term dest, Message *message);
+
+/**
+ * @brief cancels a timer started with `scheduler_start_timer`
+ *
+ * @param glb the global context
+ * @param ref_ticks the reference identifying the timer
+ * @param remaining set to the time left before expiry, in milliseconds
+ * @returns false if the timer was not found because it expired or was
+ * already cancelled
+ */
+bool scheduler_cancel_timer(GlobalContext *glb, uint64_t ref_ticks, avm_int64_t *remaining);
+
+/**
+ * @brief reads the time left of a timer started with `scheduler_start_timer`
+ *
+ * @param glb the global context
+ * @param ref_ticks the reference identifying the timer
+ * @param remaining set to the time left before expiry, in milliseconds
+ * @returns false if the timer was not found because it expired or was
+ * cancelled
+ */
+bool scheduler_read_timer(GlobalContext *glb, uint64_t ref_ticks, avm_int64_t *remaining);
+
+/**
+ * @brief destroys pending timers started with `scheduler_start_timer`
+ *
+ * @param glb the global context
+ */
+void scheduler_destroy_timers(GlobalContext *glb);
+
 /**
  * @brief Entry point for schedulers.
  *
@@ -24,13 +24,14 @@
 #include "context.h"
 #include "interop.h"
 #include "tempstack.h"
-#include "valueshashtable.h"
 
 #include <ctype.h>
 #include <inttypes.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 struct FprintfFun
 {
@@ -113,8 +114,7 @@ int term_funprint(PrinterFun *fun, term t, const GlobalContext *global)
 {
     if (term_is_atom(t)) {
         int atom_index = term_to_atom_index(t);
-        AtomString atom_string = (AtomString) valueshashtable_get_value(
-            global->atoms_ids_table, atom_index, (unsigned long) NULL);
+        AtomString atom_string = globalcontext_atomstring_from_index(global, atom_index);
         return fun->print(fun, "%.*s", (int) atom_string_len(atom_string),
             (char *) atom_string_data(atom_string));
 
@@ -401,6 +401,133 @@ static int term_type_to_index(term t)
     }
 }
 
+static TermCompareResult atom_compare(term t, term other, GlobalContext *global)
+{
+    int t_atom_index = term_to_atom_index(t);
+    int other_atom_index = term_to_atom_index(other);
+
+    // sort keys are made of the first bytes of the name, most atoms differ there
+    uint64_t t_key = globalcontext_atom_sort_key_from_index(global, t_atom_index);
+    uint64_t other_key = globalcontext_atom_sort_key_from_index(global, other_atom_index);
+    if (t_key != other_key) {
+        return (t_key > other_key) ? TermGreaterThan : TermLessThan;
+    }
+
+    AtomString t_atom_string = globalcontext_atomstring_from_index(global, t_atom_index);
+    int t_atom_len = atom_string_len(t_atom_string);
+    const char *t_atom_data = (const char *) atom_string_data(t_atom_string);
+
+    AtomString other_atom_string = globalcontext_atomstring_from_index(global, other_atom_index);
+    int other_atom_len = atom_string_len(other_atom_string);
+    const char *other_atom_data = (const char *) atom_string_data(other_atom_string);
+
+    int cmp_size = (t_atom_len > other_atom_len) ? other_atom_len : t_atom_len;
+
+    int memcmp_result = memcmp(t_atom_data, other_atom_data, cmp_size);
+    if (memcmp_result == 0) {
+        // different atoms never have the same name
+        return (t_atom_len > other_atom_len) ? TermGreaterThan : TermLessThan;
+    } else {
+        return memcmp_result > 0 ? TermGreaterThan : TermLessThan;
+    }
+}
+
+static TermCompareResult binary_compare(term t, term other)
+{
+    int t_size = term_binary_size(t);
+    int other_size = term_binary_size(other);
+
+    const char *t_data = term_binary_data(t);
+    const char *other_data = term_binary_data(other);
+
+    int cmp_size = (t_size > other_size) ? other_size : t_size;
+
+    int memcmp_result = memcmp(t_data, other_data, cmp_size);
+    if (memcmp_result == 0) {
+        if (t_size == other_size) {
+            return TermEquals;
+        } else {
+            return (t_size > other_size) ? TermGreaterThan : TermLessThan;
+        }
+    } else {
+        return (memcmp_result > 0) ? TermGreaterThan : TermLessThan;
+    }
+}
+
+static inline bool term_is_compound(term t)
+{
+    return term_is_nonempty_list(t) || term_is_tuple(t) || term_is_map(t);
+}
+
+// Compares terms that can be compared without walking their content, such as
+// immediates, numbers, atoms and binaries, without using a temp stack.
+// Returns false if t and other are containers of the same kind.
+static inline bool term_compare_leaf(term t, term other, TermCompareOpts opts, GlobalContext *global, TermCompareResult *result)
+{
+    if (t == other) {
+        *result = TermEquals;
+
+    } else if (term_is_integer(t) && term_is_integer(other)) {
+        *result = (term_to_int(t) > term_to_int(other)) ? TermGreaterThan : TermLessThan;
+
+    } else if (term_is_atom(t) && term_is_atom(other)) {
+        *result = atom_compare(t, other, global);
+
+    } else if (term_is_any_integer(t) && term_is_any_integer(other)) {
+        avm_int64_t t_int = term_maybe_unbox_int64(t);
+        avm_int64_t other_int = term_maybe_unbox_int64(other);
+        if (t_int == other_int) {
+            *result = TermEquals;
+        } else {
+            *result = (t_int > other_int) ? TermGreaterThan : TermLessThan;
+        }
+
+    } else if (term_is_float(t) && term_is_float(other)) {
+        avm_float_t t_float = term_to_float(t);
+        avm_float_t other_float = term_to_float(other);
+        if (t_float == other_float) {
+            *result = TermEquals;
+        } else {
+            *result = (t_float > other_float) ? TermGreaterThan : TermLessThan;
+        }
+
+    } else if (term_is_number(t) && term_is_number(other)
+        && ((opts & TermCompareExact) != TermCompareExact)) {
+        avm_float_t t_float = term_conv_to_float(t);
+        avm_float_t other_float = term_conv_to_float(other);
+        if (t_float == other_float) {
+            *result = TermEquals;
+        } else {
+            *result = (t_float > other_float) ? TermGreaterThan : TermLessThan;
+        }
+
+    } else if (term_is_binary(t) && term_is_binary(other)) {
+        *result = binary_compare(t, other);
+
+    } else if (term_is_reference(t) && term_is_reference(other)) {
+        int64_t t_ticks = term_to_ref_ticks(t);
+        int64_t other_ticks = term_to_ref_ticks(other);
+        if (t_ticks == other_ticks) {
+            *result = TermEquals;
+        } else {
+            *result = (t_ticks > other_ticks) ? TermGreaterThan : TermLessThan;
+        }
+
+    } else if (term_is_pid(t) && term_is_pid(other)) {
+        //TODO: handle ports
+        *result = (t > other) ? TermGreaterThan : TermLessThan;
+
+    } else if (term_is_compound(t) && term_is_compound(other)
+        && term_type_to_index(t) == term_type_to_index(other)) {
+        return false;
+
+    } else {
+        *result = (term_type_to_index(t) > term_type_to_index(other)) ? TermGreaterThan : TermLessThan;
+    }
+
+    return true;
+}
+
 #define BEGIN_MAP_KEY TERM_RESERVED_MARKER(1)
 #define END_MAP_KEY TERM_RESERVED_MARKER(0)
 
@@ -417,6 +544,11 @@ static int term_type_to_index(term t)
 
 TermCompareResult term_compare(term t, term other, TermCompareOpts opts, GlobalContext *global)
 {
+    TermCompareResult leaf_result;
+    if (term_compare_leaf(t, other, opts, global, &leaf_result)) {
+        return leaf_result;
+    }
+
     struct TempStack temp_stack;
     if (UNLIKELY(temp_stack_init(&temp_stack) != TempStackOk)) {
         return TermCompareMemoryAllocFail;
@@ -501,24 +633,11 @@ TermCompareResult term_compare(term t, term other, TermCompareOpts opts, GlobalC
             }
 
         } else if (term_is_binary(t) && term_is_binary(other)) {
-            int t_size = term_binary_size(t);
-            int other_size = term_binary_size(other);
-
-            const char *t_data = term_binary_data(t);
-            const char *other_data = term_binary_data(other);
-
-            int cmp_size = (t_size > other_size) ? other_size : t_size;
-
-            int memcmp_result = memcmp(t_data, other_data, cmp_size);
-            if (memcmp_result == 0) {
-                if (t_size == other_size) {
-                    CMP_POP_AND_CONTINUE();
-                } else {
-                    result = (t_size > other_size) ? TermGreaterThan : TermLessThan;
-                    break;
-                }
+            TermCompareResult binary_result = binary_compare(t, other);
+            if (binary_result == TermEquals) {
+                CMP_POP_AND_CONTINUE();
             } else {
-                result = (memcmp_result > 0) ? TermGreaterThan : TermLessThan;
+                result = binary_result;
                 break;
             }
 
@@ -606,30 +725,8 @@ TermCompareResult term_compare(term t, term other, TermCompareOpts opts, GlobalC
             }
 
         } else if (term_is_atom(t) && term_is_atom(other)) {
-            int t_atom_index = term_to_atom_index(t);
-            AtomString t_atom_string = (AtomString) valueshashtable_get_value(global->atoms_ids_table,
-                t_atom_index, (unsigned long) NULL);
-
-            int t_atom_len = atom_string_len(t_atom_string);
-            const char *t_atom_data = (const char *) atom_string_data(t_atom_string);
-
-            int other_atom_index = term_to_atom_index(other);
-            AtomString other_atom_string = (AtomString) valueshashtable_get_value(global->atoms_ids_table,
-                other_atom_index, (unsigned long) NULL);
-
-            int other_atom_len = atom_string_len(other_atom_string);
-            const char *other_atom_data = (const char *) atom_string_data(other_atom_string);
-
-            int cmp_size = (t_atom_len > other_atom_len) ? other_atom_len : t_atom_len;
-
-            int memcmp_result = memcmp(t_atom_data, other_atom_data, cmp_size);
-            if (memcmp_result == 0) {
-                result = (t_atom_len > other_atom_len) ? TermGreaterThan : TermLessThan;
-                break;
-            } else {
-                result = memcmp_result > 0 ? TermGreaterThan : TermLessThan;
-                break;
-            }
+            result = atom_compare(t, other, global);
+            break;
 
         } else if (term_is_pid(t) && term_is_pid(other)) {
             //TODO: handle ports
@@ -710,3 +807,83 @@ term term_get_map_assoc(term map, term key, GlobalContext *glb)
     }
     return term_get_map_value(map, pos);
 }
+
+// Stable merge sort of map entries by key, buffer must hold len entries
+static bool map_entries_sort(struct MapEntry *entries, struct MapEntry *buffer, size_t len, GlobalContext *global)
+{
+    if (len < 2) {
+        return true;
+    }
+    size_t half = len / 2;
+    if (UNLIKELY(!map_entries_sort(entries, buffer, half, global) || !map_entries_sort(entries + half, buffer, len - half, global))) {
+        return false;
+    }
+    memcpy(buffer, entries, len * sizeof(struct MapEntry));
+    size_t i = 0;
+    size_t j = half;
+    size_t k = 0;
+    while (i < half && j < len) {
+        TermCompareResult result = term_compare(buffer[j].key, buffer[i].key, TermCompareExact, global);
+        if (UNLIKELY(result == TermCompareMemoryAllocFail)) {
+            return false;
+        }
+        entries[k++] = result == TermLessThan ? buffer[j++] : buffer[i++];
+    }
+    while (i < half) {
+        entries[k++] = buffer[i++];
+    }
+    while (j < len) {
+        entries[k++] = buffer[j++];
+    }
+    return true;
+}
+
+bool term_sort_map_entries(struct MapEntry *entries, size_t len, GlobalContext *global)
+{
+    if (len < 2) {
+        return true;
+    }
+    struct MapEntry *buffer = malloc(len * sizeof(struct MapEntry));
+    if (IS_NULL_PTR(buffer)) {
+        return false;
+    }
+    bool result = map_entries_sort(entries, buffer, len, global);
+    free(buffer);
+    return result;
+}
+
+bool term_sort_map(term map, GlobalContext *global)
+{
+    int size = term_get_map_size(map);
+    bool sorted = true;
+    for (int i = 1; i < size; i++) {
+        TermCompareResult result = term_compare(term_get_map_key(map, i - 1), term_get_map_key(map, i), TermCompareExact, global);
+        if (UNLIKELY(result == TermCompareMemoryAllocFail)) {
+            return false;
+        }
+        if (result == TermGreaterThan) {
+            sorted = false;
+            break;
+        }
+    }
+    if (sorted) {
+        return true;
+    }
+
+    struct MapEntry *entries = malloc(size * sizeof(struct MapEntry));
+    if (IS_NULL_PTR(entries)) {
+        return false;
+    }
+    for (int i = 0; i < size; i++) {
+        entries[i].key = term_get_map_key(map, i);
+        entries[i].value = term_get_map_value(map, i);
+    }
+    bool result = term_sort_map_entries(entries, size, global);
+    if (result) {
+        for (int i = 0; i < size; i++) {
+            term_set_map_assoc(map, i, entries[i].key, entries[i].value);
+        }
+    }
+    free(entries);
+    return result;
+}
@@ -142,6 +142,9 @@ typedef enum
 #define TERM_MAP_NOT_FOUND -1
 #define TERM_MAP_MEMORY_ALLOC_FAIL -2
 
+// Maps up to this size are scanned for immediate keys instead of searched
+#define TERM_MAP_LINEAR_SEARCH_MAX_SIZE 8
+
 /**
  * @brief All empty tuples will reference this
  */
@@ -1644,18 +1647,47 @@ static inline term term_get_map_value(term map, avm_uint_t pos)
     return boxed_value[term_get_map_value_offset() + pos];
 }
 
+/**
+ * @brief Find the position of a key in a map
+ *
+ * @details Keys of a map are sorted with `TermCompareExact`, so they are
+ * binary searched. In small maps, immediate keys are compared by value instead.
+ * @param map the map to search
+ * @param key the key to find
+ * @param global the global context
+ * @return the position of the key, `TERM_MAP_NOT_FOUND` or `TERM_MAP_MEMORY_ALLOC_FAIL`
+ */
 static inline int term_find_map_pos(term map, term key, GlobalContext *global)
 {
     term keys = term_get_map_keys(map);
     int arity = term_get_tuple_arity(keys);
-    for (int i = 0; i < arity; ++i) {
-        term k = term_get_tuple_element(keys, i);
+    /* immediate: xx 11 */
+    if (arity <= TERM_MAP_LINEAR_SEARCH_MAX_SIZE && (key & 0x3) == 0x3) {
+        // An immediate key is only equal to the same immediate
+        for (int i = 0; i < arity; ++i) {
+            if (term_get_tuple_element(keys, i) == key) {
+                return i;
+            }
+        }
+        return TERM_MAP_NOT_FOUND;
+    }
+    int low = 0;
+    int high = arity;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        term k = term_get_tuple_element(keys, mid);
         // TODO: not sure if exact is the right choice here
-        TermCompareResult result = term_compare(key, k, TermCompareExact, global);
-        if (result == TermEquals) {
-            return i;
-        } else if (UNLIKELY(result == TermCompareMemoryAllocFail)) {
-            return TERM_MAP_MEMORY_ALLOC_FAIL;
+        switch (term_compare(key, k, TermCompareExact, global)) {
+            case TermEquals:
+                return mid;
+            case TermLessThan:
+                high = mid;
+                break;
+            case TermGreaterThan:
+                low = mid + 1;
+                break;
+            case TermCompareMemoryAllocFail:
+                return TERM_MAP_MEMORY_ALLOC_FAIL;
         }
     }
 
@@ -1664,6 +1696,36 @@ static inline int term_find_map_pos(term map, term key, GlobalContext *global)
 
 term term_get_map_assoc(term map, term key, GlobalContext *glb);
 
+struct MapEntry
+{
+    term key;
+    term value;
+};
+
+/**
+ * @brief Sort map entries by key
+ *
+ * @details Entries are sorted with `TermCompareExact`, like map keys. The sort
+ * is stable, so entries with the same key keep their order.
+ * @param entries the entries to sort
+ * @param len the number of entries
+ * @param global the global context
+ * @return \c false if memory allocation failed
+ */
+bool term_sort_map_entries(struct MapEntry *entries, size_t len, GlobalContext *global);
+
+/**
+ * @brief Sort the keys of a map built in another order
+ *
+ * @details Maps built from external terms or by native code may not have
+ * sorted keys, which `term_find_map_pos` requires. Keys tuple of the map
+ * must not be shared with another map.
+ * @param map the map to sort
+ * @param global the global context
+ * @return \c false if memory allocation failed
+ */
+bool term_sort_map(term map, GlobalContext *global);
+
 static inline term term_get_map_assoc_default(term map, term key, term default_value, GlobalContext *glb)
 {
     term ret = term_get_map_assoc(map, key, glb);
@@ -20,24 +20,169 @@
 
 #include "timer_list.h"
 
-void timer_list_next(struct TimerList *tw, uint64_t now, timer_list_callback_t cb)
+#define TIMER_LIST_WHEEL_BITS (TIMER_LIST_LEVEL_BITS * TIMER_LIST_LEVELS)
+
+static inline unsigned timer_list_first_slot(uint64_t bitmap)
 {
-    if (tw->timers == 0 || now < tw->next_timer) {
-        return;
+#ifdef __GNUC__
+    return __builtin_ctzll(bitmap);
+#else
+    unsigned slot = 0;
+    while (!(bitmap & 1)) {
+        bitmap >>= 1;
+        slot++;
+    }
+    return slot;
+#endif
+}
+
+static void timer_list_place(struct TimerList *tw, struct TimerListItem *item)
+{
+    uint64_t current = tw->current;
+    uint64_t expiry_time = item->expiry_time;
+    if (expiry_time < current) {
+        expiry_time = current;
+    }
+    uint64_t delta = expiry_time ^ current;
+    for (int level = 0; level < TIMER_LIST_LEVELS; level++) {
+        unsigned shift = level * TIMER_LIST_LEVEL_BITS;
+        if ((delta >> (shift + TIMER_LIST_LEVEL_BITS)) == 0) {
+            unsigned slot = (expiry_time >> shift) & TIMER_LIST_LEVEL_MASK;
+            list_append(&tw->levels[level].slots[slot], &item->head);
+            tw->levels[level].occupied |= UINT64_C(1) << slot;
+            return;
+        }
+    }
+    list_append(&tw->overflow, &item->head);
+}
+
+void timer_list_insert(struct TimerList *tw, struct TimerListItem *item)
+{
+    uint64_t expiry_time = item->expiry_time;
+
+    if (tw->timers == 0 || expiry_time < tw->next_timer) {
+        tw->next_timer = expiry_time;
+    }
+
+    tw->timers++;
+
+    timer_list_place(tw, item);
+}
+
+static uint64_t timer_list_min_expiry(struct ListHead *list)
+{
+    uint64_t result = UINT64_MAX;
+    struct ListHead *item;
+    LIST_FOR_EACH (item, list) {
+        struct TimerListItem *ti = GET_LIST_ENTRY(item, struct TimerListItem, head);
+        if (ti->expiry_time < result) {
+            result = ti->expiry_time;
+        }
+    }
+    return result;
+}
+
+/*
+ * Find the next tick after current where something happens: either a level 0
+ * slot with timers to fire, or a slot of an upper level (or the overflow
+ * list) with timers to cascade. Slots of lower levels always come before
+ * slots of upper levels, so the first non-empty slot found is the next one.
+ */
+static uint64_t timer_list_next_event(struct TimerList *tw, struct ListHead **slot_list)
+{
+    uint64_t current = tw->current;
+    for (int level = 0; level < TIMER_LIST_LEVELS; level++) {
+        struct TimerListLevel *wheel_level = &tw->levels[level];
+        unsigned shift = level * TIMER_LIST_LEVEL_BITS;
+        unsigned position = (current >> shift) & TIMER_LIST_LEVEL_MASK;
+        uint64_t pending = position == TIMER_LIST_LEVEL_MASK ? 0 : wheel_level->occupied & (~UINT64_C(0) << (position + 1));
+        while (pending) {
+            unsigned slot = timer_list_first_slot(pending);
+            uint64_t slot_bit = UINT64_C(1) << slot;
+            if (list_is_empty(&wheel_level->slots[slot])) {
+                // All timers of this slot were removed
+                wheel_level->occupied &= ~slot_bit;
+                pending &= ~slot_bit;
+                continue;
+            }
+            *slot_list = &wheel_level->slots[slot];
+            uint64_t window = (current >> (shift + TIMER_LIST_LEVEL_BITS)) << (shift + TIMER_LIST_LEVEL_BITS);
+            return window | ((uint64_t) slot << shift);
+        }
+    }
+    if (!list_is_empty(&tw->overflow)) {
+        *slot_list = &tw->overflow;
+        // Jump directly to the block of the earliest timer
+        uint64_t min_expiry = timer_list_min_expiry(&tw->overflow);
+        return (min_expiry >> TIMER_LIST_WHEEL_BITS) << TIMER_LIST_WHEEL_BITS;
     }
+    *slot_list = NULL;
+    return UINT64_MAX;
+}
+
+static void timer_list_fire_slot(struct TimerList *tw, struct ListHead *slot_list, timer_list_callback_t cb)
+{
     struct ListHead *item;
     struct ListHead *tmp;
-    uint64_t next_timer = 0;
-    MUTABLE_LIST_FOR_EACH (item, tmp, &tw->head) {
+    MUTABLE_LIST_FOR_EACH (item, tmp, slot_list) {
         struct TimerListItem *ti = GET_LIST_ENTRY(item, struct TimerListItem, head);
-        if (ti->expiry_time <= now) {
-            tw->timers--;
-            list_remove(item);
-            list_init(item);
+        tw->timers--;
+        list_remove(item);
+        list_init(item);
+        if (ti->callback) {
+            ti->callback(ti);
+        } else {
             cb(ti);
-        } else if (next_timer == 0 || ti->expiry_time < next_timer) {
-            next_timer = ti->expiry_time;
         }
     }
-    tw->next_timer = next_timer;
+}
+
+static void timer_list_cascade_slot(struct TimerList *tw, struct ListHead *slot_list)
+{
+    // Detach timers from the slot first, as some of them may be placed back
+    // into it (this happens with the overflow list)
+    struct ListHead pending;
+    list_append(slot_list, &pending);
+    list_remove(slot_list);
+    list_init(slot_list);
+
+    struct ListHead *item;
+    struct ListHead *tmp;
+    MUTABLE_LIST_FOR_EACH (item, tmp, &pending) {
+        struct TimerListItem *ti = GET_LIST_ENTRY(item, struct TimerListItem, head);
+        list_remove(item);
+        timer_list_place(tw, ti);
+    }
+}
+
+void timer_list_next(struct TimerList *tw, uint64_t now, timer_list_callback_t cb)
+{
+    if (tw->timers == 0 || now < tw->next_timer || now < tw->current) {
+        return;
+    }
+    struct TimerListLevel *level0 = &tw->levels[0];
+
+    // Timers expiring at current or inserted with an expiry time in the past
+    timer_list_fire_slot(tw, &level0->slots[tw->current & TIMER_LIST_LEVEL_MASK], cb);
+
+    struct ListHead *slot_list;
+    uint64_t event;
+    while ((event = timer_list_next_event(tw, &slot_list)) <= now) {
+        tw->current = event;
+        struct ListHead *current_slot = &level0->slots[event & TIMER_LIST_LEVEL_MASK];
+        if (slot_list != current_slot) {
+            timer_list_cascade_slot(tw, slot_list);
+        }
+        timer_list_fire_slot(tw, current_slot, cb);
+    }
+    // No timer is due up to now, so every remaining timer keeps its slot
+    tw->current = now;
+
+    if (slot_list == NULL) {
+        tw->next_timer = 0;
+    } else if (slot_list == &level0->slots[event & TIMER_LIST_LEVEL_MASK]) {
+        tw->next_timer = event;
+    } else {
+        tw->next_timer = timer_list_min_expiry(slot_list);
+    }
 }
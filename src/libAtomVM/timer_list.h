@@ -26,16 +26,50 @@ extern "C" {
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "list.h"
 
+/**
+ * @brief number of bits of the expiry time consumed by each wheel level
+ */
+#define TIMER_LIST_LEVEL_BITS 6
+#define TIMER_LIST_LEVEL_SLOTS (1 << TIMER_LIST_LEVEL_BITS)
+#define TIMER_LIST_LEVEL_MASK (TIMER_LIST_LEVEL_SLOTS - 1)
+
+/**
+ * @brief number of levels of the wheel
+ *
+ * @details Timers expiring further than `TIMER_LIST_LEVEL_SLOTS ^
+ * TIMER_LIST_LEVELS` ticks away are kept in an overflow list until they get
+ * closer.
+ */
+#define TIMER_LIST_LEVELS 4
+
 struct TimerListItem;
 typedef void(timer_list_callback_t)(struct TimerListItem *);
 
+struct TimerListLevel
+{
+    uint64_t occupied;
+    struct ListHead slots[TIMER_LIST_LEVEL_SLOTS];
+};
+
+/**
+ * @brief hierarchical timer wheel
+ *
+ * @details Level `n` holds timers whose expiry time shares all bits above
+ * level `n` with `current`, in the slot given by the level `n` bits of their
+ * expiry time. Timers are moved down one or more levels when `current`
+ * reaches their slot. The unit of `expiry_time` (the tick) is chosen by the
+ * caller.
+ */
 struct TimerList
 {
-    struct ListHead head;
+    struct TimerListLevel levels[TIMER_LIST_LEVELS];
+    struct ListHead overflow;
+    uint64_t current;
     int timers;
     uint64_t next_timer;
 };
@@ -44,32 +78,40 @@ struct TimerListItem
 {
     uint64_t expiry_time;
     struct ListHead head;
+    // Callback for this item, NULL for the one passed to timer_list_next
+    timer_list_callback_t *callback;
 };
 
 static inline void timer_list_init(struct TimerList *tw)
 {
-    list_init(&tw->head);
+    for (int i = 0; i < TIMER_LIST_LEVELS; i++) {
+        tw->levels[i].occupied = 0;
+        for (int j = 0; j < TIMER_LIST_LEVEL_SLOTS; j++) {
+            list_init(&tw->levels[i].slots[j]);
+        }
+    }
+    list_init(&tw->overflow);
+    tw->current = 0;
     tw->timers = 0;
     tw->next_timer = 0;
 }
 
-static inline void timer_list_insert(struct TimerList *tw, struct TimerListItem *item)
-{
-    uint64_t expiry_time = item->expiry_time;
-
-    if (tw->timers == 0 || expiry_time < tw->next_timer) {
-        tw->next_timer = expiry_time;
-    }
-
-    tw->timers++;
-
-    list_append(&tw->head, &item->head);
-}
+/**
+ * @brief add an item to the timer wheel
+ *
+ * @details Insertion is O(1). Items with an `expiry_time` in the past are
+ * fired by the next call to `timer_list_next`.
+ *
+ * @param tw the timer wheel
+ * @param item the item to insert, initialized with `timer_list_item_init`
+ */
+void timer_list_insert(struct TimerList *tw, struct TimerListItem *item);
 
 static inline void timer_list_remove(struct TimerList *tw, struct TimerListItem *item)
 {
     if (item->head.next != &item->head) {
         tw->timers--;
+        // Slot occupancy bit is cleared lazily by timer_list_next
         list_remove(&item->head);
         list_init(&item->head);
     }
@@ -89,20 +131,22 @@ static inline void timer_list_item_init(struct TimerListItem *it, uint64_t expir
 {
     list_init(&it->head);
     it->expiry_time = expiry;
+    it->callback = NULL;
 }
 
 /**
- * @brief process the timer wheel, calling cb for every item that should be
- * fired (for which `expiry_time` <= `now`).
+ * @brief process the timer wheel, calling the callback of every item that
+ * should be fired (for which `expiry_time` <= `now`), or cb if the item has
+ * none.
  *
- * @details The current algorithm is very basic. Under heavy load, two
- * processes scheduled for different timers might be triggered (same seems to
- * be true with BEAM). The only optimization is the next time is saved so the
- * function doesn't run every timer on every call.
+ * @details Only non-empty slots between the previous call and `now` are
+ * visited, so the cost is proportional to the number of fired and cascaded
+ * timers rather than to the number of pending timers. `next_timer` is
+ * updated to the earliest pending expiry time, or 0 if the wheel is empty.
  *
  * @param tw the timer wheel
- * @param now the current monotonic date
- * @param cb the callback
+ * @param now the current monotonic date, in ticks
+ * @param cb the callback for items without their own callback
  */
 void timer_list_next(struct TimerList *tw, uint64_t now, timer_list_callback_t cb);
 
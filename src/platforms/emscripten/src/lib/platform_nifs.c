@@ -292,6 +292,15 @@ static term term_from_emscripten_result(EMSCRIPTEN_RESULT em_result, Context *ct
     return result_tuple;
 }
 
+// Keys of event maps are entered in no particular order
+static void sort_event_map(term map, GlobalContext *global)
+{
+    if (UNLIKELY(!term_sort_map(map, global))) {
+        fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+        AVM_ABORT();
+    }
+}
+
 static EM_BOOL html5api_key_callback(int eventType, const EmscriptenKeyboardEvent *event, void *user_data)
 {
     struct RefcBinary *refc = refc_binary_from_data(user_data);
@@ -352,6 +361,7 @@ static EM_BOOL html5api_key_callback(int eventType, const EmscriptenKeyboardEven
     term_set_map_assoc(event_map, 12, globalcontext_make_atom(global, ATOM_STR("\xA", "char_value")), term_from_literal_binary(event->charValue, char_value_len, &heap, global));
     term_set_map_assoc(event_map, 13, globalcontext_make_atom(global, ATOM_STR("\x6", "locale")), term_from_literal_binary(event->locale, locale_len, &heap, global));
 
+    sort_event_map(event_map, global);
     sys_enqueue_emscripten_htmlevent_message(global, resource->target_pid, event_term, resource->user_data, heap.root);
     return resource->prevent_default;
 }
@@ -444,6 +454,7 @@ static EM_BOOL html5api_mouse_callback(int eventType, const EmscriptenMouseEvent
 
     enter_mouse_event_to_map(event_map, event, global, &heap);
 
+    sort_event_map(event_map, global);
     sys_enqueue_emscripten_htmlevent_message(global, resource->target_pid, event_term, resource->user_data, heap.root);
     return resource->prevent_default;
 }
@@ -484,6 +495,7 @@ static EM_BOOL html5api_wheel_callback(int eventType, const EmscriptenWheelEvent
     term_set_map_assoc(event_map, 18, globalcontext_make_atom(global, ATOM_STR("\x7", "delta_z")), term_from_float(event->deltaZ, &heap));
     term_set_map_assoc(event_map, 19, globalcontext_make_atom(global, ATOM_STR("\xA", "delta_mode")), term_make_maybe_boxed_int64(event->deltaMode, &heap));
 
+    sort_event_map(event_map, global);
     sys_enqueue_emscripten_htmlevent_message(global, resource->target_pid, event_term, resource->user_data, heap.root);
     return resource->prevent_default;
 }
@@ -528,6 +540,7 @@ static EM_BOOL html5api_ui_callback(int eventType, const EmscriptenUiEvent *even
     term_set_map_assoc(event_map, 7, globalcontext_make_atom(global, ATOM_STR("\xA", "scroll_top")), term_from_int(event->scrollTop));
     term_set_map_assoc(event_map, 8, globalcontext_make_atom(global, ATOM_STR("\xB", "scroll_left")), term_from_int(event->scrollLeft));
 
+    sort_event_map(event_map, global);
     sys_enqueue_emscripten_htmlevent_message(global, resource->target_pid, event_term, resource->user_data, heap.root);
     return resource->prevent_default;
 }
@@ -574,6 +587,7 @@ static EM_BOOL html5api_focus_callback(int eventType, const EmscriptenFocusEvent
     term_set_map_assoc(event_map, 0, globalcontext_make_atom(global, ATOM_STR("\x9", "node_name")), term_from_literal_binary(event->nodeName, node_name_len, &heap, global));
     term_set_map_assoc(event_map, 1, globalcontext_make_atom(global, ATOM_STR("\x2", "id")), term_from_literal_binary(event->id, id_len, &heap, global));
 
+    sort_event_map(event_map, global);
     sys_enqueue_emscripten_htmlevent_message(global, resource->target_pid, event_term, resource->user_data, heap.root);
     return resource->prevent_default;
 }
@@ -652,6 +666,7 @@ static EM_BOOL html5api_touch_callback(int eventType, const EmscriptenTouchEvent
     for (int i = event->numTouches - 1; i >= 0; i--) {
         term touch_map = term_alloc_map(11, &heap);
         enter_touch_point_to_map(touch_map, &event->touches[i], global, &heap);
+        sort_event_map(touch_map, global);
         touches_list = term_list_prepend(touch_map, touches_list, &heap);
     }
 
@@ -662,6 +677,7 @@ static EM_BOOL html5api_touch_callback(int eventType, const EmscriptenTouchEvent
     term_set_map_assoc(event_map, 4, globalcontext_make_atom(global, ATOM_STR("\x8", "meta_key")), event->metaKey ? TRUE_ATOM : FALSE_ATOM);
     term_set_map_assoc(event_map, 5, globalcontext_make_atom(global, ATOM_STR("\x7", "touches")), touches_list);
 
+    sort_event_map(event_map, global);
     sys_enqueue_emscripten_htmlevent_message(global, resource->target_pid, event_term, resource->user_data, heap.root);
     return resource->prevent_default;
 }
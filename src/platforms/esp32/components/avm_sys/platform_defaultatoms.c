@@ -25,8 +25,6 @@ static const char *const gpio_interrupt_atom = "\xE" "gpio_interrupt";
 static const char *const rising_atom = "\x6" "rising";
 static const char *const falling_atom = "\x7" "falling";
 static const char *const both_atom = "\x4" "both";
-static const char *const low_atom = "\x3" "low";
-static const char *const high_atom = "\x4" "high";
 
 static const char *const esp32_atom = "\x5" "esp32";
 
@@ -82,8 +80,6 @@ void platform_defaultatoms_init(GlobalContext *glb)
     ok &= globalcontext_insert_atom(glb, rising_atom) == RISING_ATOM_INDEX;
     ok &= globalcontext_insert_atom(glb, falling_atom) == FALLING_ATOM_INDEX;
     ok &= globalcontext_insert_atom(glb, both_atom) == BOTH_ATOM_INDEX;
-    ok &= globalcontext_insert_atom(glb, low_atom) == LOW_ATOM_INDEX;
-    ok &= globalcontext_insert_atom(glb, high_atom) == HIGH_ATOM_INDEX;
 
     ok &= globalcontext_insert_atom(glb, esp32_atom) == ESP32_ATOM_INDEX;
 
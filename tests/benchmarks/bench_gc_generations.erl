@@ -0,0 +1,66 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+%% Measures garbage collection of a process keeping a large state while it
+%% allocates short lived terms, with full sweeps only (fullsweep_after set to
+%% 0) and with minor collections. Along with the time, it displays the number
+%% of collections and of words they reclaimed.
+
+-module(bench_gc_generations).
+
+-export([start/0, run/2]).
+
+-define(STATE_SIZE, 5000).
+-define(ROUNDS, 5000).
+-define(GARBAGE_SIZE, 100).
+
+start() ->
+    ok = bench(0),
+    ok = bench(65535),
+    0.
+
+bench(FullsweepAfter) ->
+    Self = self(),
+    {GCs0, Reclaimed0, 0} = erlang:statistics(garbage_collection),
+    Start = erlang:system_time(millisecond),
+    Pid = spawn_opt(?MODULE, run, [Self, ?ROUNDS], [{fullsweep_after, FullsweepAfter}]),
+    receive
+        {Pid, done} -> ok
+    end,
+    Time = erlang:system_time(millisecond) - Start,
+    {GCs1, Reclaimed1, 0} = erlang:statistics(garbage_collection),
+    erlang:display({fullsweep_after, FullsweepAfter, Time, GCs1 - GCs0, Reclaimed1 - Reclaimed0}),
+    ok.
+
+run(Parent, Rounds) ->
+    State = make_list(?STATE_SIZE, []),
+    ok = loop(State, Rounds),
+    Parent ! {self(), done}.
+
+loop(_State, 0) ->
+    ok;
+loop(State, N) ->
+    _Garbage = make_list(?GARBAGE_SIZE, []),
+    loop(State, N - 1).
+
+make_list(0, Acc) ->
+    Acc;
+make_list(N, Acc) ->
+    make_list(N - 1, [{N, N} | Acc]).
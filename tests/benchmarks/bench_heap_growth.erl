@@ -0,0 +1,73 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+%% Measures a process that allocates steadily with each heap growth strategy.
+%% Along with the time, it displays the number of garbage collections, the
+%% number of collections avoided compared to bounded_free and the memory of
+%% the process at the end of the run.
+
+-module(bench_heap_growth).
+
+-export([start/0, run/2]).
+
+-define(ROUNDS, 2000).
+-define(LIST_SIZE, 500).
+
+start() ->
+    ok = bench(bounded_free),
+    ok = bench(minimum),
+    ok = bench(fibonacci),
+    0.
+
+bench(Strategy) ->
+    Self = self(),
+    {GCs0, _, 0} = erlang:statistics(garbage_collection),
+    Start = erlang:system_time(millisecond),
+    Pid = spawn_opt(?MODULE, run, [Self, ?ROUNDS], [{atomvm_heap_growth, Strategy}]),
+    receive
+        {Pid, {garbage_collection, GC}, {memory, Memory}} ->
+            Time = erlang:system_time(millisecond) - Start,
+            {GCs1, _, 0} = erlang:statistics(garbage_collection),
+            {avoided_gcs, AvoidedGCs} = keyfind(avoided_gcs, GC),
+            erlang:display({Strategy, Time, GCs1 - GCs0, AvoidedGCs, Memory}),
+            ok
+    end.
+
+run(Parent, Rounds) ->
+    ok = loop(Rounds),
+    Parent ! {self(), process_info(self(), garbage_collection), process_info(self(), memory)}.
+
+loop(0) ->
+    ok;
+loop(N) ->
+    _ = make_list(?LIST_SIZE, []),
+    loop(N - 1).
+
+make_list(0, Acc) ->
+    Acc;
+make_list(N, Acc) ->
+    make_list(N - 1, [N | Acc]).
+
+keyfind(_Key, []) ->
+    false;
+keyfind(Key, [{Key, _} = Tuple | _]) ->
+    Tuple;
+keyfind(Key, [_ | T]) ->
+    keyfind(Key, T).
@@ -0,0 +1,73 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+%% Measures native maps module functions on maps of a few sizes.
+
+-module(bench_maps).
+
+-export([start/0]).
+
+start() ->
+    ok = bench_size(10, 10000),
+    ok = bench_size(100, 1000),
+    ok = bench_size(1000, 100),
+    0.
+
+bench_size(Size, Rounds) ->
+    List = make_entries(Size, []),
+    Map = maps:from_list(List),
+    Other = maps:from_list(make_entries(Size div 2, [])),
+    Key = Size div 2,
+    ok = bench(Size, from_list, Rounds, fun() -> maps:from_list(List) end),
+    ok = bench(Size, to_list, Rounds, fun() -> maps:to_list(Map) end),
+    ok = bench(Size, keys, Rounds, fun() -> maps:keys(Map) end),
+    ok = bench(Size, values, Rounds, fun() -> maps:values(Map) end),
+    ok = bench(Size, get, Rounds, fun() -> maps:get(Key, Map, undefined) end),
+    ok = bench(Size, find, Rounds, fun() -> maps:find(Key, Map) end),
+    ok = bench(Size, put_new, Rounds, fun() -> maps:put(new_key, value, Map) end),
+    ok = bench(Size, put_existing, Rounds, fun() -> maps:put(Key, value, Map) end),
+    ok = bench(Size, update, Rounds, fun() -> maps:update(Key, value, Map) end),
+    ok = bench(Size, remove, Rounds, fun() -> maps:remove(Key, Map) end),
+    ok = bench(Size, merge, Rounds, fun() -> maps:merge(Map, Other) end),
+    ok.
+
+bench(Size, Name, Rounds, Fun) ->
+    Start = erlang:system_time(millisecond),
+    ok = run(Fun, Rounds),
+    Time = erlang:system_time(millisecond) - Start,
+    erlang:display({maps, Name, Size, Rounds, Time}),
+    ok.
+
+run(_Fun, 0) ->
+    ok;
+run(Fun, N) ->
+    _ = Fun(),
+    run(Fun, N - 1).
+
+%% keys in reverse order, so from_list has to sort them
+make_entries(0, Acc) ->
+    reverse(Acc, []);
+make_entries(N, Acc) ->
+    make_entries(N - 1, [{N, N} | Acc]).
+
+reverse([], Acc) ->
+    Acc;
+reverse([H | T], Acc) ->
+    reverse(T, [H | Acc]).
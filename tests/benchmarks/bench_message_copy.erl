@@ -0,0 +1,60 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+%% Sends small, medium and large (about 100KB on 64 bits) messages to a
+%% process, to measure the cost of copying terms to mailboxes.
+
+-module(bench_message_copy).
+
+-export([start/0, receiver/2]).
+
+start() ->
+    ok = bench(small, {hello, 42, [1, 2, 3]}, 100000),
+    ok = bench(medium, make_list(100, []), 10000),
+    ok = bench(large, make_list(2500, []), 500),
+    0.
+
+bench(Name, Message, Rounds) ->
+    Pid = spawn(?MODULE, receiver, [self(), Rounds]),
+    Start = erlang:system_time(millisecond),
+    ok = send_rounds(Pid, Message, Rounds),
+    receive
+        {Pid, done} -> ok
+    end,
+    Time = erlang:system_time(millisecond) - Start,
+    erlang:display({message_copy, Name, erts_debug:flat_size(Message), Rounds, Time}),
+    ok.
+
+receiver(Parent, 0) ->
+    Parent ! {self(), done};
+receiver(Parent, N) ->
+    receive
+        _ -> receiver(Parent, N - 1)
+    end.
+
+send_rounds(_Pid, _Message, 0) ->
+    ok;
+send_rounds(Pid, Message, N) ->
+    Pid ! Message,
+    send_rounds(Pid, Message, N - 1).
+
+make_list(0, Acc) ->
+    Acc;
+make_list(N, Acc) ->
+    make_list(N - 1, [{N, N} | Acc]).
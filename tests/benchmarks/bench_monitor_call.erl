@@ -0,0 +1,83 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+%% Measures the latency of calls done like gen_server:call/2 (monitor, send,
+%% receive, demonitor with flush) while many idle processes exist.
+
+-module(bench_monitor_call).
+
+-export([start/0, idle/0, server/0]).
+
+-define(IDLE_PROCESSES, 10000).
+-define(CALLS, 100000).
+
+start() ->
+    Idle = spawn_idle(?IDLE_PROCESSES, []),
+    Server = spawn(?MODULE, server, []),
+    Start = erlang:system_time(millisecond),
+    ok = calls(Server, ?CALLS),
+    End = erlang:system_time(millisecond),
+    Server ! stop,
+    ok = stop_all(Idle),
+    erlang:display({monitor_call, ?IDLE_PROCESSES, ?CALLS, End - Start}),
+    0.
+
+spawn_idle(0, Acc) ->
+    Acc;
+spawn_idle(N, Acc) ->
+    Pid = spawn(?MODULE, idle, []),
+    spawn_idle(N - 1, [Pid | Acc]).
+
+idle() ->
+    receive
+        stop -> ok
+    end.
+
+stop_all([]) ->
+    ok;
+stop_all([Pid | Tail]) ->
+    Pid ! stop,
+    stop_all(Tail).
+
+server() ->
+    receive
+        {call, From, Ref, Request} ->
+            From ! {Ref, Request},
+            server();
+        stop ->
+            ok
+    end.
+
+calls(_Server, 0) ->
+    ok;
+calls(Server, N) ->
+    N = call(Server, N),
+    calls(Server, N - 1).
+
+call(Server, Request) ->
+    Ref = erlang:monitor(process, Server),
+    Server ! {call, self(), Ref, Request},
+    receive
+        {Ref, Reply} ->
+            erlang:demonitor(Ref, [flush]),
+            Reply;
+        {'DOWN', Ref, process, Server, Reason} ->
+            exit(Reason)
+    end.
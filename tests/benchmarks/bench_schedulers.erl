@@ -0,0 +1,127 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+%% Measures message passing throughput with 1 to N online schedulers, N being
+%% the number of schedulers, with two workloads:
+%% - ping_pong: pairs of processes exchanging messages, which benefit from
+%%   running both ends of a pair on the same scheduler;
+%% - fan_out: a process sending work to many workers and collecting the
+%%   replies, which benefits from idle schedulers stealing work.
+
+-module(bench_schedulers).
+
+-export([start/0, ponger/0, pinger/3, worker/0]).
+
+-define(PAIRS, 16).
+-define(EXCHANGES, 20000).
+-define(WORKERS, 64).
+-define(FAN_OUT_ROUNDS, 500).
+-define(WORK, 200).
+
+start() ->
+    Schedulers = erlang:system_info(schedulers),
+    Online = erlang:system_info(schedulers_online),
+    ok = run(1, Schedulers),
+    erlang:system_flag(schedulers_online, Online),
+    0.
+
+run(N, Schedulers) when N > Schedulers ->
+    ok;
+run(N, Schedulers) ->
+    erlang:system_flag(schedulers_online, N),
+    PingPong = ping_pong(?PAIRS, ?EXCHANGES),
+    erlang:display({ping_pong, N, ?PAIRS * ?EXCHANGES, PingPong}),
+    FanOut = fan_out(?WORKERS, ?FAN_OUT_ROUNDS),
+    erlang:display({fan_out, N, ?WORKERS * ?FAN_OUT_ROUNDS, FanOut}),
+    run(N + 1, Schedulers).
+
+ping_pong(Pairs, Exchanges) ->
+    Self = self(),
+    Start = erlang:system_time(millisecond),
+    ok = spawn_pingers(Pairs, Self, Exchanges),
+    ok = wait_done(Pairs),
+    erlang:system_time(millisecond) - Start.
+
+spawn_pingers(0, _Parent, _Exchanges) ->
+    ok;
+spawn_pingers(N, Parent, Exchanges) ->
+    spawn(?MODULE, pinger, [Parent, spawn(?MODULE, ponger, []), Exchanges]),
+    spawn_pingers(N - 1, Parent, Exchanges).
+
+pinger(Parent, Ponger, 0) ->
+    Ponger ! stop,
+    Parent ! done;
+pinger(Parent, Ponger, N) ->
+    Ponger ! {self(), N},
+    receive
+        N -> pinger(Parent, Ponger, N - 1)
+    end.
+
+ponger() ->
+    receive
+        {From, N} ->
+            From ! N,
+            ponger();
+        stop ->
+            ok
+    end.
+
+fan_out(Workers, Rounds) ->
+    Pids = spawn_workers(Workers, []),
+    Start = erlang:system_time(millisecond),
+    ok = fan_out_rounds(Pids, Rounds),
+    End = erlang:system_time(millisecond),
+    [Pid ! stop || Pid <- Pids],
+    End - Start.
+
+spawn_workers(0, Acc) ->
+    Acc;
+spawn_workers(N, Acc) ->
+    spawn_workers(N - 1, [spawn(?MODULE, worker, []) | Acc]).
+
+fan_out_rounds(_Pids, 0) ->
+    ok;
+fan_out_rounds(Pids, N) ->
+    Self = self(),
+    [Pid ! {Self, ?WORK} || Pid <- Pids],
+    ok = wait_done(length(Pids)),
+    fan_out_rounds(Pids, N - 1).
+
+worker() ->
+    receive
+        {From, Work} ->
+            _ = work(Work, 0),
+            From ! done,
+            worker();
+        stop ->
+            ok
+    end.
+
+work(0, Acc) ->
+    Acc;
+work(N, Acc) ->
+    work(N - 1, (Acc * 31 + N) band 16#FFFFFF).
+
+wait_done(0) ->
+    ok;
+wait_done(N) ->
+    receive
+        done -> wait_done(N - 1)
+    end.
@@ -0,0 +1,65 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+%% Sends messages to many processes, to measure the cost of looking up the
+%% destination process of each message.
+
+-module(bench_send_processes).
+
+-export([start/0, sink/0]).
+
+-define(PROCESSES, 100000).
+-define(ROUNDS, 10).
+
+start() ->
+    Pids = spawn_sinks(?PROCESSES, []),
+    Start = erlang:system_time(millisecond),
+    ok = send_rounds(Pids, ?ROUNDS),
+    End = erlang:system_time(millisecond),
+    ok = stop_sinks(Pids),
+    erlang:display({send_processes, ?PROCESSES, ?ROUNDS, End - Start}),
+    0.
+
+spawn_sinks(0, Acc) ->
+    Acc;
+spawn_sinks(N, Acc) ->
+    Pid = spawn(?MODULE, sink, []),
+    spawn_sinks(N - 1, [Pid | Acc]).
+
+sink() ->
+    receive
+        stop -> ok;
+        _ -> sink()
+    end.
+
+send_rounds(_Pids, 0) ->
+    ok;
+send_rounds(Pids, N) ->
+    send_all(Pids, hello),
+    send_rounds(Pids, N - 1).
+
+send_all([], _Message) ->
+    ok;
+send_all([Pid | Tail], Message) ->
+    Pid ! Message,
+    send_all(Tail, Message).
+
+stop_sinks(Pids) ->
+    send_all(Pids, stop).
@@ -42,6 +42,8 @@ start() ->
     _ = stringize(333222),
     "undefined" = erlang:atom_to_list(the_erase(6)),
     ok = test_put_get_erase(),
+    ok = test_many_keys(),
+    ok = test_get_keys(),
     W.
 
 put_int(N) ->
@@ -80,3 +82,89 @@ test_put_get_erase() ->
     2 = apply(erlang, list_to_atom("erase"), [{any_term}]),
     undefined = erase({any_term}),
     ok.
+
+test_many_keys() ->
+    ok = put_keys(0, 300),
+    erlang:garbage_collect(),
+    ok = check_keys(0, 300),
+    ok = erase_keys(0, 300, 2),
+    ok = check_erased_keys(0, 300),
+    ok = erase_keys(1, 300, 2),
+    0 = count_many_keys(get_keys(), 0),
+    ok.
+
+count_many_keys([], Count) ->
+    Count;
+count_many_keys([Key | T], Count) ->
+    case get(Key) of
+        {many_keys, _} -> count_many_keys(T, Count + 1);
+        _ -> count_many_keys(T, Count)
+    end.
+
+make_key(N) when N rem 4 == 0 ->
+    N;
+make_key(N) when N rem 4 == 1 ->
+    {key, N};
+make_key(N) when N rem 4 == 2 ->
+    [N, <<"key">>];
+make_key(N) ->
+    #{key => N * 1.5}.
+
+put_keys(N, N) ->
+    ok;
+put_keys(I, N) ->
+    undefined = put(make_key(I), {many_keys, I}),
+    put_keys(I + 1, N).
+
+check_keys(N, N) ->
+    ok;
+check_keys(I, N) ->
+    {many_keys, I} = get(make_key(I)),
+    check_keys(I + 1, N).
+
+erase_keys(I, N, _Step) when I >= N ->
+    ok;
+erase_keys(I, N, Step) ->
+    {many_keys, I} = erase(make_key(I)),
+    erase_keys(I + Step, N, Step).
+
+check_erased_keys(N, N) ->
+    ok;
+check_erased_keys(I, N) when I rem 2 == 0 ->
+    undefined = get(make_key(I)),
+    check_erased_keys(I + 1, N);
+check_erased_keys(I, N) ->
+    {many_keys, I} = get(make_key(I)),
+    check_erased_keys(I + 1, N).
+
+test_get_keys() ->
+    undefined = put({get_keys, 1}, shared),
+    undefined = put({get_keys, 2}, shared),
+    undefined = put({get_keys, 3}, other),
+    undefined = put(1.0, float_key),
+    undefined = put(1, integer_key),
+    float_key = get(1.0),
+    integer_key = get(1),
+    Shared = sort(get_keys(shared)),
+    [{get_keys, 1}, {get_keys, 2}] = Shared,
+    [{get_keys, 3}] = get_keys(other),
+    [] = get_keys(not_a_value),
+    Keys = get_keys(),
+    true = is_member({get_keys, 3}, Keys),
+    true = is_member(1.0, Keys),
+    false = is_member({get_keys, 4}, Keys),
+    shared = erase({get_keys, 1}),
+    [{get_keys, 2}] = get_keys(shared),
+    ok.
+
+is_member(_X, []) ->
+    false;
+is_member(X, [X | _T]) ->
+    true;
+is_member(X, [_H | T]) ->
+    is_member(X, T).
+
+sort([]) ->
+    [];
+sort([H | T]) ->
+    sort([X || X <- T, X < H]) ++ [H] ++ sort([X || X <- T, X >= H]).
@@ -0,0 +1,136 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+-module(test_gc_generations).
+
+-export([start/0, churn/3]).
+
+start() ->
+    ok = test_long_lived_data(),
+    ok = test_fullsweep_after(),
+    ok = test_system_flag(),
+    ok = test_statistics(),
+    0.
+
+% Long lived terms survive many minor collections while they are promoted
+test_long_lived_data() ->
+    Data = make_data(1000, []),
+    Binary = list_to_binary(make_list(200, [])),
+    Sum = sum(Data, 0),
+    ok = churn_check(Data, Binary, Sum, 2000),
+    {garbage_collection, GC} = process_info(self(), garbage_collection),
+    {minor_gcs, MinorGCs} = lists_keyfind(minor_gcs, GC),
+    true = MinorGCs > 0,
+    true = erlang:garbage_collect(),
+    {garbage_collection, GCAfterFullsweep} = process_info(self(), garbage_collection),
+    {minor_gcs, MinorGCsAfterFullsweep} = lists_keyfind(minor_gcs, GCAfterFullsweep),
+    true = MinorGCsAfterFullsweep < MinorGCs,
+    Sum = sum(Data, 0),
+    200 = byte_size(Binary),
+    ok.
+
+% With fullsweep_after set to 0, every collection is a full sweep
+test_fullsweep_after() ->
+    Self = self(),
+    Pid = spawn_opt(?MODULE, churn, [Self, 1000, 500], [{fullsweep_after, 0}]),
+    ok =
+        receive
+            {Pid, Result, {garbage_collection, GC}} ->
+                {minor_gcs, 0} = lists_keyfind(minor_gcs, GC),
+                {fullsweep_after, 0} = lists_keyfind(fullsweep_after, GC),
+                Result
+        after 5000 -> timeout
+        end,
+    ok =
+        try
+            spawn_opt(?MODULE, churn, [Self, 10, 10], [{fullsweep_after, -1}]),
+            unexpected
+        catch
+            error:badarg -> ok
+        end,
+    ok.
+
+test_system_flag() ->
+    {fullsweep_after, Default} = erlang:system_info(fullsweep_after),
+    Default = erlang:system_flag(fullsweep_after, 10),
+    {fullsweep_after, 10} = erlang:system_info(fullsweep_after),
+    Self = self(),
+    Pid = spawn(?MODULE, churn, [Self, 100, 100]),
+    ok =
+        receive
+            {Pid, Result, {garbage_collection, GC}} ->
+                {fullsweep_after, 10} = lists_keyfind(fullsweep_after, GC),
+                Result
+        after 5000 -> timeout
+        end,
+    10 = erlang:system_flag(fullsweep_after, Default),
+    ok.
+
+test_statistics() ->
+    {GCs1, Reclaimed1, 0} = erlang:statistics(garbage_collection),
+    ok = churn_check(make_data(100, []), <<>>, sum(make_data(100, []), 0), 100),
+    {GCs2, Reclaimed2, 0} = erlang:statistics(garbage_collection),
+    true = GCs2 > GCs1,
+    true = Reclaimed2 > Reclaimed1,
+    ok =
+        try
+            erlang:statistics(unknown_item),
+            unexpected
+        catch
+            error:badarg -> ok
+        end,
+    ok.
+
+churn(Parent, Size, N) ->
+    Data = make_data(Size, []),
+    Result = churn_check(Data, <<>>, sum(Data, 0), N),
+    Parent ! {self(), Result, process_info(self(), garbage_collection)}.
+
+churn_check(_Data, _Binary, _Sum, 0) ->
+    ok;
+churn_check(Data, Binary, Sum, N) ->
+    _Garbage = make_data(50, []),
+    _GarbageBinary = list_to_binary(make_list(100, [])),
+    case sum(Data, 0) of
+        Sum -> churn_check(Data, Binary, Sum, N - 1);
+        _ -> {bad_sum, N}
+    end.
+
+make_data(0, Acc) ->
+    Acc;
+make_data(N, Acc) ->
+    make_data(N - 1, [{N, [N]} | Acc]).
+
+make_list(0, Acc) ->
+    Acc;
+make_list(N, Acc) ->
+    make_list(N - 1, [N rem 256 | Acc]).
+
+sum([], Acc) ->
+    Acc;
+sum([{N, [M]} | T], Acc) ->
+    sum(T, Acc + N + M).
+
+lists_keyfind(_Key, []) ->
+    false;
+lists_keyfind(Key, [{Key, _} = Tuple | _]) ->
+    Tuple;
+lists_keyfind(Key, [_ | T]) ->
+    lists_keyfind(Key, T).
@@ -0,0 +1,70 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+-module(test_heap_fragments).
+
+-export([start/0, sink/2]).
+
+start() ->
+    N = 200,
+    {GCs0, _, 0} = erlang:statistics(garbage_collection),
+    Pid = spawn_opt(?MODULE, sink, [self(), N], []),
+    send(Pid, N),
+    receive
+        {Pid, Sum, {garbage_collection, GC}} ->
+            {GCs1, _, 0} = erlang:statistics(garbage_collection),
+            true = Sum =:= N * 55,
+            % Each received message is a heap fragment that used to force a
+            % collection at the next safe point
+            {avoided_forced_gcs, AvoidedForcedGCs} = lists_keyfind(avoided_forced_gcs, GC),
+            true = AvoidedForcedGCs > 0,
+            true = GCs1 - GCs0 < N,
+            0
+    after 5000 -> timeout
+    end.
+
+send(_Pid, 0) ->
+    ok;
+send(Pid, N) ->
+    Pid ! {msg, [1, 2, 3, 4, 5, 6, 7, 8, 9, 10]},
+    send(Pid, N - 1).
+
+sink(Parent, N) ->
+    Sum = sink(N, 0),
+    Parent ! {self(), Sum, process_info(self(), garbage_collection)}.
+
+sink(0, Acc) ->
+    Acc;
+sink(N, Acc) ->
+    receive
+        {msg, List} -> sink(N - 1, Acc + sum(List, 0))
+    end.
+
+sum([], Acc) ->
+    Acc;
+sum([H | T], Acc) ->
+    sum(T, Acc + H).
+
+lists_keyfind(_Key, []) ->
+    false;
+lists_keyfind(Key, [{Key, _} = Tuple | _]) ->
+    Tuple;
+lists_keyfind(Key, [_ | T]) ->
+    lists_keyfind(Key, T).
@@ -0,0 +1,105 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+-module(test_heap_growth).
+
+-export([start/0, churn/2, steady/2]).
+
+-define(STEADY_ITERATIONS, 1000).
+
+start() ->
+    {0, _} = run(bounded_free),
+    {0, _} = run(minimum),
+    {AvoidedGCs, FibonacciGCs} = run(fibonacci),
+    true = AvoidedGCs > 0,
+    {0, BoundedFreeGCs} = run([]),
+    true = FibonacciGCs < BoundedFreeGCs,
+    % Float operations may shrink the heap before each allocation: no
+    % strategy should collect for each of them
+    true = run_steady(bounded_free) < ?STEADY_ITERATIONS div 2,
+    true = run_steady(minimum) < ?STEADY_ITERATIONS div 2,
+    true = run_steady(fibonacci) < ?STEADY_ITERATIONS div 2,
+    ok =
+        try
+            spawn_opt(?MODULE, churn, [self(), 10], [{atomvm_heap_growth, unknown}]),
+            unexpected
+        catch
+            error:badarg -> ok
+        end,
+    0.
+
+run(Strategy) ->
+    Self = self(),
+    Opts =
+        case Strategy of
+            [] -> [];
+            _ -> [{atomvm_heap_growth, Strategy}]
+        end,
+    {GCs0, _, 0} = erlang:statistics(garbage_collection),
+    Pid = spawn_opt(?MODULE, churn, [Self, 300], Opts),
+    receive
+        {Pid, Sum, {garbage_collection, GC}} ->
+            {GCs1, _, 0} = erlang:statistics(garbage_collection),
+            45150 = Sum,
+            {avoided_gcs, AvoidedGCs} = lists_keyfind(avoided_gcs, GC),
+            {AvoidedGCs, GCs1 - GCs0}
+    after 5000 -> timeout
+    end.
+
+run_steady(Strategy) ->
+    {GCs0, _, 0} = erlang:statistics(garbage_collection),
+    Pid = spawn_opt(?MODULE, steady, [self(), ?STEADY_ITERATIONS], [{atomvm_heap_growth, Strategy}]),
+    receive
+        {Pid, Sum} ->
+            {GCs1, _, 0} = erlang:statistics(garbage_collection),
+            true = Sum == ?STEADY_ITERATIONS * 0.5,
+            GCs1 - GCs0
+    after 5000 -> timeout
+    end.
+
+steady(Parent, N) ->
+    Parent ! {self(), steady(N, 0.0)}.
+
+steady(0, Acc) ->
+    Acc;
+steady(N, Acc) ->
+    steady(N - 1, Acc + 0.5).
+
+churn(Parent, N) ->
+    Sum = churn(N, 0),
+    Parent ! {self(), Sum, process_info(self(), garbage_collection)}.
+
+churn(0, Acc) ->
+    Acc;
+churn(N, Acc) ->
+    List = make_list(N, []),
+    churn(N - 1, Acc + length(List)).
+
+make_list(0, Acc) ->
+    Acc;
+make_list(N, Acc) ->
+    make_list(N - 1, [{N} | Acc]).
+
+lists_keyfind(_Key, []) ->
+    false;
+lists_keyfind(Key, [{Key, _} = Tuple | _]) ->
+    Tuple;
+lists_keyfind(Key, [_ | T]) ->
+    lists_keyfind(Key, T).
@@ -0,0 +1,99 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+
+-module(test_large_messages).
+
+-export([start/0, echo/0, exit_with/1]).
+
+start() ->
+    Pid = spawn(?MODULE, echo, []),
+    List = make_list(5000, []),
+    ok = round_trip(Pid, List),
+    ok = round_trip(Pid, {List, erlang:make_tuple(2000, {tuple, [element]}), List}),
+    ok = round_trip(Pid, make_deep_list(3000, [])),
+    Binary = list_to_binary(make_bytes(1000, [])),
+    <<_:10/binary, SubBinary:500/binary, _/binary>> = Binary,
+    ok = round_trip(Pid, [{Binary, SubBinary, N} || N <- make_range(500, [])]),
+    ok = round_trip(Pid, #{list => List, binary => Binary, sub_binary => SubBinary}),
+    Fun = fun() -> {List, SubBinary} end,
+    Pid ! {self(), Fun},
+    ok =
+        receive
+            {Pid, CopiedFun} ->
+                {List, SubBinary} = CopiedFun(),
+                ok
+        after 5000 -> timeout
+        end,
+    Pid ! stop,
+    ok = test_exit_reason(List),
+    0.
+
+round_trip(Pid, Term) ->
+    Pid ! {self(), Term},
+    receive
+        {Pid, Term} -> ok;
+        {Pid, _Other} -> mismatch
+    after 5000 -> timeout
+    end.
+
+echo() ->
+    receive
+        {Caller, Term} ->
+            Caller ! {self(), Term},
+            echo();
+        stop ->
+            ok
+    end.
+
+test_exit_reason(Reason) ->
+    Pid = spawn(?MODULE, exit_with, [Reason]),
+    Ref = monitor(process, Pid),
+    Pid ! go,
+    receive
+        {'DOWN', Ref, process, Pid, Reason} -> ok;
+        {'DOWN', Ref, process, Pid, _Other} -> mismatch
+    after 5000 -> timeout
+    end.
+
+exit_with(Reason) ->
+    receive
+        go -> exit(Reason)
+    end.
+
+make_list(0, Acc) ->
+    Acc;
+make_list(N, Acc) ->
+    make_list(N - 1, [{N, [N]} | Acc]).
+
+make_deep_list(0, Acc) ->
+    Acc;
+make_deep_list(N, Acc) ->
+    make_deep_list(N - 1, [Acc, N]).
+
+make_bytes(0, Acc) ->
+    Acc;
+make_bytes(N, Acc) ->
+    make_bytes(N - 1, [N rem 256 | Acc]).
+
+make_range(0, Acc) ->
+    Acc;
+make_range(N, Acc) ->
+    make_range(N - 1, [N | Acc]).
@@ -0,0 +1,102 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+-module(test_large_select).
+
+-export([start/0, atom_to_num/1, dense/1, sparse/1, arity/1]).
+
+start() ->
+    1 = atom_to_num(one),
+    7 = atom_to_num(seven),
+    12 = atom_to_num(twelve),
+    error = atom_to_num(thirteen),
+    error = atom_to_num(1),
+    a = dense(0),
+    h = dense(7),
+    p = dense(15),
+    error = dense(-1),
+    error = dense(16),
+    error = dense(seven),
+    first = sparse(100),
+    fifth = sparse(5000),
+    last = sparse(1000000),
+    error = sparse(101),
+    error = sparse(foo),
+    0 = arity({}),
+    3 = arity({a, b, c}),
+    9 = arity({1, 2, 3, 4, 5, 6, 7, 8, 9}),
+    error = arity({1, 2, 3, 4, 5, 6, 7, 8, 9, 10}),
+    error = arity([a, b, c]),
+    0.
+
+atom_to_num(one) -> 1;
+atom_to_num(two) -> 2;
+atom_to_num(three) -> 3;
+atom_to_num(four) -> 4;
+atom_to_num(five) -> 5;
+atom_to_num(six) -> 6;
+atom_to_num(seven) -> 7;
+atom_to_num(eight) -> 8;
+atom_to_num(nine) -> 9;
+atom_to_num(ten) -> 10;
+atom_to_num(eleven) -> 11;
+atom_to_num(twelve) -> 12;
+atom_to_num(_) -> error.
+
+dense(0) -> a;
+dense(1) -> b;
+dense(2) -> c;
+dense(3) -> d;
+dense(4) -> e;
+dense(5) -> f;
+dense(6) -> g;
+dense(7) -> h;
+dense(8) -> i;
+dense(9) -> j;
+dense(10) -> k;
+dense(11) -> l;
+dense(12) -> m;
+dense(13) -> n;
+dense(14) -> o;
+dense(15) -> p;
+dense(_) -> error.
+
+sparse(100) -> first;
+sparse(200) -> second;
+sparse(1000) -> third;
+sparse(2000) -> fourth;
+sparse(5000) -> fifth;
+sparse(10000) -> sixth;
+sparse(50000) -> seventh;
+sparse(100000) -> eighth;
+sparse(1000000) -> last;
+sparse(_) -> error.
+
+arity({}) -> 0;
+arity({_}) -> 1;
+arity({_, _}) -> 2;
+arity({_, _, _}) -> 3;
+arity({_, _, _, _}) -> 4;
+arity({_, _, _, _, _}) -> 5;
+arity({_, _, _, _, _, _}) -> 6;
+arity({_, _, _, _, _, _, _}) -> 7;
+arity({_, _, _, _, _, _, _, _}) -> 8;
+arity({_, _, _, _, _, _, _, _, _}) -> 9;
+arity(_) -> error.
@@ -0,0 +1,83 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+-module(test_leaf_ordering).
+
+-export([start/0, id/1]).
+
+start() ->
+    ok = test_atoms(),
+    ok = test_numbers(),
+    ok = test_binaries(),
+    ok = test_mixed_types(),
+    0.
+
+test_atoms() ->
+    true = ?MODULE:id(abcdefgh) < ?MODULE:id(abcdefghi),
+    true = ?MODULE:id(abcdefghij) < ?MODULE:id(abcdefghik),
+    true = ?MODULE:id(abcdefghik) > ?MODULE:id(abcdefghij),
+    true = ?MODULE:id(abcdefghi) > ?MODULE:id(abcdefgh),
+    true = ?MODULE:id(abc) < ?MODULE:id(abd),
+    true = ?MODULE:id(b) > ?MODULE:id(abcdefghijklmnop),
+    true = ?MODULE:id('') < ?MODULE:id(a),
+    A = list_to_atom(?MODULE:id("abcdefgh_dynamic_2")),
+    B = list_to_atom(?MODULE:id("abcdefgh_dynamic_10")),
+    true = A > B,
+    false = A == B,
+    true = A == list_to_atom(?MODULE:id("abcdefgh_dynamic_2")),
+    ok.
+
+test_numbers() ->
+    true = ?MODULE:id(1) == ?MODULE:id(1.0),
+    false = ?MODULE:id(1) =:= ?MODULE:id(1.0),
+    true = ?MODULE:id(1) < ?MODULE:id(1.5),
+    true = ?MODULE:id(2) > ?MODULE:id(1.5),
+    true = ?MODULE:id(-1.0) < ?MODULE:id(0),
+    true = ?MODULE:id(1.5) == ?MODULE:id(1.5),
+    true = ?MODULE:id(16#FFFFFFFFFFFF) > ?MODULE:id(1),
+    true = ?MODULE:id(-16#FFFFFFFFFFFF) < ?MODULE:id(-1),
+    true = ?MODULE:id(16#FFFFFFFFFFFF) =:= ?MODULE:id(16#FFFFFFFFFFFF),
+    2 = map_size(#{?MODULE:id(1) => a, ?MODULE:id(1.0) => b}),
+    ok.
+
+test_binaries() ->
+    true = ?MODULE:id(<<"abc">>) < ?MODULE:id(<<"abd">>),
+    true = ?MODULE:id(<<"abc">>) < ?MODULE:id(<<"abcd">>),
+    true = ?MODULE:id(<<>>) < ?MODULE:id(<<0>>),
+    true = ?MODULE:id(<<"abc">>) =:= ?MODULE:id(<<"abc">>),
+    ok.
+
+test_mixed_types() ->
+    Sorted = [1, 1.5, abc, make_ref(), self(), {}, [], [a], <<>>],
+    ok = check_sorted(Sorted),
+    true = ?MODULE:id({a}) < ?MODULE:id({b}),
+    true = ?MODULE:id([a, b]) < ?MODULE:id([a, c]),
+    true = ?MODULE:id(#{a => 1}) < ?MODULE:id(#{a => 2}),
+    ok.
+
+check_sorted([_]) ->
+    ok;
+check_sorted([A, B | T]) ->
+    true = A < B,
+    false = B < A,
+    check_sorted([B | T]).
+
+id(X) ->
+    X.
@@ -35,6 +35,8 @@ start() ->
     ok = test_match_case(),
     ok = test_match_clause(),
     ok = test_external_terms(),
+    ok = test_large_map(),
+    ok = test_unsorted_external_map(),
     0.
 
 test_is_map_bif() ->
@@ -272,6 +274,41 @@ test_external_terms() ->
     true = Map =:= Map2,
     ok.
 
+test_large_map() ->
+    Map = build_map(large_map_entries(1000, [])),
+    1100 = map_size(Map),
+    ok = check_large_map(Map, 1000),
+    false = is_map_key({key, 0}, Map),
+    false = is_map_key(0, Map),
+    100 = map_get(100, Map),
+    #{{key, 500} := 500, 50 := 50} = Map,
+    Map2 = Map#{{key, 500} := five_hundred},
+    five_hundred = map_get({key, 500}, Map2),
+    ok.
+
+large_map_entries(0, Accum) ->
+    Accum;
+large_map_entries(N, Accum) when N =< 100 ->
+    large_map_entries(N - 1, [{{key, N}, N}, {N, N} | Accum]);
+large_map_entries(N, Accum) ->
+    large_map_entries(N - 1, [{{key, N}, N} | Accum]).
+
+check_large_map(_Map, 0) ->
+    ok;
+check_large_map(Map, N) ->
+    N = map_get({key, N}, id(Map)),
+    check_large_map(Map, N - 1).
+
+test_unsorted_external_map() ->
+    % #{c => 3, a => 1, b => 2} with keys in hash order, as BEAM encodes large maps
+    Bin = <<131, 116, 3:32, 119, 1, $c, 97, 3, 119, 1, $a, 97, 1, 119, 1, $b, 97, 2>>,
+    Map = binary_to_term(id(Bin)),
+    1 = map_get(a, Map),
+    2 = map_get(b, Map),
+    3 = map_get(c, Map),
+    true = Map =:= #{a => 1, b => 2, c => 3},
+    ok.
+
 build_map(KVList) ->
     build_map(KVList, #{}).
 
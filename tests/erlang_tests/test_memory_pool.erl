@@ -0,0 +1,89 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+-module(test_memory_pool).
+
+-export([start/0, echo/0]).
+
+start() ->
+    Reserved0 = erlang:memory(atomvm_pool_reserved),
+    true = is_integer(Reserved0) andalso Reserved0 >= 0,
+    Oversized0 = erlang:memory(atomvm_pool_oversized),
+    true = is_integer(Oversized0) andalso Oversized0 >= 0,
+    Pids = spawn_echoes(20, []),
+    ok = ping(Pids, 50),
+    ok = ping(Pids, {large, make_list(2000, [])}),
+    ok = stop(Pids),
+    % Chunks are kept by the pool once reserved
+    Reserved1 = erlang:memory(atomvm_pool_reserved),
+    true = Reserved1 >= Reserved0,
+    Oversized1 = erlang:memory(atomvm_pool_oversized),
+    true = is_integer(Oversized1) andalso Oversized1 >= 0,
+    ok =
+        try
+            erlang:memory(unknown_type),
+            unexpected
+        catch
+            error:badarg -> ok
+        end,
+    0.
+
+spawn_echoes(0, Acc) ->
+    Acc;
+spawn_echoes(N, Acc) ->
+    spawn_echoes(N - 1, [spawn(?MODULE, echo, []) | Acc]).
+
+ping(_Pids, 0) ->
+    ok;
+ping(Pids, N) when is_integer(N) ->
+    ok = ping(Pids, {small, N}),
+    ping(Pids, N - 1);
+ping([], _Message) ->
+    ok;
+ping([Pid | Tail], Message) ->
+    Pid ! {self(), Message},
+    receive
+        {Pid, Message} -> ping(Tail, Message)
+    after 5000 -> timeout
+    end.
+
+stop([]) ->
+    ok;
+stop([Pid | Tail]) ->
+    Monitor = monitor(process, Pid),
+    Pid ! stop,
+    receive
+        {'DOWN', Monitor, process, Pid, normal} -> stop(Tail)
+    after 5000 -> timeout
+    end.
+
+echo() ->
+    receive
+        {From, Message} ->
+            From ! {self(), Message},
+            echo();
+        stop ->
+            ok
+    end.
+
+make_list(0, Acc) ->
+    Acc;
+make_list(N, Acc) ->
+    make_list(N - 1, [N | Acc]).
@@ -0,0 +1,99 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+-module(test_message_queue_data).
+
+-export([start/0, sink/2]).
+
+start() ->
+    on_heap = process_flag(message_queue_data, off_heap),
+    {message_queue_data, off_heap} = process_info(self(), message_queue_data),
+    off_heap = process_flag(message_queue_data, on_heap),
+    {message_queue_data, on_heap} = process_info(self(), message_queue_data),
+    ok =
+        try
+            process_flag(message_queue_data, unknown),
+            unexpected
+        catch
+            error:badarg -> ok
+        end,
+    ok =
+        try
+            spawn_opt(?MODULE, sink, [self(), 1], [{message_queue_data, unknown}]),
+            unexpected
+        catch
+            error:badarg -> ok
+        end,
+    {OnHeapGCs, OnHeapAvoidedGCs} = run([]),
+    {OffHeapGCs, OffHeapAvoidedGCs} = run([{message_queue_data, off_heap}]),
+    % Each message received by an on_heap process is a new heap fragment at
+    % the next safe point, which is tolerated until there are too many of
+    % them. Messages received by an off_heap process only become fragments
+    % when the chain of consumed messages is flushed, and the flushed chain
+    % is too long to be tolerated.
+    true = OffHeapAvoidedGCs < OnHeapAvoidedGCs,
+    true = OffHeapGCs =< OnHeapGCs,
+    0.
+
+run(Opts) ->
+    N = 500,
+    {GCs0, _, 0} = erlang:statistics(garbage_collection),
+    % A fixed minimum heap size makes the number of tolerated fragments
+    % independent of the heap growth of the sink
+    Pid = spawn_opt(?MODULE, sink, [self(), N], [{min_heap_size, 1000} | Opts]),
+    send(Pid, N),
+    receive
+        {Pid, Sum, {garbage_collection, GC}} ->
+            {GCs1, _, 0} = erlang:statistics(garbage_collection),
+            % Each message is a list of 10 integers from 1 to 10
+            true = Sum =:= N * 55,
+            {avoided_forced_gcs, AvoidedForcedGCs} = lists_keyfind(avoided_forced_gcs, GC),
+            {GCs1 - GCs0, AvoidedForcedGCs}
+    after 5000 -> timeout
+    end.
+
+send(_Pid, 0) ->
+    ok;
+send(Pid, N) ->
+    Pid ! {msg, [1, 2, 3, 4, 5, 6, 7, 8, 9, 10]},
+    send(Pid, N - 1).
+
+sink(Parent, N) ->
+    Sum = sink(N, 0),
+    Parent ! {self(), Sum, process_info(self(), garbage_collection)}.
+
+sink(0, Acc) ->
+    Acc;
+sink(N, Acc) ->
+    receive
+        {msg, List} -> sink(N - 1, Acc + sum(List, 0))
+    end.
+
+sum([], Acc) ->
+    Acc;
+sum([H | T], Acc) ->
+    sum(T, Acc + H).
+
+lists_keyfind(_Key, []) ->
+    false;
+lists_keyfind(Key, [{Key, _} = Tuple | _]) ->
+    Tuple;
+lists_keyfind(Key, [_ | T]) ->
+    lists_keyfind(Key, T).
@@ -0,0 +1,94 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+-module(test_nif_heap_reservation).
+
+-export([start/0, id/1]).
+
+start() ->
+    % Results are kept alive so heap is collected before some of the calls
+    Acc = loop(200, []),
+    200 = length(Acc),
+    ok = check(Acc),
+    ok =
+        try
+            erlang:integer_to_list(?MODULE:id(10), ?MODULE:id(37)),
+            unexpected
+        catch
+            error:badarg -> ok
+        end,
+    ok =
+        try
+            erlang:list_to_tuple(?MODULE:id([a | b])),
+            unexpected
+        catch
+            error:badarg -> ok
+        end,
+    ok =
+        try
+            erlang:tuple_to_list(?MODULE:id([a])),
+            unexpected
+        catch
+            error:badarg -> ok
+        end,
+    0.
+
+loop(0, Acc) ->
+    Acc;
+loop(N, Acc) ->
+    List = lists_seq(N),
+    Tuple = erlang:list_to_tuple(?MODULE:id(List)),
+    List = erlang:tuple_to_list(Tuple),
+    Digits = erlang:integer_to_list(?MODULE:id(N * 1000003), 16),
+    Binary = erlang:integer_to_binary(?MODULE:id(-N), 2),
+    Chars = erlang:binary_to_list(Binary),
+    Name = erlang:atom_to_list(?MODULE:id(test_nif_heap_reservation)),
+    NameBinary = erlang:atom_to_binary(?MODULE:id(test_nif_heap_reservation), latin1),
+    loop(N - 1, [{N, Tuple, Digits, Chars, Name, NameBinary} | Acc]).
+
+check([]) ->
+    ok;
+check([{N, Tuple, Digits, Chars, Name, NameBinary} | T]) ->
+    N = tuple_size(Tuple),
+    N = element(N, Tuple),
+    N = parse(Digits, 16, 0) div 1000003,
+    [$- | Bits] = Chars,
+    N = parse(Bits, 2, 0),
+    "test_nif_heap_reservation" = Name,
+    <<"test_nif_heap_reservation">> = NameBinary,
+    check(T).
+
+parse([], _Base, Acc) ->
+    Acc;
+parse([C | T], Base, Acc) when C >= $A ->
+    parse(T, Base, Acc * Base + C - $A + 10);
+parse([C | T], Base, Acc) ->
+    parse(T, Base, Acc * Base + C - $0).
+
+lists_seq(N) ->
+    lists_seq(N, []).
+
+lists_seq(0, Acc) ->
+    Acc;
+lists_seq(N, Acc) ->
+    lists_seq(N - 1, [N | Acc]).
+
+id(X) ->
+    X.
@@ -0,0 +1,81 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+-module(test_process_priority).
+
+-export([start/0, busy_loop/1, notify/1]).
+
+start() ->
+    ok = test_process_flag(),
+    ok = test_spawn_opt(),
+    ok = test_no_starvation(),
+    0.
+
+test_process_flag() ->
+    {priority, normal} = process_info(self(), priority),
+    normal = process_flag(priority, high),
+    {priority, high} = process_info(self(), priority),
+    high = process_flag(priority, max),
+    max = process_flag(priority, low),
+    {priority, low} = process_info(self(), priority),
+    ok =
+        try
+            process_flag(priority, urgent),
+            unexpected
+        catch
+            error:badarg -> ok
+        end,
+    low = process_flag(priority, normal),
+    ok.
+
+test_spawn_opt() ->
+    Self = self(),
+    Pid = spawn_opt(?MODULE, notify, [Self], [{priority, low}]),
+    {priority, low} = process_info(Pid, priority),
+    Pid ! go,
+    receive
+        {Pid, alive} -> ok
+    after 5000 -> timeout
+    end.
+
+% A low priority process still runs while a max priority process never waits
+test_no_starvation() ->
+    Self = self(),
+    Busy = spawn_opt(?MODULE, busy_loop, [0], [{priority, max}]),
+    Low = spawn_opt(?MODULE, notify, [Self], [{priority, low}]),
+    Low ! go,
+    Result =
+        receive
+            {Low, alive} -> ok
+        after 5000 -> timeout
+        end,
+    Busy ! stop,
+    Result.
+
+busy_loop(N) ->
+    receive
+        stop -> ok
+    after 0 -> busy_loop(N + 1)
+    end.
+
+notify(Pid) ->
+    receive
+        go -> Pid ! {self(), alive}
+    end.
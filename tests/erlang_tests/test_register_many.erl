@@ -0,0 +1,93 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+
+-module(test_register_many).
+
+-export([start/0]).
+
+-define(NAMES, 200).
+
+start() ->
+    Self = self(),
+    ok = register_names(Self, 0, ?NAMES),
+    ok = check_names(Self, 0, ?NAMES),
+    true = unregister(name(10)),
+    undefined = whereis(name(10)),
+    Self = whereis(name(11)),
+    true = register(name(10), Self),
+    Self = whereis(name(10)),
+    ok = send_by_name(name(42)),
+    ok = unregister_names(0, ?NAMES),
+    ok = check_names(undefined, 0, ?NAMES),
+    ok = test_exit_unregisters(),
+    0.
+
+name(N) ->
+    list_to_atom("test_register_many_" ++ integer_to_list(N)).
+
+register_names(_Pid, N, N) ->
+    ok;
+register_names(Pid, I, N) ->
+    true = register(name(I), Pid),
+    register_names(Pid, I + 1, N).
+
+check_names(_Expected, N, N) ->
+    ok;
+check_names(Expected, I, N) ->
+    Expected = whereis(name(I)),
+    check_names(Expected, I + 1, N).
+
+unregister_names(N, N) ->
+    ok;
+unregister_names(I, N) ->
+    true = unregister(name(I)),
+    unregister_names(I + 1, N).
+
+send_by_name(Name) ->
+    Name ! {hello, Name},
+    receive
+        {hello, Name} -> ok
+    after 1000 -> timeout
+    end.
+
+test_exit_unregisters() ->
+    Parent = self(),
+    {Pid, Ref} = spawn_opt(
+        fun() ->
+            receive
+                {Parent, stop} -> ok
+            end
+        end,
+        [monitor]
+    ),
+    true = register(name(1000), Pid),
+    true = register(name(1001), Pid),
+    Pid = whereis(name(1000)),
+    Pid = whereis(name(1001)),
+    name(1000) ! {Parent, stop},
+    ok =
+        receive
+            {'DOWN', Ref, process, Pid, normal} -> ok
+        after 1000 -> timeout
+        end,
+    undefined = whereis(name(1000)),
+    undefined = whereis(name(1001)),
+    ok.
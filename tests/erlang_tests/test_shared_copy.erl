@@ -0,0 +1,134 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+
+-module(test_shared_copy).
+
+-export([start/0, echo/0, report_size/3]).
+
+% Defined by the build when the VM is built with AVM_SHARING_PRESERVING_COPY
+-ifdef(SHARING_PRESERVING_COPY).
+-define(SHARING, true).
+-else.
+-define(SHARING, false).
+-endif.
+
+start() ->
+    List = make_list(100, []),
+    Term = {List, List, [List | List]},
+    400 = erts_debug:size(List),
+    400 = erts_debug:flat_size(List),
+    406 = erts_debug:size(Term),
+    1606 = erts_debug:flat_size(Term),
+    62 = erts_debug:size(make_dag(20, [a])),
+    Sharing = ?SHARING,
+    ok = test_round_trip(Sharing, Term),
+    ok = test_binaries(Sharing, List),
+    ok = test_spawn(Sharing, Term),
+    0.
+
+% Received terms keep their sharing only if the VM preserves it when copying,
+% otherwise they are as large as their flat size.
+test_round_trip(Sharing, Term) ->
+    Pid = spawn(?MODULE, echo, []),
+    ok = round_trip(Pid, Term, copy_size(Sharing, Term)),
+    Dag = make_dag(10, [a]),
+    ok = round_trip(Pid, Dag, copy_size(Sharing, Dag)),
+    Map = #{a => Term, b => Term},
+    ok = round_trip(Pid, Map, copy_size(Sharing, Map)),
+    % Large enough to be copied in a single pass to a chain of fragments
+    LargeDag = {make_list(1000, []), make_dag(16, [a])},
+    true = erts_debug:size(LargeDag) > 256,
+    case Sharing of
+        true -> ok = round_trip(Pid, LargeDag, erts_debug:size(LargeDag));
+        false -> ok
+    end,
+    Pid ! stop,
+    ok.
+
+test_binaries(Sharing, List) ->
+    Pid = spawn(?MODULE, echo, []),
+    Binary = list_to_binary(make_bytes(1000, [])),
+    <<_:10/binary, SubBinary:500/binary, _/binary>> = Binary,
+    Term = {Binary, SubBinary, Binary, [SubBinary | List], List},
+    ok = round_trip(Pid, Term, copy_size(Sharing, Term)),
+    Pid ! stop,
+    ok.
+
+test_spawn(Sharing, Term) ->
+    Self = self(),
+    ArgsSize = copy_size(Sharing, {Term, Term}) - 3,
+    Pid = spawn(?MODULE, report_size, [Self, Term, Term]),
+    ok =
+        receive
+            {Pid, Term, Term, ArgsSize} -> ok;
+            {Pid, _A, _B, Size} -> {unexpected_size, Size, ArgsSize}
+        after 5000 -> timeout
+        end,
+    Fun = fun() -> Self ! {self(), erts_debug:size({Term, Term})} end,
+    FunPid = spawn(Fun),
+    SizeInFun = copy_size(Sharing, {Term, Term}),
+    receive
+        {FunPid, SizeInFun} -> ok;
+        {FunPid, Other} -> {unexpected_size, Other, SizeInFun}
+    after 5000 -> timeout
+    end.
+
+copy_size(true, Term) ->
+    erts_debug:size(Term);
+copy_size(false, Term) ->
+    erts_debug:flat_size(Term).
+
+report_size(Parent, A, B) ->
+    Parent ! {self(), A, B, erts_debug:size({A, B}) - 3}.
+
+round_trip(Pid, Term, ExpectedSize) ->
+    Pid ! {self(), Term},
+    receive
+        {Pid, Term, ExpectedSize} -> ok;
+        {Pid, Term, Size} -> {unexpected_size, Size, ExpectedSize};
+        {Pid, _Other, _Size} -> mismatch
+    after 5000 -> timeout
+    end.
+
+echo() ->
+    receive
+        {Caller, Term} ->
+            Caller ! {self(), Term, erts_debug:size(Term)},
+            echo();
+        stop ->
+            ok
+    end.
+
+make_list(0, Acc) ->
+    Acc;
+make_list(N, Acc) ->
+    make_list(N - 1, [{N} | Acc]).
+
+% Each level references the previous one twice, its flat size doubles.
+make_dag(0, Acc) ->
+    Acc;
+make_dag(N, Acc) ->
+    make_dag(N - 1, {Acc, Acc}).
+
+make_bytes(0, Acc) ->
+    Acc;
+make_bytes(N, Acc) ->
+    make_bytes(N - 1, [N rem 256 | Acc]).
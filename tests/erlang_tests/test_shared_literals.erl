@@ -0,0 +1,104 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+-module(test_shared_literals).
+
+-export([start/0, config/0, id/1]).
+
+start() ->
+    ok = test_survives_gc(),
+    ok = test_send_literal(),
+    ok = test_update_literal(),
+    ok = test_many_processes(),
+    0.
+
+config() ->
+    #{
+        name => <<"a rather long binary that is stored as a reference to literal data">>,
+        values => [1, 2, 3, {a, b, c}, 1.5, "string"],
+        nested => #{key => [{x, 1}, {y, 2}]}
+    }.
+
+test_survives_gc() ->
+    C1 = config(),
+    Garbage = make_garbage(1000, []),
+    erlang:garbage_collect(),
+    1000 = length(id(Garbage)),
+    C2 = config(),
+    erlang:garbage_collect(),
+    true = C1 =:= C2,
+    #{values := [1, 2, 3, {a, b, c}, 1.5, "string"]} = C1,
+    ok.
+
+test_send_literal() ->
+    Self = self(),
+    Pid = spawn(fun() ->
+        receive
+            {Self, Config} ->
+                erlang:garbage_collect(),
+                Self ! {self(), Config =:= config()}
+        end
+    end),
+    Pid ! {Self, config()},
+    receive
+        {Pid, true} -> ok
+    after 5000 -> timeout
+    end.
+
+test_update_literal() ->
+    C1 = config(),
+    C2 = C1#{values := [4]},
+    #{values := [4]} = C2,
+    #{values := [1, 2, 3, {a, b, c}, 1.5, "string"]} = config(),
+    T = setelement(1, id({a, b, c}), z),
+    {z, b, c} = T,
+    {a, b, c} = id({a, b, c}),
+    ok.
+
+test_many_processes() ->
+    Self = self(),
+    Pids = spawn_checkers(Self, 10, []),
+    wait_checkers(Pids).
+
+spawn_checkers(_Parent, 0, Acc) ->
+    Acc;
+spawn_checkers(Parent, N, Acc) ->
+    Pid = spawn(fun() ->
+        C = config(),
+        erlang:garbage_collect(),
+        Parent ! {self(), C =:= config()}
+    end),
+    spawn_checkers(Parent, N - 1, [Pid | Acc]).
+
+wait_checkers([]) ->
+    ok;
+wait_checkers([Pid | Tail]) ->
+    receive
+        {Pid, true} -> wait_checkers(Tail)
+    after 5000 -> timeout
+    end.
+
+make_garbage(0, Acc) ->
+    Acc;
+make_garbage(N, Acc) ->
+    make_garbage(N - 1, [{N, N} | Acc]).
+
+id(X) ->
+    X.
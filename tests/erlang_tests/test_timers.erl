@@ -0,0 +1,116 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 agent <agent@local>
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+-module(test_timers).
+
+-export([start/0]).
+
+start() ->
+    ok = test_send_after(),
+    ok = test_start_timer(),
+    ok = test_cancel_timer(),
+    ok = test_registered_name(),
+    ok = test_order(),
+    ok = test_badarg(),
+    0.
+
+test_send_after() ->
+    Ref = erlang:send_after(20, self(), {hello, <<"binary">>}),
+    true = is_reference(Ref),
+    Left = erlang:read_timer(Ref),
+    true = is_integer(Left) andalso Left =< 20,
+    ok =
+        receive
+            {hello, <<"binary">>} -> ok
+        after 1000 -> timeout
+        end,
+    false = erlang:read_timer(Ref),
+    false = erlang:cancel_timer(Ref),
+    ok.
+
+test_start_timer() ->
+    Ref = erlang:start_timer(10, self(), hello),
+    ok =
+        receive
+            {timeout, Ref, hello} -> ok
+        after 1000 -> timeout
+        end,
+    Ref2 = erlang:start_timer(10, self(), hello, []),
+    receive
+        {timeout, Ref2, hello} -> ok
+    after 1000 -> timeout
+    end.
+
+test_cancel_timer() ->
+    Ref = erlang:start_timer(60000, self(), never),
+    Left = erlang:cancel_timer(Ref),
+    true = Left > 50000 andalso Left =< 60000,
+    false = erlang:cancel_timer(Ref),
+    false = erlang:read_timer(Ref),
+    ok =
+        receive
+            {timeout, Ref, never} -> unexpected
+        after 100 -> ok
+        end,
+    % timers for exited processes or unknown names are dropped
+    Pid = spawn(fun() -> ok end),
+    erlang:send_after(10, Pid, dropped),
+    erlang:send_after(10, test_timers_nobody, dropped),
+    ok.
+
+test_registered_name() ->
+    true = register(test_timers_name, self()),
+    erlang:send_after(10, test_timers_name, by_name),
+    ok =
+        receive
+            by_name -> ok
+        after 1000 -> timeout
+        end,
+    true = unregister(test_timers_name),
+    ok.
+
+test_order() ->
+    Self = self(),
+    [erlang:send_after(T, Self, {order, T}) || T <- [50, 10, 40, 20, 30, 0]],
+    [0, 10, 20, 30, 40, 50] = [
+        receive
+            {order, T} -> T
+        after 1000 -> timeout
+        end
+     || _ <- [1, 2, 3, 4, 5, 6]
+    ],
+    ok.
+
+test_badarg() ->
+    ok = expect_badarg(fun() -> erlang:send_after(-1, self(), msg) end),
+    ok = expect_badarg(fun() -> erlang:send_after(10, "self", msg) end),
+    ok = expect_badarg(fun() -> erlang:start_timer(foo, self(), msg) end),
+    ok = expect_badarg(fun() -> erlang:start_timer(10, self(), msg, foo) end),
+    ok = expect_badarg(fun() -> erlang:cancel_timer(foo) end),
+    ok = expect_badarg(fun() -> erlang:read_timer(foo) end),
+    ok.
+
+expect_badarg(Fun) ->
+    try
+        Fun(),
+        unexpected
+    catch
+        error:badarg -> ok
+    end.
@@ -31,18 +31,19 @@ test() ->
 -include("etest.hrl").
 
 test_start_timer() ->
-    ?ASSERT_MATCH(timer_manager:get_timer_refs(), []),
-    timer_manager:start_timer(100, self(), test_start_timer),
-    wait_for_timeout(test_start_timer, 5000).
+    TimerRef = timer_manager:start_timer(100, self(), test_start_timer),
+    ?ASSERT_TRUE(is_integer(timer_manager:read_timer(TimerRef))),
+    ok = wait_for_timeout(test_start_timer, 5000),
+    ?ASSERT_EQUALS(false, timer_manager:read_timer(TimerRef)),
+    ok.
 
 test_cancel_timer() ->
-    ?ASSERT_MATCH(timer_manager:get_timer_refs(), []),
     TimerRef = timer_manager:start_timer(60000, self(), test_cancel_timer),
-    ?ASSERT_MATCH(timer_manager:get_timer_refs(), [TimerRef]),
+    ?ASSERT_TRUE(is_integer(timer_manager:read_timer(TimerRef))),
     R = timer_manager:cancel_timer(TimerRef),
     ?ASSERT_TRUE(is_integer(R)),
     ?ASSERT_TRUE(R > 0),
-    ?ASSERT_MATCH(timer_manager:get_timer_refs(), []),
+    ?ASSERT_EQUALS(false, timer_manager:read_timer(TimerRef)),
     R2 = timer_manager:cancel_timer(TimerRef),
     ?ASSERT_EQUALS(false, R2),
     ok.
@@ -42,6 +42,9 @@ test() ->
     ok = test_join(),
     ok = test_seq(),
     ok = test_sort(),
+    ok = test_duplicate(),
+    ok = test_long_improper_list(),
+    ok = test_long_lists(),
     ok.
 
 test_nth() ->
@@ -60,6 +63,12 @@ test_reverse() ->
     ?ASSERT_MATCH(lists:reverse([]), []),
     ?ASSERT_MATCH(lists:reverse([a]), [a]),
     ?ASSERT_MATCH(lists:reverse([a, b]), [b, a]),
+    ?ASSERT_MATCH(lists:reverse([a, b], [c]), [b, a, c]),
+    ?ASSERT_MATCH(lists:reverse([a, b], c), [b, a | c]),
+    ?ASSERT_MATCH(lists:reverse([], c), c),
+    ?ASSERT_MATCH(lists:reverse(lists:seq(1, 1000)), [1000, 999 | _]),
+    ?ASSERT_FAILURE(lists:reverse([a | b]), badarg),
+    ?ASSERT_FAILURE(lists:reverse(a), badarg),
     ok.
 
 test_member() ->
@@ -68,6 +77,9 @@ test_member() ->
     ?ASSERT_TRUE(lists:member(c, [a, b, c])),
     ?ASSERT_TRUE(not lists:member(d, [a, b, c])),
     ?ASSERT_TRUE(not lists:member(x, [])),
+    ?ASSERT_TRUE(lists:member({a, "b"}, [c, {a, "b"}])),
+    ?ASSERT_TRUE(not lists:member(1, [1.0])),
+    ?ASSERT_FAILURE(lists:member(x, [a | b]), badarg),
     ok.
 
 test_delete() ->
@@ -86,6 +98,12 @@ test_keyfind() ->
 
     ?ASSERT_MATCH(lists:keyfind(b, 1, [{a, x}, {b, foo, bar}, []]), {b, foo, bar}),
     ?ASSERT_MATCH(lists:keyfind(nope, 2, [{a, x}, {b, foo, bar}, []]), false),
+
+    ?ASSERT_MATCH(lists:keyfind(1, 1, [{1.0, x}]), {1.0, x}),
+    ?ASSERT_MATCH(lists:keymember(b, 1, [{a, x}, {b, y}]), true),
+    ?ASSERT_MATCH(lists:keymember(c, 1, [{a, x}, {b, y}]), false),
+    ?ASSERT_FAILURE(lists:keyfind(a, 0, [{a, x}]), badarg),
+    ?ASSERT_FAILURE(lists:keymember(a, foo, [{a, x}]), badarg),
     ok.
 
 test_keydelete() ->
@@ -93,6 +111,8 @@ test_keydelete() ->
     ?ASSERT_MATCH(lists:keydelete(a, 1, [{a, x}, b, []]), [b, []]),
     ?ASSERT_MATCH(lists:keydelete(a, 1, [b, {a, x}, []]), [b, []]),
     ?ASSERT_MATCH(lists:keydelete(a, 1, [b, {a, x}, {a, x}, {a, x}, []]), [b, {a, x}, {a, x}, []]),
+    ?ASSERT_MATCH(lists:keydelete(c, 1, [{a, x}, {b, y}]), [{a, x}, {b, y}]),
+    ?ASSERT_MATCH(lists:keydelete(y, 2, [{a, x}, {b, y}, {c, z}]), [{a, x}, {c, z}]),
     ok.
 
 test_keyreplace() ->
@@ -168,6 +188,9 @@ test_flatten() ->
     ?ASSERT_MATCH(lists:flatten([[a], [b, [c]]]), [a, b, c]),
     ?ASSERT_MATCH(lists:flatten([[a], [b, {c, [d, [e, [f]]]}]]), [a, b, {c, [d, [e, [f]]]}]),
     ?ASSERT_MATCH(lists:flatten([[a, b, c], [d, e, f], [g, h, i]]), [a, b, c, d, e, f, g, h, i]),
+    ?ASSERT_MATCH(lists:flatten([[], [[]], [a, [], [[b]]]]), [a, b]),
+    ?ASSERT_MATCH(length(lists:flatten(nest(1000, [a]))), 1001),
+    ?ASSERT_FAILURE(lists:flatten([a | b]), badarg),
     ok.
 
 test_filter() ->
@@ -192,6 +215,11 @@ test_seq() ->
     ?ASSERT_MATCH(lists:seq(-1, 2, 3), [-1, 2]),
     ?ASSERT_MATCH(lists:seq(5, 1, -1), [5, 4, 3, 2, 1]),
     ?ASSERT_MATCH(lists:seq(1, 1, 0), [1]),
+    ?ASSERT_MATCH(lists:seq(1, 0), []),
+    ?ASSERT_MATCH(lists:seq(-2, 1), [-2, -1, 0, 1]),
+    ?ASSERT_MATCH(length(lists:seq(1, 10000)), 10000),
+    Max = 16#7FFFFFFFFFFFFFFF,
+    ?ASSERT_MATCH(lists:seq(Max - 1, Max), [_, Max]),
 
     ?ASSERT_FAILURE(lists:seq(foo, 1)),
     ?ASSERT_FAILURE(lists:seq(1, bar)),
@@ -210,6 +238,9 @@ test_sort() ->
     ?ASSERT_MATCH(lists:sort([1, 3, 5, 2, 4]), [1, 2, 3, 4, 5]),
     ?ASSERT_MATCH(lists:sort([c, a, b, d]), [a, b, c, d]),
     ?ASSERT_MATCH(lists:sort([#{}, z]), [z, #{}]),
+    ?ASSERT_MATCH(lists:sort([{b, 1}, 2.0, "a", a, <<"a">>]), [2.0, a, {b, 1}, "a", <<"a">>]),
+    ?ASSERT_MATCH(lists:sort([1, 1.0, 0, 1]), [0, 1, 1.0, 1]),
+    ?ASSERT_MATCH(lists:sort(lists:reverse(lists:seq(1, 1000))), [1, 2, 3 | _]),
 
     ?ASSERT_MATCH(lists:sort(fun(A, B) -> A > B end, [1, 2, 3, 4, 5]), [5, 4, 3, 2, 1]),
 
@@ -219,4 +250,49 @@ test_sort() ->
 
     ok.
 
+test_duplicate() ->
+    ?ASSERT_MATCH(lists:duplicate(0, a), []),
+    ?ASSERT_MATCH(lists:duplicate(3, a), [a, a, a]),
+    ?ASSERT_MATCH(lists:duplicate(2, {a, "b"}), [{a, "b"}, {a, "b"}]),
+    ?ASSERT_FAILURE(lists:duplicate(-1, a), badarg),
+    ?ASSERT_FAILURE(lists:duplicate(foo, a), badarg),
+    ok.
+
+test_long_improper_list() ->
+    Prefix = [{N} || N <- lists:seq(1, 1000)],
+    Improper = Prefix ++ b,
+    ?ASSERT_FAILURE(lists:reverse(Improper), badarg),
+    ?ASSERT_FAILURE(lists:reverse(Improper, []), badarg),
+    ?ASSERT_FAILURE(lists:flatten(Improper), badarg),
+    ?ASSERT_FAILURE(lists:flatten([Prefix | Improper]), badarg),
+    ?ASSERT_FAILURE(lists:sort(Improper), badarg),
+    ?ASSERT_FAILURE(lists:keydelete(k, 1, Improper), badarg),
+    ?ASSERT_EQUALS(lists:keydelete(k, 1, Prefix ++ [{k} | b]), Improper),
+    ok.
+
+test_long_lists() ->
+    Seq = lists:seq(1, 5000),
+    ok = check_seq(1, 5000, Seq),
+    ok = check_seq(-2500, 2500, lists:seq(-2500, 2500)),
+    Reversed = lists:reverse(Seq),
+    ok = check_seq(1, 5000, lists:reverse(Reversed)),
+    ?ASSERT_MATCH(lists:reverse(Seq, tail), [5000, 4999 | _]),
+    ?ASSERT_EQUALS(lists:flatten([[I, [I]] || I <- Seq]), [X || I <- Seq, X <- [I, I]]),
+    ?ASSERT_EQUALS(lists:flatten(nest(5000, [])), Seq),
+    ?ASSERT_EQUALS(lists:sort(Reversed), Seq),
+    % equal elements keep their order across sorted chunks
+    Mixed = [X || I <- Seq, X <- [I rem 5, float(I rem 5)]],
+    ?ASSERT_EQUALS(lists:sort(Mixed), [X || V <- lists:seq(0, 4), _ <- lists:seq(1, 1000), X <- [V, float(V)]]),
+    ok.
+
+check_seq(From, To, [From]) when From =:= To ->
+    ok;
+check_seq(From, To, [From | T]) ->
+    check_seq(From + 1, To, T).
+
+nest(0, Acc) ->
+    Acc;
+nest(N, Acc) ->
+    nest(N - 1, [N, Acc]).
+
 id(X) -> X.
@@ -41,6 +41,7 @@ test() ->
     ok = test_merge(),
     ok = test_remove(),
     ok = test_update(),
+    ok = test_large_maps(),
     ok.
 
 test_get() ->
@@ -107,6 +108,9 @@ test_from_list() ->
     ?ASSERT_EQUALS(maps:from_list([{a, 1}, {b, 2}, {c, 3}]), #{a => 1, b => 2, c => 3}),
     ok = etest:assert_failure(fun() -> maps:from_list(id(foo)) end, badarg),
     ok = etest:assert_failure(fun() -> maps:from_list(id([improper | list])) end, badarg),
+    ok = etest:assert_failure(fun() -> maps:from_list(id([{a, 1} | b])) end, badarg),
+    ?ASSERT_EQUALS(maps:from_list([{b, 1}, {a, 2}, {b, 3}, {a, 4}, {c, 5}]), #{a => 4, b => 3, c => 5}),
+    ?ASSERT_EQUALS(maps:from_list([{1, integer}, {1.0, float}]), #{1 => integer, 1.0 => float}),
     ok.
 
 test_size() ->
@@ -173,6 +177,9 @@ test_remove() ->
     ?ASSERT_EQUALS(maps:remove(c, #{a => 1, b => 2, c => 3}), #{a => 1, b => 2}),
     ?ASSERT_EQUALS(maps:remove(d, #{a => 1, b => 2, c => 3}), #{a => 1, b => 2, c => 3}),
     ok = check_bad_map(fun() -> maps:remove(foo, id(not_a_map)) end),
+    {_, _, Iterator} = maps:next(maps:iterator(#{a => 1, b => 2, c => 3})),
+    ?ASSERT_EQUALS(lists:sort(maps:to_list(maps:remove(a, Iterator))), [{b, 2}, {c, 3}]),
+    ?ASSERT_EQUALS(maps:size(maps:remove(b, Iterator)), 1),
     ok.
 
 test_update() ->
@@ -186,6 +193,31 @@ test_update() ->
     ok = check_bad_map(fun() -> maps:update(foo, bar, id(not_a_map)) end),
     ok.
 
+test_large_maps() ->
+    Evens = maps:from_list([{N, even} || N <- lists:seq(0, 200, 2)]),
+    Odds = maps:from_list([{N, odd} || N <- lists:seq(1, 201, 2)]),
+    All = maps:merge(Evens, Odds),
+    ?ASSERT_EQUALS(maps:size(All), 202),
+    ?ASSERT_EQUALS(maps:keys(All), lists:seq(0, 201)),
+    ?ASSERT_MATCH(maps:get(100, All), even),
+    ?ASSERT_MATCH(maps:get(101, All), odd),
+    ?ASSERT_EQUALS(maps:merge(All, Evens), All),
+    Overwritten = maps:merge(All, maps:from_list([{N, new} || N <- lists:seq(0, 201, 3)])),
+    ?ASSERT_EQUALS(maps:size(Overwritten), 202),
+    ?ASSERT_MATCH(maps:get(3, Overwritten), new),
+    ?ASSERT_MATCH(maps:get(4, Overwritten), even),
+    Mixed = lists:foldl(
+        fun(Key, Acc) -> maps:put(Key, Key, Acc) end,
+        maps:new(),
+        [z, 1, <<"b">>, {t}, 2.5, [l], a, 0, <<"a">>]
+    ),
+    ?ASSERT_EQUALS(maps:keys(Mixed), lists:sort([z, 1, <<"b">>, {t}, 2.5, [l], a, 0, <<"a">>])),
+    ?ASSERT_MATCH(maps:find({t}, Mixed), {ok, {t}}),
+    ?ASSERT_MATCH(maps:get(<<"a">>, maps:remove(<<"b">>, Mixed)), <<"a">>),
+    ?ASSERT_MATCH(maps:get(2.5, maps:update(2.5, updated, Mixed)), updated),
+    ?ASSERT_EQUALS(maps:fold(fun(K, _V, Acc) -> [K | Acc] end, [], All), lists:reverse(lists:seq(0, 201))),
+    ok.
+
 id(X) -> X.
 
 check_bad_map(F) ->
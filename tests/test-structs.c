@@ -19,9 +19,11 @@
  */
 
 #include <assert.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "atomshashtable.h"
+#include "timer_list.h"
 #include "utils.h"
 #include "valueshashtable.h"
 
@@ -118,6 +120,31 @@ void test_atomshashtable()
     assert(atomshashtable_has_key(htable, atom_9) == 1);
 }
 
+void test_atomshashtable_grow()
+{
+    struct AtomsHashTable *htable = atomshashtable_new();
+
+    char(*atoms)[8] = malloc(5000 * sizeof(*atoms));
+    assert(atoms != NULL);
+    for (int i = 0; i < 5000; i++) {
+        atoms[i][0] = snprintf(atoms[i] + 1, 7, "a%d", i);
+        assert(atomshashtable_insert(htable, atoms[i], i) == 1);
+    }
+    assert(htable->count == 5000);
+    assert(htable->capacity >= 5000);
+
+    for (int i = 0; i < 5000; i++) {
+        assert(atomshashtable_get_value(htable, atoms[i], 0xCAFEBABE) == (unsigned long) i);
+    }
+
+    char atom_missing[] = {5, 'a', '5', '0', '0', '0'};
+    assert(atomshashtable_has_key(htable, atom_missing) == 0);
+    assert(atomshashtable_get_value(htable, atom_missing, 0xCAFEBABE) == 0xCAFEBABE);
+
+    atomshashtable_destroy(htable);
+    free(atoms);
+}
+
 void test_valueshashtable()
 {
     struct ValuesHashTable *htable = valueshashtable_new();
@@ -139,13 +166,93 @@ void test_valueshashtable()
     }
 }
 
+#define TIMER_LIST_TEST_ITEMS 3000
+
+static uint64_t timer_list_test_now;
+static int timer_list_test_fired;
+
+static void timer_list_test_callback(struct TimerListItem *it)
+{
+    assert(it->expiry_time <= timer_list_test_now);
+    // Mark as fired
+    it->expiry_time = UINT64_MAX;
+    timer_list_test_fired++;
+}
+
+void test_timer_list()
+{
+    struct TimerList tw;
+    timer_list_init(&tw);
+    assert(timer_list_is_empty(&tw));
+
+    struct TimerListItem *items = malloc(TIMER_LIST_TEST_ITEMS * sizeof(struct TimerListItem));
+    assert(items != NULL);
+
+    uint64_t start = 1000000000;
+    uint32_t seed = 42;
+    for (int i = 0; i < TIMER_LIST_TEST_ITEMS; i++) {
+        seed = seed * 1103515245 + 12345;
+        // Cover all levels of the wheel as well as the overflow list
+        uint64_t delay = ((uint64_t) (seed >> 4) << 8) >> ((seed & 0xF) + 2);
+        timer_list_item_init(&items[i], start + delay);
+        timer_list_insert(&tw, &items[i]);
+    }
+    assert(timer_list_timers_count(&tw) == TIMER_LIST_TEST_ITEMS);
+
+    int removed = 0;
+    for (int i = 0; i < TIMER_LIST_TEST_ITEMS; i += 7) {
+        timer_list_remove(&tw, &items[i]);
+        removed++;
+    }
+    assert(timer_list_timers_count(&tw) == TIMER_LIST_TEST_ITEMS - removed);
+
+    // Nothing is due yet
+    timer_list_test_now = start - 1;
+    timer_list_next(&tw, timer_list_test_now, timer_list_test_callback);
+    assert(timer_list_test_fired == 0);
+
+    timer_list_test_now = start;
+    while (!timer_list_is_empty(&tw)) {
+        seed = seed * 1103515245 + 12345;
+        timer_list_test_now += ((uint64_t) (seed >> 4) << 4) >> ((seed & 0xF) + 4);
+        timer_list_next(&tw, timer_list_test_now, timer_list_test_callback);
+
+        // Every timer up to now was fired and next_timer is the earliest
+        uint64_t next_timer = 0;
+        for (int i = 0; i < TIMER_LIST_TEST_ITEMS; i++) {
+            if (i % 7 == 0 || items[i].expiry_time == UINT64_MAX) {
+                continue;
+            }
+            assert(items[i].expiry_time > timer_list_test_now);
+            if (next_timer == 0 || items[i].expiry_time < next_timer) {
+                next_timer = items[i].expiry_time;
+            }
+        }
+        assert(tw.next_timer == next_timer);
+    }
+    assert(timer_list_test_fired == TIMER_LIST_TEST_ITEMS - removed);
+
+    // Timers in the past fire on next call
+    timer_list_test_fired = 0;
+    timer_list_item_init(&items[0], start);
+    timer_list_insert(&tw, &items[0]);
+    timer_list_next(&tw, timer_list_test_now, timer_list_test_callback);
+    assert(timer_list_test_fired == 1);
+    assert(timer_list_is_empty(&tw));
+    assert(tw.next_timer == 0);
+
+    free(items);
+}
+
 int main(int argc, char **argv)
 {
     UNUSED(argc);
     UNUSED(argv);
 
     test_atomshashtable();
+    test_atomshashtable_grow();
     test_valueshashtable();
+    test_timer_list();
 
     return EXIT_SUCCESS;
 }
@@ -508,6 +508,20 @@ struct Test tests[] = {
     TEST_CASE(test_crypto),
 
     TEST_CASE(test_min_max_guard),
+    TEST_CASE(test_shared_literals),
+    TEST_CASE(test_large_select),
+    TEST_CASE(test_register_many),
+    TEST_CASE(test_timers),
+    TEST_CASE(test_process_priority),
+    TEST_CASE(test_gc_generations),
+    TEST_CASE(test_heap_growth),
+    TEST_CASE(test_memory_pool),
+    TEST_CASE(test_large_messages),
+    TEST_CASE(test_shared_copy),
+    TEST_CASE(test_message_queue_data),
+    TEST_CASE(test_heap_fragments),
+    TEST_CASE(test_nif_heap_reservation),
+    TEST_CASE(test_leaf_ordering),
 
     // TEST CRASHES HERE: TEST_CASE(memlimit),
 